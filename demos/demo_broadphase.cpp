@@ -0,0 +1,120 @@
+#include "demo_framework.hpp"
+#include "engine/physics/physics_system.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+// Compares PhysicsSystem broadphases on the scene shapes the games produce.
+// Every collider moves and is marked each frame; timings cover run() only.
+
+namespace {
+
+enum class SceneKind { Uniform, Bosses, Clustered, Sparse };
+
+struct BenchScene {
+    std::vector<Transform2D> transforms;
+    std::vector<Collider> colliders;
+    std::vector<Vec2f> velocity;
+    float world = 1280.0f;
+};
+
+// Small LCG so every mode sees the exact same scene
+struct Lcg {
+    uint32_t state;
+    float next() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.0f;
+    }
+};
+
+void build_scene(BenchScene& s, SceneKind kind, int count) {
+    Lcg rng{12345u};
+    s.world = (kind == SceneKind::Sparse) ? 20000.0f : 1280.0f;
+    s.transforms.assign(count, Transform2D{});
+    s.colliders.assign(count, Collider{});
+    s.velocity.assign(count, Vec2f{});
+
+    for (int i = 0; i < count; ++i) {
+        Vec2f p{rng.next() * s.world, rng.next() * s.world};
+        if (kind == SceneKind::Clustered) {
+            // Eight dense clumps, as around spawners
+            float cx = static_cast<float>(i % 8) * 150.0f + 100.0f;
+            p = {cx + rng.next() * 80.0f, 300.0f + rng.next() * 80.0f};
+        }
+        s.transforms[i].position = p;
+        s.velocity[i] = {rng.next() * 4.0f - 2.0f, rng.next() * 4.0f - 2.0f};
+
+        auto& c = s.colliders[i];
+        c.transform = &s.transforms[i];
+        if (i % 50 == 0) {
+            c.tag = ColliderTag::Player;
+            c.shape = CircleData{8.0f};
+        } else if (i % 5 == 0) {
+            c.tag = ColliderTag::Enemy;
+            bool boss = (kind == SceneKind::Bosses) && (i % 250 == 5);
+            c.shape = boss ? AABBData{Vec2f(400.0f, 250.0f)} : AABBData{Vec2f(12.0f, 12.0f)};
+        } else {
+            c.tag = ColliderTag::Bullet;
+            c.shape = CircleData{3.0f};
+        }
+    }
+}
+
+struct BenchResult {
+    double ms_per_frame;
+    size_t hits;
+};
+
+BenchResult run_bench(SceneKind kind, int count, Broadphase2D mode, int frames) {
+    BenchScene s;
+    build_scene(s, kind, count);
+
+    PhysicsSystem physics;
+    physics.set_broadphase(mode);
+    size_t hits = 0;
+    for (auto& c : s.colliders) {
+        physics.register_collider(c);
+        c.on_hit = [&hits](const Collider&) { ++hits; return false; };
+    }
+
+    double total_ms = 0.0;
+    for (int f = 0; f < frames; ++f) {
+        for (int i = 0; i < count; ++i) {
+            s.transforms[i].position += s.velocity[i];
+            physics.mark_moved(s.colliders[i]);
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        physics.run();
+        auto end = std::chrono::high_resolution_clock::now();
+        total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    return {total_ms / frames, hits};
+}
+
+} // namespace
+
+DEMO(Physics2D_Broadphase_Benchmark) {
+    struct Case { const char* name; SceneKind kind; int count; };
+    const Case cases[] = {
+        {"uniform",   SceneKind::Uniform,   4000},
+        {"bosses",    SceneKind::Bosses,    4000},
+        {"clustered", SceneKind::Clustered, 2000},
+        {"sparse",    SceneKind::Sparse,    4000},
+    };
+    const struct { const char* name; Broadphase2D mode; } modes[] = {
+        {"brute", Broadphase2D::BruteForce},
+        {"grid",  Broadphase2D::Grid},
+        {"tree",  Broadphase2D::AabbTree},
+    };
+    constexpr int frames = 20;
+
+    std::printf("  %-10s %6s  %-6s %10s %10s\n", "scene", "count", "mode", "ms/frame", "hits");
+    for (const auto& c : cases) {
+        for (const auto& m : modes) {
+            auto r = run_bench(c.kind, c.count, m.mode, frames);
+            std::printf("  %-10s %6d  %-6s %10.3f %10zu\n",
+                        c.name, c.count, m.name, r.ms_per_frame, r.hits);
+        }
+    }
+}
@@ -64,6 +64,7 @@ DEMO(Physics2D_SpatialGrid) {
     grid.insert(&c1);
     grid.insert(&c2);
     grid.insert(&c3);
+    grid.build();
 
     auto near = grid.query({0.0f, 0.0f}, {64.0f, 64.0f});
     std::printf("  Query (0,0)-(64,64): found %zu colliders\n", near.size());
@@ -2,6 +2,9 @@
 #include "engine/render/render_command.hpp"
 #include "engine/render/command_buffer.hpp"
 #include "engine/render/double_buffer.hpp"
+#include "engine/render/headless_renderer.hpp"
+#include "engine/render/render_pipeline.hpp"
+#include <chrono>
 #include <cstdio>
 
 DEMO(RenderCommand_CommandBuffer) {
@@ -15,24 +18,37 @@ DEMO(RenderCommand_CommandBuffer) {
 
     std::printf("  Buffer commands: %zu\n", buf.size());
 
-    for (const auto& cmd : buf.commands()) {
-        std::visit([](const auto& c) {
-            using T = std::decay_t<decltype(c)>;
-            if constexpr (std::is_same_v<T, RenderCmd_Clear>)
+    std::printf("  Stream: %zu bytes\n", buf.stream_bytes());
+
+    for (CommandView cmd : buf) {
+        switch (cmd.type()) {
+            case RenderCommandType::Clear: {
+                const auto& c = cmd.as<RenderCmd_Clear>();
                 std::printf("    Clear: color=(%d,%d,%d)\n", c.color.r, c.color.g, c.color.b);
-            else if constexpr (std::is_same_v<T, RenderCmd_SetViewProjection>)
+                break;
+            }
+            case RenderCommandType::SetViewProjection:
                 std::printf("    SetViewProjection\n");
-            else if constexpr (std::is_same_v<T, RenderCmd_DrawRect>)
+                break;
+            case RenderCommandType::DrawRect: {
+                const auto& c = cmd.as<RenderCmd_DrawRect>();
                 std::printf("    DrawRect: pos=(%.1f,%.1f) size=%.1fx%.1f\n",
                             c.position.x, c.position.y, c.width, c.height);
-            else if constexpr (std::is_same_v<T, RenderCmd_DrawCircle>)
+                break;
+            }
+            case RenderCommandType::DrawCircle: {
+                const auto& c = cmd.as<RenderCmd_DrawCircle>();
                 std::printf("    DrawCircle: center=(%.1f,%.1f) r=%.1f\n",
                             c.center.x, c.center.y, c.radius);
-            else if constexpr (std::is_same_v<T, RenderCmd_DrawDebugLine>)
+                break;
+            }
+            case RenderCommandType::DrawDebugLine:
                 std::printf("    DrawDebugLine\n");
-            else
+                break;
+            default:
                 std::printf("    (other command)\n");
-        }, cmd);
+                break;
+        }
     }
 }
 
@@ -69,3 +85,45 @@ DEMO(RenderCommand_SharedCollector) {
     std::printf("  Thread1: 2 commands, Thread2: 1 command\n");
     std::printf("  Merged total: %zu commands\n", merged.size());
 }
+
+DEMO(RenderCommand_Headless) {
+    RenderPipeline pipeline;
+    MeshData tri;
+    tri.vertices.resize(3);
+    tri.vertices[1].position = {1.0f, 0.0f, 0.0f};
+    tri.vertices[2].position = {0.0f, 1.0f, 0.0f};
+    uint64_t mesh = pipeline.register_mesh(tri);
+    pipeline.set_projection_matrix(Mat4::perspective(1.0f, 4.0f / 3.0f, 0.1f, 100.0f));
+    pipeline.set_view_matrix(Mat4::look_at({0.0f, 0.0f, 10.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}));
+
+    // Record, sort and consume frames with no window or GPU
+    HeadlessRenderer renderer({320, 240});
+    renderer.initialize();
+    double total_ms = 0.0;
+    const int frames = 10;
+    for (int f = 0; f < frames; ++f) {
+        auto start = std::chrono::high_resolution_clock::now();
+        pipeline.begin_frame();
+        CommandBuffer opaque;
+        for (int i = 0; i < 1000; ++i) {
+            float x = static_cast<float>(i % 40) * 0.5f - 10.0f;
+            float y = static_cast<float>(i / 40) * 0.5f - 6.0f;
+            opaque.push(RenderCmd_DrawMesh{mesh, Mat4::translation({x, y, 0.0f}), 0});
+        }
+        pipeline.submit(RenderStage::Opaque, std::move(opaque));
+        pipeline.end_frame();
+
+        renderer.begin_frame();
+        renderer.consume(pipeline);
+        renderer.end_frame();
+        auto end = std::chrono::high_resolution_clock::now();
+        total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    // The read buffer lags one frame, so the first frame is empty
+    const HeadlessFrameStats& stats = renderer.stats();
+    std::printf("  %d frames, avg %.3f ms\n", frames, total_ms / frames);
+    std::printf("  Last frame: %u commands, %u triangles, %u errors, hash %016llx\n",
+                stats.commands, stats.triangles, stats.errors,
+                static_cast<unsigned long long>(stats.hash));
+}
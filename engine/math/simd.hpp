@@ -0,0 +1,94 @@
+#pragma once
+
+// SIMD capability detection for batched kernels (physics, culling).
+//
+//   ERGO_SIMD_AVX2  8-wide float lanes (configure with -DERGO_ENABLE_AVX2=ON)
+//   ERGO_SIMD_SSE   4-wide float lanes (baseline on x86-64)
+//
+// Kernels must keep a scalar path for other targets (ARM, Web).
+// FMA is deliberately not enabled so SIMD and scalar results match bit for bit.
+
+#if defined(__AVX2__)
+    #define ERGO_SIMD_AVX2 1
+#else
+    #define ERGO_SIMD_AVX2 0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ERGO_SIMD_SSE 1
+#else
+    #define ERGO_SIMD_SSE 0
+#endif
+
+#if ERGO_SIMD_AVX2
+    #include <immintrin.h>
+#elif ERGO_SIMD_SSE
+    #include <emmintrin.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Thin lane wrappers so kernels are written once for both widths.
+// Everything maps to a single IEEE instruction except rsqrt (an estimate).
+#if ERGO_SIMD_AVX2 || ERGO_SIMD_SSE
+namespace simd {
+
+#if ERGO_SIMD_AVX2
+constexpr size_t lanes = 8;
+using vfloat = __m256;
+inline vfloat load(const float* p)        { return _mm256_loadu_ps(p); }
+inline void store(float* p, vfloat v)     { _mm256_storeu_ps(p, v); }
+inline vfloat splat(float v)              { return _mm256_set1_ps(v); }
+inline vfloat add(vfloat a, vfloat b)     { return _mm256_add_ps(a, b); }
+inline vfloat sub(vfloat a, vfloat b)     { return _mm256_sub_ps(a, b); }
+inline vfloat mul(vfloat a, vfloat b)     { return _mm256_mul_ps(a, b); }
+inline vfloat div(vfloat a, vfloat b)     { return _mm256_div_ps(a, b); }
+inline vfloat sqrt(vfloat a)              { return _mm256_sqrt_ps(a); }
+inline vfloat rsqrt(vfloat a)             { return _mm256_rsqrt_ps(a); }
+inline vfloat vmax(vfloat a, vfloat b)    { return _mm256_max_ps(a, b); }
+inline vfloat cmp_le(vfloat a, vfloat b)  { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+inline vfloat cmp_lt(vfloat a, vfloat b)  { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline vfloat vand(vfloat a, vfloat b)    { return _mm256_and_ps(a, b); }
+inline vfloat vor(vfloat a, vfloat b)     { return _mm256_or_ps(a, b); }
+// mask ? a : b, per lane
+inline vfloat select(vfloat mask, vfloat a, vfloat b) { return _mm256_blendv_ps(b, a, mask); }
+inline uint32_t movemask(vfloat m)        { return static_cast<uint32_t>(_mm256_movemask_ps(m)); }
+// All-ones lanes where the byte p[i] is zero
+inline vfloat zero_byte_mask(const uint8_t* p) {
+    __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    return _mm256_castsi256_ps(_mm256_cmpeq_epi32(v, _mm256_setzero_si256()));
+}
+#else
+constexpr size_t lanes = 4;
+using vfloat = __m128;
+inline vfloat load(const float* p)        { return _mm_loadu_ps(p); }
+inline void store(float* p, vfloat v)     { _mm_storeu_ps(p, v); }
+inline vfloat splat(float v)              { return _mm_set1_ps(v); }
+inline vfloat add(vfloat a, vfloat b)     { return _mm_add_ps(a, b); }
+inline vfloat sub(vfloat a, vfloat b)     { return _mm_sub_ps(a, b); }
+inline vfloat mul(vfloat a, vfloat b)     { return _mm_mul_ps(a, b); }
+inline vfloat div(vfloat a, vfloat b)     { return _mm_div_ps(a, b); }
+inline vfloat sqrt(vfloat a)              { return _mm_sqrt_ps(a); }
+inline vfloat rsqrt(vfloat a)             { return _mm_rsqrt_ps(a); }
+inline vfloat vmax(vfloat a, vfloat b)    { return _mm_max_ps(a, b); }
+inline vfloat cmp_le(vfloat a, vfloat b)  { return _mm_cmple_ps(a, b); }
+inline vfloat cmp_lt(vfloat a, vfloat b)  { return _mm_cmplt_ps(a, b); }
+inline vfloat vand(vfloat a, vfloat b)    { return _mm_and_ps(a, b); }
+inline vfloat vor(vfloat a, vfloat b)     { return _mm_or_ps(a, b); }
+inline vfloat select(vfloat mask, vfloat a, vfloat b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+inline uint32_t movemask(vfloat m)        { return static_cast<uint32_t>(_mm_movemask_ps(m)); }
+inline vfloat zero_byte_mask(const uint8_t* p) {
+    int32_t bytes;
+    std::memcpy(&bytes, p, sizeof(bytes));
+    __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+    return _mm_castsi128_ps(_mm_cmpeq_epi32(v, zero));
+}
+#endif
+
+} // namespace simd
+#endif
@@ -0,0 +1,241 @@
+#include "aabb_tree.hpp"
+
+// Insertion cost heuristic and rotations follow the surface-area (here:
+// perimeter) approach popularized by Box2D's b2DynamicTree.
+
+int32_t AabbTree2D::allocate_node() {
+    int32_t id;
+    if (free_list_ != null_node) {
+        id = free_list_;
+        free_list_ = nodes_[id].parent;
+    } else {
+        id = static_cast<int32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    nodes_[id] = Node{};
+    nodes_[id].height = 0;
+    return id;
+}
+
+void AabbTree2D::free_node(int32_t id) {
+    nodes_[id] = Node{};
+    nodes_[id].parent = free_list_;
+    free_list_ = id;
+}
+
+int32_t AabbTree2D::create_proxy(const Aabb2D& aabb, void* user_data) {
+    int32_t leaf = allocate_node();
+    nodes_[leaf].aabb = {{aabb.min.x - margin_, aabb.min.y - margin_},
+                         {aabb.max.x + margin_, aabb.max.y + margin_}};
+    nodes_[leaf].user_data = user_data;
+    insert_leaf(leaf);
+    ++proxy_count_;
+    return leaf;
+}
+
+void AabbTree2D::destroy_proxy(int32_t proxy) {
+    remove_leaf(proxy);
+    free_node(proxy);
+    --proxy_count_;
+}
+
+bool AabbTree2D::move_proxy(int32_t proxy, const Aabb2D& aabb) {
+    if (nodes_[proxy].aabb.contains(aabb)) return false;
+
+    remove_leaf(proxy);
+    nodes_[proxy].aabb = {{aabb.min.x - margin_, aabb.min.y - margin_},
+                          {aabb.max.x + margin_, aabb.max.y + margin_}};
+    insert_leaf(proxy);
+    return true;
+}
+
+void AabbTree2D::touch(int32_t proxy) {
+    if (!nodes_[proxy].moved) touched_.push_back(proxy);
+    // Ancestors of a moved leaf are always flagged, so stop at the first one
+    for (int32_t i = proxy; i != null_node && !nodes_[i].moved; i = nodes_[i].parent) {
+        nodes_[i].moved = true;
+    }
+}
+
+void AabbTree2D::clear_moved() {
+    // The first chain clears up to the root; later chains stop early
+    for (int32_t leaf : touched_) {
+        for (int32_t i = leaf; i != null_node && nodes_[i].moved; i = nodes_[i].parent) {
+            nodes_[i].moved = false;
+        }
+    }
+    touched_.clear();
+}
+
+void AabbTree2D::clear() {
+    nodes_.clear();
+    touched_.clear();
+    root_ = null_node;
+    free_list_ = null_node;
+    proxy_count_ = 0;
+}
+
+void AabbTree2D::insert_leaf(int32_t leaf) {
+    if (root_ == null_node) {
+        root_ = leaf;
+        nodes_[leaf].parent = null_node;
+        return;
+    }
+
+    // Descend to the sibling with the cheapest perimeter increase
+    Aabb2D leaf_aabb = nodes_[leaf].aabb;
+    int32_t index = root_;
+    while (!nodes_[index].is_leaf()) {
+        const Node& n = nodes_[index];
+        float area = n.aabb.perimeter();
+        float combined = Aabb2D::merge(n.aabb, leaf_aabb).perimeter();
+
+        float cost = 2.0f * combined;
+        float inheritance = 2.0f * (combined - area);
+
+        auto child_cost = [&](int32_t c) {
+            const Node& cn = nodes_[c];
+            float merged = Aabb2D::merge(leaf_aabb, cn.aabb).perimeter();
+            return (cn.is_leaf() ? merged : merged - cn.aabb.perimeter()) + inheritance;
+        };
+        float cost1 = child_cost(n.child1);
+        float cost2 = child_cost(n.child2);
+
+        if (cost < cost1 && cost < cost2) break;
+        index = (cost1 < cost2) ? n.child1 : n.child2;
+    }
+
+    int32_t sibling = index;
+    int32_t old_parent = nodes_[sibling].parent;
+    int32_t new_parent = allocate_node();
+    nodes_[new_parent].parent = old_parent;
+    nodes_[new_parent].child1 = sibling;
+    nodes_[new_parent].child2 = leaf;
+    nodes_[sibling].parent = new_parent;
+    nodes_[leaf].parent = new_parent;
+
+    if (old_parent != null_node) {
+        if (nodes_[old_parent].child1 == sibling) nodes_[old_parent].child1 = new_parent;
+        else                                      nodes_[old_parent].child2 = new_parent;
+    } else {
+        root_ = new_parent;
+    }
+
+    refit_upwards(new_parent);
+}
+
+void AabbTree2D::remove_leaf(int32_t leaf) {
+    if (leaf == root_) {
+        root_ = null_node;
+        return;
+    }
+
+    int32_t parent = nodes_[leaf].parent;
+    int32_t grand = nodes_[parent].parent;
+    int32_t sibling = (nodes_[parent].child1 == leaf) ? nodes_[parent].child2
+                                                      : nodes_[parent].child1;
+
+    if (grand != null_node) {
+        if (nodes_[grand].child1 == parent) nodes_[grand].child1 = sibling;
+        else                                nodes_[grand].child2 = sibling;
+        nodes_[sibling].parent = grand;
+        free_node(parent);
+        refit_upwards(grand);
+    } else {
+        root_ = sibling;
+        nodes_[sibling].parent = null_node;
+        free_node(parent);
+    }
+    nodes_[leaf].parent = null_node;
+}
+
+void AabbTree2D::refit_upwards(int32_t index) {
+    while (index != null_node) {
+        index = balance(index);
+        Node& n = nodes_[index];
+        const Node& c1 = nodes_[n.child1];
+        const Node& c2 = nodes_[n.child2];
+        n.aabb = Aabb2D::merge(c1.aabb, c2.aabb);
+        n.height = 1 + std::max(c1.height, c2.height);
+        n.moved = c1.moved || c2.moved;
+        index = n.parent;
+    }
+}
+
+// Rotate a child up when the subtree heights differ by more than one.
+// Returns the index of the node now at A's position.
+int32_t AabbTree2D::balance(int32_t ia) {
+    Node& a = nodes_[ia];
+    if (a.is_leaf() || a.height < 2) return ia;
+
+    auto update = [this](int32_t i) {
+        Node& n = nodes_[i];
+        const Node& c1 = nodes_[n.child1];
+        const Node& c2 = nodes_[n.child2];
+        n.aabb = Aabb2D::merge(c1.aabb, c2.aabb);
+        n.height = 1 + std::max(c1.height, c2.height);
+        n.moved = c1.moved || c2.moved;
+    };
+
+    auto replace_in_parent = [this](int32_t parent, int32_t old_child, int32_t new_child) {
+        if (parent == null_node) {
+            root_ = new_child;
+        } else if (nodes_[parent].child1 == old_child) {
+            nodes_[parent].child1 = new_child;
+        } else {
+            nodes_[parent].child2 = new_child;
+        }
+    };
+
+    int32_t ib = a.child1;
+    int32_t ic = a.child2;
+    int32_t diff = nodes_[ic].height - nodes_[ib].height;
+
+    if (diff > 1) {
+        // Rotate C up
+        int32_t i_f = nodes_[ic].child1;
+        int32_t i_g = nodes_[ic].child2;
+        nodes_[ic].child1 = ia;
+        nodes_[ic].parent = a.parent;
+        a.parent = ic;
+        replace_in_parent(nodes_[ic].parent, ia, ic);
+
+        if (nodes_[i_f].height > nodes_[i_g].height) {
+            nodes_[ic].child2 = i_f;
+            a.child2 = i_g;
+            nodes_[i_g].parent = ia;
+        } else {
+            nodes_[ic].child2 = i_g;
+            a.child2 = i_f;
+            nodes_[i_f].parent = ia;
+        }
+        update(ia);
+        update(ic);
+        return ic;
+    }
+
+    if (diff < -1) {
+        // Rotate B up
+        int32_t i_d = nodes_[ib].child1;
+        int32_t i_e = nodes_[ib].child2;
+        nodes_[ib].child1 = ia;
+        nodes_[ib].parent = a.parent;
+        a.parent = ib;
+        replace_in_parent(nodes_[ib].parent, ia, ib);
+
+        if (nodes_[i_d].height > nodes_[i_e].height) {
+            nodes_[ib].child2 = i_d;
+            a.child1 = i_e;
+            nodes_[i_e].parent = ia;
+        } else {
+            nodes_[ib].child2 = i_e;
+            a.child1 = i_d;
+            nodes_[i_d].parent = ia;
+        }
+        update(ia);
+        update(ib);
+        return ib;
+    }
+
+    return ia;
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include "../math/vec2.hpp"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// Axis-aligned box used by the 2D broadphase structures
+struct Aabb2D {
+    Vec2f min;
+    Vec2f max;
+
+    bool overlaps(const Aabb2D& o) const {
+        return min.x <= o.max.x && max.x >= o.min.x &&
+               min.y <= o.max.y && max.y >= o.min.y;
+    }
+
+    bool contains(const Aabb2D& o) const {
+        return min.x <= o.min.x && min.y <= o.min.y &&
+               max.x >= o.max.x && max.y >= o.max.y;
+    }
+
+    float perimeter() const {
+        return 2.0f * ((max.x - min.x) + (max.y - min.y));
+    }
+
+    static Aabb2D merge(const Aabb2D& a, const Aabb2D& b) {
+        return {{std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y)},
+                {std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y)}};
+    }
+};
+
+// Dynamic AABB tree (incrementally balanced BVH) for 2D broadphase.
+//
+// Leaves store "fat" AABBs enlarged by a margin, so small movements only
+// need a containment check; a leaf is reinserted when its tight box escapes.
+// Suited to sparse worlds and colliders whose sizes vary by orders of
+// magnitude, where a fixed-cell grid degrades.
+//
+// Moved tracking: touch() flags a leaf and its ancestors so find_pairs()
+// can skip subtree pairs in which nothing moved. clear_moved() resets them.
+class AabbTree2D {
+public:
+    static constexpr int32_t null_node = -1;
+
+    explicit AabbTree2D(float margin = 4.0f) : margin_(margin) {}
+
+    // Create a leaf for `aabb` (tight box); returns the proxy id
+    int32_t create_proxy(const Aabb2D& aabb, void* user_data);
+    void destroy_proxy(int32_t proxy);
+
+    // Refit after movement. Returns true if the leaf had to be reinserted.
+    bool move_proxy(int32_t proxy, const Aabb2D& aabb);
+
+    void touch(int32_t proxy);
+    void clear_moved();
+    bool was_moved(int32_t proxy) const { return nodes_[proxy].moved; }
+
+    void* user_data(int32_t proxy) const { return nodes_[proxy].user_data; }
+    const Aabb2D& fat_aabb(int32_t proxy) const { return nodes_[proxy].aabb; }
+
+    void clear();
+    int32_t height() const { return root_ == null_node ? 0 : nodes_[root_].height; }
+    size_t proxy_count() const { return proxy_count_; }
+
+    // Call fn(user_data) for every leaf whose fat AABB overlaps `aabb`.
+    // Reuses an internal stack: not safe to call concurrently on one tree.
+    template<typename Fn>
+    void query(const Aabb2D& aabb, Fn&& fn) const {
+        if (root_ == null_node) return;
+        query_stack_.clear();
+        query_stack_.push_back(root_);
+        while (!query_stack_.empty()) {
+            const Node& n = nodes_[query_stack_.back()];
+            query_stack_.pop_back();
+            if (!n.aabb.overlaps(aabb)) continue;
+            if (n.is_leaf()) {
+                fn(n.user_data);
+            } else {
+                query_stack_.push_back(n.child1);
+                query_stack_.push_back(n.child2);
+            }
+        }
+    }
+
+    // Tree-vs-tree: call fn(user_a, user_b) for every overlapping leaf pair
+    // (a from this tree, b from `other`). With moved_only, pairs where
+    // neither leaf was touched since clear_moved() are skipped.
+    // Reuses an internal stack: not safe to call concurrently on one tree.
+    template<typename Fn>
+    void find_pairs(const AabbTree2D& other, bool moved_only, Fn&& fn) const {
+        if (root_ == null_node || other.root_ == null_node) return;
+        pair_stack_.clear();
+        pair_stack_.push_back({root_, other.root_});
+        while (!pair_stack_.empty()) {
+            NodePair p = pair_stack_.back();
+            pair_stack_.pop_back();
+            const Node& na = nodes_[p.a];
+            const Node& nb = other.nodes_[p.b];
+            if (moved_only && !na.moved && !nb.moved) continue;
+            if (!na.aabb.overlaps(nb.aabb)) continue;
+
+            if (na.is_leaf() && nb.is_leaf()) {
+                fn(na.user_data, nb.user_data);
+            } else if (nb.is_leaf() || (!na.is_leaf() &&
+                       na.aabb.perimeter() >= nb.aabb.perimeter())) {
+                // Descend the larger node first to keep the pair set tight
+                pair_stack_.push_back({na.child1, p.b});
+                pair_stack_.push_back({na.child2, p.b});
+            } else {
+                pair_stack_.push_back({p.a, nb.child1});
+                pair_stack_.push_back({p.a, nb.child2});
+            }
+        }
+    }
+
+private:
+    struct Node {
+        Aabb2D aabb;
+        void* user_data = nullptr;
+        int32_t parent = null_node;   // doubles as the free-list link
+        int32_t child1 = null_node;
+        int32_t child2 = null_node;
+        int32_t height = -1;          // leaf = 0, free = -1
+        bool moved = false;
+
+        bool is_leaf() const { return child1 == null_node; }
+    };
+
+    std::vector<Node> nodes_;
+    int32_t root_ = null_node;
+    int32_t free_list_ = null_node;
+    size_t proxy_count_ = 0;
+    float margin_;
+
+    struct NodePair {
+        int32_t a, b;
+    };
+
+    std::vector<int32_t> touched_;
+    mutable std::vector<int32_t> query_stack_;
+    mutable std::vector<NodePair> pair_stack_;
+
+    int32_t allocate_node();
+    void free_node(int32_t id);
+    void insert_leaf(int32_t leaf);
+    void remove_leaf(int32_t leaf);
+    void refit_upwards(int32_t index);
+    int32_t balance(int32_t a);
+};
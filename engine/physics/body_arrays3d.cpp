@@ -0,0 +1,93 @@
+#include "body_arrays3d.hpp"
+#include "rigid_body_world.hpp"
+#include "convex_hull3d.hpp"
+
+float inverse_inertia(const PhysicsBody& pb) {
+    if (pb.body.inv_mass == 0.0f) return 0.0f;
+    if (auto* sphere = std::get_if<SphereShape>(&pb.shape)) {
+        return pb.body.inv_mass / (0.4f * sphere->radius * sphere->radius);
+    }
+    // Boxes use the mean of the three principal moments m/3 * (h1^2 + h2^2);
+    // capsules and hulls use the box of their bounds
+    Vec3f half;
+    if (auto* box = std::get_if<BoxShape>(&pb.shape)) {
+        half = box->half_extent;
+    } else if (auto* capsule = std::get_if<CapsuleShape>(&pb.shape)) {
+        half = {capsule->radius, capsule->half_height + capsule->radius, capsule->radius};
+    } else if (auto* hull = std::get_if<ConvexHullShape>(&pb.shape); hull && hull->hull) {
+        half = (hull->hull->bounds().max - hull->hull->bounds().min) * 0.5f;
+    } else {
+        return 0.0f;
+    }
+    return pb.body.inv_mass / ((2.0f / 9.0f) * half.length_sq());
+}
+
+void BodyArrays3D::clear() {
+    id.clear();
+    position.clear();
+    rotation.clear();
+    velocity.clear();
+    angular_velocity.clear();
+    force.clear();
+    torque.clear();
+    inv_mass.clear();
+    inv_inertia.clear();
+    gravity_scale.clear();
+    linear_damping.clear();
+    angular_damping.clear();
+    sleep_timer.clear();
+    flags.clear();
+    cold.clear();
+}
+
+void BodyArrays3D::reserve(size_t n) {
+    id.reserve(n);
+    position.reserve(n);
+    rotation.reserve(n);
+    velocity.reserve(n);
+    angular_velocity.reserve(n);
+    force.reserve(n);
+    torque.reserve(n);
+    inv_mass.reserve(n);
+    inv_inertia.reserve(n);
+    gravity_scale.reserve(n);
+    linear_damping.reserve(n);
+    angular_damping.reserve(n);
+    sleep_timer.reserve(n);
+    flags.reserve(n);
+    cold.reserve(n);
+}
+
+void BodyArrays3D::push_back(PhysicsBody& pb) {
+    const RigidBody& body = pb.body;
+    id.push_back(pb.id);
+    position.push_back(pb.transform.position);
+    rotation.push_back(pb.transform.rotation);
+    velocity.push_back(body.velocity);
+    angular_velocity.push_back(body.angular_velocity);
+    force.push_back(body.force_accumulator);
+    torque.push_back(body.torque_accumulator);
+    inv_mass.push_back(body.inv_mass);
+    inv_inertia.push_back(inverse_inertia(pb));
+    gravity_scale.push_back(body.gravity_scale);
+    linear_damping.push_back(body.linear_damping);
+    angular_damping.push_back(body.angular_damping);
+    sleep_timer.push_back(body.sleep_timer);
+    uint8_t f = 0;
+    if (body.type == RigidBodyType::Static) f |= flag_static;
+    if (body.is_sleeping) f |= flag_sleeping;
+    flags.push_back(f);
+    cold.push_back(&pb);
+}
+
+void BodyArrays3D::store(uint32_t i) const {
+    PhysicsBody& pb = *cold[i];
+    pb.transform.position = position[i];
+    pb.transform.rotation = rotation[i];
+    pb.body.velocity = velocity[i];
+    pb.body.angular_velocity = angular_velocity[i];
+    pb.body.force_accumulator = force[i];
+    pb.body.torque_accumulator = torque[i];
+    pb.body.sleep_timer = sleep_timer[i];
+    pb.body.is_sleeping = is_sleeping(i);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "../math/vec3.hpp"
+#include "../math/quat.hpp"
+#include "../math/transform3d.hpp"
+#include <vector>
+#include <cstdint>
+
+struct PhysicsBody;
+
+// One float array per component, so batched kernels can load 4-8 bodies'
+// x (or y, z) with a single instruction
+struct Vec3Column {
+    std::vector<float> x, y, z;
+
+    Vec3f operator[](size_t i) const { return {x[i], y[i], z[i]}; }
+    void set(size_t i, Vec3f v) { x[i] = v.x; y[i] = v.y; z[i] = v.z; }
+    void push_back(Vec3f v) { x.push_back(v.x); y.push_back(v.y); z.push_back(v.z); }
+    void clear() { x.clear(); y.clear(); z.clear(); }
+    void reserve(size_t n) { x.reserve(n); y.reserve(n); z.reserve(n); }
+};
+
+struct QuatColumn {
+    std::vector<float> x, y, z, w;
+
+    Quat operator[](size_t i) const { return {x[i], y[i], z[i], w[i]}; }
+    void set(size_t i, Quat q) { x[i] = q.x; y[i] = q.y; z[i] = q.z; w[i] = q.w; }
+    void push_back(Quat q) { x.push_back(q.x); y.push_back(q.y); z.push_back(q.z); w.push_back(q.w); }
+    void clear() { x.clear(); y.clear(); z.clear(); w.clear(); }
+    void reserve(size_t n) { x.reserve(n); y.reserve(n); z.reserve(n); w.reserve(n); }
+};
+
+// Hot per-body state of RigidBodyWorld in SoA form, one entry per live body.
+//
+// The world loads these arrays from its PhysicsBody records at the start of
+// a step and stores them back at the end, so the integrator, broadphase and
+// contact solver stream small contiguous arrays instead of walking large
+// PhysicsBody objects (shape variant, std::function callback, material).
+// Everything the solver never touches stays behind the cold pointer.
+struct BodyArrays3D {
+    enum Flags : uint8_t {
+        flag_static   = 1 << 0,
+        flag_sleeping = 1 << 1,
+    };
+
+    std::vector<uint64_t> id;
+    Vec3Column position;
+    QuatColumn rotation;
+    Vec3Column velocity;
+    Vec3Column angular_velocity;
+    Vec3Column force;
+    Vec3Column torque;
+    std::vector<float> inv_mass;
+    std::vector<float> inv_inertia;   // isotropic approximation, see inverse_inertia()
+    std::vector<float> gravity_scale;
+    std::vector<float> linear_damping;
+    std::vector<float> angular_damping;
+    std::vector<float> sleep_timer;
+    std::vector<uint8_t> flags;
+    std::vector<PhysicsBody*> cold;   // shape, material, callback
+
+    size_t size() const { return id.size(); }
+    void clear();
+    void reserve(size_t n);
+
+    // Append the hot state of pb; pb must outlive the arrays
+    void push_back(PhysicsBody& pb);
+
+    // Write entry i back to its PhysicsBody (transform, velocities, sleep)
+    void store(uint32_t i) const;
+
+    bool is_static(uint32_t i) const { return (flags[i] & flag_static) != 0; }
+    bool is_sleeping(uint32_t i) const { return (flags[i] & flag_sleeping) != 0; }
+    bool is_resting(uint32_t i) const { return flags[i] != 0; }
+
+    Transform3D transform(uint32_t i) const {
+        Transform3D t;
+        t.position = position[i];
+        t.rotation = rotation[i];
+        return t;
+    }
+};
+
+// Scalar inverse inertia for a body: sphere 2/5 m r^2, box the mean of the
+// three principal moments, capsules and hulls that of their bounding box.
+// Zero for immovable bodies and meshes.
+float inverse_inertia(const PhysicsBody& pb);
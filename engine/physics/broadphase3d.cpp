@@ -0,0 +1,175 @@
+#include "broadphase3d.hpp"
+#include "collision3d.hpp"
+#include "rigid_body_world.hpp"
+#include <algorithm>
+#include <cmath>
+
+int SweepAndPrune3D::choose_axis() const {
+    // Axis with the largest variance of AABB centers separates the most
+    Vec3f sum, sum_sq;
+    for (uint32_t i : order_) {
+        Vec3f c = (proxies_[i].aabb.min + proxies_[i].aabb.max) * 0.5f;
+        sum += c;
+        sum_sq += Vec3f{c.x * c.x, c.y * c.y, c.z * c.z};
+    }
+    float n = order_.empty() ? 1.0f : static_cast<float>(order_.size());
+    Vec3f var = sum_sq * (1.0f / n) - Vec3f{sum.x * sum.x, sum.y * sum.y, sum.z * sum.z} * (1.0f / (n * n));
+    int best = var.x >= var.y && var.x >= var.z ? 0 : (var.y >= var.z ? 1 : 2);
+    // A switch costs a full re-sort, so while the order is still valid keep
+    // the current axis unless another one clearly spreads bodies further
+    if (order_valid_ && axis_value(var, best) <= axis_switch_ratio * axis_value(var, axis_)) return axis_;
+    return best;
+}
+
+void SweepAndPrune3D::sort_order() {
+    auto key = [this](uint32_t i) { return axis_value(proxies_[i].aabb.min, axis_); };
+
+    if (!order_valid_) {
+        std::sort(order_.begin(), order_.end(), [&](uint32_t a, uint32_t b) {
+            return key(a) < key(b);
+        });
+        order_valid_ = true;
+        return;
+    }
+
+    // Nearly sorted from last step: insertion sort moves each body only as
+    // far as it travelled past its neighbours
+    for (size_t i = 1; i < order_.size(); ++i) {
+        uint32_t v = order_[i];
+        float k = key(v);
+        size_t j = i;
+        while (j > 0 && key(order_[j - 1]) > k) {
+            order_[j] = order_[j - 1];
+            --j;
+        }
+        order_[j] = v;
+    }
+}
+
+void SweepAndPrune3D::sweep_chunk(const BodyArrays3D& bodies, uint32_t chunk) {
+    auto& out = chunk_pairs_[chunk];
+    out.clear();
+    auto sweep_count = static_cast<uint32_t>(order_.size());
+    uint32_t begin = chunk * sweep_chunk_size_;
+    uint32_t end = std::min(sweep_count, begin + sweep_chunk_size_);
+
+    auto add_pair = [&](uint32_t a, uint32_t b) {
+        if (bodies.id[a] > bodies.id[b]) std::swap(a, b);
+        out.push_back({a, b, bodies.id[a], bodies.id[b], true});
+    };
+
+    // Candidates along the axis are those whose min lies before our max
+    for (uint32_t i = begin; i < end; ++i) {
+        uint32_t a = order_[i];
+        const Proxy& pa = proxies_[a];
+        float max_a = axis_value(pa.aabb.max, axis_);
+        for (size_t j = i + 1; j < order_.size(); ++j) {
+            uint32_t b = order_[j];
+            const Proxy& pb = proxies_[b];
+            if (axis_value(pb.aabb.min, axis_) > max_a) break;
+            if (pa.is_static && pb.is_static) continue;
+            if (pa.aabb.overlaps(pb.aabb)) add_pair(a, b);
+        }
+    }
+
+    // Planes: half-space test against each AABB's most negative corner
+    for (uint32_t p : planes_) {
+        const auto& plane = std::get<PlaneShape>(bodies.cold[p]->shape);
+        Vec3f n = plane.normal;
+        Vec3f abs_n{std::abs(n.x), std::abs(n.y), std::abs(n.z)};
+        for (uint32_t k = begin; k < end; ++k) {
+            uint32_t i = order_[k];
+            const Proxy& pi = proxies_[i];
+            if (proxies_[p].is_static && pi.is_static) continue;
+            Vec3f center = (pi.aabb.min + pi.aabb.max) * 0.5f;
+            Vec3f extent = (pi.aabb.max - pi.aabb.min) * 0.5f;
+            float dist = n.dot(center) - plane.offset;
+            if (dist < abs_n.dot(extent)) add_pair(p, i);
+        }
+    }
+}
+
+void SweepAndPrune3D::refit(const BodyArrays3D& bodies, JobSystem& jobs) {
+    auto count = static_cast<uint32_t>(bodies.size());
+    if (proxies_.size() != count) order_valid_ = false;
+
+    proxies_.resize(count);
+    jobs.parallel_for(0, count, aabb_chunk_size_, [this, &bodies](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            proxies_[i].aabb = compute_aabb3d(bodies.cold[i]->shape, bodies.transform(i));
+            proxies_[i].is_static = bodies.is_static(i);
+        }
+    });
+
+    if (!order_valid_) {
+        order_.clear();
+        planes_.clear();
+        for (uint32_t i = 0; i < count; ++i) {
+            bool is_plane = std::holds_alternative<PlaneShape>(bodies.cold[i]->shape);
+            (is_plane ? planes_ : order_).push_back(i);
+        }
+    }
+
+    int axis = choose_axis();
+    if (axis != axis_) {
+        axis_ = axis;
+        order_valid_ = false;
+    }
+    sort_order();
+
+    // Query bound: bodies over large_extent_factor times the mean length
+    // along the axis are set aside instead of widening every query's run
+    auto length = [this](uint32_t i) {
+        return axis_value(proxies_[i].aabb.max, axis_) - axis_value(proxies_[i].aabb.min, axis_);
+    };
+    float mean = 0.0f;
+    for (uint32_t i : order_) mean += length(i);
+    mean /= order_.empty() ? 1.0f : static_cast<float>(order_.size());
+
+    max_extent_ = 0.0f;
+    large_.clear();
+    for (uint32_t i : order_) {
+        float l = length(i);
+        proxies_[i].is_large = l > large_extent_factor * mean;
+        if (proxies_[i].is_large) large_.push_back(i);
+        else max_extent_ = std::max(max_extent_, l);
+    }
+}
+
+void SweepAndPrune3D::update(const BodyArrays3D& bodies, JobSystem& jobs) {
+    refit(bodies, jobs);
+
+    std::swap(prev_pairs_, pairs_);
+    pairs_.clear();
+
+    // Sweep in chunks of the sorted order, each into its own buffer
+    auto sweep_count = static_cast<uint32_t>(order_.size());
+    uint32_t buffer_count = (sweep_count + sweep_chunk_size_ - 1) / sweep_chunk_size_;
+    if (chunk_pairs_.size() < buffer_count) chunk_pairs_.resize(buffer_count);
+
+    jobs.parallel_for(0, buffer_count, 1, [this, &bodies](uint32_t first, uint32_t last) {
+        for (uint32_t c = first; c < last; ++c) sweep_chunk(bodies, c);
+    });
+
+    for (uint32_t c = 0; c < buffer_count; ++c) {
+        pairs_.insert(pairs_.end(), chunk_pairs_[c].begin(), chunk_pairs_[c].end());
+    }
+
+    // Id order is independent of where removals left each body in the arrays
+    std::sort(pairs_.begin(), pairs_.end(), [](const BroadphasePair3D& x, const BroadphasePair3D& y) {
+        if (x.id_a != y.id_a) return x.id_a < y.id_a;
+        return x.id_b < y.id_b;
+    });
+
+    // Merge against last step's pairs to flag the new ones
+    size_t k = 0;
+    for (auto& p : pairs_) {
+        while (k < prev_pairs_.size() &&
+               (prev_pairs_[k].id_a < p.id_a ||
+                (prev_pairs_[k].id_a == p.id_a && prev_pairs_[k].id_b < p.id_b))) {
+            ++k;
+        }
+        p.is_new = !(k < prev_pairs_.size() &&
+                     prev_pairs_[k].id_a == p.id_a && prev_pairs_[k].id_b == p.id_b);
+    }
+}
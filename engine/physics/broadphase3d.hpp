@@ -0,0 +1,144 @@
+#pragma once
+#include "collision_shape3d.hpp"
+#include "body_arrays3d.hpp"
+#include "../core/job_system.hpp"
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+// Candidate pair from the 3D broadphase. Indices refer to the body arrays
+// passed to update(), oriented so that id_a < id_b.
+struct BroadphasePair3D {
+    uint32_t a, b;
+    uint64_t id_a, id_b;
+    bool is_new;  // AABBs started overlapping this step
+};
+
+// Incremental sweep-and-prune over RigidBodyWorld bodies.
+//
+// Bodies are kept sorted by AABB min along the axis with the largest spread
+// of centers. Frame-to-frame coherence keeps that order nearly sorted, so the
+// re-sort is an insertion sort that runs in close to O(n). Adding or removing
+// bodies (or an axis change) falls back to a full sort, so the axis only
+// changes once another one's variance beats the current one's by 1.2x.
+//
+// Planes are infinite and never enter the sweep: each plane is tested
+// against every finite body's AABB as a half-space.
+//
+// The pair list persists across steps, keyed by body id, so pairs that keep
+// overlapping can be told apart from new ones (is_new). Pairs between two
+// static bodies are never reported.
+//
+// AABB updates and the sweep run in chunks on the given job system; pairs
+// are sorted afterwards, so the result does not depend on the chunking.
+//
+// The sorted order also serves scene queries: with the largest AABB length
+// along the sort axis known, the bodies that can reach an interval on that
+// axis form one contiguous run of the order, found by binary search. Bodies
+// far longer than average (level geometry) would stretch every run, so
+// queries test them separately, like planes.
+class SweepAndPrune3D {
+public:
+    void update(const BodyArrays3D& bodies, JobSystem& jobs = g_job_system);
+
+    // Recompute the bounds and sorted order without producing pairs, so
+    // queries see bodies where they are now (e.g. after the last substep
+    // moved them). The pair list is left as it was.
+    void refit(const BodyArrays3D& bodies, JobSystem& jobs = g_job_system);
+
+    // Force a full re-sort on the next update (bodies added or removed)
+    void invalidate() { order_valid_ = false; }
+
+    // Pairs sorted by (id_a, id_b)
+    const std::vector<BroadphasePair3D>& pairs() const { return pairs_; }
+
+    int sort_axis() const { return axis_; }
+
+    // Calls fn(body index) for every body whose AABB overlaps box, using the
+    // bounds from the last update() or refit(). Planes are always reported;
+    // callers test them exactly.
+    template <typename Fn>
+    void query(const Aabb3D& box, Fn&& fn) const {
+        float hi = axis_value(box.max, axis_);
+        for (auto it = first_reaching(axis_value(box.min, axis_));
+             it != order_.end() && min_key(*it) <= hi; ++it) {
+            if (!proxies_[*it].is_large && proxies_[*it].aabb.overlaps(box)) fn(*it);
+        }
+        for (uint32_t i : large_) {
+            if (proxies_[i].aabb.overlaps(box)) fn(i);
+        }
+        for (uint32_t p : planes_) fn(p);
+    }
+
+    // Calls fn(body index) for planes and for every body whose AABB, grown
+    // by radius, the ray origin + t * direction enters for t in
+    // [0, max_distance]. fn returns the new max_distance, so a closest-hit
+    // search stops scanning once nothing nearer can remain.
+    template <typename Fn>
+    void query_ray(Vec3f origin, Vec3f direction, float max_distance, float radius, Fn&& fn) const {
+        for (uint32_t p : planes_) max_distance = fn(p);
+
+        Vec3f inv = ray_inverse(direction);
+        Vec3f pad{radius, radius, radius};
+        auto visit = [&](uint32_t i) {
+            Aabb3D box{proxies_[i].aabb.min - pad, proxies_[i].aabb.max + pad};
+            if (box.ray_entry(origin, inv, max_distance) >= 0.0f) max_distance = fn(i);
+        };
+        for (uint32_t i : large_) visit(i);
+
+        // The segment's interval on the sort axis shrinks as hits come in;
+        // walk the order away from the origin so that shrinking ends the scan
+        float o = axis_value(origin, axis_);
+        float d = axis_value(direction, axis_);
+        if (d >= 0.0f) {
+            for (auto it = first_reaching(o - radius);
+                 it != order_.end() && min_key(*it) <= o + d * max_distance + radius; ++it) {
+                if (!proxies_[*it].is_large) visit(*it);
+            }
+        } else {
+            auto it = std::upper_bound(order_.begin(), order_.end(), o + radius,
+                                       [this](float v, uint32_t i) { return v < min_key(i); });
+            while (it != order_.begin()) {
+                --it;
+                if (min_key(*it) + max_extent_ < o + d * max_distance - radius) break;
+                if (!proxies_[*it].is_large) visit(*it);
+            }
+        }
+    }
+
+private:
+    struct Proxy {
+        Aabb3D aabb;
+        bool is_static;
+        bool is_large;   // kept out of max_extent_, see large_
+    };
+
+    std::vector<Proxy> proxies_;          // indexed by body index
+    std::vector<uint32_t> order_;         // finite bodies, sorted by min on axis_
+    std::vector<uint32_t> planes_;
+    std::vector<uint32_t> large_;         // queried exhaustively
+    std::vector<BroadphasePair3D> pairs_;
+    std::vector<BroadphasePair3D> prev_pairs_;
+    std::vector<std::vector<BroadphasePair3D>> chunk_pairs_;
+    static constexpr float large_extent_factor = 8.0f;
+    static constexpr float axis_switch_ratio = 1.2f;   // variance margin to change axis_
+    uint32_t aabb_chunk_size_ = 1024;
+    uint32_t sweep_chunk_size_ = 256;
+    int axis_ = 0;
+    float max_extent_ = 0.0f;             // largest AABB length along axis_, large_ excluded
+    bool order_valid_ = false;
+
+    static float axis_value(Vec3f v, int axis) {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+    float min_key(uint32_t i) const { return axis_value(proxies_[i].aabb.min, axis_); }
+    // First body in order_ whose AABB can reach lo or beyond on the sort axis
+    std::vector<uint32_t>::const_iterator first_reaching(float lo) const {
+        return std::lower_bound(order_.begin(), order_.end(), lo - max_extent_,
+                                [this](uint32_t i, float v) { return min_key(i) < v; });
+    }
+
+    int choose_axis() const;
+    void sort_order();
+    void sweep_chunk(const BodyArrays3D& bodies, uint32_t chunk);
+};
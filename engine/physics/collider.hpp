@@ -35,4 +35,13 @@ struct Collider {
     uint64_t owner_id = 0;
     const Transform2D* transform = nullptr;
     std::function<bool(const Collider&)> on_hit;
+
+    // Continuous collision: when set, PhysicsSystem sweeps this collider from
+    // prev_position to its current position instead of testing only the end
+    // position. prev_position is refreshed by PhysicsSystem::run().
+    bool ccd = false;
+    Vec2f prev_position;
+
+    // Leaf in PhysicsSystem's AABB tree broadphase (-1 when not in a tree)
+    int32_t proxy_id = -1;
 };
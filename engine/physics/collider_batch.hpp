@@ -0,0 +1,74 @@
+#pragma once
+#include "collider.hpp"
+#include <vector>
+#include <cstdint>
+
+// Packed SoA snapshot of 2D colliders, grouped by shape type.
+// Filled once per frame from the Collider objects so batched hit tests
+// read contiguous float arrays instead of visiting variants and chasing
+// Transform2D pointers per pair.
+
+struct AABBBatch {
+    std::vector<float> x, y;      // center
+    std::vector<float> hx, hy;    // half extent
+    std::vector<Collider*> colliders;
+
+    size_t size() const { return colliders.size(); }
+
+    void clear() {
+        x.clear(); y.clear(); hx.clear(); hy.clear();
+        colliders.clear();
+    }
+
+    void push(Collider* c, Vec2f pos, const AABBData& s) {
+        x.push_back(pos.x);
+        y.push_back(pos.y);
+        hx.push_back(s.half_extent.x);
+        hy.push_back(s.half_extent.y);
+        colliders.push_back(c);
+    }
+};
+
+struct CircleBatch {
+    std::vector<float> x, y;      // center
+    std::vector<float> r;         // radius
+    std::vector<Collider*> colliders;
+
+    size_t size() const { return colliders.size(); }
+
+    void clear() {
+        x.clear(); y.clear(); r.clear();
+        colliders.clear();
+    }
+
+    void push(Collider* c, Vec2f pos, const CircleData& s) {
+        x.push_back(pos.x);
+        y.push_back(pos.y);
+        r.push_back(s.radius);
+        colliders.push_back(c);
+    }
+};
+
+struct ColliderBatch2D {
+    AABBBatch aabbs;
+    CircleBatch circles;
+
+    size_t size() const { return aabbs.size() + circles.size(); }
+
+    void clear() {
+        aabbs.clear();
+        circles.clear();
+    }
+
+    // Snapshot the collider's current position; colliders without a
+    // transform are skipped
+    void add(Collider* c) {
+        if (!c || !c->transform) return;
+        Vec2f pos = c->transform->position;
+        if (auto* aabb = std::get_if<AABBData>(&c->shape)) {
+            aabbs.push(c, pos, *aabb);
+        } else if (auto* circle = std::get_if<CircleData>(&c->shape)) {
+            circles.push(c, pos, *circle);
+        }
+    }
+};
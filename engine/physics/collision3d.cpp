@@ -1,6 +1,9 @@
 #include "collision3d.hpp"
+#include "convex_hull3d.hpp"
+#include "triangle_mesh3d.hpp"
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 std::optional<ContactPoint> collide_sphere_sphere(
     const SphereShape& a, const Transform3D& ta,
@@ -30,9 +33,10 @@ std::optional<ContactPoint> collide_sphere_plane(
 
     if (dist >= sphere.radius) return std::nullopt;
 
+    // Normal points from the sphere (A) into the plane (B)
     return ContactPoint{
         ts.position - plane.normal * dist,
-        plane.normal,
+        plane.normal * -1.0f,
         sphere.radius - dist
     };
 }
@@ -62,9 +66,10 @@ std::optional<ContactPoint> collide_sphere_box(
     Vec3f world_normal = tb.rotation.rotate(local_normal);
     Vec3f world_closest = tb.position + tb.rotation.rotate(closest);
 
+    // local_normal points from the box out to the sphere; report A to B
     return ContactPoint{
         world_closest,
-        world_normal,
+        world_normal * -1.0f,
         sphere.radius - dist
     };
 }
@@ -101,50 +106,909 @@ std::optional<ContactPoint> collide_box_plane(
 
     if (deepest >= 0.0f) return std::nullopt;
 
+    // Normal points from the box (A) into the plane (B)
     return ContactPoint{
         deepest_point,
-        plane.normal,
+        plane.normal * -1.0f,
         -deepest
     };
 }
 
+// --- Oriented box vs box (SAT + face clipping) ---
+
+namespace {
+
+// Box manifolds keep points up to this far apart (negative penetration) as
+// speculative contacts, so resting contacts do not drop in and out with
+// rounding noise and leave the solver with a lopsided point set
+constexpr float contact_margin = 0.01f;
+
+struct Obb {
+    Vec3f center;
+    Vec3f axis[3];
+    float extent[3];
+};
+
+Obb make_obb(const BoxShape& box, const Transform3D& t) {
+    Obb o;
+    o.center = t.position;
+    o.axis[0] = t.rotation.rotate({1.0f, 0.0f, 0.0f});
+    o.axis[1] = t.rotation.rotate({0.0f, 1.0f, 0.0f});
+    o.axis[2] = t.rotation.rotate({0.0f, 0.0f, 1.0f});
+    o.extent[0] = box.half_extent.x;
+    o.extent[1] = box.half_extent.y;
+    o.extent[2] = box.half_extent.z;
+    return o;
+}
+
+float project_obb(const Obb& o, Vec3f axis) {
+    return o.extent[0] * std::abs(o.axis[0].dot(axis)) +
+           o.extent[1] * std::abs(o.axis[1].dot(axis)) +
+           o.extent[2] * std::abs(o.axis[2].dot(axis));
+}
+
+// Sutherland-Hodgman against the plane dot(n, p) <= d
+int clip_polygon(const Vec3f* in, int count, Vec3f n, float d, Vec3f* out) {
+    int out_count = 0;
+    for (int i = 0; i < count; ++i) {
+        Vec3f v0 = in[i];
+        Vec3f v1 = in[(i + 1) % count];
+        float d0 = n.dot(v0) - d;
+        float d1 = n.dot(v1) - d;
+        if (d0 <= 0.0f) out[out_count++] = v0;
+        if ((d0 <= 0.0f) != (d1 <= 0.0f)) {
+            float t = d0 / (d0 - d1);
+            out[out_count++] = v0 + (v1 - v0) * t;
+        }
+    }
+    return out_count;
+}
+
+// Add points to out, reducing to four when there are more: the deepest,
+// the one farthest from it, then the two that span the most area on either
+// side of that segment (measured around `axis`)
+void reduce_contacts(const ContactPoint* points, int n, Vec3f axis, ContactManifold& out) {
+    if (n <= ContactManifold::max_points) {
+        for (int i = 0; i < n; ++i) out.add(points[i]);
+        return;
+    }
+
+    int pick[4];
+    pick[0] = 0;
+    for (int i = 1; i < n; ++i) {
+        if (points[i].penetration > points[pick[0]].penetration) pick[0] = i;
+    }
+    Vec3f p0 = points[pick[0]].point;
+    pick[1] = pick[0] == 0 ? 1 : 0;
+    for (int i = 0; i < n; ++i) {
+        if ((points[i].point - p0).length_sq() > (points[pick[1]].point - p0).length_sq()) pick[1] = i;
+    }
+    Vec3f p1 = points[pick[1]].point;
+    auto area = [&](int i) { return (p1 - p0).cross(points[i].point - p0).dot(axis); };
+    pick[2] = pick[3] = -1;
+    float max_area = 0.0f, min_area = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        float a = area(i);
+        if (a > max_area) { max_area = a; pick[2] = i; }
+        if (a < min_area) { min_area = a; pick[3] = i; }
+    }
+    for (int i : pick) {
+        if (i >= 0) out.add(points[i]);
+    }
+}
+
+void add_face_contact(const Obb& ref, int ref_axis, Vec3f ref_normal,
+                      const Obb& inc, bool ref_is_a, ContactManifold& out) {
+    // Incident face: the face of `inc` most anti-parallel to the reference normal
+    int inc_axis = 0;
+    float best = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        float dp = std::abs(inc.axis[k].dot(ref_normal));
+        if (dp > best) { best = dp; inc_axis = k; }
+    }
+    float inc_sign = inc.axis[inc_axis].dot(ref_normal) > 0.0f ? -1.0f : 1.0f;
+    Vec3f inc_center = inc.center + inc.axis[inc_axis] * (inc.extent[inc_axis] * inc_sign);
+    int k1 = (inc_axis + 1) % 3;
+    int k2 = (inc_axis + 2) % 3;
+    Vec3f e1 = inc.axis[k1] * inc.extent[k1];
+    Vec3f e2 = inc.axis[k2] * inc.extent[k2];
+
+    Vec3f poly_a[8] = {
+        inc_center + e1 + e2, inc_center - e1 + e2,
+        inc_center - e1 - e2, inc_center + e1 - e2,
+    };
+    Vec3f poly_b[8];
+    int count = 4;
+
+    // Clip against the four side planes of the reference face
+    int s1 = (ref_axis + 1) % 3;
+    int s2 = (ref_axis + 2) % 3;
+    for (int s : {s1, s2}) {
+        Vec3f side = ref.axis[s];
+        float c = side.dot(ref.center);
+        float limit = ref.extent[s] * 1.0001f;  // keep vertices lying on the edge
+        count = clip_polygon(poly_a, count, side, c + limit, poly_b);
+        if (count == 0) return;
+        count = clip_polygon(poly_b, count, side * -1.0f, -c + limit, poly_a);
+        if (count == 0) return;
+    }
+
+    // Keep points below the reference face; report them midway between faces
+    float face_d = ref_normal.dot(ref.center) + ref.extent[ref_axis];
+    Vec3f normal = ref_is_a ? ref_normal : ref_normal * -1.0f;
+
+    ContactPoint points[8];
+    int n = 0;
+    for (int i = 0; i < count; ++i) {
+        float depth = face_d - ref_normal.dot(poly_a[i]);
+        if (depth < -contact_margin) continue;
+        points[n++] = {poly_a[i] + ref_normal * (depth * 0.5f), normal, depth};
+    }
+    out.normal = normal;
+    reduce_contacts(points, n, ref_normal, out);
+}
+
+// Closest points between two segments given as center +/- dir * half
+void closest_between_edges(Vec3f ca, Vec3f da, float ha, Vec3f cb, Vec3f db, float hb,
+                           Vec3f& pa, Vec3f& pb) {
+    Vec3f r = ca - cb;
+    float b = da.dot(db);
+    float c = da.dot(r);
+    float f = db.dot(r);
+    float denom = 1.0f - b * b;
+    float s = denom > 1e-6f ? std::clamp((b * f - c) / denom, -ha, ha) : 0.0f;
+    float t = std::clamp(b * s + f, -hb, hb);
+    s = std::clamp(b * t - c, -ha, ha);
+    pa = ca + da * s;
+    pb = cb + db * t;
+}
+
+bool manifold_obb(const Obb& a, const Obb& b, ContactManifold& out) {
+    Vec3f d = b.center - a.center;
+
+    // Face axes of A, face axes of B, then the nine edge-edge axes
+    float best_face_a = -1e30f, best_face_b = -1e30f, best_edge = -1e30f;
+    int face_a = 0, face_b = 0, edge_i = 0, edge_j = 0;
+    Vec3f edge_axis;
+
+    for (int i = 0; i < 3; ++i) {
+        float sep = std::abs(d.dot(a.axis[i])) - (a.extent[i] + project_obb(b, a.axis[i]));
+        if (sep > contact_margin) return false;
+        if (sep > best_face_a) { best_face_a = sep; face_a = i; }
+    }
+    for (int j = 0; j < 3; ++j) {
+        float sep = std::abs(d.dot(b.axis[j])) - (b.extent[j] + project_obb(a, b.axis[j]));
+        if (sep > contact_margin) return false;
+        if (sep > best_face_b) { best_face_b = sep; face_b = j; }
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            Vec3f axis = a.axis[i].cross(b.axis[j]);
+            float len = axis.length();
+            if (len < 1e-4f) continue;  // parallel edges: covered by face axes
+            axis = axis * (1.0f / len);
+            float sep = std::abs(d.dot(axis)) - (project_obb(a, axis) + project_obb(b, axis));
+            if (sep > contact_margin) return false;
+            if (sep > best_edge) { best_edge = sep; edge_i = i; edge_j = j; edge_axis = axis; }
+        }
+    }
+
+    // Prefer face contacts unless an edge axis separates clearly more,
+    // so resting contacts do not flicker between axes
+    constexpr float rel_tol = 0.95f;
+    constexpr float abs_tol = 0.01f;
+    bool use_b = best_face_b > rel_tol * best_face_a + abs_tol;
+    float best_face = use_b ? best_face_b : best_face_a;
+
+    if (best_edge > rel_tol * best_face + abs_tol) {
+        Vec3f n = d.dot(edge_axis) < 0.0f ? edge_axis * -1.0f : edge_axis;
+        Vec3f ca = a.center, cb = b.center;
+        for (int k = 0; k < 3; ++k) {
+            if (k != edge_i) ca += a.axis[k] * (a.axis[k].dot(n) > 0.0f ? a.extent[k] : -a.extent[k]);
+            if (k != edge_j) cb += b.axis[k] * (b.axis[k].dot(n) > 0.0f ? -b.extent[k] : b.extent[k]);
+        }
+        Vec3f pa, pb;
+        closest_between_edges(ca, a.axis[edge_i], a.extent[edge_i],
+                              cb, b.axis[edge_j], b.extent[edge_j], pa, pb);
+        out.normal = n;
+        out.add({(pa + pb) * 0.5f, n, -best_edge});
+        return true;
+    }
+
+    if (use_b) {
+        Vec3f n = d.dot(b.axis[face_b]) > 0.0f ? b.axis[face_b] * -1.0f : b.axis[face_b];
+        add_face_contact(b, face_b, n, a, false, out);
+    } else {
+        Vec3f n = d.dot(a.axis[face_a]) < 0.0f ? a.axis[face_a] * -1.0f : a.axis[face_a];
+        add_face_contact(a, face_a, n, b, true, out);
+    }
+    return out.point_count > 0;
+}
+
+} // namespace
+
 std::optional<ContactPoint> collide_box_box(
     const BoxShape& a, const Transform3D& ta,
     const BoxShape& b, const Transform3D& tb)
 {
-    // Simplified AABB vs AABB (ignoring rotation for initial implementation)
-    Vec3f diff = tb.position - ta.position;
-    Vec3f overlap{
-        a.half_extent.x + b.half_extent.x - std::abs(diff.x),
-        a.half_extent.y + b.half_extent.y - std::abs(diff.y),
-        a.half_extent.z + b.half_extent.z - std::abs(diff.z)
-    };
+    // Deepest point of the full oriented-box manifold
+    ContactManifold m;
+    if (!manifold_obb(make_obb(a, ta), make_obb(b, tb), m)) return std::nullopt;
 
-    if (overlap.x <= 0.0f || overlap.y <= 0.0f || overlap.z <= 0.0f)
-        return std::nullopt;
+    int deepest = 0;
+    for (int i = 1; i < m.point_count; ++i) {
+        if (m.points[i].penetration > m.points[deepest].penetration) deepest = i;
+    }
+    if (m.points[deepest].penetration <= 0.0f) return std::nullopt;  // speculative only
+    return m.points[deepest];
+}
+
+// --- Capsules, convex hulls and triangle meshes (GJK + EPA) ---
+
+namespace {
+
+// A convex shape as a core (point, segment, box, hull or triangle) plus a
+// spherical margin: spheres and capsules are a point and a segment inflated
+// by their radius. Coordinates are in whatever frame the caller chose.
+struct ConvexProxy {
+    enum class Kind : uint8_t { Point, Segment, Box, Hull, Triangle };
+
+    Kind kind = Kind::Point;
+    Vec3f position;                     // triangles: centroid
+    Quat rotation;
+    Vec3f half_extent;                  // box; segments use y
+    float margin = 0.0f;
+    const ConvexHull3D* hull = nullptr;
+    Vec3f triangle[3];
+
+    Vec3f support_core(Vec3f dir) const {
+        if (kind == Kind::Point) return position;
+        if (kind == Kind::Triangle) {
+            float d0 = triangle[0].dot(dir), d1 = triangle[1].dot(dir), d2 = triangle[2].dot(dir);
+            if (d0 >= d1 && d0 >= d2) return triangle[0];
+            return d1 >= d2 ? triangle[1] : triangle[2];
+        }
+        Vec3f local = rotation.conjugate().rotate(dir);
+        Vec3f p;
+        if (kind == Kind::Segment) {
+            p = {0.0f, local.y >= 0.0f ? half_extent.y : -half_extent.y, 0.0f};
+        } else if (kind == Kind::Box) {
+            p = {local.x >= 0.0f ? half_extent.x : -half_extent.x,
+                 local.y >= 0.0f ? half_extent.y : -half_extent.y,
+                 local.z >= 0.0f ? half_extent.z : -half_extent.z};
+        } else {
+            p = hull->support(local);
+        }
+        return position + rotation.rotate(p);
+    }
+
+    Vec3f support(Vec3f dir) const {
+        Vec3f p = support_core(dir);
+        float len_sq = dir.length_sq();
+        if (margin > 0.0f && len_sq > 1e-24f) p = p + dir * (margin / std::sqrt(len_sq));
+        return p;
+    }
+
+    // Calls fn(vertex) for each vertex of the core
+    template <typename Fn>
+    void for_each_vertex(Fn&& fn) const {
+        switch (kind) {
+            case Kind::Point:
+                fn(position);
+                break;
+            case Kind::Segment:
+                fn(position + rotation.rotate({0.0f, half_extent.y, 0.0f}));
+                fn(position + rotation.rotate({0.0f, -half_extent.y, 0.0f}));
+                break;
+            case Kind::Box: {
+                Vec3f h = half_extent;
+                for (int i = 0; i < 8; ++i) {
+                    Vec3f local{(i & 1) ? h.x : -h.x, (i & 2) ? h.y : -h.y, (i & 4) ? h.z : -h.z};
+                    fn(position + rotation.rotate(local));
+                }
+                break;
+            }
+            case Kind::Hull:
+                for (const Vec3f& v : hull->vertices()) fn(position + rotation.rotate(v));
+                break;
+            case Kind::Triangle:
+                for (const Vec3f& v : triangle) fn(v);
+                break;
+        }
+    }
+};
+
+// Planes and meshes have no proxy
+bool make_proxy(const CollisionShape3D& shape, const Transform3D& t, ConvexProxy& out) {
+    out.position = t.position;
+    out.rotation = t.rotation;
+    if (auto* sphere = std::get_if<SphereShape>(&shape)) {
+        out.kind = ConvexProxy::Kind::Point;
+        out.margin = sphere->radius;
+    } else if (auto* capsule = std::get_if<CapsuleShape>(&shape)) {
+        out.kind = ConvexProxy::Kind::Segment;
+        out.half_extent = {0.0f, capsule->half_height, 0.0f};
+        out.margin = capsule->radius;
+    } else if (auto* box = std::get_if<BoxShape>(&shape)) {
+        out.kind = ConvexProxy::Kind::Box;
+        out.half_extent = box->half_extent;
+    } else if (auto* hull = std::get_if<ConvexHullShape>(&shape); hull && hull->hull &&
+               !hull->hull->vertices().empty()) {
+        out.kind = ConvexProxy::Kind::Hull;
+        out.hull = hull->hull.get();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// A vertex of the Minkowski difference A - B with the points it came from
+struct SupportPoint {
+    Vec3f a, b, w;
+};
+
+SupportPoint support_pair(const ConvexProxy& a, const ConvexProxy& b, Vec3f dir, bool core) {
+    Vec3f pa = core ? a.support_core(dir) : a.support(dir);
+    Vec3f pb = core ? b.support_core(dir * -1.0f) : b.support(dir * -1.0f);
+    return {pa, pb, pa - pb};
+}
+
+struct Simplex {
+    SupportPoint v[4];
+    float bary[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+    int count = 0;
+};
+
+// Closest point of triangle (a, b, c) to the origin as barycentric weights
+// (Ericson, Real-Time Collision Detection 5.1.5)
+void closest_on_triangle(Vec3f a, Vec3f b, Vec3f c, float bary[3]) {
+    Vec3f ab = b - a, ac = c - a;
+    float d1 = -ab.dot(a), d2 = -ac.dot(a);
+    if (d1 <= 0.0f && d2 <= 0.0f) { bary[0] = 1.0f; bary[1] = bary[2] = 0.0f; return; }
+
+    float d3 = -ab.dot(b), d4 = -ac.dot(b);
+    if (d3 >= 0.0f && d4 <= d3) { bary[1] = 1.0f; bary[0] = bary[2] = 0.0f; return; }
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        float v = d1 / (d1 - d3);
+        bary[0] = 1.0f - v; bary[1] = v; bary[2] = 0.0f;
+        return;
+    }
+
+    float d5 = -ab.dot(c), d6 = -ac.dot(c);
+    if (d6 >= 0.0f && d5 <= d6) { bary[2] = 1.0f; bary[0] = bary[1] = 0.0f; return; }
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        float w = d2 / (d2 - d6);
+        bary[0] = 1.0f - w; bary[1] = 0.0f; bary[2] = w;
+        return;
+    }
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        bary[0] = 0.0f; bary[1] = 1.0f - w; bary[2] = w;
+        return;
+    }
+
+    float denom = 1.0f / (va + vb + vc);
+    bary[1] = vb * denom;
+    bary[2] = vc * denom;
+    bary[0] = 1.0f - bary[1] - bary[2];
+}
+
+// Drop vertices with zero weight
+void compact_simplex(Simplex& s) {
+    int n = 0;
+    for (int i = 0; i < s.count; ++i) {
+        if (s.bary[i] > 0.0f) {
+            s.v[n] = s.v[i];
+            s.bary[n] = s.bary[i];
+            ++n;
+        }
+    }
+    s.count = n;
+}
+
+Vec3f simplex_point(const Simplex& s) {
+    Vec3f p = Vec3f::zero();
+    for (int i = 0; i < s.count; ++i) p = p + s.v[i].w * s.bary[i];
+    return p;
+}
+
+// Reduce s to the sub-simplex nearest the origin and return the nearest
+// point. A tetrahedron that contains the origin is kept whole.
+Vec3f solve_simplex(Simplex& s) {
+    switch (s.count) {
+        case 1:
+            s.bary[0] = 1.0f;
+            break;
+        case 2: {
+            Vec3f a = s.v[0].w, ab = s.v[1].w - a;
+            float len_sq = ab.length_sq();
+            float t = len_sq > 0.0f ? std::clamp(-a.dot(ab) / len_sq, 0.0f, 1.0f) : 0.0f;
+            s.bary[0] = 1.0f - t;
+            s.bary[1] = t;
+            break;
+        }
+        case 3:
+            closest_on_triangle(s.v[0].w, s.v[1].w, s.v[2].w, s.bary);
+            break;
+        case 4: {
+            // Faces the origin lies outside of, each opposite vertex `opp`
+            static constexpr int faces[4][4] = {{0, 1, 2, 3}, {0, 1, 3, 2}, {0, 2, 3, 1}, {1, 2, 3, 0}};
+            float best = INFINITY;
+            Simplex nearest;
+            for (const auto& f : faces) {
+                Vec3f a = s.v[f[0]].w, b = s.v[f[1]].w, c = s.v[f[2]].w;
+                Vec3f n = (b - a).cross(c - a);
+                float side_origin = -n.dot(a);
+                float side_opp = n.dot(s.v[f[3]].w - a);
+                if (side_origin * side_opp > 0.0f) continue;  // same side as the interior
+
+                Simplex tri;
+                tri.count = 3;
+                tri.v[0] = s.v[f[0]]; tri.v[1] = s.v[f[1]]; tri.v[2] = s.v[f[2]];
+                closest_on_triangle(a, b, c, tri.bary);
+                float d = simplex_point(tri).length_sq();
+                if (d < best) { best = d; nearest = tri; }
+            }
+            if (best == INFINITY) {
+                // Origin inside
+                for (float& w : s.bary) w = 0.25f;
+                return Vec3f::zero();
+            }
+            s = nearest;
+            break;
+        }
+        default:
+            break;
+    }
+    compact_simplex(s);
+    return simplex_point(s);
+}
+
+struct GjkResult {
+    bool overlap = false;
+    float distance = 0.0f;
+    Vec3f point_a, point_b;   // closest points when separated
+    Simplex simplex;          // encloses the origin when overlapping
+};
+
+// GJK distance between the cores (core = true) or the full shapes
+GjkResult gjk(const ConvexProxy& a, const ConvexProxy& b, bool core) {
+    GjkResult r;
+    Simplex& s = r.simplex;
+    Vec3f dir = a.position - b.position;
+    if (dir.length_sq() < 1e-12f) dir = {1.0f, 0.0f, 0.0f};
+    s.v[0] = support_pair(a, b, dir * -1.0f, core);
+    s.count = 1;
+    Vec3f v = s.v[0].w;
+
+    for (int iter = 0; iter < 64; ++iter) {
+        float vv = v.length_sq();
+        if (vv <= 1e-12f) {
+            r.overlap = true;
+            break;
+        }
+        SupportPoint w = support_pair(a, b, v * -1.0f, core);
+        // No progress towards the origin: v is the closest point
+        if (vv - v.dot(w.w) <= 1e-6f * vv) break;
+        bool repeated = false;
+        for (int i = 0; i < s.count; ++i) {
+            if ((s.v[i].w - w.w).length_sq() <= 1e-12f) repeated = true;
+        }
+        if (repeated) break;
+
+        s.v[s.count] = w;
+        s.bary[s.count] = 0.0f;
+        ++s.count;
+        v = solve_simplex(s);
+        if (s.count == 4) {
+            r.overlap = true;
+            break;
+        }
+    }
+
+    r.point_a = r.point_b = Vec3f::zero();
+    for (int i = 0; i < s.count; ++i) {
+        r.point_a = r.point_a + s.v[i].a * s.bary[i];
+        r.point_b = r.point_b + s.v[i].b * s.bary[i];
+    }
+    r.distance = r.overlap ? 0.0f : v.length();
+    return r;
+}
 
-    // Find minimum penetration axis
+struct EpaFace {
+    int v[3];
     Vec3f normal;
-    float penetration;
-
-    if (overlap.x < overlap.y && overlap.x < overlap.z) {
-        penetration = overlap.x;
-        normal = {(diff.x > 0.0f) ? 1.0f : -1.0f, 0.0f, 0.0f};
-    } else if (overlap.y < overlap.z) {
-        penetration = overlap.y;
-        normal = {0.0f, (diff.y > 0.0f) ? 1.0f : -1.0f, 0.0f};
+    float distance;
+};
+
+// Polytope storage, reused across calls so narrow phase does not allocate
+// per contact; per thread, as pairs may be tested on jobs
+struct EpaScratch {
+    std::vector<SupportPoint> verts;
+    std::vector<EpaFace> faces;
+    std::vector<std::pair<int, int>> horizon;
+};
+thread_local EpaScratch epa_scratch;
+
+// Expanding polytope: penetration normal (A to B) and depth of the full
+// shapes, starting from a GJK simplex that encloses the origin
+bool epa(const ConvexProxy& a, const ConvexProxy& b, const Simplex& start, ContactPoint& out) {
+    constexpr int max_iterations = 64;
+    constexpr float tolerance = 1e-4f;
+
+    std::vector<SupportPoint>& verts = epa_scratch.verts;
+    verts.assign(start.v, start.v + start.count);
+    auto support = [&](Vec3f dir) { return support_pair(a, b, dir, false); };
+
+    // Grow a degenerate simplex into a tetrahedron
+    if (verts.size() == 1) {
+        static const Vec3f axes[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+        for (const Vec3f& axis : axes) {
+            SupportPoint p = support(axis);
+            if ((p.w - verts[0].w).length_sq() > 1e-10f) { verts.push_back(p); break; }
+        }
+    }
+    if (verts.size() == 2) {
+        Vec3f d = (verts[1].w - verts[0].w).normalized();
+        Vec3f perp = std::abs(d.x) < 0.57735f ? d.cross({1, 0, 0}) : d.cross({0, 1, 0});
+        for (int k = 0; k < 6; ++k) {
+            Vec3f dir = Quat::from_axis_angle(d, static_cast<float>(k) * 1.0471976f).rotate(perp);
+            SupportPoint p = support(dir);
+            if ((p.w - verts[0].w).cross(d).length_sq() > 1e-10f) { verts.push_back(p); break; }
+        }
+    }
+    if (verts.size() == 3) {
+        Vec3f n = (verts[1].w - verts[0].w).cross(verts[2].w - verts[0].w);
+        SupportPoint p = support(n);
+        if (std::abs(n.dot(p.w - verts[0].w)) <= 1e-10f) p = support(n * -1.0f);
+        if (std::abs(n.dot(p.w - verts[0].w)) <= 1e-10f) return false;
+        verts.push_back(p);
+    }
+    if (verts.size() != 4) return false;
+
+    std::vector<EpaFace>& faces = epa_scratch.faces;
+    faces.clear();
+    auto add_face = [&](int i, int j, int k) {
+        Vec3f n = (verts[j].w - verts[i].w).cross(verts[k].w - verts[i].w);
+        float len = n.length();
+        EpaFace f{{i, j, k}, Vec3f::zero(), INFINITY};
+        if (len > 1e-12f) {
+            f.normal = n * (1.0f / len);
+            f.distance = f.normal.dot(verts[i].w);
+        }
+        faces.push_back(f);
+    };
+    // Initial faces wound away from the opposite vertex
+    static constexpr int tetra[4][4] = {{0, 1, 2, 3}, {0, 3, 1, 2}, {0, 2, 3, 1}, {1, 3, 2, 0}};
+    for (const auto& t : tetra) {
+        Vec3f n = (verts[t[1]].w - verts[t[0]].w).cross(verts[t[2]].w - verts[t[0]].w);
+        if (n.dot(verts[t[3]].w - verts[t[0]].w) > 0.0f) add_face(t[0], t[2], t[1]);
+        else add_face(t[0], t[1], t[2]);
+    }
+
+    std::vector<std::pair<int, int>>& horizon = epa_scratch.horizon;
+    auto closest_face = [&] {
+        size_t closest = 0;
+        for (size_t i = 1; i < faces.size(); ++i) {
+            if (faces[i].distance < faces[closest].distance) closest = i;
+        }
+        return closest;
+    };
+    for (int iter = 0; iter < max_iterations; ++iter) {
+        const EpaFace& f = faces[closest_face()];
+        if (f.distance == INFINITY) return false;
+
+        SupportPoint p = support(f.normal);
+        if (f.normal.dot(p.w) - f.distance <= tolerance) break;
+
+        // Remove every face the new point sees; their unshared edges form
+        // the horizon the new faces fan out from
+        auto index = static_cast<int>(verts.size());
+        verts.push_back(p);
+        horizon.clear();
+        for (size_t i = 0; i < faces.size();) {
+            const EpaFace& g = faces[i];
+            if (g.distance != INFINITY && g.normal.dot(p.w - verts[g.v[0]].w) <= 0.0f) {
+                ++i;
+                continue;
+            }
+            for (int e = 0; e < 3; ++e) {
+                std::pair<int, int> edge{g.v[e], g.v[(e + 1) % 3]};
+                auto twin = std::find(horizon.begin(), horizon.end(),
+                                      std::make_pair(edge.second, edge.first));
+                if (twin != horizon.end()) horizon.erase(twin);
+                else horizon.push_back(edge);
+            }
+            faces[i] = faces.back();
+            faces.pop_back();
+        }
+        for (auto [i, j] : horizon) add_face(i, j, index);
+        if (faces.empty()) return false;
+    }
+
+    // Witness points: barycentric coordinates of the origin's projection.
+    // Search again: running out of iterations leaves the faces expanded.
+    const EpaFace& f = faces[closest_face()];
+    if (f.distance == INFINITY) return false;
+    const SupportPoint& s0 = verts[f.v[0]];
+    const SupportPoint& s1 = verts[f.v[1]];
+    const SupportPoint& s2 = verts[f.v[2]];
+    Vec3f p = f.normal * f.distance;
+    Vec3f e0 = s1.w - s0.w, e1 = s2.w - s0.w, e2 = p - s0.w;
+    float d00 = e0.dot(e0), d01 = e0.dot(e1), d11 = e1.dot(e1);
+    float d20 = e2.dot(e0), d21 = e2.dot(e1);
+    float denom = d00 * d11 - d01 * d01;
+    float v = 0.0f, w = 0.0f;
+    if (std::abs(denom) > 1e-20f) {
+        v = (d11 * d20 - d01 * d21) / denom;
+        w = (d00 * d21 - d01 * d20) / denom;
+    }
+    float u = 1.0f - v - w;
+    Vec3f point_a = s0.a * u + s1.a * v + s2.a * w;
+    Vec3f point_b = s0.b * u + s1.b * v + s2.b * w;
+
+    out = {(point_a + point_b) * 0.5f, f.normal, f.distance};
+    return true;
+}
+
+// Contact between two convex proxies, normal from a to b. Separated shapes
+// within contact_margin report a speculative (negative) penetration.
+bool collide_convex(const ConvexProxy& a, const ConvexProxy& b, ContactPoint& out) {
+    float margins = a.margin + b.margin;
+    GjkResult core = gjk(a, b, true);
+    if (!core.overlap) {
+        if (core.distance >= margins + contact_margin) return false;
+        if (core.distance > 1e-5f) {
+            // Shallow: the margins overlap while the cores are apart
+            Vec3f n = (core.point_b - core.point_a) * (1.0f / core.distance);
+            Vec3f surface_a = core.point_a + n * a.margin;
+            Vec3f surface_b = core.point_b - n * b.margin;
+            out = {(surface_a + surface_b) * 0.5f, n, margins - core.distance};
+            return true;
+        }
+    }
+
+    // Deep: EPA on the full shapes
+    if (margins == 0.0f && core.overlap) return epa(a, b, core.simplex, out);
+    GjkResult full = gjk(a, b, false);
+    if (!full.overlap) return false;
+    return epa(a, b, full.simplex, out);
+}
+
+// Bounded candidate list that keeps the deepest points once full
+struct ContactCandidates {
+    static constexpr int capacity = 64;
+    ContactPoint points[capacity];
+    int count = 0;
+
+    void add(const ContactPoint& p) {
+        if (count < capacity) {
+            points[count++] = p;
+            return;
+        }
+        int shallowest = 0;
+        for (int i = 1; i < count; ++i) {
+            if (points[i].penetration < points[shallowest].penetration) shallowest = i;
+        }
+        if (p.penetration > points[shallowest].penetration) points[shallowest] = p;
+    }
+};
+
+// Core vertices within contact_margin of the plane, reduced to four
+void manifold_convex_plane(const ConvexProxy& x, const PlaneShape& plane, ContactManifold& out) {
+    ContactCandidates hits;
+    out.normal = plane.normal * -1.0f;
+    x.for_each_vertex([&](Vec3f p) {
+        float dist = plane.normal.dot(p) - plane.offset - x.margin;
+        if (dist <= contact_margin) hits.add({p - plane.normal * x.margin, out.normal, -dist});
+    });
+    reduce_contacts(hits.points, hits.count, plane.normal, out);
+}
+
+bool inside_triangle(Vec3f p, const Vec3f* tri, Vec3f normal) {
+    for (int i = 0; i < 3; ++i) {
+        Vec3f a = tri[i], b = tri[(i + 1) % 3];
+        if ((b - a).cross(p - a).dot(normal) < 0.0f) return false;
+    }
+    return true;
+}
+
+// Convex shape against a triangle mesh. Each triangle the shape overlaps
+// contributes its GJK/EPA contact, or for face contacts the core vertices
+// above the triangle (so boxes rest on four points). Points are grouped
+// around the deepest normal, since a manifold carries one normal.
+void manifold_convex_mesh(const ConvexProxy& shape, const TriangleMesh3D& mesh,
+                          const Transform3D& tm, ContactManifold& out) {
+    // Work in mesh space
+    Quat to_mesh = tm.rotation.conjugate();
+    ConvexProxy x = shape;
+    x.position = to_mesh.rotate(shape.position - tm.position);
+    x.rotation = to_mesh * shape.rotation;
+
+    Aabb3D box{
+        {x.support({-1, 0, 0}).x, x.support({0, -1, 0}).y, x.support({0, 0, -1}).z},
+        {x.support({1, 0, 0}).x, x.support({0, 1, 0}).y, x.support({0, 0, 1}).z},
+    };
+    Vec3f pad{contact_margin, contact_margin, contact_margin};
+    box.min = box.min - pad;
+    box.max = box.max + pad;
+
+    ContactCandidates hits;
+    mesh.query(box, [&](uint32_t t) {
+        ConvexProxy tri;
+        tri.kind = ConvexProxy::Kind::Triangle;
+        mesh.triangle(t, tri.triangle[0], tri.triangle[1], tri.triangle[2]);
+        tri.position = (tri.triangle[0] + tri.triangle[1] + tri.triangle[2]) * (1.0f / 3.0f);
+        Vec3f face_n = (tri.triangle[1] - tri.triangle[0]).cross(tri.triangle[2] - tri.triangle[0]);
+        if (face_n.length_sq() <= 1e-20f) return;
+        face_n = face_n.normalized();
+        if (face_n.dot(x.position - tri.triangle[0]) < 0.0f) return;  // one-sided
+
+        ContactPoint c;
+        if (!collide_convex(x, tri, c)) return;
+
+        int before = hits.count;
+        if (c.normal.dot(face_n) < -0.98f) {
+            float offset = face_n.dot(tri.triangle[0]);
+            Vec3f normal = face_n * -1.0f;
+            x.for_each_vertex([&](Vec3f p) {
+                float dist = face_n.dot(p) - offset - x.margin;
+                if (dist > contact_margin || !inside_triangle(p, tri.triangle, face_n)) return;
+                hits.add({p - face_n * x.margin, normal, -dist});
+            });
+        }
+        if (hits.count == before) hits.add(c);
+    });
+    if (hits.count == 0) return;
+
+    int deepest = 0;
+    for (int i = 1; i < hits.count; ++i) {
+        if (hits.points[i].penetration > hits.points[deepest].penetration) deepest = i;
+    }
+    Vec3f normal = hits.points[deepest].normal;
+    int n = 0;
+    for (int i = 0; i < hits.count; ++i) {
+        if (hits.points[i].normal.dot(normal) < 0.95f) continue;
+        hits.points[n] = hits.points[i];
+        hits.points[n].normal = normal;
+        ++n;
+    }
+    reduce_contacts(hits.points, n, normal, out);
+
+    // Back to world space
+    out.normal = tm.rotation.rotate(normal);
+    for (int i = 0; i < out.point_count; ++i) {
+        out.points[i].point = tm.position + tm.rotation.rotate(out.points[i].point);
+        out.points[i].normal = out.normal;
+    }
+}
+
+void flip_manifold(ContactManifold& m) {
+    m.normal = m.normal * -1.0f;
+    for (int i = 0; i < m.point_count; ++i) m.points[i].normal = m.normal;
+}
+
+bool is_convex_or_mesh(const CollisionShape3D& s) {
+    return std::holds_alternative<CapsuleShape>(s) || std::holds_alternative<ConvexHullShape>(s) ||
+           std::holds_alternative<TriangleMeshShape>(s);
+}
+
+// Any pair involving a capsule, hull or mesh
+bool manifold_generic(const CollisionShape3D& shape_a, const Transform3D& ta,
+                      const CollisionShape3D& shape_b, const Transform3D& tb,
+                      ContactManifold& out) {
+    const auto* mesh_a = std::get_if<TriangleMeshShape>(&shape_a);
+    const auto* mesh_b = std::get_if<TriangleMeshShape>(&shape_b);
+    const auto* plane_a = std::get_if<PlaneShape>(&shape_a);
+    const auto* plane_b = std::get_if<PlaneShape>(&shape_b);
+    ConvexProxy a, b;
+
+    if (mesh_a || mesh_b) {
+        // Mesh vs mesh or plane: both static
+        const TriangleMeshShape* mesh = mesh_a ? mesh_a : mesh_b;
+        if (!mesh->mesh || (mesh_a && mesh_b)) return false;
+        if (!make_proxy(mesh_a ? shape_b : shape_a, mesh_a ? tb : ta, a)) return false;
+        manifold_convex_mesh(a, *mesh->mesh, mesh_a ? ta : tb, out);
+        if (mesh_a) flip_manifold(out);
+    } else if (plane_a || plane_b) {
+        if (plane_a && plane_b) return false;
+        if (!make_proxy(plane_a ? shape_b : shape_a, plane_a ? tb : ta, a)) return false;
+        manifold_convex_plane(a, plane_a ? *plane_a : *plane_b, out);
+        if (plane_a) flip_manifold(out);
     } else {
-        penetration = overlap.z;
-        normal = {0.0f, 0.0f, (diff.z > 0.0f) ? 1.0f : -1.0f};
+        if (!make_proxy(shape_a, ta, a) || !make_proxy(shape_b, tb, b)) return false;
+        ContactPoint c;
+        if (!collide_convex(a, b, c)) return false;
+        out.normal = c.normal;
+        out.add(c);
+    }
+    return out.point_count > 0;
+}
+
+// Sphere cast against a proxy by conservative advancement: step the sphere
+// along the ray by its core distance divided by the closing speed, which can
+// never pass the surface. Flat faces are reached in one step, rounded ones
+// converge within a few.
+bool cast_convex(const ConvexProxy& x, Vec3f origin, Vec3f dir, float max_t, float radius,
+                 ShapeCastHit3D& out) {
+    constexpr float tolerance = 1e-4f;
+    float reach = x.margin + radius;
+    ConvexProxy p;
+    float t = 0.0f;
+    for (int iter = 0; iter < 32; ++iter) {
+        p.position = origin + dir * t;
+        GjkResult g = gjk(x, p, true);
+        if (g.overlap || g.distance <= 1e-6f) {
+            // Center inside the core: only possible at the start
+            out = {p.position, dir * -1.0f, t};
+            return true;
+        }
+        Vec3f n = (g.point_b - g.point_a) * (1.0f / g.distance);
+        if (g.distance <= reach + tolerance) {
+            out = {g.point_a + n * x.margin, n, t};
+            return true;
+        }
+        float closing = -n.dot(dir);
+        if (closing <= 1e-6f) return false;  // moving away from the closest point
+        t += (g.distance - reach) / closing;
+        if (t > max_t) return false;
     }
+    return false;
+}
 
-    Vec3f point = ta.position + normal * (a.half_extent.x * normal.x +
-                                           a.half_extent.y * normal.y +
-                                           a.half_extent.z * normal.z);
+// Triangle mesh: candidates from the BVH along the ray, in mesh space
+bool cast_mesh(const TriangleMesh3D& mesh, const Transform3D& tm, Vec3f origin, Vec3f dir,
+               float max_t, float radius, ShapeCastHit3D& out) {
+    Quat to_mesh = tm.rotation.conjugate();
+    Vec3f o = to_mesh.rotate(origin - tm.position);
+    Vec3f d = to_mesh.rotate(dir);
 
-    return ContactPoint{point, normal, penetration};
+    bool found = false;
+    mesh.query_ray(o, d, max_t, radius, [&](uint32_t t) {
+        ConvexProxy tri;
+        tri.kind = ConvexProxy::Kind::Triangle;
+        mesh.triangle(t, tri.triangle[0], tri.triangle[1], tri.triangle[2]);
+        tri.position = (tri.triangle[0] + tri.triangle[1] + tri.triangle[2]) * (1.0f / 3.0f);
+        Vec3f face_n = (tri.triangle[1] - tri.triangle[0]).cross(tri.triangle[2] - tri.triangle[0]);
+        // One-sided: approach from the front only
+        if (face_n.dot(d) >= 0.0f || face_n.dot(o - tri.triangle[0]) < 0.0f) return max_t;
+
+        ShapeCastHit3D hit;
+        if (cast_convex(tri, o, d, max_t, radius, hit)) {
+            out = hit;
+            max_t = hit.distance;
+            found = true;
+        }
+        return max_t;
+    });
+    if (!found) return false;
+
+    out.point = tm.position + tm.rotation.rotate(out.point);
+    out.normal = tm.rotation.rotate(out.normal);
+    return true;
 }
 
+// Deepest penetrating point of the generic manifold
+std::optional<ContactPoint> deepest_generic(const CollisionShape3D& shape_a, const Transform3D& ta,
+                                            const CollisionShape3D& shape_b, const Transform3D& tb) {
+    ContactManifold m;
+    if (!manifold_generic(shape_a, ta, shape_b, tb, m)) return std::nullopt;
+    int deepest = 0;
+    for (int i = 1; i < m.point_count; ++i) {
+        if (m.points[i].penetration > m.points[deepest].penetration) deepest = i;
+    }
+    if (m.points[deepest].penetration <= 0.0f) return std::nullopt;  // speculative only
+    return m.points[deepest];
+}
+
+} // namespace
+
 std::optional<ContactPoint> check_collision3d(
     const CollisionShape3D& shape_a, const Transform3D& ta,
     const CollisionShape3D& shape_b, const Transform3D& tb)
@@ -175,9 +1039,134 @@ std::optional<ContactPoint> check_collision3d(
             auto r = collide_box_plane(b, tb, a);
             if (r) r->normal = r->normal * -1.0f;
             return r;
-        } else {
+        } else if constexpr (std::is_same_v<A, PlaneShape> && std::is_same_v<B, PlaneShape>) {
             // Plane vs Plane: no collision
             return std::nullopt;
+        } else {
+            // Capsules, convex hulls and triangle meshes
+            return deepest_generic(shape_a, ta, shape_b, tb);
         }
     }, shape_a, shape_b);
 }
+
+// Every penetrating corner, keeping the four deepest
+static void manifold_box_plane(const BoxShape& box, const Transform3D& tb,
+                               const PlaneShape& plane, ContactManifold& out) {
+    struct Corner { Vec3f world; float dist; };
+    Corner hits[8];
+    int count = 0;
+    Vec3f h = box.half_extent;
+    for (int i = 0; i < 8; ++i) {
+        Vec3f local{(i & 1) ? h.x : -h.x, (i & 2) ? h.y : -h.y, (i & 4) ? h.z : -h.z};
+        Vec3f world = tb.position + tb.rotation.rotate(local);
+        float dist = plane.normal.dot(world) - plane.offset;
+        if (dist > contact_margin) continue;
+        // Insertion by depth, deepest first
+        int j = count++;
+        while (j > 0 && hits[j - 1].dist > dist) {
+            hits[j] = hits[j - 1];
+            --j;
+        }
+        hits[j] = {world, dist};
+    }
+
+    out.normal = plane.normal * -1.0f;
+    for (int i = 0; i < count && i < ContactManifold::max_points; ++i) {
+        out.add({hits[i].world, out.normal, -hits[i].dist});
+    }
+}
+
+bool collide_manifold3d(
+    const CollisionShape3D& shape_a, const Transform3D& ta,
+    const CollisionShape3D& shape_b, const Transform3D& tb,
+    ContactManifold& out)
+{
+    out.point_count = 0;
+    const auto* box_a = std::get_if<BoxShape>(&shape_a);
+    const auto* box_b = std::get_if<BoxShape>(&shape_b);
+
+    if (box_a && box_b) {
+        manifold_obb(make_obb(*box_a, ta), make_obb(*box_b, tb), out);
+    } else if (box_a && std::holds_alternative<PlaneShape>(shape_b)) {
+        manifold_box_plane(*box_a, ta, std::get<PlaneShape>(shape_b), out);
+    } else if (box_b && std::holds_alternative<PlaneShape>(shape_a)) {
+        manifold_box_plane(*box_b, tb, std::get<PlaneShape>(shape_a), out);
+        flip_manifold(out);
+    } else if (is_convex_or_mesh(shape_a) || is_convex_or_mesh(shape_b)) {
+        manifold_generic(shape_a, ta, shape_b, tb, out);
+    } else if (auto contact = check_collision3d(shape_a, ta, shape_b, tb)) {
+        out.normal = contact->normal;
+        out.add(*contact);
+    }
+    return out.point_count > 0;
+}
+
+// World extent of a local box with half extents h, rotated by q
+static Vec3f rotated_extent(const Quat& q, Vec3f h) {
+    Vec3f ax = q.rotate({1.0f, 0.0f, 0.0f});
+    Vec3f ay = q.rotate({0.0f, 1.0f, 0.0f});
+    Vec3f az = q.rotate({0.0f, 0.0f, 1.0f});
+    return {
+        std::abs(ax.x) * h.x + std::abs(ay.x) * h.y + std::abs(az.x) * h.z,
+        std::abs(ax.y) * h.x + std::abs(ay.y) * h.y + std::abs(az.y) * h.z,
+        std::abs(ax.z) * h.x + std::abs(ay.z) * h.y + std::abs(az.z) * h.z,
+    };
+}
+
+Aabb3D compute_aabb3d(const CollisionShape3D& shape, const Transform3D& t) {
+    Vec3f extent;
+    if (auto* sphere = std::get_if<SphereShape>(&shape)) {
+        float r = sphere->radius;
+        extent = {r, r, r};
+    } else if (auto* box = std::get_if<BoxShape>(&shape)) {
+        // Project the rotated box onto each world axis
+        extent = rotated_extent(t.rotation, box->half_extent);
+    } else if (auto* capsule = std::get_if<CapsuleShape>(&shape)) {
+        Vec3f axis = t.rotation.rotate({0.0f, capsule->half_height, 0.0f});
+        float r = capsule->radius;
+        extent = {std::abs(axis.x) + r, std::abs(axis.y) + r, std::abs(axis.z) + r};
+    } else {
+        // Hulls and meshes: rotate their local bounds, which need not be
+        // centered on the body origin
+        const Aabb3D* local = nullptr;
+        if (auto* hull = std::get_if<ConvexHullShape>(&shape); hull && hull->hull) {
+            local = &hull->hull->bounds();
+        } else if (auto* mesh = std::get_if<TriangleMeshShape>(&shape); mesh && mesh->mesh) {
+            local = &mesh->mesh->bounds();
+        }
+        if (!local) return {t.position, t.position};
+
+        Vec3f center = t.position + t.rotation.rotate((local->min + local->max) * 0.5f);
+        extent = rotated_extent(t.rotation, (local->max - local->min) * 0.5f);
+        return {center - extent, center + extent};
+    }
+    return {t.position - extent, t.position + extent};
+}
+
+std::optional<ShapeCastHit3D> sphere_cast3d(
+    const CollisionShape3D& shape, const Transform3D& t,
+    Vec3f origin, Vec3f direction, float max_distance, float radius)
+{
+    ShapeCastHit3D hit;
+    if (auto* plane = std::get_if<PlaneShape>(&shape)) {
+        float dist = plane->normal.dot(origin) - plane->offset - radius;
+        if (dist <= 0.0f) return ShapeCastHit3D{origin - plane->normal * (dist + radius), plane->normal, 0.0f};
+        float closing = -plane->normal.dot(direction);
+        if (closing <= 0.0f || dist > closing * max_distance) return std::nullopt;
+        float d = dist / closing;
+        Vec3f center = origin + direction * d;
+        return ShapeCastHit3D{center - plane->normal * radius, plane->normal, d};
+    }
+    if (auto* mesh = std::get_if<TriangleMeshShape>(&shape)) {
+        if (!mesh->mesh || !cast_mesh(*mesh->mesh, t, origin, direction, max_distance, radius, hit)) {
+            return std::nullopt;
+        }
+        return hit;
+    }
+
+    ConvexProxy x;
+    if (!make_proxy(shape, t, x) || !cast_convex(x, origin, direction, max_distance, radius, hit)) {
+        return std::nullopt;
+    }
+    return hit;
+}
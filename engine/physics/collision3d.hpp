@@ -26,7 +26,36 @@ std::optional<ContactPoint> collide_box_plane(
     const BoxShape& box, const Transform3D& tb,
     const PlaneShape& plane);
 
-// Generic collision check using variant visitor
+// Generic collision check using variant visitor. Pairs involving a capsule,
+// convex hull or triangle mesh go through GJK (closest points of the shape
+// cores, e.g. a capsule's segment) and EPA when the cores overlap.
 std::optional<ContactPoint> check_collision3d(
     const CollisionShape3D& shape_a, const Transform3D& ta,
     const CollisionShape3D& shape_b, const Transform3D& tb);
+
+// Multi-point contact for the solver. Box-plane, box-box, capsule/hull-plane
+// and convex-mesh produce up to four points; every other combination
+// produces the single point that check_collision3d reports.
+bool collide_manifold3d(
+    const CollisionShape3D& shape_a, const Transform3D& ta,
+    const CollisionShape3D& shape_b, const Transform3D& tb,
+    ContactManifold& out);
+
+// World-space bounds of a finite shape. Planes are unbounded and must be
+// handled separately by callers; they return an empty box at the origin.
+Aabb3D compute_aabb3d(const CollisionShape3D& shape, const Transform3D& t);
+
+// First contact of a sphere swept along a ray
+struct ShapeCastHit3D {
+    Vec3f point;           // On the shape's surface
+    Vec3f normal;          // Out of the shape, towards the sphere
+    float distance = 0.0f; // Along the ray to the sphere's center at contact
+};
+
+// Sweep a sphere of the given radius (0 for a plain ray) from origin along
+// the unit vector direction, up to max_distance. A sphere that already
+// overlaps the shape at origin hits at distance 0. Triangle meshes are only
+// hit on their front side.
+std::optional<ShapeCastHit3D> sphere_cast3d(
+    const CollisionShape3D& shape, const Transform3D& t,
+    Vec3f origin, Vec3f direction, float max_distance, float radius);
@@ -1,9 +1,15 @@
 #pragma once
 #include "../math/vec3.hpp"
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <variant>
 
 // 3D collision shapes for rigid body physics
 
+class ConvexHull3D;
+class TriangleMesh3D;
+
 struct SphereShape {
     float radius = 1.0f;
 };
@@ -17,7 +23,57 @@ struct PlaneShape {
     float offset = 0.0f;  // distance from origin along normal
 };
 
-using CollisionShape3D = std::variant<SphereShape, BoxShape, PlaneShape>;
+// Segment along the local Y axis from -half_height to +half_height,
+// inflated by radius
+struct CapsuleShape {
+    float radius = 0.5f;
+    float half_height = 0.5f;
+};
+
+// Convex polytope; the hull data is immutable and shared between bodies
+struct ConvexHullShape {
+    std::shared_ptr<const ConvexHull3D> hull;
+};
+
+// Static triangle mesh (level geometry); bodies using it are always static
+struct TriangleMeshShape {
+    std::shared_ptr<const TriangleMesh3D> mesh;
+};
+
+using CollisionShape3D = std::variant<SphereShape, BoxShape, PlaneShape,
+                                      CapsuleShape, ConvexHullShape, TriangleMeshShape>;
+
+// World-space axis-aligned bounds used by the 3D broadphase
+struct Aabb3D {
+    Vec3f min;
+    Vec3f max;
+
+    bool overlaps(const Aabb3D& o) const {
+        return min.x <= o.max.x && max.x >= o.min.x &&
+               min.y <= o.max.y && max.y >= o.min.y &&
+               min.z <= o.max.z && max.z >= o.min.z;
+    }
+
+    // Distance along the ray at which origin + t * direction enters the box
+    // (0 if origin is inside), or -1 if it misses within [0, max_t].
+    // inv_direction comes from ray_inverse().
+    float ray_entry(Vec3f origin, Vec3f inv_direction, float max_t) const {
+        float x1 = (min.x - origin.x) * inv_direction.x, x2 = (max.x - origin.x) * inv_direction.x;
+        float y1 = (min.y - origin.y) * inv_direction.y, y2 = (max.y - origin.y) * inv_direction.y;
+        float z1 = (min.z - origin.z) * inv_direction.z, z2 = (max.z - origin.z) * inv_direction.z;
+        float t_near = std::max({std::min(x1, x2), std::min(y1, y2), std::min(z1, z2), 0.0f});
+        float t_far = std::min({std::max(x1, x2), std::max(y1, y2), std::max(z1, z2), max_t});
+        return t_near <= t_far ? t_near : -1.0f;
+    }
+};
+
+// Per-axis reciprocal of a ray direction for Aabb3D::ray_entry. Zero
+// components become huge rather than infinite, so slabs the ray runs
+// along never produce 0 * inf.
+inline Vec3f ray_inverse(Vec3f d) {
+    auto inv = [](float v) { return 1.0f / (std::abs(v) > 1e-20f ? v : std::copysign(1e-20f, v)); };
+    return {inv(d.x), inv(d.y), inv(d.z)};
+}
 
 // Contact information from collision detection
 struct ContactPoint {
@@ -25,3 +81,16 @@ struct ContactPoint {
     Vec3f normal;          // Contact normal (from A to B)
     float penetration;     // Penetration depth (positive = overlapping)
 };
+
+// Up to four contact points sharing one normal, for the contact solver
+struct ContactManifold {
+    static constexpr int max_points = 4;
+
+    Vec3f normal;  // from A to B
+    ContactPoint points[max_points];
+    int point_count = 0;
+
+    void add(const ContactPoint& p) {
+        if (point_count < max_points) points[point_count++] = p;
+    }
+};
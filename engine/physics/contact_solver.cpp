@@ -0,0 +1,219 @@
+#include "contact_solver.hpp"
+#include "rigid_body_world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+constexpr float baumgarte = 0.2f;            // fraction of penetration removed per step
+constexpr float penetration_slop = 0.01f;
+constexpr float restitution_threshold = 1.0f; // slower impacts do not bounce
+
+void tangent_basis(Vec3f n, Vec3f& t1, Vec3f& t2) {
+    if (std::abs(n.x) >= 0.57735f) t1 = Vec3f{n.y, -n.x, 0.0f}.normalized();
+    else                           t1 = Vec3f{0.0f, n.z, -n.y}.normalized();
+    t2 = n.cross(t1);
+}
+
+} // namespace
+
+void ContactSolver3D::begin_step() {
+    std::swap(cache_, constraints_);
+    constraints_.clear();
+    cache_cursor_ = 0;
+}
+
+void ContactSolver3D::save_state(std::vector<uint8_t>& out) const {
+    // Constraints are plain data; body indices in them are stale by the next
+    // step and only the ids and impulses are read back from the cache
+    static_assert(std::is_trivially_copyable_v<Constraint>);
+    auto count = static_cast<uint32_t>(constraints_.size());
+    size_t offset = out.size();
+    out.resize(offset + sizeof(count) + count * sizeof(Constraint));
+    std::memcpy(out.data() + offset, &count, sizeof(count));
+    if (count > 0) {
+        std::memcpy(out.data() + offset + sizeof(count), constraints_.data(), count * sizeof(Constraint));
+    }
+}
+
+size_t ContactSolver3D::restore_state(const uint8_t* data, size_t size) {
+    uint32_t count = 0;
+    if (size < sizeof(count)) return 0;
+    std::memcpy(&count, data, sizeof(count));
+    size_t bytes = sizeof(count) + static_cast<size_t>(count) * sizeof(Constraint);
+    if (size < bytes) return 0;
+    constraints_.resize(count);
+    if (count > 0) std::memcpy(constraints_.data(), data + sizeof(count), count * sizeof(Constraint));
+    cache_.clear();
+    cache_cursor_ = 0;
+    return bytes;
+}
+
+void ContactSolver3D::add_manifold(const BodyArrays3D& bodies,
+                                   uint32_t a, uint32_t b,
+                                   const ContactManifold& manifold) {
+    const RigidBody& ma = bodies.cold[a]->body;
+    const RigidBody& mb = bodies.cold[b]->body;
+
+    Constraint c;
+    c.a = a;
+    c.b = b;
+    c.id_a = bodies.id[a];
+    c.id_b = bodies.id[b];
+    c.normal = manifold.normal;
+    tangent_basis(c.normal, c.tangent[0], c.tangent[1]);
+    c.inv_mass_a = bodies.inv_mass[a];
+    c.inv_mass_b = bodies.inv_mass[b];
+    c.inv_inertia_a = bodies.inv_inertia[a];
+    c.inv_inertia_b = bodies.inv_inertia[b];
+    c.friction = (ma.friction + mb.friction) * 0.5f;
+    c.restitution = std::min(ma.restitution, mb.restitution);
+    c.point_count = manifold.point_count;
+    for (int i = 0; i < c.point_count; ++i) {
+        Point& p = c.points[i];
+        p.ra = manifold.points[i].point - bodies.position[a];
+        p.rb = manifold.points[i].point - bodies.position[b];
+        p.penetration = manifold.points[i].penetration;
+    }
+
+    // Both lists are sorted by id pair, so the cache is walked once per step
+    if (warm_starting_) {
+        while (cache_cursor_ < cache_.size() &&
+               (cache_[cache_cursor_].id_a < c.id_a ||
+                (cache_[cache_cursor_].id_a == c.id_a && cache_[cache_cursor_].id_b < c.id_b))) {
+            ++cache_cursor_;
+        }
+        if (cache_cursor_ < cache_.size() &&
+            cache_[cache_cursor_].id_a == c.id_a && cache_[cache_cursor_].id_b == c.id_b) {
+            const Constraint& old = cache_[cache_cursor_];
+            for (int i = 0; i < c.point_count; ++i) {
+                int match = -1;
+                float best = match_distance_ * match_distance_;
+                for (int k = 0; k < old.point_count; ++k) {
+                    float d = (old.points[k].ra - c.points[i].ra).length_sq();
+                    if (d < best) { best = d; match = k; }
+                }
+                if (match < 0) continue;
+                c.points[i].normal_impulse = old.points[match].normal_impulse;
+                c.points[i].tangent_impulse[0] = old.points[match].tangent_impulse[0];
+                c.points[i].tangent_impulse[1] = old.points[match].tangent_impulse[1];
+            }
+        }
+    }
+
+    constraints_.push_back(c);
+}
+
+void ContactSolver3D::prepare_constraint(const BodyArrays3D& bodies,
+                                         Constraint& c, float inv_dt) {
+    for (int i = 0; i < c.point_count; ++i) {
+        Point& p = c.points[i];
+
+        auto effective_mass = [&](Vec3f dir) {
+            Vec3f rna = p.ra.cross(dir);
+            Vec3f rnb = p.rb.cross(dir);
+            float k = c.inv_mass_a + c.inv_mass_b +
+                      c.inv_inertia_a * rna.length_sq() +
+                      c.inv_inertia_b * rnb.length_sq();
+            return k > 0.0f ? 1.0f / k : 0.0f;
+        };
+        p.normal_mass = effective_mass(c.normal);
+        p.tangent_mass[0] = effective_mass(c.tangent[0]);
+        p.tangent_mass[1] = effective_mass(c.tangent[1]);
+
+        // Push out penetration beyond the slop; for speculative points
+        // (negative penetration) allow approach until the gap closes
+        if (p.penetration > penetration_slop) {
+            p.bias = baumgarte * inv_dt * (p.penetration - penetration_slop);
+        } else {
+            p.bias = std::min(p.penetration, 0.0f) * inv_dt;
+        }
+
+        Vec3f dv = relative_velocity(bodies, c, p);
+        float vn = dv.dot(c.normal);
+        if (vn < -restitution_threshold) {
+            p.bias += -c.restitution * vn;
+        }
+
+        if (!warm_starting_) {
+            p.normal_impulse = 0.0f;
+            p.tangent_impulse[0] = p.tangent_impulse[1] = 0.0f;
+        }
+    }
+}
+
+Vec3f ContactSolver3D::relative_velocity(const BodyArrays3D& bodies, const Constraint& c,
+                                         const Point& p) {
+    return bodies.velocity[c.b] + bodies.angular_velocity[c.b].cross(p.rb) -
+           bodies.velocity[c.a] - bodies.angular_velocity[c.a].cross(p.ra);
+}
+
+void ContactSolver3D::apply_impulse(BodyArrays3D& bodies, const Constraint& c,
+                                    const Point& p, Vec3f impulse) {
+    // Static bodies are shared between islands, so they are never written
+    if (c.inv_mass_a > 0.0f) {
+        bodies.velocity.set(c.a, bodies.velocity[c.a] - impulse * c.inv_mass_a);
+        bodies.angular_velocity.set(c.a, bodies.angular_velocity[c.a] -
+                                         p.ra.cross(impulse) * c.inv_inertia_a);
+    }
+    if (c.inv_mass_b > 0.0f) {
+        bodies.velocity.set(c.b, bodies.velocity[c.b] + impulse * c.inv_mass_b);
+        bodies.angular_velocity.set(c.b, bodies.angular_velocity[c.b] +
+                                         p.rb.cross(impulse) * c.inv_inertia_b);
+    }
+}
+
+void ContactSolver3D::solve_constraint(BodyArrays3D& bodies, Constraint& c) {
+    for (int i = 0; i < c.point_count; ++i) {
+        Point& p = c.points[i];
+
+        // Friction, bounded by the current normal impulse
+        float max_friction = c.friction * p.normal_impulse;
+        for (int t = 0; t < 2; ++t) {
+            Vec3f dv = relative_velocity(bodies, c, p);
+            float lambda = -dv.dot(c.tangent[t]) * p.tangent_mass[t];
+            float old_impulse = p.tangent_impulse[t];
+            p.tangent_impulse[t] = std::clamp(old_impulse + lambda, -max_friction, max_friction);
+            apply_impulse(bodies, c, p, c.tangent[t] * (p.tangent_impulse[t] - old_impulse));
+        }
+
+        // Non-penetration
+        Vec3f dv = relative_velocity(bodies, c, p);
+        float lambda = -p.normal_mass * (dv.dot(c.normal) - p.bias);
+        float old_impulse = p.normal_impulse;
+        p.normal_impulse = std::max(old_impulse + lambda, 0.0f);
+        apply_impulse(bodies, c, p, c.normal * (p.normal_impulse - old_impulse));
+    }
+}
+
+void ContactSolver3D::solve_island(BodyArrays3D& bodies, float dt,
+                                   const uint32_t* constraints, uint32_t count) {
+    float inv_dt = dt > 0.0f ? 1.0f / dt : 0.0f;
+
+    // Biases use the pre-solve velocities, so every constraint is set up
+    // before any warm-start impulse is applied
+    for (uint32_t i = 0; i < count; ++i) {
+        prepare_constraint(bodies, constraints_[constraints[i]], inv_dt);
+    }
+
+    if (warm_starting_) {
+        for (uint32_t i = 0; i < count; ++i) {
+            const Constraint& c = constraints_[constraints[i]];
+            for (int k = 0; k < c.point_count; ++k) {
+                const Point& p = c.points[k];
+                apply_impulse(bodies, c, p,
+                              c.normal * p.normal_impulse +
+                              c.tangent[0] * p.tangent_impulse[0] +
+                              c.tangent[1] * p.tangent_impulse[1]);
+            }
+        }
+    }
+
+    for (int it = 0; it < iterations_; ++it) {
+        for (uint32_t i = 0; i < count; ++i) {
+            solve_constraint(bodies, constraints_[constraints[i]]);
+        }
+    }
+}
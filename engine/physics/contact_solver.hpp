@@ -0,0 +1,92 @@
+#pragma once
+#include "collision_shape3d.hpp"
+#include "body_arrays3d.hpp"
+#include <vector>
+#include <cstdint>
+
+// Sequential-impulse contact solver for RigidBodyWorld.
+//
+// Each step the world adds one manifold (up to four points) per touching
+// pair, then calls solve_island() once per contact island: effective masses
+// and bias velocities are precomputed, warm-start impulses applied, and N
+// velocity iterations run over the island's points. Accumulated impulses
+// are clamped (normal >= 0, friction inside the Coulomb cone) rather than
+// per-iteration ones, which is what lets stacks settle.
+//
+// Warm starting: the constraints of the previous step are kept as a cache
+// keyed by body id pair. A new point inherits the impulses of the closest
+// cached point of the same pair (within match_distance), so resting
+// contacts converge in a few iterations.
+//
+// Rotational inertia is approximated as isotropic (a scalar per body,
+// BodyArrays3D::inv_inertia).
+class ContactSolver3D {
+public:
+    void set_iterations(int n) { iterations_ = n; }
+    int iterations() const { return iterations_; }
+
+    void set_warm_starting(bool enabled) { warm_starting_ = enabled; }
+    bool warm_starting() const { return warm_starting_; }
+
+    // Start a new step: last step's constraints become the warm-start cache
+    void begin_step();
+
+    // Add the manifold between bodies[a] and bodies[b]. Calls must come in
+    // increasing (id a, id b) order, as the broadphase reports pairs.
+    void add_manifold(const BodyArrays3D& bodies, uint32_t a, uint32_t b,
+                      const ContactManifold& manifold);
+
+    // Prepare, warm start and iterate the given constraints. Islands share
+    // no dynamic bodies, so different islands may be solved concurrently.
+    void solve_island(BodyArrays3D& bodies, float dt,
+                      const uint32_t* constraints, uint32_t count);
+
+    // Warm-start state (the last step's constraints) as raw bytes, for
+    // RigidBodyWorld snapshots. restore_state returns the bytes consumed,
+    // or 0 if data is truncated.
+    void save_state(std::vector<uint8_t>& out) const;
+    size_t restore_state(const uint8_t* data, size_t size);
+
+    size_t constraint_count() const { return constraints_.size(); }
+    uint32_t body_a(size_t constraint) const { return constraints_[constraint].a; }
+    uint32_t body_b(size_t constraint) const { return constraints_[constraint].b; }
+
+private:
+    struct Point {
+        Vec3f ra, rb;             // contact offset from each body center
+        float penetration = 0.0f;
+        float normal_mass = 0.0f;
+        float tangent_mass[2] = {};
+        float bias = 0.0f;
+        float normal_impulse = 0.0f;
+        float tangent_impulse[2] = {};
+    };
+
+    struct Constraint {
+        uint32_t a, b;            // body indices for this step
+        uint64_t id_a, id_b;
+        Vec3f normal;
+        Vec3f tangent[2];
+        float inv_mass_a, inv_mass_b;
+        float inv_inertia_a, inv_inertia_b;
+        float friction, restitution;
+        Point points[ContactManifold::max_points];
+        int point_count;
+    };
+
+    // Cached points farther than this from every new point are dropped
+    static constexpr float match_distance_ = 0.05f;
+
+    std::vector<Constraint> constraints_;
+    std::vector<Constraint> cache_;
+    size_t cache_cursor_ = 0;
+
+    int iterations_ = 8;
+    bool warm_starting_ = true;
+
+    void prepare_constraint(const BodyArrays3D& bodies, Constraint& c, float inv_dt);
+    static Vec3f relative_velocity(const BodyArrays3D& bodies, const Constraint& c, const Point& p);
+    static void apply_impulse(BodyArrays3D& bodies, const Constraint& c,
+                              const Point& p, Vec3f impulse);
+    void solve_constraint(BodyArrays3D& bodies, Constraint& c);
+};
@@ -0,0 +1,233 @@
+#include "convex_hull3d.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+struct HullFace {
+    uint32_t v[3];
+    Vec3f normal;
+    float offset;
+};
+
+HullFace make_face(const std::vector<Vec3f>& pts, uint32_t a, uint32_t b, uint32_t c,
+                   Vec3f inside) {
+    Vec3f n = (pts[b] - pts[a]).cross(pts[c] - pts[a]).normalized();
+    HullFace f{{a, b, c}, n, n.dot(pts[a])};
+    // Keep faces counter-clockwise seen from outside
+    if (n.dot(inside) > f.offset) {
+        std::swap(f.v[1], f.v[2]);
+        f.normal = n * -1.0f;
+        f.offset = -f.offset;
+    }
+    return f;
+}
+
+float distance_to_line(Vec3f p, Vec3f a, Vec3f b) {
+    return (p - a).cross(b - a).length() / (b - a).length();
+}
+
+} // namespace
+
+ConvexHull3D::ConvexHull3D(const std::vector<Vec3f>& points) {
+    build_hull(points);
+    build_adjacency();
+
+    bounds_ = {vertices_.empty() ? Vec3f::zero() : vertices_[0],
+               vertices_.empty() ? Vec3f::zero() : vertices_[0]};
+    for (const Vec3f& v : vertices_) {
+        bounds_.min = {std::min(bounds_.min.x, v.x), std::min(bounds_.min.y, v.y),
+                       std::min(bounds_.min.z, v.z)};
+        bounds_.max = {std::max(bounds_.max.x, v.x), std::max(bounds_.max.y, v.y),
+                       std::max(bounds_.max.z, v.z)};
+    }
+
+    // Support map: farthest vertex for the center direction of every texel
+    constexpr int res = support_map_resolution;
+    support_map_.resize(6 * res * res);
+    for (int face = 0; face < 6; ++face) {
+        for (int v = 0; v < res; ++v) {
+            for (int u = 0; u < res; ++u) {
+                float s = (static_cast<float>(u) + 0.5f) * (2.0f / res) - 1.0f;
+                float t = (static_cast<float>(v) + 0.5f) * (2.0f / res) - 1.0f;
+                float sign = (face & 1) ? -1.0f : 1.0f;
+                Vec3f dir;
+                switch (face >> 1) {
+                    case 0:  dir = {sign, s, t}; break;
+                    case 1:  dir = {s, sign, t}; break;
+                    default: dir = {s, t, sign}; break;
+                }
+                support_map_[(face * res + v) * res + u] = support_brute_force(dir);
+            }
+        }
+    }
+}
+
+// Incremental hull: start from a tetrahedron of extreme points, then for
+// each point outside the current hull replace the faces it can see with a
+// fan from the point to their horizon.
+void ConvexHull3D::build_hull(const std::vector<Vec3f>& points) {
+    std::vector<Vec3f> pts = points;
+    std::sort(pts.begin(), pts.end(), [](Vec3f a, Vec3f b) {
+        if (a.x != b.x) return a.x < b.x;
+        if (a.y != b.y) return a.y < b.y;
+        return a.z < b.z;
+    });
+    pts.erase(std::unique(pts.begin(), pts.end(), [](Vec3f a, Vec3f b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }), pts.end());
+
+    // Flat or tiny input keeps every point and uses brute-force support
+    vertices_ = pts;
+    if (pts.size() < 4) return;
+
+    // pts is sorted by x: the ends are extreme along x
+    uint32_t i0 = 0, i1 = static_cast<uint32_t>(pts.size() - 1);
+    float scale = (pts[i1] - pts[i0]).length();
+    for (const Vec3f& p : pts) scale = std::max(scale, (p - pts[i0]).length());
+    float eps = 1e-5f * scale;
+    if ((pts[i1] - pts[i0]).length() <= eps) {
+        for (uint32_t i = 0; i < pts.size(); ++i) {
+            if ((pts[i] - pts[i0]).length() > (pts[i1] - pts[i0]).length()) i1 = i;
+        }
+    }
+
+    uint32_t i2 = i0;
+    float best = 0.0f;
+    for (uint32_t i = 0; i < pts.size(); ++i) {
+        float d = distance_to_line(pts[i], pts[i0], pts[i1]);
+        if (d > best) { best = d; i2 = i; }
+    }
+    if (best <= eps) return;
+
+    Vec3f plane_n = (pts[i1] - pts[i0]).cross(pts[i2] - pts[i0]).normalized();
+    uint32_t i3 = i0;
+    best = 0.0f;
+    for (uint32_t i = 0; i < pts.size(); ++i) {
+        float d = std::abs(plane_n.dot(pts[i] - pts[i0]));
+        if (d > best) { best = d; i3 = i; }
+    }
+    if (best <= eps) return;
+
+    Vec3f inside = (pts[i0] + pts[i1] + pts[i2] + pts[i3]) * 0.25f;
+    std::vector<HullFace> faces = {
+        make_face(pts, i0, i1, i2, inside), make_face(pts, i0, i1, i3, inside),
+        make_face(pts, i0, i2, i3, inside), make_face(pts, i1, i2, i3, inside),
+    };
+
+    std::vector<HullFace> kept;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    for (uint32_t p = 0; p < pts.size(); ++p) {
+        if (p == i0 || p == i1 || p == i2 || p == i3) continue;
+
+        kept.clear();
+        edges.clear();
+        for (const HullFace& f : faces) {
+            if (f.normal.dot(pts[p]) - f.offset > eps) {
+                edges.push_back({f.v[0], f.v[1]});
+                edges.push_back({f.v[1], f.v[2]});
+                edges.push_back({f.v[2], f.v[0]});
+            } else {
+                kept.push_back(f);
+            }
+        }
+        if (edges.empty()) continue;  // inside the current hull
+
+        // Horizon: visible-face edges whose twin belongs to a hidden face
+        for (auto [a, b] : edges) {
+            bool shared = std::find(edges.begin(), edges.end(), std::make_pair(b, a)) != edges.end();
+            if (!shared) kept.push_back(make_face(pts, a, b, p, inside));
+        }
+        std::swap(faces, kept);
+    }
+
+    // Compact to the vertices the faces use
+    std::vector<uint32_t> remap(pts.size(), UINT32_MAX);
+    vertices_.clear();
+    triangles_.clear();
+    for (const HullFace& f : faces) {
+        for (uint32_t v : f.v) {
+            if (remap[v] == UINT32_MAX) {
+                remap[v] = static_cast<uint32_t>(vertices_.size());
+                vertices_.push_back(pts[v]);
+            }
+            triangles_.push_back(remap[v]);
+        }
+    }
+}
+
+void ConvexHull3D::build_adjacency() {
+    neighbor_begin_.assign(vertices_.size() + 1, 0);
+    neighbors_.clear();
+    if (triangles_.empty()) return;
+
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    edges.reserve(triangles_.size() * 2);
+    for (size_t t = 0; t < triangles_.size(); t += 3) {
+        for (int k = 0; k < 3; ++k) {
+            uint32_t a = triangles_[t + k];
+            uint32_t b = triangles_[t + (k + 1) % 3];
+            edges.push_back({a, b});
+            edges.push_back({b, a});
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    for (auto [a, b] : edges) {
+        ++neighbor_begin_[a + 1];
+        neighbors_.push_back(b);
+    }
+    for (size_t i = 1; i < neighbor_begin_.size(); ++i) {
+        neighbor_begin_[i] += neighbor_begin_[i - 1];
+    }
+}
+
+uint32_t ConvexHull3D::support_brute_force(Vec3f dir) const {
+    uint32_t best = 0;
+    float best_dot = -INFINITY;
+    for (uint32_t i = 0; i < vertices_.size(); ++i) {
+        float d = vertices_[i].dot(dir);
+        if (d > best_dot) { best_dot = d; best = i; }
+    }
+    return best;
+}
+
+uint32_t ConvexHull3D::map_texel(Vec3f dir) {
+    constexpr int res = support_map_resolution;
+    Vec3f a{std::abs(dir.x), std::abs(dir.y), std::abs(dir.z)};
+    int face;
+    float major, s, t;
+    if (a.x >= a.y && a.x >= a.z) {
+        face = dir.x >= 0.0f ? 0 : 1; major = a.x; s = dir.y; t = dir.z;
+    } else if (a.y >= a.z) {
+        face = dir.y >= 0.0f ? 2 : 3; major = a.y; s = dir.x; t = dir.z;
+    } else {
+        face = dir.z >= 0.0f ? 4 : 5; major = a.z; s = dir.x; t = dir.y;
+    }
+    if (!(major > 0.0f)) return 0;
+
+    auto texel = [&](float c) {
+        int i = static_cast<int>((c / major + 1.0f) * (0.5f * res));
+        return std::clamp(i, 0, res - 1);
+    };
+    return static_cast<uint32_t>((face * res + texel(t)) * res + texel(s));
+}
+
+uint32_t ConvexHull3D::support_index(Vec3f dir) const {
+    if (neighbors_.empty()) return support_brute_force(dir);
+
+    // Steepest ascent over the edge graph from the map's start vertex
+    uint32_t v = support_map_[map_texel(dir)];
+    float best = vertices_[v].dot(dir);
+    for (;;) {
+        uint32_t next = v;
+        for (uint32_t k = neighbor_begin_[v]; k < neighbor_begin_[v + 1]; ++k) {
+            float d = vertices_[neighbors_[k]].dot(dir);
+            if (d > best) { best = d; next = neighbors_[k]; }
+        }
+        if (next == v) return v;
+        v = next;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "collision_shape3d.hpp"
+#include "../math/vec3.hpp"
+#include <vector>
+#include <cstdint>
+
+// Convex hull collision data, built once and shared between bodies through
+// ConvexHullShape.
+//
+// The constructor computes the hull of a point cloud (interior points are
+// dropped) and precomputes a support map: a cube map of the farthest vertex
+// for a grid of directions. A support query starts at the map's vertex for
+// the nearest direction and hill-climbs the vertex adjacency graph, which on
+// a convex polytope always ends at a global maximum, so GJK/EPA usually
+// touch only a handful of vertices regardless of hull size.
+class ConvexHull3D {
+public:
+    static constexpr int support_map_resolution = 8;  // texels per cube face edge
+
+    explicit ConvexHull3D(const std::vector<Vec3f>& points);
+
+    // Farthest vertex along dir (local space)
+    uint32_t support_index(Vec3f dir) const;
+    Vec3f support(Vec3f dir) const { return vertices_[support_index(dir)]; }
+
+    const std::vector<Vec3f>& vertices() const { return vertices_; }
+    // Outward (counter-clockwise) triangles, three vertex indices each;
+    // empty for degenerate (flat) input
+    const std::vector<uint32_t>& triangles() const { return triangles_; }
+    // Local-space bounds of the vertices
+    const Aabb3D& bounds() const { return bounds_; }
+
+private:
+    std::vector<Vec3f> vertices_;
+    std::vector<uint32_t> triangles_;
+    std::vector<uint32_t> neighbor_begin_;  // CSR adjacency, size vertices + 1
+    std::vector<uint32_t> neighbors_;
+    std::vector<uint32_t> support_map_;     // 6 * resolution^2 start vertices
+    Aabb3D bounds_{};
+
+    void build_hull(const std::vector<Vec3f>& points);
+    void build_adjacency();
+    uint32_t support_brute_force(Vec3f dir) const;
+    static uint32_t map_texel(Vec3f dir);
+};
@@ -5,32 +5,36 @@ CpuPhysicsComponent::~CpuPhysicsComponent() {
     release();
 }
 
+void CpuPhysicsComponent::start_workers() {
+    jobs_.shutdown();
+    // The calling thread waits in parallel_for, so one thread means none
+    if (thread_count_ > 1) jobs_.initialize(thread_count_);
+}
+
 void CpuPhysicsComponent::start() {
     running_.store(true);
     if (thread_count_ == 0) {
         thread_count_ = std::max(1u, std::thread::hardware_concurrency() / 2);
     }
+    start_workers();
 }
 
 void CpuPhysicsComponent::update(float dt) {
     if (!running_.load()) return;
 
-    // For CPU physics, run the world step directly
-    // The RigidBodyWorld handles its own fixed-timestep accumulation
+    // The RigidBodyWorld handles its own fixed-timestep accumulation and
+    // fans each substep's stages out to jobs_
     world_.step(dt);
 }
 
 void CpuPhysicsComponent::release() {
     running_.store(false);
-    for (auto& w : workers_) {
-        w.active.store(false);
-        if (w.thread.joinable()) w.thread.join();
-    }
-    workers_.clear();
+    jobs_.shutdown();
 }
 
 void CpuPhysicsComponent::set_thread_count(uint32_t count) {
     thread_count_ = (count == 0)
         ? std::max(1u, std::thread::hardware_concurrency() / 2)
         : count;
+    if (running_.load()) start_workers();
 }
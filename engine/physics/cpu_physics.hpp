@@ -1,33 +1,29 @@
 #pragma once
 #include "rigid_body_world.hpp"
 #include "../core/concepts.hpp"
-#include <vector>
+#include "../core/job_system.hpp"
 #include <thread>
-#include <mutex>
-#include <functional>
 #include <atomic>
-#include <condition_variable>
 
 // CPU-based physics component
 // Runs rigid body simulation on CPU threads
 // Suitable for: precise simulation, small-medium body counts, all platforms
-
+//
+// The world's parallel stages (integration, broadphase sweep, narrowphase,
+// island solves) run on a job system owned by this component, sized by
+// set_thread_count(). With one thread everything runs inline on the caller.
+// Results are identical for any thread count.
 class CpuPhysicsComponent {
     RigidBodyWorld world_;
-
-    // Multi-threaded broadphase partitioning
-    struct WorkerContext {
-        std::thread thread;
-        std::atomic<bool> active{false};
-    };
-    std::vector<WorkerContext> workers_;
-    std::mutex mutex_;
+    JobSystem jobs_;
     std::atomic<bool> running_{false};
 
     uint32_t thread_count_ = 1;
 
+    void start_workers();
+
 public:
-    CpuPhysicsComponent() = default;
+    CpuPhysicsComponent() { world_.set_job_system(jobs_); }
     ~CpuPhysicsComponent();
 
     // Lifecycle (satisfies concept-based interface)
@@ -35,8 +31,10 @@ public:
     void update(float dt);
     void release();
 
-    // Configuration
+    // Configuration (0 = half the hardware threads); applies immediately
+    // when running
     void set_thread_count(uint32_t count);
+    uint32_t thread_count() const { return thread_count_; }
     void set_gravity(Vec3f gravity) { world_.set_gravity(gravity); }
 
     // Body management (delegates to RigidBodyWorld)
@@ -0,0 +1,76 @@
+#pragma once
+#include "collision_shape3d.hpp"
+#include "../math/vec3.hpp"
+#include <vector>
+#include <cstdint>
+
+// Data layout and backend interface shared by GpuPhysicsComponent and its
+// compute backends. A backend owns the device-side copies of the packed
+// arrays and runs one simulation step per dispatch:
+//
+//   1. integrate    gravity + forces, semi-implicit Euler, damping
+//   2. broadphase   bin bodies into a uniform grid (hash + counting sort)
+//   3. narrowphase  per-body contacts against the 27 neighbouring cells
+//   4. resolve      per-body impulse + positional correction (Jacobi)
+//
+// GpuComputeEmulator runs these kernels on the job system; a Vulkan compute
+// backend implements the same interface with shaders.
+
+// GPU buffer handles (opaque IDs managed by the backend)
+struct GpuBufferHandle {
+    uint64_t id = 0;
+    bool valid() const { return id != 0; }
+};
+
+// Compact body representation for GPU transfer (SOA-friendly)
+struct alignas(16) GpuBodyData {
+    float pos_x, pos_y, pos_z, inv_mass;
+    float vel_x, vel_y, vel_z, restitution;
+    float force_x, force_y, force_z, padding;
+};
+
+// Compact shape representation for GPU
+struct alignas(16) GpuShapeData {
+    uint32_t type;         // 0=sphere, 1=box, 2=plane
+    float param0;          // sphere: radius, box: half_extent.x, plane: normal.x
+    float param1;          // box: half_extent.y, plane: normal.y
+    float param2;          // box: half_extent.z, plane: normal.z
+};
+
+enum GpuShapeType : uint32_t {
+    gpu_shape_sphere = 0,
+    gpu_shape_box    = 1,
+    gpu_shape_plane  = 2,
+};
+
+// Uniforms for one dispatch
+struct GpuDispatchParams {
+    Vec3f gravity;
+    float dt = 0.0f;
+    float damping = 1.0f;         // velocity scale applied after each step
+    bool report_contacts = false; // fill the contact buffer for callbacks
+};
+
+// One resolved contact, indices into the uploaded body array
+struct GpuContact {
+    uint32_t body_a;
+    uint32_t body_b;
+    ContactPoint contact;  // normal from A to B
+};
+
+class GpuComputeBackend {
+public:
+    virtual ~GpuComputeBackend() = default;
+
+    // Copy the packed arrays into backend buffers
+    virtual void upload(const std::vector<GpuBodyData>& bodies,
+                        const std::vector<GpuShapeData>& shapes) = 0;
+
+    // Run one fixed step over the uploaded bodies
+    virtual void dispatch(const GpuDispatchParams& params) = 0;
+
+    // Copy positions/velocities back (bodies must match the uploaded size)
+    // and replace contacts with the ones found by the last dispatch
+    virtual void readback(std::vector<GpuBodyData>& bodies,
+                          std::vector<GpuContact>& contacts) = 0;
+};
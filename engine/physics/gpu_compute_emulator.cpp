@@ -0,0 +1,396 @@
+#include "gpu_compute_emulator.hpp"
+#include "../math/simd.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Positional correction, same constants as the CPU fallback
+constexpr float penetration_slop = 0.01f;
+constexpr float correction_percent = 0.8f;
+
+// Largest half extent of a finite shape
+float bound_extent(uint32_t type, Vec3f param) {
+    if (type == gpu_shape_sphere) return param.x;
+    return std::max(param.x, std::max(param.y, param.z));
+}
+
+// Sphere vs axis-aligned box; normal from the sphere to the box
+bool sphere_box(Vec3f sphere_pos, float radius, Vec3f box_pos, Vec3f half,
+                ContactPoint& out) {
+    Vec3f local = sphere_pos - box_pos;
+    Vec3f closest{
+        std::clamp(local.x, -half.x, half.x),
+        std::clamp(local.y, -half.y, half.y),
+        std::clamp(local.z, -half.z, half.z)
+    };
+    Vec3f diff = local - closest;
+    float dist_sq = diff.length_sq();
+    if (dist_sq >= radius * radius) return false;
+
+    float dist = std::sqrt(dist_sq);
+    Vec3f n = (dist > 0.0001f) ? diff * (1.0f / dist) : Vec3f{0.0f, 1.0f, 0.0f};
+    out = {box_pos + closest, n * -1.0f, radius - dist};
+    return true;
+}
+
+// Grid coordinate of a scaled position. Converting NaN or a float outside
+// int32 range is undefined, so clamp first; +-2^30 leaves room for the
+// neighbour offsets the contact stage adds.
+int32_t cell_coord(float scaled) {
+    constexpr float limit = 1073741824.0f;
+    float c = std::floor(scaled);
+    c = c > -limit ? std::min(c, limit) : -limit;  // NaN clamps low
+    return static_cast<int32_t>(c);
+}
+
+} // namespace
+
+// --- Upload / readback ---
+
+void GpuComputeEmulator::upload(const std::vector<GpuBodyData>& bodies,
+                                const std::vector<GpuShapeData>& shapes) {
+    size_t n = bodies.size();
+    Vec3Column* columns[] = {&position_, &velocity_, &force_, &next_position_,
+                             &next_velocity_, &shape_param_};
+    for (Vec3Column* c : columns) {
+        c->clear();
+        c->reserve(n);
+    }
+    inv_mass_.clear();
+    restitution_.clear();
+    shape_type_.clear();
+
+    float max_extent = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        const GpuBodyData& bd = bodies[i];
+        const GpuShapeData& sd = shapes[i];
+        position_.push_back({bd.pos_x, bd.pos_y, bd.pos_z});
+        velocity_.push_back({bd.vel_x, bd.vel_y, bd.vel_z});
+        force_.push_back({bd.force_x, bd.force_y, bd.force_z});
+        next_position_.push_back(Vec3f::zero());
+        next_velocity_.push_back(Vec3f::zero());
+        inv_mass_.push_back(bd.inv_mass);
+        restitution_.push_back(bd.restitution);
+        shape_type_.push_back(sd.type);
+        shape_param_.push_back({sd.param0, sd.param1, sd.param2});
+
+        if (bd.inv_mass > 0.0f && sd.type != gpu_shape_plane) {
+            max_extent = std::max(max_extent, bound_extent(sd.type, shape_param_[i]));
+        }
+    }
+
+    // Every dynamic body fits in one cell, so overlapping bodies always sit
+    // in neighbouring cells
+    cell_size_ = (max_extent > 0.0f) ? 2.0f * max_extent : 1.0f;
+
+    unbounded_.clear();
+    for (uint32_t i = 0; i < n; ++i) {
+        if (!is_binned(i)) unbounded_.push_back(i);
+    }
+}
+
+void GpuComputeEmulator::readback(std::vector<GpuBodyData>& bodies,
+                                  std::vector<GpuContact>& contacts) {
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        GpuBodyData& bd = bodies[i];
+        bd.pos_x = position_.x[i];
+        bd.pos_y = position_.y[i];
+        bd.pos_z = position_.z[i];
+        bd.vel_x = velocity_.x[i];
+        bd.vel_y = velocity_.y[i];
+        bd.vel_z = velocity_.z[i];
+        bd.force_x = force_.x[i];
+        bd.force_y = force_.y[i];
+        bd.force_z = force_.z[i];
+    }
+
+    contacts.clear();
+    for (uint32_t c = 0; c < contact_chunks_; ++c) {
+        contacts.insert(contacts.end(), contact_buffers_[c].begin(), contact_buffers_[c].end());
+    }
+}
+
+// --- Dispatch ---
+
+void GpuComputeEmulator::dispatch(const GpuDispatchParams& params) {
+    auto n = static_cast<uint32_t>(inv_mass_.size());
+    contact_chunks_ = 0;
+    if (n == 0) return;
+
+    // Stage 1: integration
+    jobs_->parallel_for(0, n, integrate_chunk_size, [&](uint32_t begin, uint32_t end) {
+        integrate(begin, end, params);
+    });
+
+    // Stage 2: broadphase
+    build_grid();
+
+    // Stages 3 + 4: per-body contacts and response into the next_ buffers.
+    // Chunks are iterated explicitly so each owns one contact buffer even
+    // when parallel_for runs the whole range inline.
+    uint32_t chunks = (n + solve_chunk_size - 1) / solve_chunk_size;
+    if (contact_buffers_.size() < chunks) contact_buffers_.resize(chunks);
+    contact_chunks_ = chunks;
+
+    jobs_->parallel_for(0, chunks, 1, [&](uint32_t first, uint32_t last) {
+        for (uint32_t c = first; c < last; ++c) {
+            auto& buffer = contact_buffers_[c];
+            buffer.clear();
+            uint32_t end = std::min(n, (c + 1) * solve_chunk_size);
+            for (uint32_t i = c * solve_chunk_size; i < end; ++i) {
+                solve_body(i, params.report_contacts ? &buffer : nullptr);
+            }
+        }
+    });
+
+    std::swap(position_, next_position_);
+    std::swap(velocity_, next_velocity_);
+}
+
+// --- Stage 1: integration ---
+
+// v += (g + f / m) dt; p += v dt; v *= damping. Static bodies are untouched.
+// The SIMD loop and the scalar tail perform the same operations in order.
+void GpuComputeEmulator::integrate(uint32_t begin, uint32_t end,
+                                   const GpuDispatchParams& params) {
+    float dt = params.dt;
+    float damping = params.damping;
+    uint32_t i = begin;
+
+#if ERGO_SIMD_AVX2 || ERGO_SIMD_SSE
+    using namespace simd;
+    vfloat vdt = splat(dt), vdamp = splat(damping), zero = splat(0.0f);
+    vfloat g[3] = {splat(params.gravity.x), splat(params.gravity.y), splat(params.gravity.z)};
+    float* pos[3] = {position_.x.data(), position_.y.data(), position_.z.data()};
+    float* vel[3] = {velocity_.x.data(), velocity_.y.data(), velocity_.z.data()};
+    float* force[3] = {force_.x.data(), force_.y.data(), force_.z.data()};
+
+    for (; i + lanes <= end; i += lanes) {
+        vfloat im = load(&inv_mass_[i]);
+        vfloat movable = cmp_lt(zero, im);
+        if (movemask(movable) == 0) continue;
+
+        for (int axis = 0; axis < 3; ++axis) {
+            float* p = pos[axis] + i;
+            float* v = vel[axis] + i;
+            float* f = force[axis] + i;
+            vfloat old_v = load(v);
+            vfloat nv = add(old_v, mul(add(g[axis], mul(load(f), im)), vdt));
+            vfloat old_p = load(p);
+            store(p, select(movable, add(old_p, mul(nv, vdt)), old_p));
+            store(v, select(movable, mul(nv, vdamp), old_v));
+            store(f, select(movable, zero, load(f)));
+        }
+    }
+#endif
+
+    for (; i < end; ++i) {
+        float im = inv_mass_[i];
+        if (!(im > 0.0f)) continue;
+
+        Vec3f v = velocity_[i];
+        Vec3f f = force_[i];
+        v.x = v.x + (params.gravity.x + f.x * im) * dt;
+        v.y = v.y + (params.gravity.y + f.y * im) * dt;
+        v.z = v.z + (params.gravity.z + f.z * im) * dt;
+        position_.x[i] = position_.x[i] + v.x * dt;
+        position_.y[i] = position_.y[i] + v.y * dt;
+        position_.z[i] = position_.z[i] + v.z * dt;
+        velocity_.set(i, {v.x * damping, v.y * damping, v.z * damping});
+        force_.set(i, Vec3f::zero());
+    }
+}
+
+// --- Stage 2: uniform grid ---
+
+uint32_t GpuComputeEmulator::hash_cell(int32_t x, int32_t y, int32_t z) const {
+    uint32_t h = (static_cast<uint32_t>(x) * 73856093u) ^
+                 (static_cast<uint32_t>(y) * 19349663u) ^
+                 (static_cast<uint32_t>(z) * 83492791u);
+    return h & cell_mask_;
+}
+
+bool GpuComputeEmulator::is_binned(uint32_t i) const {
+    return shape_type_[i] != gpu_shape_plane &&
+           bound_extent(shape_type_[i], shape_param_[i]) <= 0.5f * cell_size_;
+}
+
+void GpuComputeEmulator::build_grid() {
+    auto n = static_cast<uint32_t>(inv_mass_.size());
+    size_t table = 64;
+    while (table < 2 * static_cast<size_t>(n)) table <<= 1;
+    cell_mask_ = static_cast<uint32_t>(table - 1);
+    cell_start_.assign(table + 1, 0);
+    cell_x_.resize(n);
+    cell_y_.resize(n);
+    cell_z_.resize(n);
+    cell_hash_.assign(n, no_cell);
+
+    // Cell of every binned body
+    float inv_cell = 1.0f / cell_size_;
+    jobs_->parallel_for(0, n, integrate_chunk_size, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            if (!is_binned(i)) continue;
+            cell_x_[i] = cell_coord(position_.x[i] * inv_cell);
+            cell_y_[i] = cell_coord(position_.y[i] * inv_cell);
+            cell_z_[i] = cell_coord(position_.z[i] * inv_cell);
+            cell_hash_[i] = hash_cell(cell_x_[i], cell_y_[i], cell_z_[i]);
+        }
+    });
+
+    // Counting sort by hash; scattering in index order keeps every bucket
+    // sorted, so neighbour iteration order never depends on the workers
+    for (uint32_t i = 0; i < n; ++i) {
+        if (cell_hash_[i] != no_cell) ++cell_start_[cell_hash_[i]];
+    }
+    uint32_t total = 0;
+    for (size_t h = 0; h < table; ++h) {
+        uint32_t count = cell_start_[h];
+        cell_start_[h] = total;
+        total += count;
+    }
+    cell_start_[table] = total;
+
+    cell_bodies_.resize(total);
+    for (uint32_t i = 0; i < n; ++i) {
+        if (cell_hash_[i] != no_cell) cell_bodies_[cell_start_[cell_hash_[i]]++] = i;
+    }
+    // Each start now holds the next bucket's start; shift back by one
+    for (size_t h = table; h > 0; --h) cell_start_[h] = cell_start_[h - 1];
+    cell_start_[0] = 0;
+}
+
+// --- Stages 3 + 4: contacts and response ---
+
+bool GpuComputeEmulator::collide(uint32_t i, uint32_t j, ContactPoint& out) const {
+    Vec3f pi = position_[i], pj = position_[j];
+    Vec3f si = shape_param_[i], sj = shape_param_[j];
+    uint32_t ti = shape_type_[i], tj = shape_type_[j];
+
+    if (tj == gpu_shape_plane) {
+        float offset = sj.dot(pj);
+        if (ti == gpu_shape_sphere) {
+            float dist = sj.dot(pi) - offset;
+            if (dist >= si.x) return false;
+            out = {pi - sj * dist, sj * -1.0f, si.x - dist};
+            return true;
+        }
+        // Box: the corner deepest along the plane normal
+        Vec3f corner{pi.x - (sj.x >= 0.0f ? si.x : -si.x),
+                     pi.y - (sj.y >= 0.0f ? si.y : -si.y),
+                     pi.z - (sj.z >= 0.0f ? si.z : -si.z)};
+        float dist = sj.dot(corner) - offset;
+        if (dist >= 0.0f) return false;
+        out = {corner, sj * -1.0f, -dist};
+        return true;
+    }
+
+    if (ti == gpu_shape_sphere && tj == gpu_shape_sphere) {
+        Vec3f diff = pj - pi;
+        float dist_sq = diff.length_sq();
+        float r_sum = si.x + sj.x;
+        if (dist_sq >= r_sum * r_sum) return false;
+
+        // Coincident centres: opposite normals from the two sides
+        float dist = std::sqrt(dist_sq);
+        Vec3f n = (dist > 0.0001f) ? diff * (1.0f / dist)
+                                   : Vec3f{0.0f, i < j ? 1.0f : -1.0f, 0.0f};
+        out = {pi + n * si.x, n, r_sum - dist};
+        return true;
+    }
+    if (ti == gpu_shape_sphere && tj == gpu_shape_box) {
+        return sphere_box(pi, si.x, pj, sj, out);
+    }
+    if (ti == gpu_shape_box && tj == gpu_shape_sphere) {
+        if (!sphere_box(pj, sj.x, pi, si, out)) return false;
+        out.normal = out.normal * -1.0f;
+        return true;
+    }
+
+    // Box vs box: separate along the axis of least overlap
+    Vec3f d = pj - pi;
+    float ox = (si.x + sj.x) - std::fabs(d.x);
+    float oy = (si.y + sj.y) - std::fabs(d.y);
+    float oz = (si.z + sj.z) - std::fabs(d.z);
+    if (ox <= 0.0f || oy <= 0.0f || oz <= 0.0f) return false;
+
+    auto side = [&](float delta) {
+        if (delta != 0.0f) return delta < 0.0f ? -1.0f : 1.0f;
+        return i < j ? 1.0f : -1.0f;
+    };
+    Vec3f point{
+        0.5f * (std::max(pi.x - si.x, pj.x - sj.x) + std::min(pi.x + si.x, pj.x + sj.x)),
+        0.5f * (std::max(pi.y - si.y, pj.y - sj.y) + std::min(pi.y + si.y, pj.y + sj.y)),
+        0.5f * (std::max(pi.z - si.z, pj.z - sj.z) + std::min(pi.z + si.z, pj.z + sj.z)),
+    };
+    if (ox <= oy && ox <= oz) {
+        out = {point, {side(d.x), 0.0f, 0.0f}, ox};
+    } else if (oy <= oz) {
+        out = {point, {0.0f, side(d.y), 0.0f}, oy};
+    } else {
+        out = {point, {0.0f, 0.0f, side(d.z)}, oz};
+    }
+    return true;
+}
+
+void GpuComputeEmulator::solve_body(uint32_t i, std::vector<GpuContact>* contacts) {
+    Vec3f p = position_[i];
+    Vec3f v = velocity_[i];
+    next_position_.set(i, p);
+    next_velocity_.set(i, v);
+
+    float im = inv_mass_[i];
+    if (!(im > 0.0f) || shape_type_[i] == gpu_shape_plane) return;
+
+    // Sums of every contact's response, from the post-integration state only
+    Vec3f dv = Vec3f::zero();
+    Vec3f dp = Vec3f::zero();
+    auto test = [&](uint32_t j) {
+        ContactPoint c;
+        if (!collide(i, j, c)) return;
+
+        float im_sum = im + inv_mass_[j];
+        float vn = (velocity_[j] - v).dot(c.normal);
+        if (vn > 0.0f) return;  // separating
+
+        float e = std::min(restitution_[i], restitution_[j]);
+        float jn = -(1.0f + e) * vn / im_sum;
+        dv = dv - c.normal * (jn * im);
+
+        float correction = std::max(c.penetration - penetration_slop, 0.0f) / im_sum
+                           * correction_percent;
+        dp = dp - c.normal * (correction * im);
+
+        // Each pair is reported once: by the lower index, or by the only
+        // dynamic side
+        if (contacts && (i < j || !(inv_mass_[j] > 0.0f))) {
+            contacts->push_back({i, j, c});
+        }
+    };
+
+    if (cell_hash_[i] != no_cell) {
+        int32_t cx = cell_x_[i], cy = cell_y_[i], cz = cell_z_[i];
+        for (int32_t z = cz - 1; z <= cz + 1; ++z) {
+            for (int32_t y = cy - 1; y <= cy + 1; ++y) {
+                for (int32_t x = cx - 1; x <= cx + 1; ++x) {
+                    uint32_t h = hash_cell(x, y, z);
+                    for (uint32_t k = cell_start_[h]; k < cell_start_[h + 1]; ++k) {
+                        uint32_t j = cell_bodies_[k];
+                        // Buckets are shared by every cell with the same hash
+                        if (j == i || cell_x_[j] != x || cell_y_[j] != y || cell_z_[j] != z) {
+                            continue;
+                        }
+                        test(j);
+                    }
+                }
+            }
+        }
+    }
+    for (uint32_t j : unbounded_) {
+        if (j != i) test(j);
+    }
+
+    next_position_.set(i, p + dp);
+    next_velocity_.set(i, v + dv);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "gpu_compute.hpp"
+#include "body_arrays3d.hpp"
+#include "../core/job_system.hpp"
+#include <vector>
+#include <cstdint>
+
+// Compute backend that runs the GPU kernels on the CPU.
+//
+// Buffers are kept in SoA form; integration runs 4-8 bodies per SIMD
+// instruction and every kernel is split across the job system. Each body is
+// resolved by exactly one "thread" that reads the post-integration state
+// and writes only its own output slot, like a compute shader invocation, so
+// results do not depend on the worker count.
+//
+// Boxes are axis-aligned (GpuBodyData carries no rotation). Planes pass
+// through their body position; planes and static bodies too large for a
+// grid cell are tested against every dynamic body instead of being binned.
+class GpuComputeEmulator final : public GpuComputeBackend {
+public:
+    explicit GpuComputeEmulator(JobSystem& jobs = g_job_system) : jobs_(&jobs) {}
+
+    void upload(const std::vector<GpuBodyData>& bodies,
+                const std::vector<GpuShapeData>& shapes) override;
+    void dispatch(const GpuDispatchParams& params) override;
+    void readback(std::vector<GpuBodyData>& bodies,
+                  std::vector<GpuContact>& contacts) override;
+
+    // Edge length of the broadphase cells: twice the largest dynamic extent
+    float cell_size() const { return cell_size_; }
+
+private:
+    static constexpr uint32_t integrate_chunk_size = 4096;
+    static constexpr uint32_t solve_chunk_size = 256;
+    static constexpr uint32_t no_cell = UINT32_MAX;
+
+    JobSystem* jobs_;
+
+    // Body buffers
+    Vec3Column position_;
+    Vec3Column velocity_;
+    Vec3Column force_;
+    Vec3Column next_position_;
+    Vec3Column next_velocity_;
+    std::vector<float> inv_mass_;
+    std::vector<float> restitution_;
+    std::vector<uint32_t> shape_type_;
+    Vec3Column shape_param_;
+
+    // Uniform grid, rebuilt every dispatch
+    float cell_size_ = 1.0f;
+    uint32_t cell_mask_ = 0;             // hash table size - 1 (power of two)
+    std::vector<int32_t> cell_x_, cell_y_, cell_z_;
+    std::vector<uint32_t> cell_hash_;    // per body, no_cell if unbounded
+    std::vector<uint32_t> cell_start_;   // hash -> first entry in cell_bodies_
+    std::vector<uint32_t> cell_bodies_;  // body indices sorted by hash
+    std::vector<uint32_t> unbounded_;    // planes and oversized static bodies
+
+    // One contact list per solve chunk, concatenated on readback
+    std::vector<std::vector<GpuContact>> contact_buffers_;
+    uint32_t contact_chunks_ = 0;
+
+    uint32_t hash_cell(int32_t x, int32_t y, int32_t z) const;
+    bool is_binned(uint32_t i) const;
+
+    void integrate(uint32_t begin, uint32_t end, const GpuDispatchParams& params);
+    void build_grid();
+    void solve_body(uint32_t i, std::vector<GpuContact>* contacts);
+
+    // Contact between body i and body j with the normal from i to j
+    bool collide(uint32_t i, uint32_t j, ContactPoint& out) const;
+};
@@ -4,15 +4,19 @@
 #include <cmath>
 #include <cstring>
 
+namespace {
+// Velocity scale applied after every step, both paths
+constexpr float step_damping = 0.99f;
+}
+
 GpuPhysicsComponent::~GpuPhysicsComponent() {
     release();
 }
 
 void GpuPhysicsComponent::start() {
-    // Check compute shader availability
-    // In a real implementation, this would query VkPhysicalDeviceProperties
-    // or check for VK_KHR_compute_shader support
-    compute_available_ = false;  // Default to CPU fallback until Vulkan compute is set up
+    // A Vulkan backend is installed only after querying compute support;
+    // the emulator is always available
+    compute_available_ = backend_ != nullptr;
     initialized_ = true;
 }
 
@@ -43,9 +47,16 @@ void GpuPhysicsComponent::release() {
     shape_data_.clear();
     body_ids_.clear();
     callbacks_.clear();
+    contacts_.clear();
+    compute_available_ = false;
     initialized_ = false;
 }
 
+void GpuPhysicsComponent::set_compute_backend(std::unique_ptr<GpuComputeBackend> backend) {
+    backend_ = std::move(backend);
+    if (initialized_) compute_available_ = backend_ != nullptr;
+}
+
 uint64_t GpuPhysicsComponent::add_body(Vec3f position, float mass,
                                          CollisionShape3D shape) {
     uint64_t id = next_id_++;
@@ -75,6 +86,13 @@ uint64_t GpuPhysicsComponent::add_body(Vec3f position, float mass,
             sd.param0 = s.normal.x;
             sd.param1 = s.normal.y;
             sd.param2 = s.normal.z;
+        } else {
+            // Capsules, hulls and meshes are approximated by their bounds
+            Aabb3D bounds = compute_aabb3d(shape, Transform3D{});
+            sd.type = 1;
+            sd.param0 = std::max(-bounds.min.x, bounds.max.x);
+            sd.param1 = std::max(-bounds.min.y, bounds.max.y);
+            sd.param2 = std::max(-bounds.min.z, bounds.max.z);
         }
     }, shape);
 
@@ -175,9 +193,9 @@ void GpuPhysicsComponent::integrate_cpu(float dt) {
         bd.force_x = bd.force_y = bd.force_z = 0.0f;
 
         // Simple damping
-        bd.vel_x *= 0.99f;
-        bd.vel_y *= 0.99f;
-        bd.vel_z *= 0.99f;
+        bd.vel_x *= step_damping;
+        bd.vel_y *= step_damping;
+        bd.vel_z *= step_damping;
     }
 }
 
@@ -196,18 +214,22 @@ void GpuPhysicsComponent::detect_collisions_cpu() {
             ta.position = {a.pos_x, a.pos_y, a.pos_z};
             tb.position = {b.pos_x, b.pos_y, b.pos_z};
 
-            // Reconstruct shapes from GpuShapeData
-            auto make_shape = [](const GpuShapeData& sd) -> CollisionShape3D {
+            // Reconstruct shapes from GpuShapeData; planes pass through
+            // their body position
+            auto make_shape = [](const GpuShapeData& sd, Vec3f pos) -> CollisionShape3D {
                 switch (sd.type) {
                     case 0: return SphereShape{sd.param0};
                     case 1: return BoxShape{{sd.param0, sd.param1, sd.param2}};
-                    case 2: return PlaneShape{{sd.param0, sd.param1, sd.param2}, 0.0f};
+                    case 2: {
+                        Vec3f n{sd.param0, sd.param1, sd.param2};
+                        return PlaneShape{n, n.dot(pos)};
+                    }
                     default: return SphereShape{0.0f};
                 }
             };
 
-            auto shape_a = make_shape(shape_data_[i]);
-            auto shape_b = make_shape(shape_data_[j]);
+            auto shape_a = make_shape(shape_data_[i], ta.position);
+            auto shape_b = make_shape(shape_data_[j], tb.position);
 
             auto contact = check_collision3d(shape_a, ta, shape_b, tb);
             if (!contact) continue;
@@ -240,37 +262,45 @@ void GpuPhysicsComponent::detect_collisions_cpu() {
             b.pos_y += contact->normal.y * correction * b.inv_mass;
             b.pos_z += contact->normal.z * correction * b.inv_mass;
 
-            // Fire callbacks
-            for (auto& cb : callbacks_) {
-                if (cb.body_id == body_ids_[i]) {
-                    cb.callback(body_ids_[j], *contact);
-                } else if (cb.body_id == body_ids_[j]) {
-                    ContactPoint reversed = *contact;
-                    reversed.normal = reversed.normal * -1.0f;
-                    cb.callback(body_ids_[i], reversed);
-                }
-            }
+            fire_callbacks(i, j, *contact);
+        }
+    }
+}
+
+void GpuPhysicsComponent::fire_callbacks(size_t i, size_t j, const ContactPoint& contact) {
+    for (auto& cb : callbacks_) {
+        if (cb.body_id == body_ids_[i]) {
+            cb.callback(body_ids_[j], contact);
+        } else if (cb.body_id == body_ids_[j]) {
+            ContactPoint reversed = contact;
+            reversed.normal = reversed.normal * -1.0f;
+            cb.callback(body_ids_[i], reversed);
         }
     }
 }
 
-// --- GPU execution stubs ---
+// --- Compute backend execution ---
 
 void GpuPhysicsComponent::upload_to_gpu() {
-    // TODO: Map GPU buffers and upload body_data_ and shape_data_
-    // vkMapMemory -> memcpy -> vkUnmapMemory
+    backend_->upload(body_data_, shape_data_);
 }
 
 void GpuPhysicsComponent::dispatch_compute() {
-    // TODO: Bind compute pipeline, set descriptor sets, dispatch
-    // Stage 1: Integration compute shader
-    // Stage 2: Broadphase compute shader (spatial hash / grid)
-    // Stage 3: Narrowphase compute shader (contact generation)
-    // Stage 4: Constraint solver compute shader
+    // Stage 1: integration
+    // Stage 2: broadphase (uniform grid)
+    // Stage 3: narrowphase (contact generation)
+    // Stage 4: contact response
+    GpuDispatchParams params;
+    params.gravity = gravity_;
+    params.dt = fixed_dt_;
+    params.damping = step_damping;
+    params.report_contacts = !callbacks_.empty();
+    backend_->dispatch(params);
 }
 
 void GpuPhysicsComponent::readback_from_gpu() {
-    // TODO: Read back resolved positions/velocities from GPU
-    // vkMapMemory -> memcpy -> vkUnmapMemory
-    // Then fire collision callbacks based on contact buffer
+    backend_->readback(body_data_, contacts_);
+    for (const GpuContact& c : contacts_) {
+        fire_callbacks(c.body_a, c.body_b, c.contact);
+    }
 }
@@ -1,10 +1,12 @@
 #pragma once
 #include "rigid_body.hpp"
 #include "collision_shape3d.hpp"
+#include "gpu_compute.hpp"
 #include "../math/vec3.hpp"
 #include <vector>
 #include <cstdint>
 #include <functional>
+#include <memory>
 
 // GPU-based physics component (Compute Shader backend)
 // Runs rigid body simulation on GPU using compute shaders
@@ -15,28 +17,9 @@
 //   2. Dispatch compute shaders for integration + broadphase + narrowphase
 //   3. Readback resolved positions/velocities
 //
-// Falls back to CPU if compute is unavailable
-
-// GPU buffer handles (opaque IDs managed by the backend)
-struct GpuBufferHandle {
-    uint64_t id = 0;
-    bool valid() const { return id != 0; }
-};
-
-// Compact body representation for GPU transfer (SOA-friendly)
-struct alignas(16) GpuBodyData {
-    float pos_x, pos_y, pos_z, inv_mass;
-    float vel_x, vel_y, vel_z, restitution;
-    float force_x, force_y, force_z, padding;
-};
-
-// Compact shape representation for GPU
-struct alignas(16) GpuShapeData {
-    uint32_t type;         // 0=sphere, 1=box, 2=plane
-    float param0;          // sphere: radius, box: half_extent.x, plane: normal.x
-    float param1;          // box: half_extent.y, plane: normal.y
-    float param2;          // box: half_extent.z, plane: normal.z
-};
+// The kernels run on whichever GpuComputeBackend is installed; headless
+// builds can use GpuComputeEmulator (job system + SIMD). Falls back to the
+// serial CPU path if no backend is set.
 
 class GpuPhysicsComponent {
     // GPU resource handles
@@ -57,6 +40,10 @@ class GpuPhysicsComponent {
     bool compute_available_ = false;
     bool initialized_ = false;
 
+    // Compute backend and the contacts it reported for the last step
+    std::unique_ptr<GpuComputeBackend> backend_;
+    std::vector<GpuContact> contacts_;
+
     // Collision callback (invoked after readback)
     struct GpuCollisionCallback {
         uint64_t body_id;
@@ -74,6 +61,9 @@ class GpuPhysicsComponent {
     void dispatch_compute();
     void readback_from_gpu();
 
+    // Invoke callbacks registered for either body of the pair (i, j)
+    void fire_callbacks(size_t i, size_t j, const ContactPoint& contact);
+
 public:
     GpuPhysicsComponent() = default;
     ~GpuPhysicsComponent();
@@ -87,6 +77,9 @@ public:
     void set_gravity(Vec3f g) { gravity_ = g; }
     void set_fixed_timestep(float dt) { fixed_dt_ = dt; }
 
+    // Install the compute backend (nullptr selects the CPU fallback)
+    void set_compute_backend(std::unique_ptr<GpuComputeBackend> backend);
+
     // Body management
     uint64_t add_body(Vec3f position, float mass, CollisionShape3D shape);
     void remove_body(uint64_t id);
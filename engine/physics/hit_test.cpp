@@ -1,5 +1,7 @@
 #include "hit_test.hpp"
+#include "../math/simd.hpp"
 #include <cmath>
+#include <algorithm>
 
 // Ported from CppSampleGame's IsHitCircle
 static bool is_hit_circle(Vec2f a, Vec2f b, float r) {
@@ -62,3 +64,271 @@ bool check_hit(const Collider& a, const Collider& b) {
         return hit_test(sa, *a.transform, sb, *b.transform);
     }, a.shape, b.shape);
 }
+
+// ------------------------------------------------------------
+// Swept tests
+// ------------------------------------------------------------
+// Each sweep reduces to a segment (p + t * d, t in [0, 1]) against the
+// Minkowski sum of both shapes, centered on the stationary one.
+
+namespace {
+
+std::optional<float> segment_vs_box(Vec2f p, Vec2f d, Vec2f min, Vec2f max) {
+    float t_enter = 0.0f;
+    float t_exit = 1.0f;
+
+    const float p_axis[2] = {p.x, p.y};
+    const float d_axis[2] = {d.x, d.y};
+    const float lo[2] = {min.x, min.y};
+    const float hi[2] = {max.x, max.y};
+
+    for (int axis = 0; axis < 2; ++axis) {
+        if (std::abs(d_axis[axis]) < 1e-8f) {
+            if (p_axis[axis] < lo[axis] || p_axis[axis] > hi[axis]) return std::nullopt;
+            continue;
+        }
+        float inv = 1.0f / d_axis[axis];
+        float t1 = (lo[axis] - p_axis[axis]) * inv;
+        float t2 = (hi[axis] - p_axis[axis]) * inv;
+        if (t1 > t2) std::swap(t1, t2);
+        t_enter = std::max(t_enter, t1);
+        t_exit = std::min(t_exit, t2);
+        if (t_enter > t_exit) return std::nullopt;
+    }
+    return t_enter;
+}
+
+std::optional<float> segment_vs_circle(Vec2f p, Vec2f d, Vec2f center, float r) {
+    Vec2f m = p - center;
+    float c = m.length_sq() - r * r;
+    if (c <= 0.0f) return 0.0f;  // starts inside
+
+    float a = d.length_sq();
+    if (a < 1e-12f) return std::nullopt;
+    float b = m.x * d.x + m.y * d.y;
+    if (b >= 0.0f) return std::nullopt;  // moving away
+
+    float disc = b * b - a * c;
+    if (disc < 0.0f) return std::nullopt;
+    float t = (-b - std::sqrt(disc)) / a;
+    if (t > 1.0f) return std::nullopt;
+    return t;
+}
+
+// Segment against a box with corners rounded by r (box swept by a circle):
+// the union of two cross-shaped slabs and four corner circles
+std::optional<float> segment_vs_rounded_box(Vec2f p, Vec2f d,
+                                            Vec2f center, Vec2f half, float r) {
+    std::optional<float> best;
+    auto take = [&](std::optional<float> t) {
+        if (t && (!best || *t < *best)) best = t;
+    };
+
+    take(segment_vs_box(p, d, {center.x - half.x - r, center.y - half.y},
+                              {center.x + half.x + r, center.y + half.y}));
+    take(segment_vs_box(p, d, {center.x - half.x, center.y - half.y - r},
+                              {center.x + half.x, center.y + half.y + r}));
+    take(segment_vs_circle(p, d, {center.x - half.x, center.y - half.y}, r));
+    take(segment_vs_circle(p, d, {center.x + half.x, center.y - half.y}, r));
+    take(segment_vs_circle(p, d, {center.x - half.x, center.y + half.y}, r));
+    take(segment_vs_circle(p, d, {center.x + half.x, center.y + half.y}, r));
+    return best;
+}
+
+} // anonymous namespace
+
+std::optional<float> sweep_test(const CircleData& a, Vec2f from, Vec2f to,
+                                const CircleData& b, const Transform2D& tb) {
+    return segment_vs_circle(from, to - from, tb.position, a.radius + b.radius);
+}
+
+std::optional<float> sweep_test(const CircleData& a, Vec2f from, Vec2f to,
+                                const AABBData& b, const Transform2D& tb) {
+    return segment_vs_rounded_box(from, to - from, tb.position, b.half_extent, a.radius);
+}
+
+std::optional<float> sweep_test(const AABBData& a, Vec2f from, Vec2f to,
+                                const AABBData& b, const Transform2D& tb) {
+    Vec2f half = a.half_extent + b.half_extent;
+    return segment_vs_box(from, to - from, tb.position - half, tb.position + half);
+}
+
+std::optional<float> sweep_test(const AABBData& a, Vec2f from, Vec2f to,
+                                const CircleData& b, const Transform2D& tb) {
+    // Relative motion: the circle sweeps backwards past a box held at `from`
+    return segment_vs_rounded_box(tb.position, from - to, from, a.half_extent, b.radius);
+}
+
+std::optional<float> check_sweep(const Collider& a, Vec2f from, const Collider& b) {
+    Vec2f to = a.transform->position;
+    return std::visit([&](const auto& sa, const auto& sb) {
+        return sweep_test(sa, from, to, sb, *b.transform);
+    }, a.shape, b.shape);
+}
+
+// ------------------------------------------------------------
+// Batched kernels
+// ------------------------------------------------------------
+// Scalar and SIMD paths evaluate the same expressions in the same order,
+// so a target hits in hit_test8() exactly when it hits in hit_test_at().
+
+namespace {
+
+// Closest-point circle vs box test on raw values. A center strictly inside
+// the box hits at any radius, zero included, as it does in hit_test().
+inline bool circle_vs_box(float cx, float cy, float r,
+                          float bx, float by, float hx, float hy) {
+    float ex = std::max((bx - hx) - cx, cx - (bx + hx));
+    float ey = std::max((by - hy) - cy, cy - (by + hy));
+    float dx = std::max(ex, 0.0f);
+    float dy = std::max(ey, 0.0f);
+    return (ex < 0.0f && ey < 0.0f) || dx * dx + dy * dy < r * r;
+}
+
+#if ERGO_SIMD_AVX2 || ERGO_SIMD_SSE
+
+using namespace simd;
+
+// Runs `kernel(offset)` over 8 targets in lane-sized steps, packing masks
+template<typename Kernel>
+inline uint32_t run8(Kernel&& kernel) {
+    uint32_t mask = 0;
+    for (size_t k = 0; k < 8; k += lanes) {
+        mask |= movemask(kernel(k)) << k;
+    }
+    return mask;
+}
+
+inline vfloat circle_vs_box_v(vfloat cx, vfloat cy, vfloat r,
+                              vfloat bx, vfloat by, vfloat hx, vfloat hy) {
+    vfloat zero = splat(0.0f);
+    vfloat ex = vmax(sub(sub(bx, hx), cx), sub(cx, add(bx, hx)));
+    vfloat ey = vmax(sub(sub(by, hy), cy), sub(cy, add(by, hy)));
+    vfloat dx = vmax(ex, zero);
+    vfloat dy = vmax(ey, zero);
+    vfloat inside = vand(cmp_lt(ex, zero), cmp_lt(ey, zero));
+    return vor(inside, cmp_lt(add(mul(dx, dx), mul(dy, dy)), mul(r, r)));
+}
+
+#endif
+
+} // anonymous namespace
+
+bool hit_test_at(const AABBData& a, const Transform2D& ta,
+                 const AABBBatch& t, size_t i) {
+    float xa1 = ta.position.x - a.half_extent.x;
+    float xa2 = ta.position.x + a.half_extent.x;
+    float ya1 = ta.position.y - a.half_extent.y;
+    float ya2 = ta.position.y + a.half_extent.y;
+    return xa1 <= t.x[i] + t.hx[i] && xa2 >= t.x[i] - t.hx[i] &&
+           ya1 <= t.y[i] + t.hy[i] && ya2 >= t.y[i] - t.hy[i];
+}
+
+bool hit_test_at(const AABBData& a, const Transform2D& ta,
+                 const CircleBatch& t, size_t i) {
+    return circle_vs_box(t.x[i], t.y[i], t.r[i],
+                         ta.position.x, ta.position.y,
+                         a.half_extent.x, a.half_extent.y);
+}
+
+bool hit_test_at(const CircleData& a, const Transform2D& ta,
+                 const AABBBatch& t, size_t i) {
+    return circle_vs_box(ta.position.x, ta.position.y, a.radius,
+                         t.x[i], t.y[i], t.hx[i], t.hy[i]);
+}
+
+bool hit_test_at(const CircleData& a, const Transform2D& ta,
+                 const CircleBatch& t, size_t i) {
+    float dx = ta.position.x - t.x[i];
+    float dy = ta.position.y - t.y[i];
+    float r = a.radius + t.r[i];
+    return dx * dx + dy * dy < r * r;
+}
+
+#if ERGO_SIMD_AVX2 || ERGO_SIMD_SSE
+
+uint32_t hit_test8(const AABBData& a, const Transform2D& ta,
+                   const AABBBatch& t, size_t base) {
+    vfloat xa1 = splat(ta.position.x - a.half_extent.x);
+    vfloat xa2 = splat(ta.position.x + a.half_extent.x);
+    vfloat ya1 = splat(ta.position.y - a.half_extent.y);
+    vfloat ya2 = splat(ta.position.y + a.half_extent.y);
+    return run8([&](size_t k) {
+        size_t i = base + k;
+        vfloat bx = load(&t.x[i]), hx = load(&t.hx[i]);
+        vfloat by = load(&t.y[i]), hy = load(&t.hy[i]);
+        vfloat ox = vand(cmp_le(xa1, add(bx, hx)), cmp_le(sub(bx, hx), xa2));
+        vfloat oy = vand(cmp_le(ya1, add(by, hy)), cmp_le(sub(by, hy), ya2));
+        return vand(ox, oy);
+    });
+}
+
+uint32_t hit_test8(const AABBData& a, const Transform2D& ta,
+                   const CircleBatch& t, size_t base) {
+    vfloat bx = splat(ta.position.x), hx = splat(a.half_extent.x);
+    vfloat by = splat(ta.position.y), hy = splat(a.half_extent.y);
+    return run8([&](size_t k) {
+        size_t i = base + k;
+        return circle_vs_box_v(load(&t.x[i]), load(&t.y[i]), load(&t.r[i]),
+                               bx, by, hx, hy);
+    });
+}
+
+uint32_t hit_test8(const CircleData& a, const Transform2D& ta,
+                   const AABBBatch& t, size_t base) {
+    vfloat cx = splat(ta.position.x), cy = splat(ta.position.y);
+    vfloat r = splat(a.radius);
+    return run8([&](size_t k) {
+        size_t i = base + k;
+        return circle_vs_box_v(cx, cy, r, load(&t.x[i]), load(&t.y[i]),
+                               load(&t.hx[i]), load(&t.hy[i]));
+    });
+}
+
+uint32_t hit_test8(const CircleData& a, const Transform2D& ta,
+                   const CircleBatch& t, size_t base) {
+    vfloat ax = splat(ta.position.x), ay = splat(ta.position.y);
+    vfloat ar = splat(a.radius);
+    return run8([&](size_t k) {
+        size_t i = base + k;
+        vfloat dx = sub(ax, load(&t.x[i]));
+        vfloat dy = sub(ay, load(&t.y[i]));
+        vfloat r = add(ar, load(&t.r[i]));
+        return cmp_lt(add(mul(dx, dx), mul(dy, dy)), mul(r, r));
+    });
+}
+
+#else
+
+// Scalar fallback for targets without SSE/AVX2
+template<typename Shape, typename Batch>
+static uint32_t hit_test8_scalar(const Shape& a, const Transform2D& ta,
+                                 const Batch& t, size_t base) {
+    uint32_t mask = 0;
+    for (size_t k = 0; k < 8; ++k) {
+        if (hit_test_at(a, ta, t, base + k)) mask |= 1u << k;
+    }
+    return mask;
+}
+
+uint32_t hit_test8(const AABBData& a, const Transform2D& ta,
+                   const AABBBatch& t, size_t base) {
+    return hit_test8_scalar(a, ta, t, base);
+}
+
+uint32_t hit_test8(const AABBData& a, const Transform2D& ta,
+                   const CircleBatch& t, size_t base) {
+    return hit_test8_scalar(a, ta, t, base);
+}
+
+uint32_t hit_test8(const CircleData& a, const Transform2D& ta,
+                   const AABBBatch& t, size_t base) {
+    return hit_test8_scalar(a, ta, t, base);
+}
+
+uint32_t hit_test8(const CircleData& a, const Transform2D& ta,
+                   const CircleBatch& t, size_t base) {
+    return hit_test8_scalar(a, ta, t, base);
+}
+
+#endif
@@ -1,5 +1,8 @@
 #pragma once
 #include "collider.hpp"
+#include "collider_batch.hpp"
+#include <bit>
+#include <optional>
 
 // AABB vs AABB
 bool hit_test(const AABBData& a, const Transform2D& ta,
@@ -19,3 +22,77 @@ bool hit_test(const AABBData& aabb, const Transform2D& ta,
 
 // Generic check using variant visitor
 bool check_hit(const Collider& a, const Collider& b);
+
+// ------------------------------------------------------------
+// Swept tests: `a` moves from `from` to `to` during the step while `b`
+// stays at tb. Returns the normalized time of first contact in [0, 1]
+// (0 if already overlapping at `from`), or nullopt if they never touch.
+// ------------------------------------------------------------
+
+std::optional<float> sweep_test(const CircleData& a, Vec2f from, Vec2f to,
+                                const CircleData& b, const Transform2D& tb);
+
+std::optional<float> sweep_test(const CircleData& a, Vec2f from, Vec2f to,
+                                const AABBData& b, const Transform2D& tb);
+
+std::optional<float> sweep_test(const AABBData& a, Vec2f from, Vec2f to,
+                                const AABBData& b, const Transform2D& tb);
+
+std::optional<float> sweep_test(const AABBData& a, Vec2f from, Vec2f to,
+                                const CircleData& b, const Transform2D& tb);
+
+// Generic sweep of `a` from `from` to its current position against `b`
+std::optional<float> check_sweep(const Collider& a, Vec2f from, const Collider& b);
+
+// ------------------------------------------------------------
+// Batched tests against packed SoA targets (see collider_batch.hpp)
+// ------------------------------------------------------------
+
+// One shape against 8 targets [base, base + 8); returns a bitmask with
+// bit i set when target base + i overlaps. Requires base + 8 <= size().
+// Uses AVX2 (one 8-lane op) or SSE (two 4-lane ops) when available.
+uint32_t hit_test8(const AABBData& a, const Transform2D& ta,
+                   const AABBBatch& targets, size_t base);
+uint32_t hit_test8(const AABBData& a, const Transform2D& ta,
+                   const CircleBatch& targets, size_t base);
+uint32_t hit_test8(const CircleData& a, const Transform2D& ta,
+                   const AABBBatch& targets, size_t base);
+uint32_t hit_test8(const CircleData& a, const Transform2D& ta,
+                   const CircleBatch& targets, size_t base);
+
+// One shape against a single packed target (scalar tail of a batch)
+bool hit_test_at(const AABBData& a, const Transform2D& ta,
+                 const AABBBatch& targets, size_t i);
+bool hit_test_at(const AABBData& a, const Transform2D& ta,
+                 const CircleBatch& targets, size_t i);
+bool hit_test_at(const CircleData& a, const Transform2D& ta,
+                 const AABBBatch& targets, size_t i);
+bool hit_test_at(const CircleData& a, const Transform2D& ta,
+                 const CircleBatch& targets, size_t i);
+
+// Test a collider against every packed target, calling fn(Collider&) per hit.
+// AABB targets are visited before circle targets.
+// Circle vs AABB uses the closest-point form plus an inside test for the
+// center, which agrees with hit_test() at every radius including zero;
+// the two can differ only by rounding within an ulp of the boundary.
+template<typename Fn>
+void check_hit_batch(const Collider& c, const ColliderBatch2D& targets, Fn&& fn) {
+    std::visit([&](const auto& shape) {
+        auto run = [&](const auto& batch) {
+            size_t n = batch.size();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                uint32_t mask = hit_test8(shape, *c.transform, batch, i);
+                while (mask) {
+                    fn(*batch.colliders[i + static_cast<size_t>(std::countr_zero(mask))]);
+                    mask &= mask - 1;
+                }
+            }
+            for (; i < n; ++i) {
+                if (hit_test_at(shape, *c.transform, batch, i)) fn(*batch.colliders[i]);
+            }
+        };
+        run(targets.aabbs);
+        run(targets.circles);
+    }, c.shape);
+}
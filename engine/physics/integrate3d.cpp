@@ -0,0 +1,168 @@
+#include "integrate3d.hpp"
+#include "../math/simd.hpp"
+#include <cmath>
+
+// The scalar and SIMD kernels below perform the same operations in the same
+// order; keep them in step when editing either.
+
+void integrate_velocities3d_scalar(BodyArrays3D& w, uint32_t begin, uint32_t end,
+                                   Vec3f gravity, float dt) {
+    for (uint32_t i = begin; i < end; ++i) {
+        if (w.is_resting(i)) continue;
+        float im = w.inv_mass[i];
+
+        // Gravity plus accumulated force; immovable dynamic bodies keep v
+        if (im > 0.0f) {
+            float gs = w.gravity_scale[i];
+            w.velocity.x[i] = w.velocity.x[i] + (gravity.x * gs + w.force.x[i] * im) * dt;
+            w.velocity.y[i] = w.velocity.y[i] + (gravity.y * gs + w.force.y[i] * im) * dt;
+            w.velocity.z[i] = w.velocity.z[i] + (gravity.z * gs + w.force.z[i] * im) * dt;
+        }
+        float ld = 1.0f - w.linear_damping[i];
+        w.velocity.x[i] = w.velocity.x[i] * ld;
+        w.velocity.y[i] = w.velocity.y[i] * ld;
+        w.velocity.z[i] = w.velocity.z[i] * ld;
+
+        float ad = 1.0f - w.angular_damping[i];
+        w.angular_velocity.x[i] = (w.angular_velocity.x[i] + w.torque.x[i] * im * dt) * ad;
+        w.angular_velocity.y[i] = (w.angular_velocity.y[i] + w.torque.y[i] * im * dt) * ad;
+        w.angular_velocity.z[i] = (w.angular_velocity.z[i] + w.torque.z[i] * im * dt) * ad;
+
+        w.force.set(i, Vec3f::zero());
+        w.torque.set(i, Vec3f::zero());
+    }
+}
+
+void integrate_positions3d_scalar(BodyArrays3D& w, uint32_t begin, uint32_t end, float dt) {
+    float half_dt = 0.5f * dt;
+    for (uint32_t i = begin; i < end; ++i) {
+        if (w.is_resting(i)) continue;
+
+        w.position.x[i] = w.position.x[i] + w.velocity.x[i] * dt;
+        w.position.y[i] = w.position.y[i] + w.velocity.y[i] * dt;
+        w.position.z[i] = w.position.z[i] + w.velocity.z[i] * dt;
+
+        float ox = w.angular_velocity.x[i] * half_dt;
+        float oy = w.angular_velocity.y[i] * half_dt;
+        float oz = w.angular_velocity.z[i] * half_dt;
+        float qx = w.rotation.x[i], qy = w.rotation.y[i];
+        float qz = w.rotation.z[i], qw = w.rotation.w[i];
+
+        float nx = qx + ((ox * qw + oy * qz) - oz * qy);
+        float ny = qy + ((oy * qw + oz * qx) - ox * qz);
+        float nz = qz + ((oz * qw + ox * qy) - oy * qx);
+        float nw = qw - ((ox * qx + oy * qy) + oz * qz);
+
+        float len = std::sqrt((nx * nx + ny * ny) + (nz * nz + nw * nw));
+        w.rotation.x[i] = nx / len;
+        w.rotation.y[i] = ny / len;
+        w.rotation.z[i] = nz / len;
+        w.rotation.w[i] = nw / len;
+    }
+}
+
+#if ERGO_SIMD_AVX2 || ERGO_SIMD_SSE
+
+using namespace simd;
+
+void integrate_velocities3d(BodyArrays3D& w, uint32_t begin, uint32_t end,
+                            Vec3f gravity, float dt, IntegrationMode) {
+    vfloat gx = splat(gravity.x), gy = splat(gravity.y), gz = splat(gravity.z);
+    vfloat vdt = splat(dt), one = splat(1.0f), zero = splat(0.0f);
+
+    uint32_t i = begin;
+    for (; i + lanes <= end; i += lanes) {
+        vfloat awake = zero_byte_mask(&w.flags[i]);
+        if (movemask(awake) == 0) continue;
+
+        vfloat im = load(&w.inv_mass[i]);
+        vfloat gs = load(&w.gravity_scale[i]);
+        vfloat movable = vand(awake, cmp_lt(zero, im));
+        vfloat ld = sub(one, load(&w.linear_damping[i]));
+        vfloat ad = sub(one, load(&w.angular_damping[i]));
+
+        auto linear = [&](float* v, float* f, vfloat g) {
+            vfloat old = load(v);
+            vfloat nv = add(old, mul(add(mul(g, gs), mul(load(f), im)), vdt));
+            nv = mul(select(movable, nv, old), ld);
+            store(v, select(awake, nv, old));
+            store(f, select(awake, zero, load(f)));
+        };
+        linear(&w.velocity.x[i], &w.force.x[i], gx);
+        linear(&w.velocity.y[i], &w.force.y[i], gy);
+        linear(&w.velocity.z[i], &w.force.z[i], gz);
+
+        auto angular = [&](float* av, float* t) {
+            vfloat old = load(av);
+            vfloat nv = mul(add(old, mul(mul(load(t), im), vdt)), ad);
+            store(av, select(awake, nv, old));
+            store(t, select(awake, zero, load(t)));
+        };
+        angular(&w.angular_velocity.x[i], &w.torque.x[i]);
+        angular(&w.angular_velocity.y[i], &w.torque.y[i]);
+        angular(&w.angular_velocity.z[i], &w.torque.z[i]);
+    }
+    integrate_velocities3d_scalar(w, i, end, gravity, dt);
+}
+
+void integrate_positions3d(BodyArrays3D& w, uint32_t begin, uint32_t end,
+                           float dt, IntegrationMode mode) {
+    vfloat vdt = splat(dt), half_dt = splat(0.5f * dt);
+    vfloat half = splat(0.5f), three = splat(3.0f);
+
+    uint32_t i = begin;
+    for (; i + lanes <= end; i += lanes) {
+        vfloat awake = zero_byte_mask(&w.flags[i]);
+        if (movemask(awake) == 0) continue;
+
+        auto advance = [&](float* p, const float* v) {
+            vfloat old = load(p);
+            store(p, select(awake, add(old, mul(load(v), vdt)), old));
+        };
+        advance(&w.position.x[i], &w.velocity.x[i]);
+        advance(&w.position.y[i], &w.velocity.y[i]);
+        advance(&w.position.z[i], &w.velocity.z[i]);
+
+        vfloat ox = mul(load(&w.angular_velocity.x[i]), half_dt);
+        vfloat oy = mul(load(&w.angular_velocity.y[i]), half_dt);
+        vfloat oz = mul(load(&w.angular_velocity.z[i]), half_dt);
+        vfloat qx = load(&w.rotation.x[i]), qy = load(&w.rotation.y[i]);
+        vfloat qz = load(&w.rotation.z[i]), qw = load(&w.rotation.w[i]);
+
+        vfloat nx = add(qx, sub(add(mul(ox, qw), mul(oy, qz)), mul(oz, qy)));
+        vfloat ny = add(qy, sub(add(mul(oy, qw), mul(oz, qx)), mul(ox, qz)));
+        vfloat nz = add(qz, sub(add(mul(oz, qw), mul(ox, qy)), mul(oy, qx)));
+        vfloat nw = sub(qw, add(add(mul(ox, qx), mul(oy, qy)), mul(oz, qz)));
+
+        vfloat len_sq = add(add(mul(nx, nx), mul(ny, ny)), add(mul(nz, nz), mul(nw, nw)));
+        if (mode == IntegrationMode::Fast) {
+            // r' = r * (3 - x r^2) / 2
+            vfloat r = rsqrt(len_sq);
+            r = mul(mul(half, r), sub(three, mul(len_sq, mul(r, r))));
+            nx = mul(nx, r); ny = mul(ny, r); nz = mul(nz, r); nw = mul(nw, r);
+        } else {
+            vfloat len = simd::sqrt(len_sq);
+            nx = div(nx, len); ny = div(ny, len); nz = div(nz, len); nw = div(nw, len);
+        }
+        store(&w.rotation.x[i], select(awake, nx, qx));
+        store(&w.rotation.y[i], select(awake, ny, qy));
+        store(&w.rotation.z[i], select(awake, nz, qz));
+        store(&w.rotation.w[i], select(awake, nw, qw));
+    }
+    integrate_positions3d_scalar(w, i, end, dt);
+}
+
+#else
+
+// Scalar fallback for targets without SSE/AVX2
+void integrate_velocities3d(BodyArrays3D& w, uint32_t begin, uint32_t end,
+                            Vec3f gravity, float dt, IntegrationMode) {
+    integrate_velocities3d_scalar(w, begin, end, gravity, dt);
+}
+
+void integrate_positions3d(BodyArrays3D& w, uint32_t begin, uint32_t end,
+                           float dt, IntegrationMode) {
+    integrate_positions3d_scalar(w, begin, end, dt);
+}
+
+#endif
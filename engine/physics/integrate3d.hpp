@@ -0,0 +1,31 @@
+#pragma once
+#include "body_arrays3d.hpp"
+#include <cstdint>
+
+// Batched semi-implicit Euler integration over BodyArrays3D.
+//
+// The SIMD kernels run 4 (SSE) or 8 (AVX2) bodies per instruction over the
+// split x/y/z columns; static and sleeping lanes are masked out. Ranges are
+// independent, so callers may split [begin, end) across threads.
+//
+// Rotation uses the first-order quaternion update q += dt/2 * (w, 0) * q
+// followed by a normalize, which needs no trig per body.
+enum class IntegrationMode : uint8_t {
+    // Only exactly rounded operations (no FMA, sqrt + divide): the SIMD
+    // and scalar paths produce identical bits on every target
+    Reproducible,
+    // Normalize with a reciprocal square root estimate plus one Newton
+    // step; faster, but last-bit results depend on the instruction set
+    Fast,
+};
+
+void integrate_velocities3d(BodyArrays3D& bodies, uint32_t begin, uint32_t end,
+                            Vec3f gravity, float dt, IntegrationMode mode);
+void integrate_positions3d(BodyArrays3D& bodies, uint32_t begin, uint32_t end,
+                           float dt, IntegrationMode mode);
+
+// Scalar reference kernels (also used for the tail of each range)
+void integrate_velocities3d_scalar(BodyArrays3D& bodies, uint32_t begin, uint32_t end,
+                                   Vec3f gravity, float dt);
+void integrate_positions3d_scalar(BodyArrays3D& bodies, uint32_t begin, uint32_t end,
+                                  float dt);
@@ -1,7 +1,23 @@
 #include "physics_system.hpp"
 #include "hit_test.hpp"
+#include "../core/job_system.hpp"
 #include <algorithm>
 
+// Bounds the broadphase uses for a collider: its current box, or for ccd
+// colliders the box enclosing the whole sweep from prev_position
+static Aabb2D broadphase_bounds(const Collider& c) {
+    Vec2f to = c.transform->position;
+    Vec2f from = c.ccd ? c.prev_position : to;
+    Vec2f extent;
+    if (auto* aabb = std::get_if<AABBData>(&c.shape)) {
+        extent = aabb->half_extent;
+    } else if (auto* circle = std::get_if<CircleData>(&c.shape)) {
+        extent = {circle->radius, circle->radius};
+    }
+    return {{std::min(from.x, to.x) - extent.x, std::min(from.y, to.y) - extent.y},
+            {std::max(from.x, to.x) + extent.x, std::max(from.y, to.y) + extent.y}};
+}
+
 PhysicsSystem::PhysicsSystem() {
     for (auto& v : colliders_) {
         v.reserve(64);
@@ -12,9 +28,13 @@ PhysicsSystem::PhysicsSystem() {
 ColliderHandle PhysicsSystem::register_collider(Collider& c) {
     uint64_t id = next_id_++;
     c.handle = {id};
+    if (c.transform) c.prev_position = c.transform->position;
     auto tag_idx = static_cast<size_t>(c.tag);
     if (tag_idx < colliders_.size()) {
         colliders_[tag_idx].push_back(&c);
+        if (broadphase_ == Broadphase2D::AabbTree && c.transform) {
+            c.proxy_id = trees_[tag_idx].create_proxy(broadphase_bounds(c), &c);
+        }
     }
     return c.handle;
 }
@@ -27,39 +47,250 @@ void PhysicsSystem::mark_moved(Collider& c) {
     calc_stack_.push_back(&c);
 }
 
-void PhysicsSystem::hit_to_all(Collider* c, ColliderTag target_tag) {
+void PhysicsSystem::set_broadphase(Broadphase2D type) {
+    if (type == broadphase_) return;
+    broadphase_ = type;
+    rebuild_trees();
+}
+
+void PhysicsSystem::rebuild_trees() {
+    for (size_t t = 0; t < colliders_.size(); ++t) {
+        trees_[t].clear();
+        for (auto* c : colliders_[t]) {
+            c->proxy_id = -1;
+            if (broadphase_ != Broadphase2D::AabbTree) continue;
+            if (c->handle.id == 0 || !c->transform) continue;
+            c->proxy_id = trees_[t].create_proxy(broadphase_bounds(*c), c);
+        }
+    }
+}
+
+void PhysicsSystem::refit_trees() {
+    // Targets move without being marked, and a collider registered before
+    // it had a transform gets its proxy once it has one
+    for (size_t t = 0; t < colliders_.size(); ++t) {
+        auto& tree = trees_[t];
+        for (auto* c : colliders_[t]) {
+            if (c->handle.id == 0 || !c->transform) continue;
+            if (c->proxy_id < 0) c->proxy_id = tree.create_proxy(broadphase_bounds(*c), c);
+            else                 tree.move_proxy(c->proxy_id, broadphase_bounds(*c));
+        }
+    }
+}
+
+void PhysicsSystem::pack_colliders() {
+    for (size_t t = 0; t < colliders_.size(); ++t) {
+        auto& batch = packed_[t];
+        batch.clear();
+        for (auto* c : colliders_[t]) {
+            if (c->handle.id == 0) continue;
+            batch.add(c);
+        }
+    }
+}
+
+void PhysicsSystem::collect_hits(Collider* c, ColliderTag target_tag,
+                                 std::vector<HitPair>& out) const {
     auto tag_idx = static_cast<size_t>(target_tag);
-    if (tag_idx >= colliders_.size()) return;
+    if (tag_idx >= packed_.size()) return;
 
-    for (auto* target : colliders_[tag_idx]) {
-        if (c == target) continue;
-        if (c->handle.id == 0 || target->handle.id == 0) continue;
+    check_hit_batch(*c, packed_[tag_idx], [&](Collider& target) {
+        if (c == &target) return;
+        out.push_back({c, &target, 1.0f});
+    });
+}
 
-        if (check_hit(*c, *target)) {
-            bool consumed = false;
-            if (c->on_hit) {
-                consumed = c->on_hit(*target);
-            }
-            if (!consumed && target->on_hit) {
-                target->on_hit(*c);
+void PhysicsSystem::collect_swept_hits(Collider* c, ColliderTag target_tag,
+                                       std::vector<HitPair>& out) const {
+    auto tag_idx = static_cast<size_t>(target_tag);
+    if (tag_idx >= packed_.size()) return;
+
+    // Targets are treated as stationary at their current positions.
+    // Prefilter with the AABB enclosing the whole sweep, then run the
+    // exact swept test on the survivors.
+    Vec2f from = c->prev_position;
+    Aabb2D sweep = broadphase_bounds(*c);
+
+    Transform2D bounds_transform;
+    bounds_transform.position = (sweep.min + sweep.max) * 0.5f;
+    Collider bounds;
+    bounds.shape = AABBData{(sweep.max - sweep.min) * 0.5f};
+    bounds.transform = &bounds_transform;
+
+    check_hit_batch(bounds, packed_[tag_idx], [&](Collider& target) {
+        if (c == &target) return;
+        if (auto toi = check_sweep(*c, from, target)) {
+            out.push_back({c, &target, *toi});
+        }
+    });
+}
+
+void PhysicsSystem::reset_hit_buffers(uint32_t chunk_count) {
+    if (hit_buffers_.size() < chunk_count) {
+        hit_buffers_.resize(chunk_count);
+    }
+    for (auto& buf : hit_buffers_) buf.clear();
+}
+
+void PhysicsSystem::collect_grid_candidates() {
+    // Rebuilt from scratch: the grid sees every target at its current position
+    grid_.clear();
+    for (size_t t = 0; t < colliders_.size(); ++t) {
+        if (static_cast<ColliderTag>(t) == ColliderTag::Invalid) continue;
+        for (auto* c : colliders_[t]) {
+            if (c->handle.id != 0) grid_.insert(c);
+        }
+    }
+    grid_.build();
+
+    for (auto* c : calc_stack_) {
+        if (c->handle.id == 0 || !c->transform) continue;
+        Aabb2D bounds = broadphase_bounds(*c);
+        grid_.query(bounds.min, bounds.max, query_buffer_);
+        for (auto* target : query_buffer_) {
+            if (target == c || target->tag == c->tag) continue;
+            candidates_.emplace_back(c, target);
+        }
+    }
+}
+
+void PhysicsSystem::collect_tree_candidates() {
+    // refit_trees() has already moved every proxy; flag the colliders to test
+    for (auto* c : calc_stack_) {
+        if (c->handle.id == 0 || c->proxy_id < 0) continue;
+        trees_[static_cast<size_t>(c->tag)].touch(c->proxy_id);
+    }
+
+    // Every pair of distinct tags once; a pair is reported from the side(s)
+    // that moved. Invalid colliders may move but are never targets.
+    constexpr auto tag_count = static_cast<size_t>(ColliderTag::Max);
+    constexpr auto invalid = static_cast<size_t>(ColliderTag::Invalid);
+    for (size_t a = 0; a < tag_count; ++a) {
+        for (size_t b = a + 1; b < tag_count; ++b) {
+            const auto& tree_a = trees_[a];
+            const auto& tree_b = trees_[b];
+            tree_a.find_pairs(tree_b, true, [&](void* ua, void* ub) {
+                auto* ca = static_cast<Collider*>(ua);
+                auto* cb = static_cast<Collider*>(ub);
+                if (b != invalid && tree_a.was_moved(ca->proxy_id)) {
+                    candidates_.emplace_back(ca, cb);
+                }
+                if (a != invalid && tree_b.was_moved(cb->proxy_id)) {
+                    candidates_.emplace_back(cb, ca);
+                }
+            });
+        }
+    }
+
+    for (auto& tree : trees_) tree.clear_moved();
+}
+
+void PhysicsSystem::test_candidates() {
+    auto count = static_cast<uint32_t>(candidates_.size());
+    reset_hit_buffers((count + pair_chunk_size_ - 1) / pair_chunk_size_);
+
+    g_job_system.parallel_for(0, count, pair_chunk_size_,
+        [this](uint32_t begin, uint32_t end) {
+            auto& out = hit_buffers_[begin / pair_chunk_size_];
+            for (uint32_t i = begin; i < end; ++i) {
+                auto [c, target] = candidates_[i];
+                if (c->ccd) {
+                    if (auto toi = check_sweep(*c, c->prev_position, *target)) {
+                        out.push_back({c, target, *toi});
+                    }
+                } else if (check_hit(*c, *target)) {
+                    out.push_back({c, target, 1.0f});
+                }
             }
+        });
+}
+
+void PhysicsSystem::narrowphase() {
+    hits_.clear();
+    candidates_.clear();
+    if (calc_stack_.empty()) {
+        reset_hit_buffers(0);
+        return;
+    }
+
+    switch (broadphase_) {
+    case Broadphase2D::BruteForce: {
+        auto count = static_cast<uint32_t>(calc_stack_.size());
+        reset_hit_buffers((count + narrowphase_chunk_size_ - 1) / narrowphase_chunk_size_);
+        pack_colliders();
+
+        // Batched hit tests only read the packed snapshot, so moved colliders
+        // can be tested in parallel. Each chunk owns its own output buffer.
+        g_job_system.parallel_for(0, count, narrowphase_chunk_size_,
+            [this](uint32_t begin, uint32_t end) {
+                auto& out = hit_buffers_[begin / narrowphase_chunk_size_];
+                for (uint32_t i = begin; i < end; ++i) {
+                    Collider* c = calc_stack_[i];
+                    if (c->handle.id == 0 || !c->transform) continue;
+
+                    // Check against all relevant tags
+                    // Player vs Enemy, Player vs Bullet, Enemy vs Bullet, etc.
+                    for (size_t t = 0; t < static_cast<size_t>(ColliderTag::Max); ++t) {
+                        auto target_tag = static_cast<ColliderTag>(t);
+                        if (target_tag == c->tag) continue;
+                        if (target_tag == ColliderTag::Invalid) continue;
+                        if (c->ccd) collect_swept_hits(c, target_tag, out);
+                        else        collect_hits(c, target_tag, out);
+                    }
+                }
+            });
+        break;
+    }
+    case Broadphase2D::Grid:
+        collect_grid_candidates();
+        test_candidates();
+        break;
+    case Broadphase2D::AabbTree:
+        collect_tree_candidates();
+        test_candidates();
+        break;
+    }
+
+    for (auto& buf : hit_buffers_) {
+        hits_.insert(hits_.end(), buf.begin(), buf.end());
+    }
+
+    // Handles are issued in registration order, so this ordering is
+    // independent of thread scheduling, of mark_moved() call order and of
+    // the broadphase in use
+    std::sort(hits_.begin(), hits_.end(), [](const HitPair& a, const HitPair& b) {
+        if (a.collider->handle.id != b.collider->handle.id)
+            return a.collider->handle.id < b.collider->handle.id;
+        return a.target->handle.id < b.target->handle.id;
+    });
+}
+
+void PhysicsSystem::dispatch_hits() {
+    for (auto& [c, target, toi] : hits_) {
+        current_toi_ = toi;
+        bool consumed = false;
+        if (c->on_hit) {
+            consumed = c->on_hit(*target);
+        }
+        if (!consumed && target->on_hit) {
+            target->on_hit(*c);
         }
     }
+    hits_.clear();
+    current_toi_ = 1.0f;
 }
 
 void PhysicsSystem::run() {
-    // Process collision detection for moved objects
+    if (broadphase_ == Broadphase2D::AabbTree) refit_trees();
+
+    // Process collision detection for moved objects, then fire callbacks
+    // serially once every pair has been tested
+    narrowphase();
+    dispatch_hits();
+
+    // The next sweep starts where this step ended
     for (auto* c : calc_stack_) {
-        if (c->handle.id == 0) continue;
-
-        // Check against all relevant tags
-        // Player vs Enemy, Player vs Bullet, Enemy vs Bullet, etc.
-        for (size_t i = 0; i < static_cast<size_t>(ColliderTag::Max); ++i) {
-            auto target_tag = static_cast<ColliderTag>(i);
-            if (target_tag == c->tag) continue;
-            if (target_tag == ColliderTag::Invalid) continue;
-            hit_to_all(c, target_tag);
-        }
+        if (c->ccd && c->transform) c->prev_position = c->transform->position;
     }
     calc_stack_.clear();
 
@@ -67,6 +298,10 @@ void PhysicsSystem::run() {
     for (auto& [collider, tag] : remove_list_) {
         auto tag_idx = static_cast<size_t>(tag);
         if (tag_idx < colliders_.size()) {
+            if (collider->proxy_id >= 0) {
+                trees_[tag_idx].destroy_proxy(collider->proxy_id);
+                collider->proxy_id = -1;
+            }
             auto& vec = colliders_[tag_idx];
             vec.erase(
                 std::remove(vec.begin(), vec.end(), collider),
@@ -3,16 +3,70 @@
 #include <vector>
 #include <utility>
 #include "collider.hpp"
+#include "collider_batch.hpp"
+#include "spatial_grid.hpp"
+#include "aabb_tree.hpp"
+
+// How run() finds candidate pairs before the exact hit tests
+enum class Broadphase2D : uint8_t {
+    BruteForce,  // every moved collider vs every packed target (default)
+    Grid,        // SpatialGrid2D rebuilt each run(); uniform-size scenes
+    AabbTree,    // per-tag dynamic AABB trees refit each run(); sparse
+                 // scenes or widely varying collider sizes
+};
 
 class PhysicsSystem {
+    // A detected overlap, dispatched to on_hit after narrowphase completes
+    struct HitPair {
+        Collider* collider;
+        Collider* target;
+        float toi;  // normalized time of impact within the step
+    };
+
     std::array<std::vector<Collider*>,
                static_cast<size_t>(ColliderTag::Max)> colliders_;
     std::vector<Collider*> calc_stack_;
     std::vector<std::pair<Collider*, ColliderTag>> remove_list_;
     uint64_t next_id_ = 1;
 
-    // Check one collider against all colliders of a target tag
-    void hit_to_all(Collider* c, ColliderTag target_tag);
+    // Per-tag SoA snapshot of live colliders, refreshed at the start of run()
+    std::array<ColliderBatch2D,
+               static_cast<size_t>(ColliderTag::Max)> packed_;
+
+    // Narrowphase output: one buffer per job chunk, merged and sorted by
+    // (collider handle, target handle) so callback order is deterministic
+    std::vector<std::vector<HitPair>> hit_buffers_;
+    std::vector<HitPair> hits_;
+    float current_toi_ = 1.0f;
+
+    // Moved colliders tested per narrowphase job
+    static constexpr uint32_t narrowphase_chunk_size_ = 32;
+    // Candidate pairs tested per narrowphase job (Grid / AabbTree)
+    static constexpr uint32_t pair_chunk_size_ = 256;
+
+    Broadphase2D broadphase_ = Broadphase2D::BruteForce;
+    SpatialGrid2D grid_;
+    std::array<AabbTree2D, static_cast<size_t>(ColliderTag::Max)> trees_;
+    // (moved collider, target) pairs awaiting the exact test
+    std::vector<std::pair<Collider*, Collider*>> candidates_;
+    std::vector<Collider*> query_buffer_;
+
+    void pack_colliders();
+    void reset_hit_buffers(uint32_t chunk_count);
+    void rebuild_trees();
+    void refit_trees();
+
+    void collect_grid_candidates();
+    void collect_tree_candidates();
+    void test_candidates();
+
+    // Check one collider against all colliders of a target tag (read-only)
+    void collect_hits(Collider* c, ColliderTag target_tag,
+                      std::vector<HitPair>& out) const;
+    void collect_swept_hits(Collider* c, ColliderTag target_tag,
+                            std::vector<HitPair>& out) const;
+    void narrowphase();
+    void dispatch_hits();
 
 public:
     PhysicsSystem();
@@ -21,6 +75,15 @@ public:
     void remove_collider(Collider& c);
     void mark_moved(Collider& c);  // CppSampleGame CalcStack equivalent
     void run();                     // Execute collision detection + remove processing
+
+    // Switching rebuilds the new structure from the registered colliders.
+    void set_broadphase(Broadphase2D type);
+    Broadphase2D broadphase() const { return broadphase_; }
+
+    // Time of impact in [0, 1] of the hit being dispatched; valid inside
+    // on_hit. Discrete hits report 1 (overlap at the end position), swept
+    // hits of ccd colliders report when contact first occurs.
+    float hit_toi() const { return current_toi_; }
 };
 
 // Global instance (Singleton<T> replacement)
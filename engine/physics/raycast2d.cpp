@@ -1,4 +1,5 @@
 #include "raycast2d.hpp"
+#include "../core/job_system.hpp"
 #include <algorithm>
 #include <cmath>
 
@@ -59,6 +60,102 @@ Vec2f compute_normal_aabb(Vec2f hit, Vec2f center, Vec2f half) {
     return {0.0f, d.y > 0 ? 1.0f : -1.0f};
 }
 
+// Test a single collider; `dir` must be normalized
+std::optional<RayHit2D> ray_vs_collider(Vec2f origin, Vec2f dir, float max_distance,
+                                        const Collider* c, ColliderTag mask) {
+    if (!c || !c->transform) return std::nullopt;
+    if (mask != ColliderTag::Invalid && c->tag != mask) return std::nullopt;
+
+    Vec2f center = c->transform->position;
+    std::optional<float> t;
+    Vec2f normal;
+
+    if (auto* aabb = std::get_if<AABBData>(&c->shape)) {
+        t = ray_vs_aabb(origin, dir, center, aabb->half_extent);
+        if (t && *t <= max_distance) {
+            Vec2f hit = {origin.x + dir.x * *t, origin.y + dir.y * *t};
+            normal = compute_normal_aabb(hit, center, aabb->half_extent);
+        }
+    } else if (auto* circle = std::get_if<CircleData>(&c->shape)) {
+        t = ray_vs_circle(origin, dir, center, circle->radius);
+        if (t && *t <= max_distance) {
+            Vec2f hit = {origin.x + dir.x * *t, origin.y + dir.y * *t};
+            Vec2f diff = {hit.x - center.x, hit.y - center.y};
+            normal = diff.normalized();
+        }
+    }
+
+    if (!t || *t < 0.0f || *t > max_distance) return std::nullopt;
+
+    RayHit2D hit;
+    hit.point = {origin.x + dir.x * *t, origin.y + dir.y * *t};
+    hit.normal = normal;
+    hit.distance = *t;
+    hit.collider = c;
+    return hit;
+}
+
+// Walk grid cells along the ray with a 2D DDA (Amanatides & Woo).
+// visit(collider) is called for every collider bucketed with each cell;
+// after each cell, done(cell_exit) may stop the walk. cell_exit is the ray
+// distance at which the ray leaves that cell.
+template<typename Visit, typename Done>
+void walk_grid(Vec2f origin, Vec2f dir, float max_distance,
+               const SpatialGrid2D& grid, Visit&& visit, Done&& done) {
+    if (!grid.is_built() || grid.size() == 0) return;
+
+    // Clip the ray to the occupied bounds so empty space is never walked
+    Vec2f bmin = grid.bounds_min();
+    Vec2f bmax = grid.bounds_max();
+    Vec2f center = (bmin + bmax) * 0.5f;
+    Vec2f half = (bmax - bmin) * 0.5f;
+    float t_start = 0.0f;
+    float t_end = max_distance;
+    bool inside = origin.x >= bmin.x && origin.x <= bmax.x &&
+                  origin.y >= bmin.y && origin.y <= bmax.y;
+    if (!inside) {
+        auto t = ray_vs_aabb(origin, dir, center, half);
+        if (!t || *t > max_distance) return;
+        t_start = *t;
+    }
+
+    float cell = grid.cell_size();
+    Vec2f start = {origin.x + dir.x * t_start, origin.y + dir.y * t_start};
+    auto c = grid.cell_of(start);
+
+    int32_t step_x = dir.x > 0.0f ? 1 : -1;
+    int32_t step_y = dir.y > 0.0f ? 1 : -1;
+    constexpr float inf = 1e30f;
+    float delta_x = std::abs(dir.x) > 1e-8f ? cell / std::abs(dir.x) : inf;
+    float delta_y = std::abs(dir.y) > 1e-8f ? cell / std::abs(dir.y) : inf;
+
+    // Ray distance to the first vertical / horizontal cell boundary
+    float next_x = static_cast<float>(c.x + (step_x > 0 ? 1 : 0)) * cell;
+    float next_y = static_cast<float>(c.y + (step_y > 0 ? 1 : 0)) * cell;
+    float t_max_x = std::abs(dir.x) > 1e-8f ? (next_x - origin.x) / dir.x : inf;
+    float t_max_y = std::abs(dir.y) > 1e-8f ? (next_y - origin.y) / dir.y : inf;
+
+    // Leaving the occupied bounds ends the walk
+    auto bmin_cell = grid.cell_of(bmin);
+    auto bmax_cell = grid.cell_of(bmax);
+
+    for (;;) {
+        float cell_exit = std::min(t_max_x, t_max_y);
+        grid.for_each_in_cell(c.x, c.y, visit);
+        if (done(cell_exit) || cell_exit > t_end) return;
+
+        if (t_max_x < t_max_y) {
+            c.x += step_x;
+            t_max_x += delta_x;
+        } else {
+            c.y += step_y;
+            t_max_y += delta_y;
+        }
+        if (c.x < bmin_cell.x || c.x > bmax_cell.x ||
+            c.y < bmin_cell.y || c.y > bmax_cell.y) return;
+    }
+}
+
 } // anonymous namespace
 
 std::optional<RayHit2D> raycast2d(
@@ -80,35 +177,8 @@ std::vector<RayHit2D> raycast2d_all(
     std::vector<RayHit2D> results;
 
     for (const Collider* c : colliders) {
-        if (!c || !c->transform) continue;
-        if (mask != ColliderTag::Invalid && c->tag != mask) continue;
-
-        Vec2f center = c->transform->position;
-        std::optional<float> t;
-        Vec2f normal;
-
-        if (auto* aabb = std::get_if<AABBData>(&c->shape)) {
-            t = ray_vs_aabb(origin, dir, center, aabb->half_extent);
-            if (t && *t <= max_distance) {
-                Vec2f hit = {origin.x + dir.x * *t, origin.y + dir.y * *t};
-                normal = compute_normal_aabb(hit, center, aabb->half_extent);
-            }
-        } else if (auto* circle = std::get_if<CircleData>(&c->shape)) {
-            t = ray_vs_circle(origin, dir, center, circle->radius);
-            if (t && *t <= max_distance) {
-                Vec2f hit = {origin.x + dir.x * *t, origin.y + dir.y * *t};
-                Vec2f diff = {hit.x - center.x, hit.y - center.y};
-                normal = diff.normalized();
-            }
-        }
-
-        if (t && *t >= 0.0f && *t <= max_distance) {
-            RayHit2D hit;
-            hit.point = {origin.x + dir.x * *t, origin.y + dir.y * *t};
-            hit.normal = normal;
-            hit.distance = *t;
-            hit.collider = c;
-            results.push_back(hit);
+        if (auto hit = ray_vs_collider(origin, dir, max_distance, c, mask)) {
+            results.push_back(*hit);
         }
     }
 
@@ -116,3 +186,69 @@ std::vector<RayHit2D> raycast2d_all(
               [](const RayHit2D& a, const RayHit2D& b) { return a.distance < b.distance; });
     return results;
 }
+
+std::optional<RayHit2D> raycast2d(
+    Vec2f origin, Vec2f direction, float max_distance,
+    const SpatialGrid2D& grid,
+    ColliderTag mask)
+{
+    Vec2f dir = direction.normalized();
+    if (dir.length_sq() == 0.0f) return std::nullopt;
+
+    std::optional<RayHit2D> best;
+    walk_grid(origin, dir, max_distance, grid,
+        [&](const Collider& c) {
+            auto hit = ray_vs_collider(origin, dir, max_distance, &c, mask);
+            if (hit && (!best || hit->distance < best->distance)) best = hit;
+        },
+        // A hit before the ray leaves this cell cannot be beaten by later cells
+        [&](float cell_exit) { return best && best->distance <= cell_exit; });
+    return best;
+}
+
+std::vector<RayHit2D> raycast2d_all(
+    Vec2f origin, Vec2f direction, float max_distance,
+    const SpatialGrid2D& grid,
+    ColliderTag mask)
+{
+    Vec2f dir = direction.normalized();
+    std::vector<RayHit2D> results;
+    if (dir.length_sq() == 0.0f) return results;
+
+    walk_grid(origin, dir, max_distance, grid,
+        [&](const Collider& c) {
+            if (auto hit = ray_vs_collider(origin, dir, max_distance, &c, mask)) {
+                results.push_back(*hit);
+            }
+        },
+        [](float) { return false; });
+
+    // Colliders spanning several cells are reported once per cell
+    std::sort(results.begin(), results.end(),
+              [](const RayHit2D& a, const RayHit2D& b) { return a.collider < b.collider; });
+    results.erase(std::unique(results.begin(), results.end(),
+                      [](const RayHit2D& a, const RayHit2D& b) { return a.collider == b.collider; }),
+                  results.end());
+
+    std::sort(results.begin(), results.end(),
+              [](const RayHit2D& a, const RayHit2D& b) { return a.distance < b.distance; });
+    return results;
+}
+
+void raycast2d_many(
+    const std::vector<RayQuery2D>& rays,
+    const SpatialGrid2D& grid,
+    std::vector<std::optional<RayHit2D>>& results,
+    ColliderTag mask)
+{
+    results.resize(rays.size());
+
+    // Grid traversal is read-only, so rays are independent
+    g_job_system.parallel_for(0, static_cast<uint32_t>(rays.size()), 64,
+        [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                const auto& r = rays[i];
+                results[i] = raycast2d(r.origin, r.direction, r.max_distance, grid, mask);
+            }
+        });
+}
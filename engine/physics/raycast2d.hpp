@@ -1,6 +1,7 @@
 #pragma once
 #include "../math/vec2.hpp"
 #include "collider.hpp"
+#include "spatial_grid.hpp"
 #include <optional>
 #include <vector>
 
@@ -22,3 +23,29 @@ std::vector<RayHit2D> raycast2d_all(
     Vec2f origin, Vec2f direction, float max_distance,
     const std::vector<Collider*>& colliders,
     ColliderTag mask = ColliderTag::Invalid);
+
+// Grid-accelerated variants: walk the grid cells along the ray (DDA) and
+// stop at the first cell that proves the closest hit. The grid must be built.
+std::optional<RayHit2D> raycast2d(
+    Vec2f origin, Vec2f direction, float max_distance,
+    const SpatialGrid2D& grid,
+    ColliderTag mask = ColliderTag::Invalid);
+
+std::vector<RayHit2D> raycast2d_all(
+    Vec2f origin, Vec2f direction, float max_distance,
+    const SpatialGrid2D& grid,
+    ColliderTag mask = ColliderTag::Invalid);
+
+struct RayQuery2D {
+    Vec2f origin;
+    Vec2f direction;
+    float max_distance = 0.0f;
+};
+
+// Batched first-hit raycasts (e.g. AI line of sight), split across the
+// global JobSystem. results[i] answers rays[i]; results is resized to match.
+void raycast2d_many(
+    const std::vector<RayQuery2D>& rays,
+    const SpatialGrid2D& grid,
+    std::vector<std::optional<RayHit2D>>& results,
+    ColliderTag mask = ColliderTag::Invalid);
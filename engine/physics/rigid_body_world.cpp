@@ -1,188 +1,466 @@
 #include "rigid_body_world.hpp"
 #include "collision3d.hpp"
+#include "integrate3d.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <type_traits>
 
 uint64_t RigidBodyWorld::add_body(PhysicsBody body) {
-    body.id = next_id_++;
-    body.body.transform = &body.transform;
-    body.body.set_mass(body.body.mass); // Ensure inv_mass is computed
-    bodies_.push_back(std::move(body));
-    // Fix transform pointer after move
-    bodies_.back().body.transform = &bodies_.back().transform;
-    return bodies_.back().id;
+    uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slots_.size());
+        slots_.emplace_back();
+        if (slot / block_size_ >= blocks_.size()) {
+            blocks_.push_back(std::make_unique<PhysicsBody[]>(block_size_));
+        }
+    }
+
+    PhysicsBody& pb = slot_body(slot);
+    pb = std::move(body);
+    pb.id = (static_cast<uint64_t>(slots_[slot].generation) << 32) | slot;
+    pb.body.transform = &pb.transform;
+    if (std::holds_alternative<TriangleMeshShape>(pb.shape)) pb.body.set_static();  // level geometry
+    pb.body.set_mass(pb.body.mass); // Ensure inv_mass is computed
+
+    slots_[slot].dense = static_cast<uint32_t>(dense_slots_.size());
+    dense_slots_.push_back(slot);
+    broadphase_.invalidate();
+    queries_valid_ = false;
+    id_order_valid_ = false;
+    return pb.id;
 }
 
 void RigidBodyWorld::remove_body(uint64_t id) {
-    bodies_.erase(
-        std::remove_if(bodies_.begin(), bodies_.end(),
-            [id](const PhysicsBody& b) { return b.id == id; }),
-        bodies_.end()
-    );
+    uint32_t slot = find_slot(id);
+    if (slot == UINT32_MAX) return;
+
+    // Swap-remove from the dense list; no other body moves in memory
+    uint32_t dense = slots_[slot].dense;
+    uint32_t last = dense_slots_.back();
+    dense_slots_[dense] = last;
+    slots_[last].dense = dense;
+    dense_slots_.pop_back();
+
+    slot_body(slot) = PhysicsBody{};  // drop the callback and its captures
+    if (++slots_[slot].generation == 0) slots_[slot].generation = 1;
+    free_slots_.push_back(slot);
+    broadphase_.invalidate();
+    queries_valid_ = false;
+    id_order_valid_ = false;
+}
+
+uint32_t RigidBodyWorld::find_slot(uint64_t id) const {
+    auto slot = static_cast<uint32_t>(id & 0xffffffffu);
+    auto generation = static_cast<uint32_t>(id >> 32);
+    if (slot >= slots_.size() || slots_[slot].generation != generation) return UINT32_MAX;
+    return slot;
 }
 
 PhysicsBody* RigidBodyWorld::get_body(uint64_t id) {
-    for (auto& b : bodies_) {
-        if (b.id == id) return &b;
-    }
-    return nullptr;
+    uint32_t slot = find_slot(id);
+    if (slot == UINT32_MAX) return nullptr;
+    queries_valid_ = false;  // the caller may move it
+    return &slot_body(slot);
 }
 
 const PhysicsBody* RigidBodyWorld::get_body(uint64_t id) const {
-    for (auto& b : bodies_) {
-        if (b.id == id) return &b;
-    }
-    return nullptr;
+    uint32_t slot = find_slot(id);
+    return slot == UINT32_MAX ? nullptr : &slot_body(slot);
 }
 
-void RigidBodyWorld::integrate(float dt) {
-    for (auto& pb : bodies_) {
-        auto& body = pb.body;
-        if (body.type == RigidBodyType::Static) continue;
-        if (body.is_sleeping) continue;
+const std::vector<uint32_t>& RigidBodyWorld::id_order() {
+    if (!id_order_valid_) {
+        id_order_ = dense_slots_;
+        std::sort(id_order_.begin(), id_order_.end(), [this](uint32_t a, uint32_t b) {
+            return slot_body(a).id < slot_body(b).id;
+        });
+        id_order_valid_ = true;
+    }
+    return id_order_;
+}
 
-        // Apply gravity
-        Vec3f gravity_force = gravity_ * body.mass * body.gravity_scale;
-        body.force_accumulator += gravity_force;
+void RigidBodyWorld::load_arrays() {
+    arrays_.clear();
+    arrays_.reserve(dense_slots_.size());
+    for (uint32_t slot : deterministic_ ? id_order() : dense_slots_) {
+        arrays_.push_back(slot_body(slot));
+    }
 
-        // Semi-implicit Euler integration (linear)
-        Vec3f accel = body.force_accumulator * body.inv_mass;
-        body.velocity += accel * dt;
+    // Sleeping bodies keep zero velocity, so a fast one had its velocity
+    // set directly: wake it, and detect_contacts() wakes its island
+    auto& w = arrays_;
+    for (uint32_t i = 0; i < w.size(); ++i) {
+        if (!w.is_sleeping(i) || w.is_static(i)) continue;
+        float speed = w.velocity[i].length_sq() + w.angular_velocity[i].length_sq();
+        if (speed >= sleep_velocity_threshold_ * sleep_velocity_threshold_) {
+            w.flags[i] &= ~BodyArrays3D::flag_sleeping;
+            w.sleep_timer[i] = 0.0f;
+        }
+    }
+}
 
-        // Linear damping
-        body.velocity *= (1.0f - body.linear_damping);
+void RigidBodyWorld::set_deterministic(bool enabled) {
+    deterministic_ = enabled;
+    if (enabled) integration_mode_ = IntegrationMode::Reproducible;
+    broadphase_.invalidate();
+    queries_valid_ = false;
+}
 
-        // Update position
-        pb.transform.position += body.velocity * dt;
+// --- Snapshots ---
+
+namespace {
+
+struct StateHeader {
+    uint32_t version;
+    uint32_t body_count;
+    float accumulator;
+    uint32_t reserved;
+};
+
+// No padding, so blobs of equal states compare (and hash) equal
+struct BodyState {
+    uint64_t id;
+    Vec3f position;
+    Quat rotation;
+    Vec3f velocity;
+    Vec3f angular_velocity;
+    Vec3f force;
+    Vec3f torque;
+    float sleep_timer;
+    uint32_t sleeping;
+    uint32_t reserved;
+};
+static_assert(sizeof(BodyState) == 96 && std::is_trivially_copyable_v<BodyState>);
+
+constexpr uint32_t state_version = 1;
+
+} // namespace
+
+void RigidBodyWorld::save_state(std::vector<uint8_t>& out) {
+    const auto& order = id_order();
+    StateHeader header{state_version, static_cast<uint32_t>(order.size()), accumulator_, 0};
+    out.resize(sizeof(header) + order.size() * sizeof(BodyState));
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    uint8_t* cursor = out.data() + sizeof(header);
+    for (uint32_t slot : order) {
+        const PhysicsBody& pb = slot_body(slot);
+        BodyState b{pb.id, pb.transform.position, pb.transform.rotation,
+                    pb.body.velocity, pb.body.angular_velocity,
+                    pb.body.force_accumulator, pb.body.torque_accumulator,
+                    pb.body.sleep_timer, pb.body.is_sleeping ? 1u : 0u, 0};
+        std::memcpy(cursor, &b, sizeof(b));
+        cursor += sizeof(b);
+    }
+    solver_.save_state(out);
+}
 
-        // Angular integration
-        body.angular_velocity += body.torque_accumulator * body.inv_mass * dt;
-        body.angular_velocity *= (1.0f - body.angular_damping);
+bool RigidBodyWorld::restore_state(const std::vector<uint8_t>& state) {
+    StateHeader header;
+    if (state.size() < sizeof(header)) return false;
+    std::memcpy(&header, state.data(), sizeof(header));
+    size_t bodies_end = sizeof(header) + static_cast<size_t>(header.body_count) * sizeof(BodyState);
+    if (header.version != state_version || header.body_count != dense_slots_.size() ||
+        state.size() < bodies_end) {
+        return false;
+    }
 
-        // Update rotation from angular velocity
-        float angle = body.angular_velocity.length();
-        if (angle > 0.0001f) {
-            Vec3f axis = body.angular_velocity.normalized();
-            Quat delta = Quat::from_axis_angle(axis, angle * dt);
-            pb.transform.rotation = (delta * pb.transform.rotation).normalized();
-        }
+    // Validate every id before touching anything
+    const uint8_t* records = state.data() + sizeof(header);
+    for (uint32_t k = 0; k < header.body_count; ++k) {
+        uint64_t id;
+        std::memcpy(&id, records + k * sizeof(BodyState), sizeof(id));
+        if (find_slot(id) == UINT32_MAX) return false;
+    }
+    if (solver_.restore_state(state.data() + bodies_end, state.size() - bodies_end) == 0) {
+        return false;
+    }
 
-        body.clear_forces();
+    for (uint32_t k = 0; k < header.body_count; ++k) {
+        BodyState b;
+        std::memcpy(&b, records + k * sizeof(BodyState), sizeof(b));
+        PhysicsBody& pb = slot_body(find_slot(b.id));
+        pb.transform.position = b.position;
+        pb.transform.rotation = b.rotation;
+        pb.body.velocity = b.velocity;
+        pb.body.angular_velocity = b.angular_velocity;
+        pb.body.force_accumulator = b.force;
+        pb.body.torque_accumulator = b.torque;
+        pb.body.sleep_timer = b.sleep_timer;
+        pb.body.is_sleeping = b.sleeping != 0;
     }
+    accumulator_ = header.accumulator;
+    events_.clear();
+    broadphase_.invalidate();
+    queries_valid_ = false;
+    return true;
 }
 
-void RigidBodyWorld::detect_and_resolve() {
-    for (size_t i = 0; i < bodies_.size(); ++i) {
-        for (size_t j = i + 1; j < bodies_.size(); ++j) {
-            auto& a = bodies_[i];
-            auto& b = bodies_[j];
+void RigidBodyWorld::store_arrays() {
+    for (uint32_t i = 0; i < arrays_.size(); ++i) {
+        if (!arrays_.is_static(i)) arrays_.store(i);
+    }
+}
 
-            // Skip if both static
-            if (a.body.type == RigidBodyType::Static &&
-                b.body.type == RigidBodyType::Static) continue;
+void RigidBodyWorld::dispatch_events() {
+    for (const auto& e : events_) {
+        // A callback may have removed either body
+        PhysicsBody* a = get_body(e.id_a);
+        PhysicsBody* b = get_body(e.id_b);
+        if (!a || !b) continue;
+        if (a->on_collision) a->on_collision(*b, e.contact);
+        if (b->on_collision) {
+            ContactPoint reversed = e.contact;
+            reversed.normal = reversed.normal * -1.0f;
+            b->on_collision(*a, reversed);
+        }
+    }
+    events_.clear();
+}
 
-            // Skip if both sleeping
-            if (a.body.is_sleeping && b.body.is_sleeping) continue;
+void RigidBodyWorld::integrate_velocities(float dt) {
+    auto count = static_cast<uint32_t>(arrays_.size());
+    jobs_->parallel_for(0, count, integrate_chunk_size_,
+        [this, dt](uint32_t begin, uint32_t end) {
+            integrate_velocities3d(arrays_, begin, end, gravity_, dt, integration_mode_);
+        });
+}
 
-            auto contact = check_collision3d(a.shape, a.transform, b.shape, b.transform);
-            if (!contact) continue;
+void RigidBodyWorld::integrate_positions(float dt) {
+    auto count = static_cast<uint32_t>(arrays_.size());
+    jobs_->parallel_for(0, count, integrate_chunk_size_,
+        [this, dt](uint32_t begin, uint32_t end) {
+            integrate_positions3d(arrays_, begin, end, dt, integration_mode_);
+        });
+}
 
-            // Wake up sleeping bodies on collision
-            a.body.wake();
-            b.body.wake();
+uint32_t RigidBodyWorld::find_island(uint32_t i) {
+    while (island_parent_[i] != i) {
+        island_parent_[i] = island_parent_[island_parent_[i]];  // path halving
+        i = island_parent_[i];
+    }
+    return i;
+}
 
-            // Resolve collision
-            resolve_contact(a, b, *contact);
+void RigidBodyWorld::unite_islands(uint32_t a, uint32_t b) {
+    a = find_island(a);
+    b = find_island(b);
+    // Lower index wins so roots do not depend on pair order
+    if (a < b) island_parent_[b] = a;
+    else if (b < a) island_parent_[a] = b;
+}
 
-            // Fire callbacks
-            if (a.on_collision) a.on_collision(b, *contact);
-            if (b.on_collision) {
-                ContactPoint reversed = *contact;
-                reversed.normal = reversed.normal * -1.0f;
-                b.on_collision(a, reversed);
+void RigidBodyWorld::detect_contacts() {
+    auto& w = arrays_;
+
+    // Narrowphase only runs on pairs whose AABBs overlap; pairs arrive in
+    // increasing id order, which the solver's warm-start cache relies on
+    broadphase_.update(w, *jobs_);
+    solver_.begin_step();
+
+    const auto& pairs = broadphase_.pairs();
+    auto count = static_cast<uint32_t>(w.size());
+    auto pair_count = static_cast<uint32_t>(pairs.size());
+    uint32_t chunk = narrowphase_chunk_size_;
+    pair_manifold_.assign(pair_count, no_contact);
+    uint32_t buffer_count = (pair_count + chunk - 1) / chunk;
+    if (manifold_buffers_.size() < buffer_count) manifold_buffers_.resize(buffer_count);
+
+    // Pass 1: narrowphase for pairs with an awake body, in parallel chunks.
+    // Pairs of resting bodies are deferred. Chunk c always covers pairs
+    // [c * chunk, (c + 1) * chunk) and fills manifold_buffers_[c], even when
+    // the job system runs several chunks in one call.
+    jobs_->parallel_for(0, buffer_count, 1,
+        [this, &w, &pairs, chunk, pair_count](uint32_t first, uint32_t last) {
+            ContactManifold manifold;
+            for (uint32_t c = first; c < last; ++c) {
+                auto& out = manifold_buffers_[c];
+                out.clear();
+                uint32_t end = std::min(pair_count, (c + 1) * chunk);
+                for (uint32_t k = c * chunk; k < end; ++k) {
+                    uint32_t a = pairs[k].a;
+                    uint32_t b = pairs[k].b;
+                    if (w.is_resting(a) && w.is_resting(b)) {
+                        pair_manifold_[k] = deferred_contact;
+                        continue;
+                    }
+                    if (!collide_manifold3d(w.cold[a]->shape, w.transform(a),
+                                            w.cold[b]->shape, w.transform(b), manifold)) continue;
+                    pair_manifold_[k] = static_cast<int32_t>(out.size());
+                    out.push_back(manifold);
+                }
             }
+        });
+
+    // Island links between dynamic bodies in contact. Touching sleeping
+    // bodies stay linked by their AABB overlap, so a pile keeps its island
+    // while asleep.
+    island_parent_.resize(count);
+    for (uint32_t i = 0; i < count; ++i) island_parent_[i] = i;
+    for (uint32_t k = 0; k < pair_count; ++k) {
+        uint32_t a = pairs[k].a;
+        uint32_t b = pairs[k].b;
+        if (pair_manifold_[k] != no_contact && !w.is_static(a) && !w.is_static(b)) {
+            unite_islands(a, b);
+        }
+    }
+
+    // An island with any awake body wakes as a whole
+    island_slot_.assign(count, 0);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!w.is_resting(i)) island_slot_[find_island(i)] = 1;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        if (w.is_sleeping(i) && island_slot_[find_island(i)]) {
+            w.flags[i] &= ~BodyArrays3D::flag_sleeping;
+            w.sleep_timer[i] = 0.0f;
+        }
+    }
+
+    // Pass 2: hand manifolds to the solver in pair order, running the
+    // narrowphase now for deferred pairs whose island just woke
+    for (uint32_t k = 0; k < pair_count; ++k) {
+        uint32_t a = pairs[k].a;
+        uint32_t b = pairs[k].b;
+
+        int32_t m = pair_manifold_[k];
+        if (m == no_contact) continue;
+        if (m == deferred_contact) {
+            if (w.is_resting(a) && w.is_resting(b)) continue;
+            if (!collide_manifold3d(w.cold[a]->shape, w.transform(a),
+                                    w.cold[b]->shape, w.transform(b), manifold_)) continue;
         }
+        const ContactManifold& manifold = m >= 0 ? manifold_buffers_[k / chunk][m] : manifold_;
+
+        solver_.add_manifold(w, a, b, manifold);
+
+        // Queue callbacks with the deepest point, skipping purely speculative
+        // manifolds (bodies within the contact margin but not yet touching)
+        if (!w.cold[a]->on_collision && !w.cold[b]->on_collision) continue;
+        int deepest = 0;
+        for (int i = 1; i < manifold.point_count; ++i) {
+            if (manifold.points[i].penetration > manifold.points[deepest].penetration) deepest = i;
+        }
+        const ContactPoint& contact = manifold.points[deepest];
+        if (contact.penetration <= 0.0f) continue;
+        events_.push_back({w.id[a], w.id[b], contact});
     }
 }
 
-void RigidBodyWorld::resolve_contact(PhysicsBody& a, PhysicsBody& b,
-                                      const ContactPoint& contact) {
-    float inv_mass_sum = a.body.inv_mass + b.body.inv_mass;
-    if (inv_mass_sum <= 0.0f) return;
-
-    // Positional correction (prevent sinking)
-    constexpr float correction_percent = 0.8f;
-    constexpr float slop = 0.01f;
-    float correction_mag = std::max(contact.penetration - slop, 0.0f) /
-                           inv_mass_sum * correction_percent;
-    Vec3f correction = contact.normal * correction_mag;
-    a.transform.position -= correction * a.body.inv_mass;
-    b.transform.position += correction * b.body.inv_mass;
-
-    // Relative velocity
-    Vec3f rel_vel = b.body.velocity - a.body.velocity;
-    float vel_along_normal = rel_vel.dot(contact.normal);
-
-    // Don't resolve if velocities are separating
-    if (vel_along_normal > 0.0f) return;
-
-    // Restitution (use minimum)
-    float e = std::min(a.body.restitution, b.body.restitution);
-
-    // Impulse magnitude
-    float j = -(1.0f + e) * vel_along_normal / inv_mass_sum;
-
-    // Apply impulse
-    Vec3f impulse = contact.normal * j;
-    a.body.velocity -= impulse * a.body.inv_mass;
-    b.body.velocity += impulse * b.body.inv_mass;
-
-    // Friction impulse (tangent)
-    Vec3f tangent = rel_vel - contact.normal * vel_along_normal;
-    float tangent_len = tangent.length();
-    if (tangent_len > 0.0001f) {
-        tangent = tangent * (1.0f / tangent_len);
-        float jt = -rel_vel.dot(tangent) / inv_mass_sum;
-        float mu = (a.body.friction + b.body.friction) * 0.5f;
-
-        Vec3f friction_impulse;
-        if (std::abs(jt) < j * mu) {
-            friction_impulse = tangent * jt;
-        } else {
-            friction_impulse = tangent * (-j * mu);
+void RigidBodyWorld::build_islands() {
+    constexpr uint32_t none = UINT32_MAX;
+    const auto& w = arrays_;
+    auto count = static_cast<uint32_t>(w.size());
+    island_slot_.assign(count, none);
+    islands_.clear();
+
+    // Count bodies and constraints per island; every awake dynamic body
+    // belongs to one, even if it touches nothing
+    for (uint32_t i = 0; i < count; ++i) {
+        if (w.is_resting(i)) continue;
+        uint32_t root = find_island(i);
+        if (island_slot_[root] == none) {
+            island_slot_[root] = static_cast<uint32_t>(islands_.size());
+            islands_.emplace_back();
         }
-        a.body.velocity -= friction_impulse * a.body.inv_mass;
-        b.body.velocity += friction_impulse * b.body.inv_mass;
+        ++islands_[island_slot_[root]].body_count;
+    }
+
+    auto constraint_island = [&](size_t c) {
+        uint32_t a = solver_.body_a(c);
+        uint32_t body = w.is_static(a) ? solver_.body_b(c) : a;
+        return island_slot_[find_island(body)];
+    };
+    for (size_t c = 0; c < solver_.constraint_count(); ++c) {
+        ++islands_[constraint_island(c)].constraint_count;
+    }
+
+    // Prefix sums, then fill; both lists stay in ascending order per island
+    uint32_t body_offset = 0, constraint_offset = 0;
+    for (auto& island : islands_) {
+        island.body_begin = body_offset;
+        island.constraint_begin = constraint_offset;
+        body_offset += island.body_count;
+        constraint_offset += island.constraint_count;
+        island.body_count = 0;
+        island.constraint_count = 0;
+    }
+    island_bodies_.resize(body_offset);
+    island_constraints_.resize(constraint_offset);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (w.is_resting(i)) continue;
+        auto& island = islands_[island_slot_[find_island(i)]];
+        island_bodies_[island.body_begin + island.body_count++] = i;
+    }
+    for (size_t c = 0; c < solver_.constraint_count(); ++c) {
+        auto& island = islands_[constraint_island(c)];
+        island_constraints_[island.constraint_begin + island.constraint_count++] =
+            static_cast<uint32_t>(c);
     }
 }
 
+void RigidBodyWorld::solve_islands(float dt) {
+    // Islands share no dynamic bodies, so each chunk solves its islands
+    // independently; results do not depend on the worker count
+    auto count = static_cast<uint32_t>(islands_.size());
+    jobs_->parallel_for(0, count, island_chunk_size_,
+        [this, dt](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                const Island& island = islands_[i];
+                if (island.constraint_count == 0) continue;
+                solver_.solve_island(arrays_, dt, &island_constraints_[island.constraint_begin],
+                                     island.constraint_count);
+            }
+        });
+}
+
 void RigidBodyWorld::update_sleep(float dt) {
-    for (auto& pb : bodies_) {
-        auto& body = pb.body;
-        if (body.type == RigidBodyType::Static) continue;
-
-        float speed = body.velocity.length_sq() + body.angular_velocity.length_sq();
-        if (speed < sleep_velocity_threshold_ * sleep_velocity_threshold_) {
-            body.sleep_timer += dt;
-            if (body.sleep_timer >= sleep_time_threshold_) {
-                body.is_sleeping = true;
-                body.velocity = Vec3f::zero();
-                body.angular_velocity = Vec3f::zero();
+    auto& w = arrays_;
+
+    // Islands sleep as a whole once every body in them has been slow for
+    // long enough, so a pile never sleeps with one body still moving
+    for (const auto& island : islands_) {
+        const uint32_t* members = &island_bodies_[island.body_begin];
+        float min_sleep_time = sleep_time_threshold_;
+        for (uint32_t k = 0; k < island.body_count; ++k) {
+            uint32_t i = members[k];
+            float speed = w.velocity[i].length_sq() + w.angular_velocity[i].length_sq();
+            if (speed < sleep_velocity_threshold_ * sleep_velocity_threshold_) {
+                w.sleep_timer[i] += dt;
+            } else {
+                w.sleep_timer[i] = 0.0f;
             }
-        } else {
-            body.sleep_timer = 0.0f;
-            body.is_sleeping = false;
+            min_sleep_time = std::min(min_sleep_time, w.sleep_timer[i]);
+        }
+        if (min_sleep_time < sleep_time_threshold_) continue;
+
+        for (uint32_t k = 0; k < island.body_count; ++k) {
+            uint32_t i = members[k];
+            w.flags[i] |= BodyArrays3D::flag_sleeping;
+            w.velocity.set(i, Vec3f::zero());
+            w.angular_velocity.set(i, Vec3f::zero());
         }
     }
 }
 
 void RigidBodyWorld::step(float dt) {
     accumulator_ += dt;
+    if (accumulator_ < fixed_dt_) return;
+
+    load_arrays();
 
     int steps = 0;
     while (accumulator_ >= fixed_dt_ && steps < max_substeps_) {
-        integrate(fixed_dt_);
-        detect_and_resolve();
+        integrate_velocities(fixed_dt_);
+        detect_contacts();
+        build_islands();
+        solve_islands(fixed_dt_);
+        integrate_positions(fixed_dt_);
         update_sleep(fixed_dt_);
         accumulator_ -= fixed_dt_;
         ++steps;
@@ -192,4 +470,91 @@ void RigidBodyWorld::step(float dt) {
     if (accumulator_ > fixed_dt_ * 2.0f) {
         accumulator_ = 0.0f;
     }
+
+    store_arrays();
+    queries_valid_ = false;
+    dispatch_events();
+}
+
+// --- Scene queries ---
+
+void RigidBodyWorld::prepare_queries() {
+    if (queries_valid_) return;
+    load_arrays();
+    broadphase_.refit(arrays_, *jobs_);
+    queries_valid_ = true;
+}
+
+std::optional<RayHit3D> RigidBodyWorld::cast_ray(Vec3f origin, Vec3f direction,
+                                                 float max_distance, float radius) const {
+    Vec3f dir = direction.normalized();
+    if (dir.length_sq() == 0.0f || !(max_distance >= 0.0f)) return std::nullopt;
+
+    std::optional<RayHit3D> best;
+    broadphase_.query_ray(origin, dir, max_distance, radius, [&](uint32_t i) {
+        auto hit = sphere_cast3d(arrays_.cold[i]->shape, arrays_.transform(i),
+                                 origin, dir, max_distance, radius);
+        // Equal distances go to the lower id, whatever order bodies arrive in
+        if (hit && (!best || hit->distance < best->distance ||
+                    (hit->distance == best->distance && arrays_.id[i] < best->id))) {
+            best = RayHit3D{arrays_.id[i], hit->point, hit->normal, hit->distance};
+            max_distance = hit->distance;
+        }
+        return max_distance;
+    });
+    return best;
+}
+
+std::optional<RayHit3D> RigidBodyWorld::raycast(Vec3f origin, Vec3f direction, float max_distance) {
+    prepare_queries();
+    return cast_ray(origin, direction, max_distance, 0.0f);
+}
+
+std::optional<RayHit3D> RigidBodyWorld::sweep_sphere(Vec3f origin, float radius, Vec3f direction,
+                                                     float max_distance) {
+    prepare_queries();
+    return cast_ray(origin, direction, max_distance, radius);
+}
+
+template <typename Fn>
+void RigidBodyWorld::overlap_shape(const CollisionShape3D& shape, const Transform3D& t,
+                                   Fn&& fn) const {
+    broadphase_.query(compute_aabb3d(shape, t), [&](uint32_t i) {
+        if (check_collision3d(shape, t, arrays_.cold[i]->shape, arrays_.transform(i))) {
+            fn(arrays_.id[i]);
+        }
+    });
+}
+
+void RigidBodyWorld::overlap_sphere(Vec3f center, float radius, std::vector<uint64_t>& out) {
+    prepare_queries();
+    out.clear();
+    Transform3D t;
+    t.position = center;
+    overlap_shape(SphereShape{radius}, t, [&](uint64_t id) { out.push_back(id); });
+}
+
+void RigidBodyWorld::overlap_box(Vec3f center, Vec3f half_extent, const Quat& rotation,
+                                 std::vector<uint64_t>& out) {
+    prepare_queries();
+    out.clear();
+    Transform3D t;
+    t.position = center;
+    t.rotation = rotation;
+    overlap_shape(BoxShape{half_extent}, t, [&](uint64_t id) { out.push_back(id); });
+}
+
+void RigidBodyWorld::raycast_many(const std::vector<RayQuery3D>& queries,
+                                  std::vector<std::optional<RayHit3D>>& results) {
+    prepare_queries();
+    results.resize(queries.size());
+
+    // Queries only read the refit bounds and arrays, so they are independent
+    jobs_->parallel_for(0, static_cast<uint32_t>(queries.size()), query_chunk_size_,
+        [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                const auto& q = queries[i];
+                results[i] = cast_ray(q.origin, q.direction, q.max_distance, q.radius);
+            }
+        });
 }
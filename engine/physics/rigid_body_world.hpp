@@ -1,9 +1,16 @@
 #pragma once
 #include "rigid_body.hpp"
 #include "collision_shape3d.hpp"
+#include "broadphase3d.hpp"
+#include "contact_solver.hpp"
+#include "body_arrays3d.hpp"
+#include "integrate3d.hpp"
+#include "../core/job_system.hpp"
 #include <vector>
+#include <memory>
 #include <cstdint>
 #include <functional>
+#include <optional>
 
 // A body entry in the physics world, pairing a rigid body with its collision shape
 struct PhysicsBody {
@@ -16,11 +23,72 @@ struct PhysicsBody {
     std::function<void(PhysicsBody& other, const ContactPoint& contact)> on_collision;
 };
 
+// Closest hit of a raycast or sphere sweep against RigidBodyWorld
+struct RayHit3D {
+    uint64_t id = 0;       // Body that was hit
+    Vec3f point;           // On the body's surface
+    Vec3f normal;          // Out of the body's surface
+    float distance = 0.0f; // Along the ray (to the sphere's center for sweeps)
+};
+
+// One query for RigidBodyWorld::raycast_many; radius > 0 sweeps a sphere
+struct RayQuery3D {
+    Vec3f origin;
+    Vec3f direction;
+    float max_distance = 0.0f;
+    float radius = 0.0f;
+};
+
 // Rigid body physics world
 // Manages integration, collision detection, and collision response
+//
+// Storage: PhysicsBody records live in fixed-size blocks that never move, so
+// pointers from get_body() (and RigidBody::transform) stay valid while other
+// bodies are added or removed. A slot map turns ids into block slots in O(1);
+// an id is (generation << 32 | slot), and removing a body bumps its slot's
+// generation so stale ids miss instead of aliasing the next occupant.
+// Live slots are also kept densely packed (swap-remove) for iteration.
+//
+// Scene queries (raycast, sweep_sphere, overlap_*) take their candidates
+// from the broadphase's sorted bounds, refit to the current positions on
+// the first query after anything changed (a step, an added or removed body,
+// or mutable access through get_body / for_each_body).
+//
+// Determinism: the contact solver works in body id order and parallel
+// stages merge their results in a fixed order, so a world stepped with the
+// same inputs produces the same bits on any worker count. Deterministic
+// mode additionally loads bodies in id order, so nothing depends on the
+// order left behind by removals, and pins the integrator to Reproducible.
+// save_state() / restore_state() copy everything step() carries from one
+// step to the next into a flat blob, for rollback.
+//
+// Simulation runs on BodyArrays3D, loaded from the records at the start of
+// step() and stored back at the end. Collision callbacks are queued during
+// the substeps and fired after the store, so they see the final state and
+// any body they modify is picked up by the next step.
 class RigidBodyWorld {
-    std::vector<PhysicsBody> bodies_;
-    uint64_t next_id_ = 1;
+    static constexpr uint32_t block_size_ = 64;
+    struct Slot {
+        uint32_t generation = 1;
+        uint32_t dense = 0;       // index into dense_slots_ while live
+    };
+    std::vector<std::unique_ptr<PhysicsBody[]>> blocks_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_slots_;
+    std::vector<uint32_t> dense_slots_;
+    // Live slots sorted by body id, rebuilt after adds and removes
+    std::vector<uint32_t> id_order_;
+    bool id_order_valid_ = false;
+    bool deterministic_ = false;
+
+    // Hot state for the current step, indexed like dense_slots_
+    BodyArrays3D arrays_;
+
+    struct ContactEvent {
+        uint64_t id_a, id_b;
+        ContactPoint contact;
+    };
+    std::vector<ContactEvent> events_;
 
     // World settings
     Vec3f gravity_{0.0f, -9.81f, 0.0f};
@@ -28,15 +96,79 @@ class RigidBodyWorld {
     float accumulator_ = 0.0f;
     int max_substeps_ = 4;
 
+    // Candidate pairs for detect_contacts, refreshed every substep
+    SweepAndPrune3D broadphase_;
+    ContactSolver3D solver_;
+    ContactManifold manifold_;
+
+    // Manifolds found in the first pass of detect_contacts. The pass runs
+    // in chunks of pairs, each appending to its own buffer; pair_manifold_
+    // holds the index within the pair's chunk buffer (or no_contact /
+    // deferred_contact when there is none yet).
+    static constexpr int32_t no_contact = -1;
+    static constexpr int32_t deferred_contact = -2;
+    std::vector<std::vector<ContactManifold>> manifold_buffers_;
+    std::vector<int32_t> pair_manifold_;
+    uint32_t narrowphase_chunk_size_ = 64;
+
+    // Workers for integration, broadphase, narrowphase and island solves.
+    // Every parallel stage writes per-chunk or per-island results that are
+    // consumed in a fixed order, so results do not depend on the worker count.
+    JobSystem* jobs_ = &g_job_system;
+
+    // Contact islands: union-find over dynamic bodies, rebuilt every substep.
+    // Static bodies never join an island, so one floor does not merge every
+    // pile in the scene. Each island's bodies and constraints are contiguous
+    // ranges of island_bodies_ / island_constraints_.
+    struct Island {
+        uint32_t body_begin = 0, body_count = 0;
+        uint32_t constraint_begin = 0, constraint_count = 0;
+    };
+    std::vector<uint32_t> island_parent_;
+    std::vector<uint32_t> island_slot_;
+    std::vector<Island> islands_;
+    std::vector<uint32_t> island_bodies_;
+    std::vector<uint32_t> island_constraints_;
+    uint32_t island_chunk_size_ = 8;
+
+    // Integration runs in chunks of bodies on jobs_
+    IntegrationMode integration_mode_ = IntegrationMode::Reproducible;
+    uint32_t integrate_chunk_size_ = 4096;
+
+    // Broadphase bounds match the bodies' current transforms
+    bool queries_valid_ = false;
+    uint32_t query_chunk_size_ = 64;
+
     // Sleep thresholds
     static constexpr float sleep_velocity_threshold_ = 0.05f;
     static constexpr float sleep_time_threshold_ = 0.5f;
 
-    void integrate(float dt);
-    void detect_and_resolve();
-    void resolve_contact(PhysicsBody& a, PhysicsBody& b, const ContactPoint& contact);
+    PhysicsBody& slot_body(uint32_t slot) { return blocks_[slot / block_size_][slot % block_size_]; }
+    const PhysicsBody& slot_body(uint32_t slot) const { return blocks_[slot / block_size_][slot % block_size_]; }
+    // Slot for a live id, or UINT32_MAX
+    uint32_t find_slot(uint64_t id) const;
+
+    const std::vector<uint32_t>& id_order();
+    void load_arrays();
+    void store_arrays();
+    void dispatch_events();
+
+    void integrate_velocities(float dt);
+    void integrate_positions(float dt);
+    void detect_contacts();
+    void build_islands();
+    void solve_islands(float dt);
     void update_sleep(float dt);
 
+    uint32_t find_island(uint32_t i);
+    void unite_islands(uint32_t a, uint32_t b);
+
+    void prepare_queries();
+    std::optional<RayHit3D> cast_ray(Vec3f origin, Vec3f direction, float max_distance,
+                                     float radius) const;
+    template <typename Fn>
+    void overlap_shape(const CollisionShape3D& shape, const Transform3D& t, Fn&& fn) const;
+
 public:
     RigidBodyWorld() = default;
 
@@ -46,24 +178,83 @@ public:
     void set_fixed_timestep(float dt) { fixed_dt_ = dt; }
     void set_max_substeps(int n) { max_substeps_ = n; }
 
+    // Contact solver settings (default: 8 iterations, warm starting on)
+    void set_velocity_iterations(int n) { solver_.set_iterations(n); }
+    void set_warm_starting(bool enabled) { solver_.set_warm_starting(enabled); }
+
+    // Job system used for the parallel stages (default: g_job_system)
+    void set_job_system(JobSystem& jobs) { jobs_ = &jobs; }
+
+    // Reproducible (default) gives the same bits with or without SIMD
+    void set_integration_mode(IntegrationMode mode) { integration_mode_ = mode; }
+    IntegrationMode integration_mode() const { return integration_mode_; }
+
+    // Deterministic mode (default off): see the class comment
+    void set_deterministic(bool enabled);
+    bool deterministic() const { return deterministic_; }
+
+    // Snapshot of the simulation state: every body's transform, velocities,
+    // accumulated forces and sleep state, the timestep accumulator and the
+    // solver's warm-start cache. out is overwritten. Shapes, materials and
+    // callbacks are not included.
+    void save_state(std::vector<uint8_t>& out);
+    // Restore a snapshot taken from this world. The same bodies (ids) must
+    // be live as when it was saved; otherwise nothing changes and false is
+    // returned.
+    bool restore_state(const std::vector<uint8_t>& state);
+
     // Add a body and return its ID
     uint64_t add_body(PhysicsBody body);
 
     // Remove a body by ID
     void remove_body(uint64_t id);
 
-    // Get a body by ID (nullptr if not found)
+    // Get a body by ID (nullptr if not found or removed). O(1); the pointer
+    // stays valid until this body itself is removed.
     PhysicsBody* get_body(uint64_t id);
     const PhysicsBody* get_body(uint64_t id) const;
 
     // Step the simulation with fixed-timestep accumulation
     void step(float dt);
 
-    // Get all bodies (for rendering, etc.)
-    const std::vector<PhysicsBody>& bodies() const { return bodies_; }
-    std::vector<PhysicsBody>& bodies() { return bodies_; }
+    // Visit all bodies (for rendering, etc.). Order changes when bodies are
+    // removed; do not add or remove bodies from fn.
+    template<typename Fn>
+    void for_each_body(Fn&& fn) {
+        queries_valid_ = false;
+        for (uint32_t slot : dense_slots_) fn(slot_body(slot));
+    }
+    template<typename Fn>
+    void for_each_body(Fn&& fn) const {
+        for (uint32_t slot : dense_slots_) fn(slot_body(slot));
+    }
+
+    size_t body_count() const { return dense_slots_.size(); }
+
+    // Closest body hit by the ray from origin along direction (normalized
+    // here) within max_distance. Rays starting inside a body hit it at 0.
+    std::optional<RayHit3D> raycast(Vec3f origin, Vec3f direction, float max_distance);
+
+    // Closest body touched by a sphere of radius swept the same way
+    std::optional<RayHit3D> sweep_sphere(Vec3f origin, float radius, Vec3f direction,
+                                         float max_distance);
+
+    // Ids of every body overlapping the sphere / oriented box, in no
+    // particular order. out is cleared first.
+    void overlap_sphere(Vec3f center, float radius, std::vector<uint64_t>& out);
+    void overlap_box(Vec3f center, Vec3f half_extent, const Quat& rotation,
+                     std::vector<uint64_t>& out);
+
+    // Batched raycasts and sphere sweeps split across the job system.
+    // results[i] answers queries[i]; results is resized to match.
+    void raycast_many(const std::vector<RayQuery3D>& queries,
+                      std::vector<std::optional<RayHit3D>>& results);
+
+    // Broadphase state from the last substep (pair count, sort axis)
+    const SweepAndPrune3D& broadphase() const { return broadphase_; }
 
-    size_t body_count() const { return bodies_.size(); }
+    // Awake islands from the last substep, including bodies touching nothing
+    size_t island_count() const { return islands_.size(); }
 };
 
 // Global instance
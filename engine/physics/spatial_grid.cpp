@@ -1,4 +1,6 @@
 #include "spatial_grid.hpp"
+#include "../core/assert.hpp"
+#include "../math/simd.hpp"
 #include <cmath>
 #include <algorithm>
 
@@ -6,75 +8,265 @@ SpatialGrid2D::SpatialGrid2D(float cell_size)
     : cell_size_(cell_size), inv_cell_size_(1.0f / cell_size) {}
 
 void SpatialGrid2D::clear() {
-    cells_.clear();
+    // Keep capacity: the grid is rebuilt every frame
+    entries_.clear();
+    ref_count_ = 0;
+    built_ = false;
 }
 
-SpatialGrid2D::CellKey SpatialGrid2D::to_cell(float x, float y) const {
-    return {
-        static_cast<int32_t>(std::floor(x * inv_cell_size_)),
-        static_cast<int32_t>(std::floor(y * inv_cell_size_))
-    };
+// Cell coordinates stay within +-max_cell: converting a float outside the
+// int32 range (or NaN) is undefined, and spans between cells must fit too
+static constexpr float max_cell = 536870912.0f;  // 2^29
+
+// Truncate-and-adjust floor; avoids a libm call per cell coordinate
+static inline int32_t fast_floor(float v) {
+    v = v > -max_cell ? std::min(v, max_cell) : -max_cell;  // NaN clamps low
+    int32_t i = static_cast<int32_t>(v);
+    return i - (v < static_cast<float>(i) ? 1 : 0);
+}
+
+SpatialGrid2D::CellCoord SpatialGrid2D::to_cell(float x, float y) const {
+    return {fast_floor(x * inv_cell_size_), fast_floor(y * inv_cell_size_)};
+}
+
+// Both corners of a box at once: the same clamp and floor as fast_floor
+// in four lanes, since insert() runs this for every collider each frame
+static inline void to_cells(Vec2f min, Vec2f max, float inv_cell_size,
+                            SpatialGrid2D::CellCoord& lo, SpatialGrid2D::CellCoord& hi) {
+#if ERGO_SIMD_AVX2 || ERGO_SIMD_SSE
+    __m128 v = _mm_mul_ps(_mm_setr_ps(min.x, min.y, max.x, max.y), _mm_set1_ps(inv_cell_size));
+    v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-max_cell)), _mm_set1_ps(max_cell));  // NaN clamps low
+    __m128i i = _mm_cvttps_epi32(v);
+    i = _mm_add_epi32(i, _mm_castps_si128(_mm_cmplt_ps(v, _mm_cvtepi32_ps(i))));  // -1 where truncated up
+    alignas(16) int32_t out[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(out), i);
+    lo = {out[0], out[1]};
+    hi = {out[2], out[3]};
+#else
+    lo = {fast_floor(min.x * inv_cell_size), fast_floor(min.y * inv_cell_size)};
+    hi = {fast_floor(max.x * inv_cell_size), fast_floor(max.y * inv_cell_size)};
+#endif
+}
+
+uint32_t SpatialGrid2D::cell_hash(int32_t cx, int32_t cy) {
+    return static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u;
+}
+
+uint32_t SpatialGrid2D::bucket_of(int32_t cx, int32_t cy) const {
+    return cell_hash(cx, cy) & bucket_mask_;
+}
+
+uint32_t SpatialGrid2D::next_stamp() const {
+    if (++stamp_ == 0) {
+        std::fill(stamps_.begin(), stamps_.end(), 0u);
+        stamp_ = 1;
+    }
+    return stamp_;
 }
 
 void SpatialGrid2D::insert(Collider* c) {
     if (!c || !c->transform) return;
 
     Vec2f pos = c->transform->position;
-    float extent = 0.0f;
+    Vec2f extent;
 
     if (auto* aabb = std::get_if<AABBData>(&c->shape)) {
-        extent = std::max(aabb->half_extent.x, aabb->half_extent.y);
+        extent = aabb->half_extent;
     } else if (auto* circle = std::get_if<CircleData>(&c->shape)) {
-        extent = circle->radius;
+        extent = {circle->radius, circle->radius};
     }
 
-    CellKey min_cell = to_cell(pos.x - extent, pos.y - extent);
-    CellKey max_cell = to_cell(pos.x + extent, pos.y + extent);
+    Entry e;
+    e.collider = c;
+    e.min = pos - extent;
+    e.max = pos + extent;
+    CellCoord lo, hi;
+    to_cells(e.min, e.max, inv_cell_size_, lo, hi);
+    hi = {std::max(hi.x, lo.x), std::max(hi.y, lo.y)};  // NaN max clamped low
 
-    for (int32_t cy = min_cell.y; cy <= max_cell.y; ++cy) {
-        for (int32_t cx = min_cell.x; cx <= max_cell.x; ++cx) {
-            cells_[{cx, cy}].push_back(c);
+    // Bounds grow here, while the entry is still in registers
+    if (entries_.empty()) {
+        bounds_min_ = e.min;
+        bounds_max_ = e.max;
+    } else {
+        bounds_min_ = {std::min(bounds_min_.x, e.min.x), std::min(bounds_min_.y, e.min.y)};
+        bounds_max_ = {std::max(bounds_max_.x, e.max.x), std::max(bounds_max_.y, e.max.y)};
+    }
+
+    // One ref per covered cell, row by row
+    auto index = static_cast<uint32_t>(entries_.size());
+    auto w = static_cast<uint32_t>(hi.x - lo.x);
+    auto h = static_cast<uint32_t>(hi.y - lo.y);
+    if (w <= 1 && h <= 1) {
+        // Up to 2x2 cells, the common case. All four refs are written and
+        // the count only advances past covered ones: whether a collider
+        // crosses a cell edge is random, so branching on it mispredicts.
+        if (refs_.size() < ref_count_ + 4) refs_.resize(std::max(refs_.size() * 2, ref_count_ + 4));
+        CellRef* out = refs_.data() + ref_count_;
+        size_t n = 0;
+        out[n] = {cell_hash(lo.x, lo.y), index};
+        n += 1;
+        out[n] = {cell_hash(hi.x, lo.y), index};
+        n += w;
+        out[n] = {cell_hash(lo.x, hi.y), index};
+        n += h;
+        out[n] = {cell_hash(hi.x, hi.y), index};
+        n += w & h;
+        ref_count_ += n;
+    } else {
+        size_t n = static_cast<size_t>(w + 1) * (h + 1);
+        if (refs_.size() < ref_count_ + n) refs_.resize(std::max(refs_.size() * 2, ref_count_ + n));
+        for (int32_t cy = lo.y; cy <= hi.y; ++cy) {
+            for (int32_t cx = lo.x; cx <= hi.x; ++cx) {
+                refs_[ref_count_++] = {cell_hash(cx, cy), index};
+            }
         }
     }
+    entries_.push_back(e);
+    built_ = false;
 }
 
-std::vector<Collider*> SpatialGrid2D::query(Vec2f min, Vec2f max) const {
-    std::vector<Collider*> result;
-    CellKey min_cell = to_cell(min.x, min.y);
-    CellKey max_cell = to_cell(max.x, max.y);
+void SpatialGrid2D::build(JobSystem& jobs) {
+    uint64_t span_cells = 0;
+    if (entries_.empty()) {
+        bounds_min_ = bounds_max_ = Vec2f::zero();
+    } else {
+        CellCoord lo = to_cell(bounds_min_.x, bounds_min_.y);
+        CellCoord hi = to_cell(bounds_max_.x, bounds_max_.y);
+        span_cells = static_cast<uint64_t>(hi.x - lo.x + 1) * static_cast<uint64_t>(hi.y - lo.y + 1);
+    }
 
+    // Bucket table sized to the occupied cell count keeps chains short.
+    // No more cells than the bounds span can be occupied, and a table that
+    // stays in cache makes the counting and scatter passes cheaper.
+    uint64_t cells = std::min<uint64_t>(ref_count_, span_cells);
+    uint32_t bucket_count = 64;
+    while (bucket_count < cells && bucket_count < (1u << 24)) bucket_count <<= 1;
+    bucket_mask_ = bucket_count - 1;
+
+    // Chunks of refs count and scatter on jobs, each with its own
+    // histogram. The prefix sum walks every histogram, so chunks are
+    // capped to keep that walk no longer than the refs themselves.
+    auto count = static_cast<uint32_t>(ref_count_);
+    auto chunks = static_cast<uint32_t>(std::max<uint64_t>(
+        1, std::min<uint64_t>(count / build_chunk, count / bucket_count)));
+    uint32_t chunk_size = (count + chunks - 1) / chunks;
+    histograms_.assign(static_cast<size_t>(chunks) * bucket_count, 0);
+    cell_start_.resize(bucket_count + 1);
+    cell_items_.resize(ref_count_);
+
+    // 1. Count refs per bucket
+    jobs.parallel_for(0, chunks, 1, [this, bucket_count, chunk_size, count](uint32_t first, uint32_t last) {
+        for (uint32_t c = first; c < last; ++c) {
+            uint32_t* hist = &histograms_[static_cast<size_t>(c) * bucket_count];
+            const CellRef* refs = refs_.data();
+            uint32_t mask = bucket_mask_;
+            uint32_t end = std::min(count, (c + 1) * chunk_size);
+            for (uint32_t i = c * chunk_size; i < end; ++i) {
+                ++hist[refs[i].hash & mask];
+            }
+        }
+    });
+
+    // 2. Exclusive prefix sum in (bucket, chunk) order: cell_start_[b] is the
+    //    first slot of bucket b, and each chunk's run of a bucket lands after
+    //    the earlier chunks', so the result matches a serial build
+    uint32_t offset = 0;
+    for (uint32_t b = 0; b < bucket_count; ++b) {
+        cell_start_[b] = offset;
+        for (uint32_t c = 0; c < chunks; ++c) {
+            uint32_t& slot = histograms_[static_cast<size_t>(c) * bucket_count + b];
+            uint32_t refs = slot;
+            slot = offset;
+            offset += refs;
+        }
+    }
+    cell_start_[bucket_count] = offset;
+
+    // 3. Scatter entry indices; each chunk's histogram is now its write cursors
+    jobs.parallel_for(0, chunks, 1, [this, bucket_count, chunk_size, count](uint32_t first, uint32_t last) {
+        for (uint32_t c = first; c < last; ++c) {
+            uint32_t* cursor = &histograms_[static_cast<size_t>(c) * bucket_count];
+            const CellRef* refs = refs_.data();
+            uint32_t* items = cell_items_.data();
+            uint32_t mask = bucket_mask_;
+            uint32_t end = std::min(count, (c + 1) * chunk_size);
+            for (uint32_t i = c * chunk_size; i < end; ++i) {
+                const CellRef ref = refs[i];
+                items[cursor[ref.hash & mask]++] = ref.entry;
+            }
+        }
+    });
+
+    stamps_.assign(entries_.size(), 0u);
+    stamp_ = 0;
+    built_ = true;
+}
+
+void SpatialGrid2D::query(Vec2f min, Vec2f max, std::vector<Collider*>& out) const {
+    out.clear();
+    // Entries inserted since the last build() would be silently missed
+    ERGO_ASSERT(built_ || entries_.empty(), "SpatialGrid2D::query before build()");
+    if (!built_) return;
+
+    auto overlaps = [&](const Entry& e) {
+        return e.min.x <= max.x && e.max.x >= min.x &&
+               e.min.y <= max.y && e.max.y >= min.y;
+    };
+
+    CellCoord min_cell = to_cell(min.x, min.y);
+    CellCoord max_cell = to_cell(max.x, max.y);
+    uint64_t query_cells = static_cast<uint64_t>(max_cell.x - min_cell.x + 1) *
+                           static_cast<uint64_t>(max_cell.y - min_cell.y + 1);
+
+    // Query covers more cells than there are buckets: a linear scan is cheaper
+    if (query_cells > bucket_mask_ + 1ull) {
+        for (const auto& e : entries_) {
+            if (overlaps(e)) out.push_back(e.collider);
+        }
+        return;
+    }
+
+    uint32_t stamp = next_stamp();
     for (int32_t cy = min_cell.y; cy <= max_cell.y; ++cy) {
         for (int32_t cx = min_cell.x; cx <= max_cell.x; ++cx) {
-            auto it = cells_.find({cx, cy});
-            if (it != cells_.end()) {
-                for (auto* c : it->second) {
-                    // Avoid duplicates
-                    if (std::find(result.begin(), result.end(), c) == result.end()) {
-                        result.push_back(c);
-                    }
-                }
+            uint32_t b = bucket_of(cx, cy);
+            for (uint32_t k = cell_start_[b]; k < cell_start_[b + 1]; ++k) {
+                uint32_t i = cell_items_[k];
+                if (stamps_[i] == stamp) continue;
+                stamps_[i] = stamp;
+                if (overlaps(entries_[i])) out.push_back(entries_[i].collider);
             }
         }
     }
-
-    return result;
 }
 
-std::vector<Collider*> SpatialGrid2D::query_radius(Vec2f center, float radius) const {
+void SpatialGrid2D::query_radius(Vec2f center, float radius,
+                                 std::vector<Collider*>& out) const {
     Vec2f min = {center.x - radius, center.y - radius};
     Vec2f max = {center.x + radius, center.y + radius};
-    auto candidates = query(min, max);
+    query(min, max, out);
 
     // Filter by actual distance
     float r2 = radius * radius;
-    candidates.erase(
-        std::remove_if(candidates.begin(), candidates.end(),
+    out.erase(
+        std::remove_if(out.begin(), out.end(),
             [&](const Collider* c) {
                 if (!c->transform) return true;
                 Vec2f d = c->transform->position - center;
                 return d.length_sq() > r2;
             }),
-        candidates.end());
+        out.end());
+}
 
-    return candidates;
+std::vector<Collider*> SpatialGrid2D::query(Vec2f min, Vec2f max) const {
+    std::vector<Collider*> result;
+    query(min, max, result);
+    return result;
+}
+
+std::vector<Collider*> SpatialGrid2D::query_radius(Vec2f center, float radius) const {
+    std::vector<Collider*> result;
+    query_radius(center, radius, result);
+    return result;
 }
@@ -1,38 +1,109 @@
 #pragma once
 #include "../math/vec2.hpp"
 #include "collider.hpp"
-#include <unordered_map>
+#include "../core/job_system.hpp"
 #include <vector>
 #include <cstdint>
 
+// Uniform-grid broadphase, rebuilt once per frame.
+//
+// insert() records each collider and hashes the cells it covers; build()
+// buckets those with a counting sort (count -> prefix sum -> scatter) into
+// one flat array. Large grids count and scatter in chunks on the job system,
+// with the same result as a serial build.
+// clear() keeps all capacity, so steady-state frames never allocate.
+// Cells are hashed into a power-of-two bucket table: a bucket may also hold
+// colliders from distant cells, so queries filter candidates by AABB.
+//
+// Usage:
+//   grid.clear();
+//   for (auto* c : colliders) grid.insert(c);
+//   grid.build();
+//   grid.query(min, max, results);  // results buffer is reused by the caller
+//
+// Queries share a dedupe stamp buffer and must not run concurrently on the
+// same grid.
 class SpatialGrid2D {
 public:
     explicit SpatialGrid2D(float cell_size = 64.0f);
 
     void clear();
     void insert(Collider* c);
+    void build(JobSystem& jobs = g_job_system);
+
+    // Allocation-free queries: `out` is cleared and refilled (capacity reused).
+    // Querying after insert() without build() aborts.
+    void query(Vec2f min, Vec2f max, std::vector<Collider*>& out) const;
+    void query_radius(Vec2f center, float radius, std::vector<Collider*>& out) const;
+
+    // Convenience overloads returning a new vector
     std::vector<Collider*> query(Vec2f min, Vec2f max) const;
     std::vector<Collider*> query_radius(Vec2f center, float radius) const;
 
+    struct CellCoord {
+        int32_t x, y;
+    };
+
+    // Visit every collider bucketed with cell (cx, cy). Stateless, so safe to
+    // call from several threads. Buckets are hashed: fn may also see colliders
+    // of other cells, and a collider spanning several cells once per cell.
+    template<typename Fn>
+    void for_each_in_cell(int32_t cx, int32_t cy, Fn&& fn) const {
+        if (!built_) return;
+        uint32_t b = bucket_of(cx, cy);
+        for (uint32_t k = cell_start_[b]; k < cell_start_[b + 1]; ++k) {
+            fn(*entries_[cell_items_[k]].collider);
+        }
+    }
+
+    CellCoord cell_of(Vec2f p) const { return to_cell(p.x, p.y); }
+
+    // Union of all inserted AABBs (valid after build() on a non-empty grid)
+    Vec2f bounds_min() const { return bounds_min_; }
+    Vec2f bounds_max() const { return bounds_max_; }
+
     float cell_size() const { return cell_size_; }
+    size_t size() const { return entries_.size(); }
+    bool is_built() const { return built_; }
 
 private:
     float cell_size_;
     float inv_cell_size_;
 
-    struct CellKey {
-        int32_t x, y;
-        bool operator==(const CellKey& o) const { return x == o.x && y == o.y; }
+    // Per-collider record, captured at insert() time
+    struct Entry {
+        Collider* collider;
+        Vec2f min, max;
     };
-
-    struct CellKeyHash {
-        size_t operator()(const CellKey& k) const {
-            return std::hash<int64_t>()(
-                (static_cast<int64_t>(k.x) << 32) | static_cast<uint32_t>(k.y));
-        }
+    // One (entry, covered cell) pair, also captured at insert() time. The
+    // cell's full hash is masked down to a bucket once build() knows the
+    // table size, so the build passes never revisit the cells.
+    struct CellRef {
+        uint32_t hash;
+        uint32_t entry;
     };
 
-    std::unordered_map<CellKey, std::vector<Collider*>, CellKeyHash> cells_;
+    std::vector<Entry> entries_;
+    std::vector<CellRef> refs_;       // first ref_count_ are live; the rest is slack
+    size_t ref_count_ = 0;            // total (entry, cell) pairs
+
+    // Per-chunk bucket counts, then write cursors, for a build on jobs
+    std::vector<uint32_t> histograms_;
+    static constexpr uint32_t build_chunk = 16384;   // refs per chunk, at least
+
+    // Counting-sort output: bucket b owns cell_items_[cell_start_[b] .. cell_start_[b + 1])
+    std::vector<uint32_t> cell_start_;
+    std::vector<uint32_t> cell_items_;
+    uint32_t bucket_mask_ = 0;
+    bool built_ = false;
+    Vec2f bounds_min_, bounds_max_;
+
+    // Per-query dedupe: an entry is reported once per stamp value
+    mutable std::vector<uint32_t> stamps_;
+    mutable uint32_t stamp_ = 0;
 
-    CellKey to_cell(float x, float y) const;
+    CellCoord to_cell(float x, float y) const;
+    static uint32_t cell_hash(int32_t cx, int32_t cy);
+    uint32_t bucket_of(int32_t cx, int32_t cy) const;
+    uint32_t next_stamp() const;
 };
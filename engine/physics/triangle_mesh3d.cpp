@@ -0,0 +1,74 @@
+#include "triangle_mesh3d.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+Aabb3D merge(const Aabb3D& a, const Aabb3D& b) {
+    return {{std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z)},
+            {std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z)}};
+}
+
+} // namespace
+
+TriangleMesh3D::TriangleMesh3D(std::vector<Vec3f> vertices, std::vector<uint32_t> indices)
+    : vertices_(std::move(vertices)), indices_(std::move(indices)) {
+    indices_.resize(indices_.size() - indices_.size() % 3);
+    auto count = static_cast<uint32_t>(triangle_count());
+    if (count == 0) return;
+
+    // Per-triangle bounds and centroids, indexed by triangle while building
+    std::vector<Vec3f> centroids(count);
+    triangle_bounds_.resize(count);
+    for (uint32_t t = 0; t < count; ++t) {
+        Vec3f a, b, c;
+        triangle(t, a, b, c);
+        triangle_bounds_[t] = merge({a, a}, merge({b, b}, {c, c}));
+        centroids[t] = (a + b + c) * (1.0f / 3.0f);
+    }
+
+    order_.resize(count);
+    std::iota(order_.begin(), order_.end(), 0u);
+    nodes_.reserve(2 * (count / leaf_size + 1));
+    build_node(0, count, centroids);
+
+    // Leaf order from here on
+    std::vector<Aabb3D> by_triangle = std::move(triangle_bounds_);
+    triangle_bounds_.resize(count);
+    for (uint32_t k = 0; k < count; ++k) triangle_bounds_[k] = by_triangle[order_[k]];
+}
+
+void TriangleMesh3D::build_node(uint32_t begin, uint32_t end,
+                                const std::vector<Vec3f>& centroids) {
+    auto index = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back({});
+
+    Aabb3D bounds = triangle_bounds_[order_[begin]];
+    Aabb3D centers{centroids[order_[begin]], centroids[order_[begin]]};
+    for (uint32_t k = begin + 1; k < end; ++k) {
+        bounds = merge(bounds, triangle_bounds_[order_[k]]);
+        Vec3f c = centroids[order_[k]];
+        centers = merge(centers, {c, c});
+    }
+
+    if (end - begin <= leaf_size) {
+        nodes_[index] = {bounds, begin, end - begin};
+        return;
+    }
+
+    // Median split along the longest centroid axis
+    Vec3f size = centers.max - centers.min;
+    int axis = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+    auto key = [&](uint32_t t) {
+        Vec3f c = centroids[t];
+        return axis == 0 ? c.x : (axis == 1 ? c.y : c.z);
+    };
+    uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(order_.begin() + begin, order_.begin() + mid, order_.begin() + end,
+                     [&](uint32_t a, uint32_t b) { return key(a) < key(b); });
+
+    build_node(begin, mid, centroids);
+    auto right = static_cast<uint32_t>(nodes_.size());
+    build_node(mid, end, centroids);
+    nodes_[index] = {bounds, right, 0};
+}
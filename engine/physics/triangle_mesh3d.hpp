@@ -0,0 +1,112 @@
+#pragma once
+#include "collision_shape3d.hpp"
+#include "../math/vec3.hpp"
+#include <vector>
+#include <cstdint>
+
+// Static triangle mesh collision data with its own bounding volume
+// hierarchy, shared between bodies through TriangleMeshShape.
+//
+// The BVH is built once by median splits along the longest axis of the
+// triangle centroids, with up to leaf_size triangles per leaf; nodes are
+// stored depth-first so a node's left child directly follows it. Triangles
+// are one-sided: the counter-clockwise side is solid-facing-out, and shapes
+// whose center lies behind a triangle ignore it.
+class TriangleMesh3D {
+public:
+    static constexpr uint32_t leaf_size = 4;
+
+    // indices: three per triangle, counter-clockwise seen from outside
+    TriangleMesh3D(std::vector<Vec3f> vertices, std::vector<uint32_t> indices);
+
+    size_t triangle_count() const { return indices_.size() / 3; }
+    void triangle(uint32_t t, Vec3f& a, Vec3f& b, Vec3f& c) const {
+        a = vertices_[indices_[3 * t]];
+        b = vertices_[indices_[3 * t + 1]];
+        c = vertices_[indices_[3 * t + 2]];
+    }
+
+    const std::vector<Vec3f>& vertices() const { return vertices_; }
+    const std::vector<uint32_t>& indices() const { return indices_; }
+    // Local-space bounds of the whole mesh
+    const Aabb3D& bounds() const { return nodes_.empty() ? empty_bounds_ : nodes_[0].bounds; }
+    size_t node_count() const { return nodes_.size(); }
+
+    // Calls fn(triangle index) for every triangle whose bounds overlap box
+    // (mesh local space)
+    template <typename Fn>
+    void query(const Aabb3D& box, Fn&& fn) const {
+        if (nodes_.empty()) return;
+        uint32_t stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes_[stack[--top]];
+            if (!node.bounds.overlaps(box)) continue;
+            if (node.count > 0) {
+                for (uint32_t k = node.first; k < node.first + node.count; ++k) {
+                    if (triangle_bounds_[k].overlaps(box)) fn(order_[k]);
+                }
+            } else {
+                // Median splits keep the depth near log2(n), well inside the stack
+                uint32_t index = static_cast<uint32_t>(&node - nodes_.data());
+                stack[top++] = node.first;  // right child
+                stack[top++] = index + 1;   // left child, visited first
+            }
+        }
+    }
+
+    // Calls fn(triangle index) for every triangle whose bounds, grown by
+    // radius, the ray origin + t * direction enters for t in
+    // [0, max_distance], nearer nodes first (mesh local space). fn returns
+    // the new max_distance, so a closest-hit search skips whatever lies
+    // beyond its best hit so far.
+    template <typename Fn>
+    void query_ray(Vec3f origin, Vec3f direction, float max_distance, float radius, Fn&& fn) const {
+        if (nodes_.empty()) return;
+        Vec3f inv = ray_inverse(direction);
+        Vec3f pad{radius, radius, radius};
+        auto entry = [&](const Aabb3D& b) {
+            return Aabb3D{b.min - pad, b.max + pad}.ray_entry(origin, inv, max_distance);
+        };
+
+        struct Item { uint32_t node; float t; };
+        Item stack[64];
+        int top = 0;
+        float t_root = entry(nodes_[0].bounds);
+        if (t_root >= 0.0f) stack[top++] = {0, t_root};
+        while (top > 0) {
+            Item item = stack[--top];
+            if (item.t > max_distance) continue;
+            const Node& node = nodes_[item.node];
+            if (node.count > 0) {
+                for (uint32_t k = node.first; k < node.first + node.count; ++k) {
+                    if (entry(triangle_bounds_[k]) >= 0.0f) max_distance = fn(order_[k]);
+                }
+                continue;
+            }
+            // Push the farther child first so the nearer one is visited first
+            Item left{item.node + 1, entry(nodes_[item.node + 1].bounds)};
+            Item right{node.first, entry(nodes_[node.first].bounds)};
+            if (left.t >= 0.0f && right.t >= 0.0f && right.t < left.t) std::swap(left, right);
+            if (right.t >= 0.0f) stack[top++] = right;
+            if (left.t >= 0.0f) stack[top++] = left;
+        }
+    }
+
+private:
+    struct Node {
+        Aabb3D bounds;
+        uint32_t first;   // leaf: first entry in order_; interior: right child
+        uint32_t count;   // triangles in a leaf, 0 for interior nodes
+    };
+
+    std::vector<Vec3f> vertices_;
+    std::vector<uint32_t> indices_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> order_;            // triangle indices in leaf order
+    std::vector<Aabb3D> triangle_bounds_;    // bounds of order_[k]
+    Aabb3D empty_bounds_{};
+
+    void build_node(uint32_t begin, uint32_t end, const std::vector<Vec3f>& centroids);
+};
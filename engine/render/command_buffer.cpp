@@ -0,0 +1,182 @@
+#include "command_buffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+constexpr uint32_t radix_bits = 8;
+constexpr uint32_t radix_buckets = 1u << radix_bits;
+// Keys per radix job; every pass splits the buffer the same way
+constexpr uint32_t radix_chunk = 4096;
+// Below this a comparison sort is faster than eight histogram passes
+constexpr size_t radix_min_size = 1024;
+
+// Ordered mode drops the state fields push() filled in, the low bits
+uint64_t sort_mask(CommandBuffer::SortMode mode) {
+    if (mode == CommandBuffer::SortMode::State) return ~0ull;
+    return ~((1ull << (RenderSortKey::material_bits + RenderSortKey::texture_bits)) - 1);
+}
+
+} // namespace
+
+void CommandBuffer::merge(const CommandBuffer& other) {
+    entries_.reserve(entries_.size() + other.entries_.size());
+    keys_.reserve(keys_.size() + other.keys_.size());
+    for (CommandView cmd : other) {
+        size_t size = cmd.header().size;
+        void* payload = append(cmd.type(), size, cmd.sort_key(), cmd.header().flags);
+        std::memcpy(payload, &cmd.header() + 1, size);
+
+        // The copy still points at the other buffer's arena
+        switch (cmd.type()) {
+            case RenderCommandType::DrawText:
+                copy_to_arena(*static_cast<RenderCmd_DrawText*>(payload));
+                break;
+            case RenderCommandType::DrawSkinnedMesh:
+                copy_to_arena(*static_cast<RenderCmd_DrawSkinnedMesh*>(payload));
+                break;
+            case RenderCommandType::DrawTextBatch:
+                copy_to_arena(*static_cast<RenderCmd_DrawTextBatch*>(payload));
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void CommandBuffer::merge(CommandBuffer&& other) {
+    if (this == &other) return;
+    if (empty()) {
+        // Nothing to keep: take the whole buffer, keeping our sort key
+        RenderSortKey key = sort_key_;
+        std::swap(arena_, other.arena_);
+        std::swap(entries_, other.entries_);
+        std::swap(keys_, other.keys_);
+        std::swap(stream_bytes_, other.stream_bytes_);
+        sort_key_ = key;
+        other.clear();
+        return;
+    }
+
+    // The commands stay in other's blocks, which now belong to this arena
+    arena_.splice(std::move(other.arena_));
+    entries_.insert(entries_.end(), other.entries_.begin(), other.entries_.end());
+    keys_.insert(keys_.end(), other.keys_.begin(), other.keys_.end());
+    stream_bytes_ += other.stream_bytes_;
+    other.clear();
+}
+
+void CommandBuffer::sort(SortMode mode, JobSystem& jobs) {
+    size_t n = entries_.size();
+    if (n < 2 || std::is_sorted(keys_.begin(), keys_.end())) return;
+
+    uint64_t mask = sort_mask(mode);
+
+    // Barriers stay where they were recorded; only the runs between them sort
+    size_t first = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (is_sort_barrier(reinterpret_cast<const Header*>(entries_[i])->type)) {
+            sort_run(first, i, mask, jobs);
+            first = i + 1;
+        }
+    }
+    sort_run(first, n, mask, jobs);
+}
+
+bool CommandBuffer::is_sorted(SortMode mode) const {
+    if (std::is_sorted(keys_.begin(), keys_.end())) return true;
+    uint64_t mask = sort_mask(mode);
+    uint64_t previous = 0;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        const auto* header = reinterpret_cast<const Header*>(entries_[i]);
+        if (is_sort_barrier(header->type)) {
+            previous = 0;
+            continue;
+        }
+        uint64_t key = header->flags & CommandView::state_from_command ? keys_[i] & mask : keys_[i];
+        if (key < previous) return false;
+        previous = key;
+    }
+    return true;
+}
+
+void CommandBuffer::sort_run(size_t first, size_t last, uint64_t mask, JobSystem& jobs) {
+    size_t n = last - first;
+    if (n < 2) return;
+    run_keys_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto* header = reinterpret_cast<const Header*>(entries_[first + i]);
+        bool masked = header->flags & CommandView::state_from_command;
+        run_keys_[i] = masked ? keys_[first + i] & mask : keys_[first + i];
+    }
+    if (std::is_sorted(run_keys_.begin(), run_keys_.end())) return;
+
+    order_.resize(n);
+    std::iota(order_.begin(), order_.end(), 0u);
+
+    if (n < radix_min_size) {
+        std::stable_sort(order_.begin(), order_.end(),
+                         [this](uint32_t a, uint32_t b) { return run_keys_[a] < run_keys_[b]; });
+    } else {
+        auto count = static_cast<uint32_t>(n);
+        uint32_t chunks = (count + radix_chunk - 1) / radix_chunk;
+        key_scratch_.resize(n);
+        order_scratch_.resize(n);
+
+        uint64_t varying = 0;
+        for (uint64_t key : run_keys_) varying |= key ^ run_keys_[0];
+
+        for (uint32_t shift = 0; shift < 64; shift += radix_bits) {
+            if (((varying >> shift) & (radix_buckets - 1)) == 0) continue;
+
+            // Per-chunk digit counts
+            histograms_.assign(static_cast<size_t>(chunks) * radix_buckets, 0);
+            jobs.parallel_for(0, chunks, 1, [this, shift, count](uint32_t first, uint32_t last) {
+                for (uint32_t c = first; c < last; ++c) {
+                    uint32_t* hist = &histograms_[c * radix_buckets];
+                    uint32_t end = std::min(count, (c + 1) * radix_chunk);
+                    for (uint32_t i = c * radix_chunk; i < end; ++i) {
+                        ++hist[(run_keys_[i] >> shift) & (radix_buckets - 1)];
+                    }
+                }
+            });
+
+            // Exclusive prefix sum in (digit, chunk) order: each chunk's run
+            // of a digit lands after the earlier chunks', keeping the sort stable
+            uint32_t offset = 0;
+            for (uint32_t d = 0; d < radix_buckets; ++d) {
+                for (uint32_t c = 0; c < chunks; ++c) {
+                    uint32_t& slot = histograms_[c * radix_buckets + d];
+                    uint32_t digits = slot;
+                    slot = offset;
+                    offset += digits;
+                }
+            }
+
+            jobs.parallel_for(0, chunks, 1, [this, shift, count](uint32_t first, uint32_t last) {
+                for (uint32_t c = first; c < last; ++c) {
+                    uint32_t* hist = &histograms_[c * radix_buckets];
+                    uint32_t end = std::min(count, (c + 1) * radix_chunk);
+                    for (uint32_t i = c * radix_chunk; i < end; ++i) {
+                        uint32_t dst = hist[(run_keys_[i] >> shift) & (radix_buckets - 1)]++;
+                        key_scratch_[dst] = run_keys_[i];
+                        order_scratch_[dst] = order_[i];
+                    }
+                }
+            });
+            std::swap(run_keys_, key_scratch_);
+            std::swap(order_, order_scratch_);
+        }
+    }
+
+    // Apply the permutation to the run's index and keys; the commands stay put
+    entry_scratch_.resize(n);
+    key_scratch_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        entry_scratch_[i] = entries_[first + order_[i]];
+        key_scratch_[i] = keys_[first + order_[i]];
+    }
+    std::copy(entry_scratch_.begin(), entry_scratch_.end(), entries_.begin() + static_cast<ptrdiff_t>(first));
+    std::copy(key_scratch_.begin(), key_scratch_.end(), keys_.begin() + static_cast<ptrdiff_t>(first));
+}
@@ -1,42 +1,285 @@
 #pragma once
 #include "render_command.hpp"
+#include "frame_arena.hpp"
+#include "../core/assert.hpp"
+#include "../core/job_system.hpp"
 #include <vector>
 #include <mutex>
+#include <new>
 #include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Packed 64-bit draw order key, most significant field first:
+//
+//   stage (4) | layer (8) | depth (20) | material (16) | texture (16)
+//
+// Sorting by the packed value groups commands by stage and layer, orders
+// them by depth inside a layer, and runs draws at equal depth together by
+// material and then texture, so the backend changes pipeline and texture
+// state once per run instead of once per draw. Wider values are truncated
+// to their field; material and texture keep the low bits of their ids.
+struct RenderSortKey {
+    static constexpr int stage_bits = 4;
+    static constexpr int layer_bits = 8;
+    static constexpr int depth_bits = 20;
+    static constexpr int material_bits = 16;
+    static constexpr int texture_bits = 16;
+
+    uint32_t stage = 0;
+    uint32_t layer = 0;
+    uint32_t depth = 0;      // see quantize_depth()
+    uint32_t material = 0;
+    uint32_t texture = 0;
+
+    constexpr uint64_t pack() const {
+        auto field = [](uint32_t v, int bits) { return static_cast<uint64_t>(v) & ((1ull << bits) - 1); };
+        return field(stage, stage_bits) << (layer_bits + depth_bits + material_bits + texture_bits) |
+               field(layer, layer_bits) << (depth_bits + material_bits + texture_bits) |
+               field(depth, depth_bits) << (material_bits + texture_bits) |
+               field(material, material_bits) << texture_bits |
+               field(texture, texture_bits);
+    }
+
+    static constexpr RenderSortKey unpack(uint64_t key) {
+        auto field = [key](int shift, int bits) {
+            return static_cast<uint32_t>((key >> shift) & ((1ull << bits) - 1));
+        };
+        return {field(layer_bits + depth_bits + material_bits + texture_bits, stage_bits),
+                field(depth_bits + material_bits + texture_bits, layer_bits),
+                field(material_bits + texture_bits, depth_bits),
+                field(texture_bits, material_bits),
+                field(0, texture_bits)};
+    }
+
+    // Depth in [0, 1] (clamped) to the depth field: near first, or far
+    // first with back_to_front for blended passes
+    static uint32_t quantize_depth(float depth, bool back_to_front = false) {
+        constexpr float scale = static_cast<float>((1u << depth_bits) - 1);
+        float d = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+        if (back_to_front) d = 1.0f - d;
+        return static_cast<uint32_t>(d * scale + 0.5f);
+    }
+
+    // This key with material and texture taken from the command, for the
+    // commands that carry them
+    template <typename T>
+    RenderSortKey with_state_of(const T& cmd) const {
+        RenderSortKey key = *this;
+        if constexpr (std::is_same_v<T, RenderCmd_DrawMesh> ||
+                      std::is_same_v<T, RenderCmd_DrawSkinnedMesh>) {
+            key.material = static_cast<uint32_t>(cmd.material_id);
+        } else if constexpr (std::is_same_v<T, RenderCmd_DrawSprite>) {
+            key.texture = static_cast<uint32_t>(cmd.texture.id);
+        } else if constexpr (std::is_same_v<T, RenderCmd_DrawTextBatch>) {
+            key.texture = static_cast<uint32_t>(cmd.font_atlas_texture);
+        }
+        return key;
+    }
+};
+
+// One recorded command: its type, its sort key, and the stored command.
+// Valid until the buffer holding the command is cleared.
+class CommandView {
+    const std::byte* entry_ = nullptr;
+    uint64_t key_ = 0;
+
+public:
+    struct Header {
+        RenderCommandType type;
+        uint16_t flags;
+        uint32_t size;     // payload bytes
+    };
+    // The key's material and texture came from the command (push() without
+    // a key), not from the caller
+    static constexpr uint16_t state_from_command = 1;
+    static constexpr size_t alignment = 8;  // of headers and payloads
+
+    CommandView() = default;
+    CommandView(const std::byte* entry, uint64_t key) : entry_(entry), key_(key) {}
+
+    RenderCommandType type() const { return header().type; }
+    uint64_t sort_key() const { return key_; }
+
+    template <typename T>
+    bool is() const { return type() == T::type; }
+
+    template <typename T>
+    const T& as() const {
+        ERGO_DEBUG_ASSERT(is<T>(), "CommandView::as: wrong command type");
+        return *reinterpret_cast<const T*>(entry_ + sizeof(Header));
+    }
+
+    template <typename T>
+    const T* get_if() const { return is<T>() ? &as<T>() : nullptr; }
+
+    const Header& header() const { return *reinterpret_cast<const Header*>(entry_); }
+};
 
 // Thread-safe command buffer for accumulating render commands from multiple threads
 // Each worker thread can have its own CommandBuffer, then merge into the main one
+//
+// Commands are packed back to back into the buffer's FrameArena: an 8-byte
+// header (type and payload size) followed by the command itself, so a rect
+// costs its own size rather than the size of the largest command. Text,
+// vertices and bone matrices are copied into the same arena. The buffer
+// indexes its commands by address, and reading goes through that index:
+// operator[] and iteration yield a CommandView, which tells the type and
+// hands out the stored command.
+//
+// merge() of an rvalue splices the other buffer's arena blocks onto this
+// one and appends its index, so collecting worker buffers copies no
+// commands; merging a const buffer copies them. clear() resets the arena,
+// keeping its first block and the index capacity for the next frame.
+//
+// Every command carries a packed RenderSortKey. push() without a key uses
+// the current key (set_sort_key) with the command's own material and
+// texture filled in. sort() reorders the index by key with a stable
+// parallel radix sort, so commands with equal keys keep their recording
+// order; the stream itself is never moved.
 
 class CommandBuffer {
-    std::vector<RenderCommand> commands_;
-    uint32_t sort_key_ = 0;  // For command ordering
+    using Header = CommandView::Header;
+
+    FrameArena arena_;                      // commands and their variable-length data
+    std::vector<const std::byte*> entries_; // each command's header, in sort order
+    std::vector<uint64_t> keys_;            // one per command, parallel to entries_
+    size_t stream_bytes_ = 0;               // headers and payloads in arena_
+    RenderSortKey sort_key_;                // for push() without a key
+
+    // sort() scratch, kept to avoid reallocating every frame
+    std::vector<uint32_t> order_, order_scratch_;
+    std::vector<uint64_t> run_keys_, key_scratch_;
+    std::vector<const std::byte*> entry_scratch_;
+    std::vector<uint32_t> histograms_;
+
+    // Appends a header and room for size payload bytes; returns the payload
+    void* append(RenderCommandType type, size_t size, uint64_t key, uint16_t flags = 0) {
+        size_t bytes = sizeof(Header) + size;
+        auto* entry = static_cast<std::byte*>(arena_.allocate(bytes, CommandView::alignment));
+        Header header{type, flags, static_cast<uint32_t>(size)};
+        std::memcpy(entry, &header, sizeof(Header));
+        entries_.push_back(entry);
+        keys_.push_back(key);
+        stream_bytes_ += bytes;
+        return entry + sizeof(Header);
+    }
+
+    template <typename T>
+    void push_with_flags(const T& cmd, uint64_t key, uint16_t flags) {
+        static_assert(std::is_trivially_copyable_v<T>, "render commands are stored by memcpy");
+        static_assert(alignof(T) <= CommandView::alignment, "render command over-aligned");
+        auto* stored = new (append(T::type, sizeof(T), key, flags)) T(cmd);
+        copy_to_arena(*stored);
+    }
+
+    // Stable sort of [first, last) by key, with mask applied to keys whose
+    // state fields came from the command
+    void sort_run(size_t first, size_t last, uint64_t mask, JobSystem& jobs);
+
+    // Moves a stored command's variable-length data into this buffer's arena
+    template <typename T>
+    void copy_to_arena(T& cmd) {
+        if constexpr (std::is_same_v<T, RenderCmd_DrawText>) {
+            cmd.text = arena_.copy(cmd.text);
+        } else if constexpr (std::is_same_v<T, RenderCmd_DrawSkinnedMesh>) {
+            cmd.bone_matrices = arena_.copy(cmd.bone_matrices);
+        } else if constexpr (std::is_same_v<T, RenderCmd_DrawTextBatch>) {
+            cmd.vertices = arena_.copy(cmd.vertices);
+            cmd.indices = arena_.copy(cmd.indices);
+        }
+    }
 
 public:
-    CommandBuffer() { commands_.reserve(1024); }
+    class Iterator {
+        const CommandBuffer* buffer_ = nullptr;
+        size_t index_ = 0;
+
+    public:
+        using value_type = CommandView;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        Iterator(const CommandBuffer* buffer, size_t index) : buffer_(buffer), index_(index) {}
+
+        CommandView operator*() const { return (*buffer_)[index_]; }
+        Iterator& operator++() { ++index_; return *this; }
+        Iterator operator++(int) { Iterator it = *this; ++index_; return it; }
+        bool operator==(const Iterator& other) const { return index_ == other.index_; }
+    };
+
+    CommandBuffer() = default;
+
+    // Copies would have to re-point every command at a new arena; merge()
+    // does that explicitly
+    CommandBuffer(CommandBuffer&&) noexcept = default;
+    CommandBuffer& operator=(CommandBuffer&&) noexcept = default;
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
 
     void clear() {
-        commands_.clear();
-        sort_key_ = 0;
+        arena_.reset();
+        entries_.clear();
+        keys_.clear();
+        stream_bytes_ = 0;
+        sort_key_ = {};
     }
 
-    void push(RenderCommand cmd) {
-        commands_.push_back(std::move(cmd));
+    // Key for the commands pushed from now on
+    void set_sort_key(const RenderSortKey& key) { sort_key_ = key; }
+    const RenderSortKey& sort_key() const { return sort_key_; }
+
+    template <typename T>
+    void push(const T& cmd, uint64_t key) {
+        push_with_flags(cmd, key, 0);
     }
 
-    template<typename T>
-    void push(T&& cmd) {
-        commands_.push_back(RenderCommand{std::forward<T>(cmd)});
+    template <typename T>
+    void push(const T& cmd) {
+        push_with_flags(cmd, sort_key_.with_state_of(cmd).pack(), CommandView::state_from_command);
     }
 
-    // Merge another buffer's commands (for multi-thread collection)
-    void merge(const CommandBuffer& other) {
-        commands_.insert(commands_.end(),
-                         other.commands_.begin(), other.commands_.end());
+    // Merge another buffer's commands (for multi-thread collection), in
+    // the other buffer's current order. The rvalue overload moves them
+    // and leaves other empty.
+    void merge(const CommandBuffer& other);
+    void merge(CommandBuffer&& other);
+
+    // Stable sort by key. Large buffers use an LSD radix sort whose passes
+    // run in chunks on jobs; 8-bit digits that are equal in every key (an
+    // unused stage or layer field, say) are skipped.
+    //
+    // Clear and SetViewProjection are barriers: they keep their place and
+    // only the runs of commands between them are sorted, so a draw never
+    // moves across the state it was recorded under. State mode sorts by the
+    // whole key; Ordered mode ignores the material and texture that push()
+    // without a key filled in, so such draws keep their recording
+    // (painter's) order unless their stage, layer or depth differ, as
+    // blended passes need. Keys given explicitly always sort whole.
+    enum class SortMode { State, Ordered };
+    void sort(SortMode mode = SortMode::State, JobSystem& jobs = g_job_system);
+    void sort(JobSystem& jobs) { sort(SortMode::State, jobs); }
+    // Whether sort(mode) would leave the order unchanged
+    bool is_sorted(SortMode mode = SortMode::State) const;
+
+    static constexpr bool is_sort_barrier(RenderCommandType type) {
+        return type == RenderCommandType::Clear || type == RenderCommandType::SetViewProjection;
     }
 
-    const std::vector<RenderCommand>& commands() const { return commands_; }
-    size_t size() const { return commands_.size(); }
-    bool empty() const { return commands_.empty(); }
+    CommandView operator[](size_t i) const {
+        return {entries_[i], keys_[i]};
+    }
+    Iterator begin() const { return {this, 0}; }
+    Iterator end() const { return {this, entries_.size()}; }
+
+    const std::vector<uint64_t>& sort_keys() const { return keys_; }
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+    // Recorded bytes: the packed commands, and the variable-length data
+    // they point at
+    size_t stream_bytes() const { return stream_bytes_; }
+    size_t arena_bytes() const { return arena_.bytes_used() - stream_bytes_; }
 };
 
 // Thread-safe wrapper for merging command buffers from multiple worker threads
@@ -45,6 +288,14 @@ class SharedCommandCollector {
     CommandBuffer merged_;
 
 public:
+    // Moves the buffer's commands in without copying them; buffer is left
+    // empty and ready for reuse
+    void submit(CommandBuffer&& buffer) {
+        std::lock_guard lock(mutex_);
+        merged_.merge(std::move(buffer));
+    }
+
+    // Copies the commands, for callers that keep their buffer
     void submit(const CommandBuffer& buffer) {
         std::lock_guard lock(mutex_);
         merged_.merge(buffer);
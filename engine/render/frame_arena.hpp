@@ -0,0 +1,135 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Linear allocator for data that lives for one frame.
+//
+// Allocations are bumped out of fixed-size blocks and never freed one by
+// one. Blocks never move, so pointers stay valid until reset(), across a
+// move of the arena and across splice() into another arena, which hands
+// over the filled blocks without copying them.
+//
+// reset() keeps the first block and returns the rest to a pool shared by
+// every arena, where whichever arena runs out next picks them up. Blocks
+// spliced from worker buffers into a frame's buffer thus flow back to the
+// workers, and a steady-state frame allocates nothing from the heap.
+class FrameArena {
+public:
+    static constexpr size_t block_size = 64 * 1024;
+
+    FrameArena() = default;
+    FrameArena(FrameArena&&) noexcept = default;
+    FrameArena& operator=(FrameArena&&) noexcept = default;
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // align must be a power of two no larger than the default new alignment
+    void* allocate(size_t size, size_t align) {
+        for (; current_ < blocks_.size(); ++current_, offset_ = 0) {
+            Block& block = blocks_[current_];
+            auto base = reinterpret_cast<uintptr_t>(block.data.get());
+            size_t start = ((base + offset_ + align - 1) & ~(align - 1)) - base;
+            if (start + size <= block.size) {
+                offset_ = start + size;
+                used_ += size;
+                return block.data.get() + start;
+            }
+        }
+        blocks_.push_back(acquire_block(size > block_size ? size : block_size));
+        current_ = blocks_.size() - 1;
+        offset_ = size;
+        used_ += size;
+        return blocks_.back().data.get();
+    }
+
+    // Copy of data in the arena; empty spans stay empty
+    template <typename T>
+    std::span<const T> copy(std::span<const T> data) {
+        if (data.empty()) return {};
+        void* dst = allocate(data.size_bytes(), alignof(T));
+        std::memcpy(dst, data.data(), data.size_bytes());
+        return {static_cast<const T*>(dst), data.size()};
+    }
+
+    std::string_view copy(std::string_view text) {
+        auto chars = copy(std::span<const char>(text.data(), text.size()));
+        return {chars.data(), chars.size()};
+    }
+
+    // Takes over other's filled blocks; everything allocated from either
+    // arena stays where it is. Allocation here continues in this arena's
+    // current block, and other keeps its unused blocks, empty.
+    void splice(FrameArena&& other) {
+        size_t filled = other.current_;
+        if (other.current_ < other.blocks_.size() && other.offset_ > 0) ++filled;
+        // Spliced blocks go before the current block, where allocate() no longer looks
+        blocks_.insert(blocks_.begin() + static_cast<std::ptrdiff_t>(current_),
+                       std::make_move_iterator(other.blocks_.begin()),
+                       std::make_move_iterator(other.blocks_.begin() + static_cast<std::ptrdiff_t>(filled)));
+        other.blocks_.erase(other.blocks_.begin(), other.blocks_.begin() + static_cast<std::ptrdiff_t>(filled));
+        current_ += filled;
+        used_ += other.used_;
+        other.current_ = 0;
+        other.offset_ = 0;
+        other.used_ = 0;
+    }
+
+    void reset() {
+        if (blocks_.size() > 1) {
+            BlockPool& spare = pool();
+            std::lock_guard lock(spare.mutex);
+            for (size_t i = 1; i < blocks_.size(); ++i) spare.blocks.push_back(std::move(blocks_[i]));
+            blocks_.resize(1);
+        }
+        current_ = 0;
+        offset_ = 0;
+        used_ = 0;
+    }
+
+    // Bytes handed out since the last reset, spliced blocks included
+    // (excluding alignment padding)
+    size_t bytes_used() const { return used_; }
+    size_t block_count() const { return blocks_.size(); }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size = 0;
+    };
+
+    struct BlockPool {
+        std::mutex mutex;
+        std::vector<Block> blocks;
+    };
+
+    static BlockPool& pool() {
+        static BlockPool instance;
+        return instance;
+    }
+
+    static Block acquire_block(size_t size) {
+        {
+            BlockPool& spare = pool();
+            std::lock_guard lock(spare.mutex);
+            for (size_t i = spare.blocks.size(); i-- > 0;) {
+                if (spare.blocks[i].size < size) continue;
+                Block block = std::move(spare.blocks[i]);
+                spare.blocks[i] = std::move(spare.blocks.back());
+                spare.blocks.pop_back();
+                return block;
+            }
+        }
+        return {std::make_unique<std::byte[]>(size), size};
+    }
+
+    std::vector<Block> blocks_;
+    size_t current_ = 0;   // block being filled
+    size_t offset_ = 0;    // bytes used in blocks_[current_]
+    size_t used_ = 0;
+};
@@ -0,0 +1,253 @@
+#include "gpu_upload_queue.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+template <typename T>
+T align_up(T value, T align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+// Staging offsets suit both buffer and image copies (texel size and 4)
+constexpr size_t staging_align = 16;
+constexpr uint64_t vertex_align = 16;
+constexpr uint64_t index_align = 4;
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// DeviceHeapAllocator
+// ---------------------------------------------------------------------------
+
+GpuAllocation DeviceHeapAllocator::allocate(uint64_t size, uint64_t align) {
+    if (size == 0) return {};
+    for (uint32_t h = 0; h < heaps_.size(); ++h) {
+        auto& free = heaps_[h].free;
+        for (size_t i = 0; i < free.size(); ++i) {
+            Range r = free[i];
+            uint64_t offset = align_up(r.offset, align);
+            if (offset + size > r.offset + r.size) continue;
+
+            // Alignment padding stays free in front, the remainder after
+            Range front{r.offset, offset - r.offset};
+            Range back{offset + size, r.offset + r.size - (offset + size)};
+            free.erase(free.begin() + static_cast<ptrdiff_t>(i));
+            if (back.size) free.insert(free.begin() + static_cast<ptrdiff_t>(i), back);
+            if (front.size) free.insert(free.begin() + static_cast<ptrdiff_t>(i), front);
+            allocated_ += size;
+            return {h, offset, size};
+        }
+    }
+
+    Heap heap;
+    heap.size = std::max(heap_size_, size);
+    if (heap.size > size) heap.free.push_back({size, heap.size - size});
+    heaps_.push_back(std::move(heap));
+    allocated_ += size;
+    return {static_cast<uint32_t>(heaps_.size() - 1), 0, size};
+}
+
+void DeviceHeapAllocator::free(const GpuAllocation& allocation) {
+    if (!allocation.valid() || allocation.heap >= heaps_.size()) return;
+    auto& free = heaps_[allocation.heap].free;
+    auto it = std::lower_bound(free.begin(), free.end(), allocation.offset,
+                               [](const Range& r, uint64_t offset) { return r.offset < offset; });
+    it = free.insert(it, {allocation.offset, allocation.size});
+    allocated_ -= allocation.size;
+
+    // Coalesce with the following, then the preceding range
+    auto next = it + 1;
+    if (next != free.end() && it->offset + it->size == next->offset) {
+        it->size += next->size;
+        free.erase(next);
+    }
+    if (it != free.begin()) {
+        auto prev = it - 1;
+        if (prev->offset + prev->size == it->offset) {
+            prev->size += it->size;
+            free.erase(it);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// StagingRing
+// ---------------------------------------------------------------------------
+
+size_t StagingRing::allocate(size_t size, size_t align, uint64_t fence) {
+    if (size == 0 || size > capacity_) return npos;
+    if (!memory_) memory_ = std::make_unique_for_overwrite<std::byte[]>(capacity_);
+
+    size_t offset = 0;
+    if (!in_flight_.empty()) {
+        size_t head = in_flight_.back().end;
+        size_t tail = in_flight_.front().begin;
+        size_t aligned = align_up(head, align);
+        if (head > tail) {
+            // Free space is [head, capacity) then [0, tail)
+            if (aligned + size <= capacity_) offset = aligned;
+            else if (size <= tail) offset = 0;
+            else return npos;
+        } else {
+            // Wrapped: free space is [head, tail)
+            if (aligned + size > tail) return npos;
+            offset = aligned;
+        }
+    }
+
+    if (!in_flight_.empty() && in_flight_.back().fence == fence && offset >= in_flight_.back().end) {
+        in_flight_.back().end = offset + size;
+    } else {
+        in_flight_.push_back({offset, offset + size, fence});
+    }
+    return offset;
+}
+
+void StagingRing::retire(uint64_t completed_fence) {
+    while (!in_flight_.empty() && in_flight_.front().fence <= completed_fence) {
+        in_flight_.pop_front();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// GpuUploadQueue
+// ---------------------------------------------------------------------------
+
+size_t GpuUploadQueue::stage(const void* data, size_t size, size_t align) {
+    size_t offset = staging_.allocate(size, align, next_fence_);
+    if (offset != StagingRing::npos) std::memcpy(staging_.data() + offset, data, size);
+    return offset;
+}
+
+void GpuUploadQueue::assign_mesh_ranges(MeshData& mesh, uint64_t vertex_bytes, uint64_t index_bytes) {
+    // Re-uploads replace the mesh's previous ranges
+    for (uint64_t handle : {mesh.gpu_vertex_buffer, mesh.gpu_index_buffer}) {
+        release_locked(handle);
+    }
+
+    GpuAllocation vb = heaps_.allocate(vertex_bytes, vertex_align);
+    buffers_[vb.handle()] = vb;
+    mesh.gpu_vertex_buffer = vb.handle();
+    mesh.gpu_index_buffer = 0;
+    if (index_bytes) {
+        GpuAllocation ib = heaps_.allocate(index_bytes, index_align);
+        buffers_[ib.handle()] = ib;
+        mesh.gpu_index_buffer = ib.handle();
+    }
+}
+
+bool GpuUploadQueue::enqueue_mesh(MeshData& mesh) {
+    uint64_t vertex_bytes = mesh.vertices.size() * sizeof(Vertex);
+    uint64_t index_bytes = mesh.indices.size() * sizeof(uint32_t);
+    if (vertex_bytes == 0) return true;
+
+    std::lock_guard lock(mutex_);
+    // Both streams in one staging block so the mesh is staged whole or not at all
+    size_t index_at = align_up<size_t>(vertex_bytes, staging_align);
+    if (index_at + index_bytes > staging_.capacity()) {
+        return enqueue_split_mesh(mesh, vertex_bytes, index_bytes);
+    }
+    size_t offset = staging_.allocate(index_at + index_bytes, staging_align, next_fence_);
+    if (offset == StagingRing::npos) return false;
+    std::memcpy(staging_.data() + offset, mesh.vertices.data(), vertex_bytes);
+    if (index_bytes) std::memcpy(staging_.data() + offset + index_at, mesh.indices.data(), index_bytes);
+
+    assign_mesh_ranges(mesh, vertex_bytes, index_bytes);
+    recording_.buffers.push_back({offset, buffers_[mesh.gpu_vertex_buffer]});
+    if (index_bytes) recording_.buffers.push_back({offset + index_at, buffers_[mesh.gpu_index_buffer]});
+    mesh.upload_fence = next_fence_;
+    mesh.upload_staged = 0;
+    mesh.uploaded = true;
+    return true;
+}
+
+bool GpuUploadQueue::enqueue_split_mesh(MeshData& mesh, uint64_t vertex_bytes, uint64_t index_bytes) {
+    // Vertices then indices, as one stream of pieces a quarter of the ring
+    // each, so later frames can refill the space earlier pieces free
+    if (mesh.upload_staged == 0) {
+        assign_mesh_ranges(mesh, vertex_bytes, index_bytes);
+        mesh.uploaded = false;
+    }
+    const GpuAllocation vb = buffers_[mesh.gpu_vertex_buffer];
+    const GpuAllocation ib = index_bytes ? buffers_[mesh.gpu_index_buffer] : GpuAllocation{};
+    const auto* vertices = reinterpret_cast<const std::byte*>(mesh.vertices.data());
+    const auto* indices = reinterpret_cast<const std::byte*>(mesh.indices.data());
+    uint64_t piece = std::max<uint64_t>(staging_align, staging_.capacity() / 4 & ~uint64_t{staging_align - 1});
+
+    while (mesh.upload_staged < vertex_bytes + index_bytes) {
+        bool vertex = mesh.upload_staged < vertex_bytes;
+        uint64_t at = vertex ? mesh.upload_staged : mesh.upload_staged - vertex_bytes;
+        uint64_t size = std::min(piece, (vertex ? vertex_bytes : index_bytes) - at);
+        size_t offset = stage((vertex ? vertices : indices) + at, static_cast<size_t>(size), staging_align);
+        if (offset == StagingRing::npos) return false;
+        const GpuAllocation& dst = vertex ? vb : ib;
+        recording_.buffers.push_back({offset, {dst.heap, dst.offset + at, size}});
+        mesh.upload_staged += size;
+    }
+    mesh.upload_fence = next_fence_;
+    mesh.upload_staged = 0;
+    mesh.uploaded = true;
+    return true;
+}
+
+bool GpuUploadQueue::enqueue_texture(uint64_t texture_id, const void* pixels,
+                                     uint32_t width, uint32_t height, uint32_t bytes_per_pixel) {
+    return enqueue_texture_region(texture_id, 0, 0, width, height, pixels, bytes_per_pixel);
+}
+
+bool GpuUploadQueue::enqueue_texture_region(uint64_t texture_id, uint32_t x, uint32_t y,
+                                            uint32_t width, uint32_t height, const void* pixels,
+                                            uint32_t bytes_per_pixel) {
+    size_t bytes = static_cast<size_t>(width) * height * bytes_per_pixel;
+    if (bytes == 0) return true;
+
+    std::lock_guard lock(mutex_);
+    size_t offset = stage(pixels, bytes, staging_align);
+    if (offset == StagingRing::npos) return false;
+    recording_.images.push_back({offset, texture_id, x, y, width, height, bytes_per_pixel});
+    return true;
+}
+
+void GpuUploadQueue::release_buffer(uint64_t handle) {
+    std::lock_guard lock(mutex_);
+    release_locked(handle);
+}
+
+void GpuUploadQueue::release_locked(uint64_t handle) {
+    auto it = buffers_.find(handle);
+    if (it == buffers_.end()) return;
+    // Draws recorded this frame may still read the range
+    releases_.push_back({it->second, next_fence_});
+    buffers_.erase(it);
+}
+
+const UploadBatch& GpuUploadQueue::submit() {
+    std::lock_guard lock(mutex_);
+    std::swap(submitted_, recording_);
+    submitted_.fence = next_fence_++;
+    recording_.buffers.clear();
+    recording_.images.clear();
+    return submitted_;
+}
+
+void GpuUploadQueue::retire(uint64_t completed_fence) {
+    std::lock_guard lock(mutex_);
+    completed_fence_ = std::max(completed_fence_, completed_fence);
+    staging_.retire(completed_fence_);
+    std::erase_if(releases_, [this](const Release& r) {
+        if (r.fence > completed_fence_) return false;
+        heaps_.free(r.allocation);
+        return true;
+    });
+}
+
+bool GpuUploadQueue::is_complete(uint64_t fence) const {
+    std::lock_guard lock(mutex_);
+    return fence <= completed_fence_;
+}
+
+uint64_t GpuUploadQueue::pending_fence() const {
+    std::lock_guard lock(mutex_);
+    return next_fence_;
+}
@@ -0,0 +1,176 @@
+#pragma once
+#include "mesh.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// GPU residency and upload batching, independent of the graphics API.
+//
+// Mesh, texture and atlas data is copied once into a persistent staging
+// ring (host-visible memory in a real backend) and given a range in one
+// of a few large device-local heaps. submit() closes the frame's copies
+// into one UploadBatch tagged with a fence value; the backend records
+// them on its transfer queue and signals that fence when the frame's
+// transfer and graphics work are both done (fences count frames). Once
+// retire() reports the fence complete, the ring space and any device
+// ranges released in that frame are reused. An empty batch needs no
+// submission; its fence is done when a later one is.
+
+// Range of a device heap; handle() packs it into the uint64 ids that
+// MeshData and textures carry
+struct GpuAllocation {
+    uint32_t heap = 0;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+
+    static constexpr int offset_bits = 48;
+
+    bool valid() const { return size != 0; }
+    uint64_t handle() const { return static_cast<uint64_t>(heap + 1) << offset_bits | offset; }
+};
+
+// First-fit sub-allocator over large device heaps. Free ranges are kept
+// sorted and coalesced per heap; a request no heap can hold opens a new
+// heap (a dedicated one if larger than heap_size).
+class DeviceHeapAllocator {
+public:
+    explicit DeviceHeapAllocator(uint64_t heap_size) : heap_size_(heap_size) {}
+
+    // align must be a power of two
+    GpuAllocation allocate(uint64_t size, uint64_t align);
+    void free(const GpuAllocation& allocation);
+
+    size_t heap_count() const { return heaps_.size(); }
+    uint64_t heap_size(uint32_t heap) const { return heaps_[heap].size; }
+    uint64_t bytes_allocated() const { return allocated_; }
+
+private:
+    struct Range { uint64_t offset, size; };
+    struct Heap {
+        uint64_t size = 0;
+        std::vector<Range> free;  // sorted by offset, never adjacent
+    };
+
+    uint64_t heap_size_;
+    std::vector<Heap> heaps_;
+    uint64_t allocated_ = 0;
+};
+
+// Ring of staging memory. Allocations are tagged with the fence of the
+// frame that copies out of them and freed in order by retire().
+class StagingRing {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit StagingRing(size_t capacity) : capacity_(capacity) {}
+
+    // Offset of size bytes (align a power of two), or npos if the ring
+    // has no room until more fences complete
+    size_t allocate(size_t size, size_t align, uint64_t fence);
+    void retire(uint64_t completed_fence);
+
+    std::byte* data() { return memory_.get(); }
+    const std::byte* data() const { return memory_.get(); }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return in_flight_.empty(); }
+
+private:
+    struct Span { size_t begin, end; uint64_t fence; };
+
+    size_t capacity_;
+    std::unique_ptr<std::byte[]> memory_;  // allocated on first use
+    std::deque<Span> in_flight_;           // oldest first
+};
+
+struct BufferCopy {
+    size_t staging_offset = 0;
+    GpuAllocation dst;
+};
+
+struct ImageCopy {
+    size_t staging_offset = 0;
+    uint64_t texture_id = 0;
+    uint32_t x = 0, y = 0;            // destination texel
+    uint32_t width = 0, height = 0;
+    uint32_t bytes_per_pixel = 4;
+};
+
+struct UploadBatch {
+    uint64_t fence = 0;               // signal when the copies are done
+    std::vector<BufferCopy> buffers;
+    std::vector<ImageCopy> images;
+
+    bool empty() const { return buffers.empty() && images.empty(); }
+};
+
+class GpuUploadQueue {
+public:
+    struct Config {
+        size_t staging_size = 16 * 1024 * 1024;
+        uint64_t heap_size = 64 * 1024 * 1024;
+    };
+
+    GpuUploadQueue() : GpuUploadQueue(Config{}) {}
+    explicit GpuUploadQueue(const Config& config)
+        : staging_(config.staging_size), heaps_(config.heap_size) {}
+
+    // Stages vertices and indices and gives them device ranges, stored as
+    // handles in gpu_vertex_buffer / gpu_index_buffer. The mesh may be
+    // drawn once is_complete(mesh.upload_fence). False, with the mesh
+    // untouched, if the ring is full until more fences complete.
+    //
+    // A mesh larger than the ring is split: its ranges are assigned with
+    // the first piece, each call stages as many pieces as the ring has
+    // room for, and it returns false (uploaded unset) until the last one
+    // is staged. Call it again each frame until it returns true.
+    bool enqueue_mesh(MeshData& mesh);
+
+    // Whole texture, or a region of one (atlas page updates). Staged
+    // whole: an image larger than the ring must be sent in regions.
+    bool enqueue_texture(uint64_t texture_id, const void* pixels,
+                         uint32_t width, uint32_t height, uint32_t bytes_per_pixel = 4);
+    bool enqueue_texture_region(uint64_t texture_id, uint32_t x, uint32_t y,
+                                uint32_t width, uint32_t height, const void* pixels,
+                                uint32_t bytes_per_pixel = 4);
+
+    // Frees a buffer handle's device range once the frames that may still
+    // read it have completed
+    void release_buffer(uint64_t handle);
+
+    // Closes this frame's copies under the next fence value. The batch
+    // stays valid until the next submit().
+    const UploadBatch& submit();
+
+    // The backend's last completed fence: frees staging space and
+    // released ranges up to it
+    void retire(uint64_t completed_fence);
+
+    // Fence of the batch being recorded
+    uint64_t pending_fence() const;
+    bool is_complete(uint64_t fence) const;
+
+    const std::byte* staging_data() const { return staging_.data(); }
+    const DeviceHeapAllocator& heaps() const { return heaps_; }
+
+private:
+    mutable std::mutex mutex_;
+    StagingRing staging_;
+    DeviceHeapAllocator heaps_;
+    std::unordered_map<uint64_t, GpuAllocation> buffers_;  // live buffer handles
+    struct Release { GpuAllocation allocation; uint64_t fence; };
+    std::vector<Release> releases_;
+
+    UploadBatch recording_;   // copies enqueued since the last submit
+    UploadBatch submitted_;
+    uint64_t next_fence_ = 1;
+    uint64_t completed_fence_ = 0;
+
+    size_t stage(const void* data, size_t size, size_t align);
+    void assign_mesh_ranges(MeshData& mesh, uint64_t vertex_bytes, uint64_t index_bytes);
+    bool enqueue_split_mesh(MeshData& mesh, uint64_t vertex_bytes, uint64_t index_bytes);
+    void release_locked(uint64_t handle);
+};
@@ -0,0 +1,505 @@
+#include "headless_renderer.hpp"
+#include "render_pipeline.hpp"
+#include "../core/concepts.hpp"
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+static_assert(RendererBackend<HeadlessRenderer>);
+
+namespace {
+
+constexpr uint64_t fnv_offset = 14695981039346656037ull;
+constexpr uint64_t fnv_prime = 1099511628211ull;
+
+// Clip w below which a vertex counts as behind the eye
+constexpr float min_clip_w = 1e-5f;
+
+uint32_t pack_color(Color c) {
+    return static_cast<uint32_t>(c.r) | static_cast<uint32_t>(c.g) << 8 |
+           static_cast<uint32_t>(c.b) << 16 | static_cast<uint32_t>(c.a) << 24;
+}
+
+// Stand-in for a texture's content: opaque, distinct per id
+uint32_t texture_color(uint64_t id) {
+    uint64_t h = id * 0x9E3779B97F4A7C15ull;
+    return static_cast<uint32_t>(h >> 40) | 0xff000000u;
+}
+
+bool finite(Vec3f v) {
+    return std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z);
+}
+
+bool finite(const Mat4& m) {
+    return std::all_of(std::begin(m.m), std::end(m.m), [](float f) { return std::isfinite(f); });
+}
+
+const char* type_name(RenderCommandType type) {
+    switch (type) {
+        case RenderCommandType::Clear: return "Clear";
+        case RenderCommandType::SetViewProjection: return "SetViewProjection";
+        case RenderCommandType::DrawMesh: return "DrawMesh";
+        case RenderCommandType::DrawSkinnedMesh: return "DrawSkinnedMesh";
+        case RenderCommandType::DrawRect: return "DrawRect";
+        case RenderCommandType::DrawCircle: return "DrawCircle";
+        case RenderCommandType::DrawSprite: return "DrawSprite";
+        case RenderCommandType::DrawText: return "DrawText";
+        case RenderCommandType::DrawDebugLine: return "DrawDebugLine";
+        case RenderCommandType::DrawTextBatch: return "DrawTextBatch";
+        default: return "Unknown";
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Frame lifecycle
+// ---------------------------------------------------------------------------
+
+bool HeadlessRenderer::initialize() {
+    size_t pixels = static_cast<size_t>(config_.width) * config_.height;
+    color_.assign(pixels, 0xff000000u);
+    depth_.assign(pixels, 1.0f);
+    return true;
+}
+
+void HeadlessRenderer::begin_frame() {
+    stats_ = {};
+    stats_.frame = ++frame_;
+    stats_.hash = fnv_offset;
+    errors_.clear();
+    context_.reset();
+    view_projection_ = Mat4{};
+    std::fill(color_.begin(), color_.end(), 0xff000000u);
+    std::fill(depth_.begin(), depth_.end(), 1.0f);
+}
+
+void HeadlessRenderer::end_frame() {
+    if (pipeline_) {
+        GpuUploadQueue& uploads = pipeline_->upload_queue();
+        const UploadBatch& batch = uploads.submit();
+        stats_.buffer_uploads = static_cast<uint32_t>(batch.buffers.size());
+        stats_.image_uploads = static_cast<uint32_t>(batch.images.size());
+        uploads.retire(batch.fence);
+        // Done with the consumed frame; lookups made while the current
+        // one records may still be held
+        if (pipeline_->frame_number() > 1) pipeline_->retire_frame(pipeline_->frame_number() - 1);
+    }
+
+    // 2D drawing from context(), as the instanced draws a GPU would issue
+    const auto& instances = context_.instances();
+    for (const InstancedDraw2D& draw : context_.draws()) {
+        ++stats_.instanced_draws;
+        mix(draw.pipeline);
+        mix(draw.texture.id);
+        mix(draw.instance_count);
+        for (uint32_t i = 0; i < draw.instance_count; ++i) {
+            const Instance2D& inst = instances[draw.first_instance + i];
+            ++stats_.instances;
+            mix(inst.rect);
+            mix(inst.uv);
+            mix(inst.color);
+            mix(inst.kind);
+            mix(inst.outline);
+            if (!rasterizing()) continue;
+
+            const float* r = inst.rect;
+            if (draw.pipeline == Batch2DPipeline::Sprite) {
+                fill_rect(r[0], r[1], r[2], r[3], texture_color(draw.texture.id), true);
+                continue;
+            }
+            switch (inst.kind) {
+                case Shape2DKind::FilledRect:
+                case Shape2DKind::RectOutline:
+                    fill_rect(r[0], r[1], r[2], r[3], inst.color, inst.kind == Shape2DKind::FilledRect);
+                    break;
+                case Shape2DKind::FilledCircle:
+                case Shape2DKind::CircleOutline:
+                    fill_circle(r[0] + r[2] * 0.5f, r[1] + r[3] * 0.5f, r[2] * 0.5f, inst.color,
+                                inst.kind == Shape2DKind::FilledCircle);
+                    break;
+            }
+        }
+    }
+}
+
+void HeadlessRenderer::shutdown() {
+    pipeline_ = nullptr;
+    color_.clear();
+    depth_.clear();
+    context_.reset();
+}
+
+TextureHandle HeadlessRenderer::load_texture(const char* /*path*/) {
+    return {next_texture_id_++};
+}
+
+// ---------------------------------------------------------------------------
+// Commands
+// ---------------------------------------------------------------------------
+
+void HeadlessRenderer::consume(RenderPipeline& pipeline) {
+    pipeline_ = &pipeline;
+    view_projection_ = pipeline.projection_matrix() * pipeline.view_matrix();
+    for (size_t s = 0; s < RenderPipeline::stage_count; ++s) {
+        auto stage_id = static_cast<RenderStage>(s);
+        const CommandBuffer& commands = pipeline.stage_commands(stage_id);
+        // end_frame() sorts every stage
+        if (!commands.is_sorted(RenderPipeline::stage_sort_mode(stage_id))) {
+            ++stats_.errors;
+            if (errors_.size() < max_error_messages) {
+                errors_.push_back("stage " + std::to_string(s) + ": commands out of sort key order");
+            }
+        }
+        uint32_t stage = static_cast<uint32_t>(s);
+        mix(stage);
+        consume(commands, &pipeline);
+    }
+}
+
+void HeadlessRenderer::consume(const CommandBuffer& commands, RenderPipeline* resources) {
+    for (CommandView cmd : commands) {
+        execute(cmd, resources);
+    }
+}
+
+void HeadlessRenderer::execute(const CommandView& cmd, RenderPipeline* resources) {
+    ++stats_.commands;
+    RenderCommandType type = cmd.type();
+    if (type >= RenderCommandType::Max) {
+        error(type, "unknown command type");
+        return;
+    }
+    ++stats_.by_type[static_cast<size_t>(type)];
+    mix(type);
+    mix(cmd.sort_key());
+
+    switch (type) {
+        case RenderCommandType::Clear: {
+            const auto& c = cmd.as<RenderCmd_Clear>();
+            mix(c.color);
+            mix(c.depth);
+            std::fill(color_.begin(), color_.end(), pack_color(c.color));
+            std::fill(depth_.begin(), depth_.end(), c.depth);
+            break;
+        }
+        case RenderCommandType::SetViewProjection: {
+            const auto& c = cmd.as<RenderCmd_SetViewProjection>();
+            mix(c.view.m);
+            mix(c.projection.m);
+            if (!finite(c.view) || !finite(c.projection)) error(type, "non-finite matrix");
+            view_projection_ = c.projection * c.view;
+            break;
+        }
+        case RenderCommandType::DrawMesh: {
+            const auto& c = cmd.as<RenderCmd_DrawMesh>();
+            mix(c.mesh_id);
+            mix(c.world_transform.m);
+            mix(c.material_id);
+            if (!finite(c.world_transform)) {
+                error(type, "non-finite world transform");
+                break;
+            }
+            if (!resources) break;
+            const MeshData* mesh = resources->get_mesh(c.mesh_id);
+            if (!mesh) {
+                error(type, "mesh not registered");
+                break;
+            }
+            if (c.material_id && !resources->get_material(c.material_id)) {
+                error(type, "material not registered");
+            }
+            size_t vertex_count = mesh->vertices.size();
+            size_t index_count = mesh->indices.empty() ? vertex_count : mesh->indices.size();
+            bool indices_ok = std::all_of(mesh->indices.begin(), mesh->indices.end(),
+                                          [vertex_count](uint32_t i) { return i < vertex_count; });
+            if (!indices_ok || index_count % 3 != 0) {
+                error(type, "mesh indices out of range or not triangles");
+                break;
+            }
+            if (!rasterizing()) break;
+
+            const MaterialData* material = resources->get_material(c.material_id);
+            uint32_t rgba = pack_color(material ? material->diffuse_color : Color{});
+            Mat4 wvp = view_projection_ * c.world_transform;
+            projected_.resize(vertex_count);
+            projected_ok_.resize(vertex_count);
+            for (size_t i = 0; i < vertex_count; ++i) {
+                projected_ok_[i] = project(wvp, mesh->vertices[i].position, projected_[i]) ? 1 : 0;
+            }
+            for (size_t t = 0; t + 2 < index_count; t += 3) {
+                uint32_t idx[3];
+                for (int k = 0; k < 3; ++k) {
+                    idx[k] = mesh->indices.empty() ? static_cast<uint32_t>(t + k) : mesh->indices[t + k];
+                }
+                // Triangles crossing the near plane are dropped, not clipped
+                if (!projected_ok_[idx[0]] || !projected_ok_[idx[1]] || !projected_ok_[idx[2]]) continue;
+                fill_triangle({projected_[idx[0]], projected_[idx[1]], projected_[idx[2]]}, rgba, true);
+                ++stats_.triangles;
+            }
+            break;
+        }
+        case RenderCommandType::DrawSkinnedMesh: {
+            const auto& c = cmd.as<RenderCmd_DrawSkinnedMesh>();
+            mix(c.mesh_id);
+            mix(c.world_transform.m);
+            mix(c.material_id);
+            mix(c.bone_count);
+            for (const Mat4& bone : c.bone_matrices) mix(bone.m);
+            if (c.bone_count != c.bone_matrices.size()) error(type, "bone_count does not match bone matrices");
+            if (!finite(c.world_transform)) error(type, "non-finite world transform");
+            break;
+        }
+        case RenderCommandType::DrawRect: {
+            const auto& c = cmd.as<RenderCmd_DrawRect>();
+            mix(c.position);
+            mix(c.width);
+            mix(c.height);
+            mix(c.color);
+            mix(static_cast<uint8_t>(c.filled));
+            if (!finite(c.position) || !(c.width >= 0.0f) || !(c.height >= 0.0f)) {
+                error(type, "invalid position or size");
+                break;
+            }
+            if (rasterizing()) {
+                fill_rect(c.position.x, c.position.y, c.width, c.height, pack_color(c.color), c.filled);
+            }
+            break;
+        }
+        case RenderCommandType::DrawCircle: {
+            const auto& c = cmd.as<RenderCmd_DrawCircle>();
+            mix(c.center);
+            mix(c.radius);
+            mix(c.color);
+            mix(static_cast<uint8_t>(c.filled));
+            if (!finite(c.center) || !(c.radius >= 0.0f)) {
+                error(type, "invalid center or radius");
+                break;
+            }
+            if (rasterizing()) {
+                fill_circle(c.center.x, c.center.y, c.radius, pack_color(c.color), c.filled);
+            }
+            break;
+        }
+        case RenderCommandType::DrawSprite: {
+            const auto& c = cmd.as<RenderCmd_DrawSprite>();
+            mix(c.position);
+            mix(c.width);
+            mix(c.height);
+            mix(c.texture.id);
+            mix(c.uv);
+            if (!c.texture.valid()) error(type, "sprite without a texture");
+            if (!finite(c.position) || !(c.width >= 0.0f) || !(c.height >= 0.0f)) {
+                error(type, "invalid position or size");
+                break;
+            }
+            if (rasterizing()) {
+                fill_rect(c.position.x, c.position.y, c.width, c.height, texture_color(c.texture.id), true);
+            }
+            break;
+        }
+        case RenderCommandType::DrawText: {
+            const auto& c = cmd.as<RenderCmd_DrawText>();
+            mix(c.position);
+            mix(c.text.data(), c.text.size());
+            mix(c.text.size());
+            mix(c.color);
+            mix(c.scale);
+            break;
+        }
+        case RenderCommandType::DrawDebugLine: {
+            const auto& c = cmd.as<RenderCmd_DrawDebugLine>();
+            mix(c.from);
+            mix(c.to);
+            mix(c.color);
+            if (!finite(c.from) || !finite(c.to)) {
+                error(type, "non-finite endpoint");
+                break;
+            }
+            if (rasterizing()) draw_line(c.from, c.to, pack_color(c.color));
+            break;
+        }
+        case RenderCommandType::DrawTextBatch: {
+            const auto& c = cmd.as<RenderCmd_DrawTextBatch>();
+            mix(c.origin);
+            mix(c.font_atlas_texture);
+            mix(c.render_mode);
+            mix(c.sdf_pixel_range);
+            mix(c.outline_width);
+            mix(c.outline_color);
+            mix(c.shadow_offset_x);
+            mix(c.shadow_offset_y);
+            mix(c.shadow_softness);
+            mix(c.shadow_color);
+            mix(c.face_dilate);
+            mix(c.face_softness);
+            mix(c.vertices.data(), c.vertices.size_bytes());
+            mix(c.indices.data(), c.indices.size_bytes());
+            size_t vertex_count = c.vertices.size();
+            bool indices_ok = std::all_of(c.indices.begin(), c.indices.end(),
+                                          [vertex_count](uint32_t i) { return i < vertex_count; });
+            if (!indices_ok || c.indices.size() % 3 != 0) {
+                error(type, "text indices out of range or not triangles");
+                break;
+            }
+            if (!rasterizing()) break;
+
+            // Glyph quads in pixels, flat in the first vertex's color
+            for (size_t t = 0; t < c.indices.size(); t += 3) {
+                Vec3f v[3];
+                for (int k = 0; k < 3; ++k) {
+                    const TextBatchVertex& tv = c.vertices[c.indices[t + k]];
+                    v[k] = {c.origin.x + tv.pos_x, c.origin.y + tv.pos_y, 0.0f};
+                }
+                const TextBatchVertex& first = c.vertices[c.indices[t]];
+                fill_triangle(v, pack_color(Color{first.r, first.g, first.b, first.a}), false);
+                ++stats_.triangles;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void HeadlessRenderer::error(RenderCommandType type, const char* what) {
+    ++stats_.errors;
+    if (errors_.size() >= max_error_messages) return;
+    errors_.push_back("command " + std::to_string(stats_.commands - 1) + " (" + type_name(type) + "): " + what);
+}
+
+// FNV-1a over the bytes of command fields
+void HeadlessRenderer::mix(const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    uint64_t h = stats_.hash;
+    for (size_t i = 0; i < size; ++i) {
+        h = (h ^ bytes[i]) * fnv_prime;
+    }
+    stats_.hash = h;
+}
+
+// ---------------------------------------------------------------------------
+// Rasterization
+// ---------------------------------------------------------------------------
+
+void HeadlessRenderer::blend(int x, int y, uint32_t rgba) {
+    if (x < 0 || y < 0 || x >= static_cast<int>(config_.width) || y >= static_cast<int>(config_.height)) return;
+    uint32_t& dst = color_[static_cast<size_t>(y) * config_.width + x];
+    uint32_t a = rgba >> 24;
+    if (a == 255) {
+        dst = rgba;
+        return;
+    }
+    if (a == 0) return;
+    uint32_t out = 0;
+    for (int shift = 0; shift < 24; shift += 8) {
+        uint32_t s = (rgba >> shift) & 0xff;
+        uint32_t d = (dst >> shift) & 0xff;
+        out |= ((s * a + d * (255 - a) + 127) / 255) << shift;
+    }
+    uint32_t da = dst >> 24;
+    out |= (a + (da * (255 - a) + 127) / 255) << 24;
+    dst = out;
+}
+
+// Pixels whose centers lie in [x, x + w) x [y, y + h); outlines are one
+// pixel wide
+void HeadlessRenderer::fill_rect(float x, float y, float w, float h, uint32_t rgba, bool filled) {
+    int x0 = static_cast<int>(std::ceil(x - 0.5f));
+    int y0 = static_cast<int>(std::ceil(y - 0.5f));
+    int x1 = static_cast<int>(std::ceil(x + w - 0.5f));
+    int y1 = static_cast<int>(std::ceil(y + h - 0.5f));
+    int cx0 = std::max(x0, 0), cy0 = std::max(y0, 0);
+    int cx1 = std::min(x1, static_cast<int>(config_.width));
+    int cy1 = std::min(y1, static_cast<int>(config_.height));
+    for (int py = cy0; py < cy1; ++py) {
+        for (int px = cx0; px < cx1; ++px) {
+            bool edge = px == x0 || px == x1 - 1 || py == y0 || py == y1 - 1;
+            if (filled || edge) blend(px, py, rgba);
+        }
+    }
+}
+
+void HeadlessRenderer::fill_circle(float cx, float cy, float radius, uint32_t rgba, bool filled) {
+    int x0 = std::max(0, static_cast<int>(std::floor(cx - radius - 1.0f)));
+    int y0 = std::max(0, static_cast<int>(std::floor(cy - radius - 1.0f)));
+    int x1 = std::min(static_cast<int>(config_.width) - 1, static_cast<int>(std::ceil(cx + radius + 1.0f)));
+    int y1 = std::min(static_cast<int>(config_.height) - 1, static_cast<int>(std::ceil(cy + radius + 1.0f)));
+    for (int py = y0; py <= y1; ++py) {
+        float dy = static_cast<float>(py) + 0.5f - cy;
+        for (int px = x0; px <= x1; ++px) {
+            float dx = static_cast<float>(px) + 0.5f - cx;
+            float d = std::sqrt(dx * dx + dy * dy);
+            bool inside = filled ? d <= radius : std::abs(d - radius) <= SpriteBatcher::outline_width * 0.5f;
+            if (inside) blend(px, py, rgba);
+        }
+    }
+}
+
+// World-space line, no depth test (debug overlay)
+void HeadlessRenderer::draw_line(Vec3f from, Vec3f to, uint32_t rgba) {
+    Vec3f a, b;
+    if (!project(view_projection_, from, a) || !project(view_projection_, to, b)) return;
+    float dx = b.x - a.x, dy = b.y - a.y;
+    float steps = std::ceil(std::max(std::abs(dx), std::abs(dy)));
+    // Lines far off-screen are not walked pixel by pixel
+    float limit = 4.0f * static_cast<float>(config_.width + config_.height);
+    if (!(steps <= limit)) return;
+    int n = std::max(1, static_cast<int>(steps));
+    for (int i = 0; i <= n; ++i) {
+        float t = static_cast<float>(i) / static_cast<float>(n);
+        blend(static_cast<int>(std::floor(a.x + dx * t)), static_cast<int>(std::floor(a.y + dy * t)), rgba);
+    }
+}
+
+bool HeadlessRenderer::project(const Mat4& wvp, Vec3f p, Vec3f& screen) const {
+    const float* m = wvp.m;
+    float x = m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12];
+    float y = m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13];
+    float z = m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14];
+    float w = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
+    if (!(w > min_clip_w)) return false;
+    screen = {(x / w * 0.5f + 0.5f) * static_cast<float>(config_.width),
+              (0.5f - y / w * 0.5f) * static_cast<float>(config_.height),
+              z / w * 0.5f + 0.5f};
+    return true;
+}
+
+// Either winding; pixel centers on an edge are inside
+void HeadlessRenderer::fill_triangle(const Vec3f (&v)[3], uint32_t rgba, bool depth_test) {
+    float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+    if (!(std::abs(area) > 1e-8f)) return;
+    float inv_area = 1.0f / area;
+
+    float w = static_cast<float>(config_.width), h = static_cast<float>(config_.height);
+    float min_x = std::clamp(std::min({v[0].x, v[1].x, v[2].x}), 0.0f, w);
+    float max_x = std::clamp(std::max({v[0].x, v[1].x, v[2].x}), 0.0f, w);
+    float min_y = std::clamp(std::min({v[0].y, v[1].y, v[2].y}), 0.0f, h);
+    float max_y = std::clamp(std::max({v[0].y, v[1].y, v[2].y}), 0.0f, h);
+    int x0 = static_cast<int>(std::floor(min_x));
+    int y0 = static_cast<int>(std::floor(min_y));
+    int x1 = std::min(static_cast<int>(config_.width) - 1, static_cast<int>(std::ceil(max_x)));
+    int y1 = std::min(static_cast<int>(config_.height) - 1, static_cast<int>(std::ceil(max_y)));
+
+    auto edge = [](const Vec3f& a, const Vec3f& b, float px, float py) {
+        return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+    };
+    for (int py = y0; py <= y1; ++py) {
+        float cy = static_cast<float>(py) + 0.5f;
+        for (int px = x0; px <= x1; ++px) {
+            float cx = static_cast<float>(px) + 0.5f;
+            // Barycentric weights, all non-negative inside for either winding
+            float b0 = edge(v[1], v[2], cx, cy) * inv_area;
+            float b1 = edge(v[2], v[0], cx, cy) * inv_area;
+            float b2 = edge(v[0], v[1], cx, cy) * inv_area;
+            if (b0 < 0.0f || b1 < 0.0f || b2 < 0.0f) continue;
+            if (depth_test) {
+                float z = b0 * v[0].z + b1 * v[1].z + b2 * v[2].z;
+                float& d = depth_[static_cast<size_t>(py) * config_.width + px];
+                if (z < 0.0f || z >= d) continue;
+                d = z;
+            }
+            blend(px, py, rgba);
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "command_buffer.hpp"
+#include "sprite_batch.hpp"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+class RenderPipeline;
+
+// Render backend without a window or GPU, for CI and benchmarks.
+//
+// HeadlessRenderer consumes recorded commands the way a GPU backend would.
+// Every command is counted, checked for malformed data and folded into a
+// frame hash built from command fields (never pointers or padding), so the
+// same frame hashes the same on every run and platform and command
+// generation, batching and sorting can be regression-tested by hash.
+//
+// With a nonzero framebuffer size it also rasterizes into an RGBA8 CPU
+// image (row 0 at the top): 2D primitives in pixels, debug lines and
+// meshes through the current view-projection with a depth buffer, meshes
+// flat-shaded in their material's diffuse color. Sprites fill their rect
+// with a color derived from the texture id, as no image data is loaded.
+// Skinned meshes and plain text are counted and validated only.
+//
+// context() records 2D drawing through the same SpriteBatcher the Vulkan
+// backend uses; its instanced draws are consumed at end_frame().
+//
+// end_frame() also drains the upload queue of the pipeline last passed to
+// consume() and retires the frame it consumed. Nothing runs asynchronously
+// here, so each upload batch is complete as soon as it is taken.
+struct HeadlessFrameStats {
+    static constexpr size_t type_count = static_cast<size_t>(RenderCommandType::Max);
+
+    uint64_t frame = 0;
+    uint32_t commands = 0;
+    std::array<uint32_t, type_count> by_type{};
+    uint32_t instanced_draws = 0;   // from context()
+    uint32_t instances = 0;
+    uint32_t buffer_uploads = 0;    // copies in the frame's upload batch
+    uint32_t image_uploads = 0;
+    uint32_t triangles = 0;         // rasterized, 2D shapes excluded
+    uint32_t errors = 0;
+    uint64_t hash = 0;
+
+    uint32_t count(RenderCommandType type) const { return by_type[static_cast<size_t>(type)]; }
+};
+
+class HeadlessRenderer {
+public:
+    struct Config {
+        uint32_t width = 0;    // 0: validate and hash only
+        uint32_t height = 0;
+    };
+
+    static constexpr size_t max_error_messages = 64;
+
+    HeadlessRenderer() = default;
+    explicit HeadlessRenderer(const Config& config) : config_(config) {}
+
+    // Satisfies RendererBackend concept
+    bool initialize();
+    void begin_frame();
+    void end_frame();
+    void shutdown();
+
+    RenderContext* context() { return &context_; }
+
+    // Every stage's read buffer, in stage order, starting from the
+    // pipeline's view and projection; meshes and materials are resolved
+    // through the pipeline
+    void consume(RenderPipeline& pipeline);
+    // One buffer; without resources, mesh ids are not checked or drawn
+    void consume(const CommandBuffer& commands, RenderPipeline* resources = nullptr);
+
+    // Ids only: there is no image data to load
+    TextureHandle load_texture(const char* path);
+    void unload_texture(TextureHandle) {}
+
+    // The frame in progress, or the last one after end_frame()
+    const HeadlessFrameStats& stats() const { return stats_; }
+    const std::vector<std::string>& errors() const { return errors_; }
+
+    uint32_t width() const { return config_.width; }
+    uint32_t height() const { return config_.height; }
+    std::span<const uint32_t> framebuffer() const { return color_; }
+    // RGBA8, r in the low byte
+    uint32_t pixel(uint32_t x, uint32_t y) const { return color_[static_cast<size_t>(y) * config_.width + x]; }
+
+private:
+    Config config_;
+    RenderPipeline* pipeline_ = nullptr;
+    SpriteBatcher context_;
+    HeadlessFrameStats stats_;
+    std::vector<std::string> errors_;
+    std::vector<uint32_t> color_;
+    std::vector<float> depth_;     // window depth, 0 near to 1 far
+    std::vector<Vec3f> projected_; // mesh vertices in screen space
+    std::vector<uint8_t> projected_ok_;
+    Mat4 view_projection_;
+    uint64_t frame_ = 0;
+    uint64_t next_texture_id_ = 1;
+
+    void execute(const CommandView& cmd, RenderPipeline* resources);
+    void error(RenderCommandType type, const char* what);
+    void mix(const void* data, size_t size);
+    template <typename T>
+    void mix(const T& value) { mix(&value, sizeof(T)); }
+
+    bool rasterizing() const { return !color_.empty(); }
+    void blend(int x, int y, uint32_t rgba);
+    void fill_rect(float x, float y, float w, float h, uint32_t rgba, bool filled);
+    void fill_circle(float cx, float cy, float radius, uint32_t rgba, bool filled);
+    void draw_line(Vec3f from, Vec3f to, uint32_t rgba);
+    bool project(const Mat4& world_view_projection, Vec3f p, Vec3f& screen) const;
+    void fill_triangle(const Vec3f (&v)[3], uint32_t rgba, bool depth_test);
+};
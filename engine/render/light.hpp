@@ -3,6 +3,7 @@
 #include "../math/color.hpp"
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
 enum class LightType : uint8_t { Directional, Point, Spot };
 
@@ -28,10 +28,32 @@ struct MeshData {
     std::vector<uint32_t> indices;
     std::vector<SubMesh> submeshes;
 
-    // GPU handles (set by the renderer backend after upload)
+    // Local-space bounds of the vertices, for culling (filled in by
+    // RenderPipeline::register_mesh)
+    Vec3f bounds_min;
+    Vec3f bounds_max;
+
+    // Device ranges (GpuAllocation handles) assigned by GpuUploadQueue;
+    // the data is resident once the queue reports upload_fence complete
     uint64_t gpu_vertex_buffer = 0;
     uint64_t gpu_index_buffer = 0;
-    bool uploaded = false;
+    uint64_t upload_fence = 0;
+    uint64_t upload_staged = 0;  // bytes of a split upload staged so far
+    bool uploaded = false;       // ranges assigned and every copy queued
+
+    void compute_bounds() {
+        if (vertices.empty()) return;
+        bounds_min = bounds_max = vertices[0].position;
+        for (const Vertex& v : vertices) {
+            const Vec3f& p = v.position;
+            bounds_min = {p.x < bounds_min.x ? p.x : bounds_min.x,
+                          p.y < bounds_min.y ? p.y : bounds_min.y,
+                          p.z < bounds_min.z ? p.z : bounds_min.z};
+            bounds_max = {p.x > bounds_max.x ? p.x : bounds_max.x,
+                          p.y > bounds_max.y ? p.y : bounds_max.y,
+                          p.z > bounds_max.z ? p.z : bounds_max.z};
+        }
+    }
 };
 
 // Material data
@@ -4,28 +4,52 @@
 #include "../math/color.hpp"
 #include "../resource/texture_handle.hpp"
 #include <cstdint>
-#include <vector>
-#include <variant>
+#include <span>
+#include <string_view>
 
 // Render commands: recorded by game threads, consumed by render thread
+//
+// Every command is trivially copyable and is stored as-is in a
+// CommandBuffer's byte stream, tagged with its type. Variable-length data
+// (text, vertices, bone matrices) is passed as a span or string_view; push()
+// copies it into the buffer's frame arena and points the stored command at
+// the copy, so the caller's data need not outlive the call.
+
+enum class RenderCommandType : uint16_t {
+    Clear,
+    SetViewProjection,
+    DrawMesh,
+    DrawSkinnedMesh,
+    DrawRect,
+    DrawCircle,
+    DrawSprite,
+    DrawText,
+    DrawDebugLine,
+    DrawTextBatch,
+    Max
+};
 
 struct RenderCmd_Clear {
+    static constexpr RenderCommandType type = RenderCommandType::Clear;
     Color color{0, 0, 0, 255};
     float depth = 1.0f;
 };
 
 struct RenderCmd_SetViewProjection {
+    static constexpr RenderCommandType type = RenderCommandType::SetViewProjection;
     Mat4 view;
     Mat4 projection;
 };
 
 struct RenderCmd_DrawMesh {
+    static constexpr RenderCommandType type = RenderCommandType::DrawMesh;
     uint64_t mesh_id = 0;
     Mat4 world_transform;
     uint64_t material_id = 0;
 };
 
 struct RenderCmd_DrawRect {
+    static constexpr RenderCommandType type = RenderCommandType::DrawRect;
     Vec3f position;
     float width = 0.0f;
     float height = 0.0f;
@@ -34,6 +58,7 @@ struct RenderCmd_DrawRect {
 };
 
 struct RenderCmd_DrawCircle {
+    static constexpr RenderCommandType type = RenderCommandType::DrawCircle;
     Vec3f center;
     float radius = 0.0f;
     Color color;
@@ -41,6 +66,7 @@ struct RenderCmd_DrawCircle {
 };
 
 struct RenderCmd_DrawSprite {
+    static constexpr RenderCommandType type = RenderCommandType::DrawSprite;
     Vec3f position;
     float width = 0.0f;
     float height = 0.0f;
@@ -49,13 +75,15 @@ struct RenderCmd_DrawSprite {
 };
 
 struct RenderCmd_DrawText {
+    static constexpr RenderCommandType type = RenderCommandType::DrawText;
     Vec3f position;
-    char text[256] = {};
+    std::string_view text;
     Color color;
     float scale = 1.0f;
 };
 
 struct RenderCmd_DrawDebugLine {
+    static constexpr RenderCommandType type = RenderCommandType::DrawDebugLine;
     Vec3f from;
     Vec3f to;
     Color color;
@@ -63,11 +91,12 @@ struct RenderCmd_DrawDebugLine {
 
 // Skinned mesh draw command: mesh with bone animation matrices
 struct RenderCmd_DrawSkinnedMesh {
+    static constexpr RenderCommandType type = RenderCommandType::DrawSkinnedMesh;
     uint64_t mesh_id = 0;
     Mat4 world_transform;
     uint64_t material_id = 0;
     uint32_t bone_count = 0;
-    std::vector<Mat4> bone_matrices;  // final bone transforms for this frame
+    std::span<const Mat4> bone_matrices;  // final bone transforms for this frame
 };
 
 // SDF/MSDFテキスト描画コマンド (バッチ描画)
@@ -79,6 +108,7 @@ struct TextBatchVertex {
 };
 
 struct RenderCmd_DrawTextBatch {
+    static constexpr RenderCommandType type = RenderCommandType::DrawTextBatch;
     Vec3f origin;
     uint64_t font_atlas_texture = 0;  // アトラスページのテクスチャID
     uint32_t render_mode = 0;         // FontRenderMode (SDF/MSDF等)
@@ -93,19 +123,6 @@ struct RenderCmd_DrawTextBatch {
     float face_dilate = 0.0f;
     float face_softness = 0.0f;
     // 頂点データ
-    std::vector<TextBatchVertex> vertices;
-    std::vector<uint32_t> indices;
+    std::span<const TextBatchVertex> vertices;
+    std::span<const uint32_t> indices;
 };
-
-using RenderCommand = std::variant<
-    RenderCmd_Clear,
-    RenderCmd_SetViewProjection,
-    RenderCmd_DrawMesh,
-    RenderCmd_DrawSkinnedMesh,
-    RenderCmd_DrawRect,
-    RenderCmd_DrawCircle,
-    RenderCmd_DrawSprite,
-    RenderCmd_DrawText,
-    RenderCmd_DrawDebugLine,
-    RenderCmd_DrawTextBatch
->;
@@ -1,8 +1,11 @@
 #include "render_pipeline.hpp"
+#include "../core/assert.hpp"
 #include <algorithm>
 
 RenderPipeline::RenderPipeline() = default;
 
+RenderPipeline::RenderPipeline(const GpuUploadQueue::Config& uploads) : uploads_(uploads) {}
+
 RenderPipeline::~RenderPipeline() {
     shutdown();
 }
@@ -30,7 +33,7 @@ void RenderPipeline::shutdown() {
 
 void RenderPipeline::worker_thread_func() {
     while (!shutdown_.load(std::memory_order_acquire)) {
-        RenderJob job;
+        QueuedJob queued;
         {
             std::unique_lock lock(job_mutex_);
             job_cv_.wait(lock, [this] {
@@ -40,42 +43,77 @@ void RenderPipeline::worker_thread_func() {
             if (shutdown_.load(std::memory_order_acquire) && job_queue_.empty()) return;
             if (job_queue_.empty()) continue;
 
-            job = std::move(job_queue_.back());
-            job_queue_.pop_back();
-        }
-
-        // Execute job with a thread-local command buffer
-        CommandBuffer local_buffer;
-        if (job.execute) {
-            job.execute(local_buffer, job.begin, job.end);
+            queued = std::move(job_queue_.front());
+            job_queue_.pop_front();
         }
 
-        // Submit results to the Opaque stage collector by default
-        stages_[static_cast<size_t>(Stage::Opaque)].collector.submit(local_buffer);
+        // Record into the job's own slot; only this thread touches it
+        // until end_frame()
+        const RenderJob& job = queued.job;
+        if (job.execute) job.execute(queued.out->commands, job.begin, job.end);
 
         if (jobs_remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Lock so the notify cannot fall between wait_for_jobs()'s
+            // check and its wait
+            { std::lock_guard lock(job_mutex_); }
             jobs_done_cv_.notify_all();
         }
     }
 }
 
 void RenderPipeline::begin_frame() {
-    frame_number_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t frame = frame_number_.fetch_add(1, std::memory_order_relaxed) + 1;
 
     // Swap all stage buffers: previous back -> new front (for render), clear new back
     for (auto& stage : stages_) {
         stage.commands.swap();
     }
+
+    // Reclaim resources removed in frames no backend can still be reading
+    std::lock_guard lock(resource_mutex_);
+    if (frame > frames_in_flight_) {
+        meshes_.retire(frame - frames_in_flight_);
+        materials_.retire(frame - frames_in_flight_);
+    }
+
+    // Retry uploads the staging ring had no room for, in registration
+    // order; the backend has retired the fences it saw complete since.
+    // Once one still does not fit the ring is full, so stop there. A mesh
+    // larger than the ring goes a piece at a time and holds the head
+    // only until its last piece is staged.
+    size_t staged = 0;
+    for (; staged < pending_uploads_.size(); ++staged) {
+        MeshData* mesh = meshes_.get(pending_uploads_[staged]);
+        if (mesh && !uploads_.enqueue_mesh(*mesh)) break;
+    }
+    pending_uploads_.erase(pending_uploads_.begin(), pending_uploads_.begin() + static_cast<ptrdiff_t>(staged));
 }
 
 void RenderPipeline::end_frame() {
-    // Collect all submitted commands from workers into stage back buffers
-    for (auto& stage : stages_) {
-        auto collected = stage.collector.take();
+    // Collect job output, in dispatch order, and submitted commands into
+    // stage back buffers, then sort each by key. Depth-tested stages sort by state so
+    // the backend sees state-coherent runs; blended and overlay stages
+    // keep painter's order apart from explicit layer and depth.
+    for (size_t s = 0; s < stage_count; ++s) {
+        CommandBuffer& out = stages_[s].commands.write_buffer();
+        for (size_t j = 0; j < job_outputs_used_; ++j) {
+            JobOutput& job = job_outputs_[j];
+            if (static_cast<size_t>(job.stage) == s && !job.commands.empty()) {
+                out.merge(std::move(job.commands));
+            }
+        }
+        auto collected = stages_[s].collector.take();
         if (!collected.empty()) {
-            stage.commands.write_buffer().merge(collected);
+            out.merge(std::move(collected));
         }
+        out.sort(stage_sort_mode(static_cast<Stage>(s)));
     }
+    job_outputs_used_ = 0;
+}
+
+void RenderPipeline::submit(Stage stage, CommandBuffer&& buffer) {
+    auto idx = static_cast<size_t>(stage);
+    stages_[idx].collector.submit(std::move(buffer));
 }
 
 void RenderPipeline::submit(Stage stage, const CommandBuffer& buffer) {
@@ -95,54 +133,128 @@ void RenderPipeline::dispatch_jobs(const std::vector<RenderJob>& jobs) {
     {
         std::lock_guard lock(job_mutex_);
         for (auto& job : jobs) {
-            job_queue_.push_back(job);
+            if (job_outputs_used_ == job_outputs_.size()) job_outputs_.emplace_back();
+            JobOutput& out = job_outputs_[job_outputs_used_++];
+            out.stage = job.stage;
+            job_queue_.push_back({job, &out});
         }
     }
     job_cv_.notify_all();
 }
 
 void RenderPipeline::wait_for_jobs() {
-    std::mutex wait_mutex;
-    std::unique_lock lock(wait_mutex);
+    std::unique_lock lock(job_mutex_);
     jobs_done_cv_.wait(lock, [this] {
         return jobs_remaining_.load(std::memory_order_acquire) == 0;
     });
 }
 
+CullStats RenderPipeline::record_visible(std::span<const MeshInstance> instances,
+                                         CommandBuffer& out, bool occlusion, JobSystem& jobs) {
+    ERGO_DEBUG_ASSERT(std::this_thread::get_id() == main_thread_,
+                      "RenderPipeline::record_visible: main thread only, not from a RenderJob");
+    constexpr uint32_t cull_chunk = 256;
+    auto n = static_cast<uint32_t>(instances.size());
+    CullStats stats;
+    stats.tested = n;
+    if (n == 0) return stats;
+
+    Mat4 view_projection = projection_matrix_ * view_matrix_;
+    Frustum frustum = Frustum::from_view_projection(view_projection);
+    cull_bounds_.resize(n);
+    cull_visible_.resize(n);
+    cull_unbounded_.resize(n);
+
+    jobs.parallel_for(0, n, cull_chunk, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            const MeshData* mesh = meshes_.get(instances[i].mesh_id);
+            cull_unbounded_[i] = !mesh;
+            Vec3f min, max;
+            if (mesh) {
+                transform_bounds(instances[i].world_transform,
+                                 mesh->bounds_min, mesh->bounds_max, min, max);
+            }
+            cull_bounds_.set(i, min, max);
+        }
+        frustum_cull(frustum, cull_bounds_, begin, end, cull_visible_.data());
+        for (uint32_t i = begin; i < end; ++i) {
+            if (cull_unbounded_[i]) cull_visible_[i] = 1;
+        }
+    });
+    for (uint32_t i = 0; i < n; ++i) stats.frustum_culled += cull_visible_[i] ? 0 : 1;
+
+    if (occlusion) {
+        auto bounds_of = [this](uint32_t i, Vec3f& min, Vec3f& max) {
+            min = {cull_bounds_.min_x[i], cull_bounds_.min_y[i], cull_bounds_.min_z[i]};
+            max = {cull_bounds_.max_x[i], cull_bounds_.max_y[i], cull_bounds_.max_z[i]};
+        };
+        occlusion_.begin(view_projection);
+        for (uint32_t i = 0; i < n; ++i) {
+            if (!cull_visible_[i] || cull_unbounded_[i] || !instances[i].occluder) continue;
+            Vec3f min, max;
+            bounds_of(i, min, max);
+            occlusion_.add_occluder(min, max);
+        }
+        jobs.parallel_for(0, n, cull_chunk, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                if (!cull_visible_[i] || cull_unbounded_[i]) continue;
+                Vec3f min, max;
+                bounds_of(i, min, max);
+                if (!occlusion_.test(min, max)) cull_visible_[i] = 2;  // occluded
+            }
+        });
+        for (uint32_t i = 0; i < n; ++i) {
+            if (cull_visible_[i] == 2) {
+                ++stats.occlusion_culled;
+                cull_visible_[i] = 0;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < n; ++i) {
+        if (!cull_visible_[i]) continue;
+        const MeshInstance& inst = instances[i];
+        out.push(RenderCmd_DrawMesh{inst.mesh_id, inst.world_transform, inst.material_id});
+    }
+    return stats;
+}
+
 uint64_t RenderPipeline::register_mesh(MeshData mesh) {
     std::lock_guard lock(resource_mutex_);
-    uint64_t id = next_mesh_id_++;
-    mesh.id = id;
-    meshes_[id] = std::move(mesh);
+    mesh.compute_bounds();
+    uint64_t id = meshes_.add(std::move(mesh));
+    if (id == 0) return 0;
+    // Not yet visible to other threads: nobody else has the id
+    MeshData& stored = *meshes_.get(id);
+    stored.id = id;
+    // Behind earlier meshes still waiting, to keep upload order
+    if (!pending_uploads_.empty() || !uploads_.enqueue_mesh(stored)) pending_uploads_.push_back(id);
     return id;
 }
 
 uint64_t RenderPipeline::register_material(MaterialData material) {
     std::lock_guard lock(resource_mutex_);
-    uint64_t id = next_material_id_++;
-    material.id = id;
-    materials_[id] = std::move(material);
+    uint64_t id = materials_.add(std::move(material));
+    if (id != 0) materials_.get(id)->id = id;
     return id;
 }
 
 void RenderPipeline::unregister_mesh(uint64_t id) {
     std::lock_guard lock(resource_mutex_);
-    meshes_.erase(id);
+    MeshData* mesh = meshes_.get(id);
+    if (!mesh) return;
+    uploads_.release_buffer(mesh->gpu_vertex_buffer);
+    uploads_.release_buffer(mesh->gpu_index_buffer);
+    meshes_.remove(id, frame_number());
 }
 
 void RenderPipeline::unregister_material(uint64_t id) {
     std::lock_guard lock(resource_mutex_);
-    materials_.erase(id);
-}
-
-MeshData* RenderPipeline::get_mesh(uint64_t id) {
-    std::lock_guard lock(resource_mutex_);
-    auto it = meshes_.find(id);
-    return (it != meshes_.end()) ? &it->second : nullptr;
+    materials_.remove(id, frame_number());
 }
 
-MaterialData* RenderPipeline::get_material(uint64_t id) {
+void RenderPipeline::retire_frame(uint64_t frame) {
     std::lock_guard lock(resource_mutex_);
-    auto it = materials_.find(id);
-    return (it != materials_.end()) ? &it->second : nullptr;
+    meshes_.retire(frame);
+    materials_.retire(frame);
 }
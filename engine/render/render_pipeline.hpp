@@ -2,9 +2,13 @@
 #include "double_buffer.hpp"
 #include "command_buffer.hpp"
 #include "mesh.hpp"
+#include "visibility.hpp"
+#include "gpu_upload_queue.hpp"
+#include "resource_registry.hpp"
 #include "../math/mat4.hpp"
+#include <deque>
 #include <vector>
-#include <unordered_map>
+#include <span>
 #include <memory>
 #include <thread>
 #include <mutex>
@@ -12,29 +16,54 @@
 #include <atomic>
 #include <functional>
 
+// Pipeline stage identifiers
+enum class RenderStage : uint32_t {
+    Shadow,
+    Opaque,
+    Transparent,
+    PostProcess,
+    UI,
+    Max
+};
+
 // Render job for parallel command generation
 struct RenderJob {
     uint32_t job_id = 0;
     uint32_t begin = 0;  // start index in entity list
     uint32_t end = 0;    // end index in entity list
+    RenderStage stage = RenderStage::Opaque;  // stage that out records into
     std::function<void(CommandBuffer& out, uint32_t begin, uint32_t end)> execute;
 };
 
+// Mesh draw submitted through the culling stage (RenderPipeline::record_visible)
+struct MeshInstance {
+    uint64_t mesh_id = 0;
+    Mat4 world_transform;
+    uint64_t material_id = 0;
+    bool occluder = false;  // drawn into the occlusion buffer when visible
+};
+
+struct CullStats {
+    uint32_t tested = 0;
+    uint32_t frustum_culled = 0;
+    uint32_t occlusion_culled = 0;
+};
+
 // Multi-threaded rendering pipeline
 // - Game threads record commands into thread-local CommandBuffers
 // - Commands are merged and double-buffered
 // - Render thread consumes the front buffer
+//
+// Jobs run on the pipeline's workers, taken in dispatch order, and each
+// records straight into an output buffer of its own. The buffers live as
+// long as the pipeline; end_frame() moves their commands into the job's
+// stage in dispatch order, whichever worker ran the job, so commands with
+// equal keys keep the order they were dispatched in. The move does not
+// copy and leaves the buffers empty for the next frame.
 class RenderPipeline {
 public:
-    // Pipeline stage identifiers
-    enum class Stage : uint32_t {
-        Shadow,
-        Opaque,
-        Transparent,
-        PostProcess,
-        UI,
-        Max
-    };
+    using Stage = RenderStage;
+    static constexpr size_t stage_count = static_cast<size_t>(Stage::Max);
 
 private:
     // Double-buffered command streams per stage
@@ -42,18 +71,33 @@ private:
         DoubleBufferedCommands commands;
         SharedCommandCollector collector;
     };
-    std::array<StageData, static_cast<size_t>(Stage::Max)> stages_;
+    std::array<StageData, stage_count> stages_;
 
-    // Mesh & material registry
-    std::unordered_map<uint64_t, MeshData> meshes_;
-    std::unordered_map<uint64_t, MaterialData> materials_;
-    uint64_t next_mesh_id_ = 1;
-    uint64_t next_material_id_ = 1;
+    // Mesh & material registry: lookups are lock-free, writes take
+    // resource_mutex_
+    ResourceRegistry<MeshData> meshes_;
+    ResourceRegistry<MaterialData> materials_;
     std::mutex resource_mutex_;
 
-    // Worker thread pool for parallel command generation
+    // Device residency: meshes are staged on registration, or retried each
+    // frame while the staging ring is full
+    GpuUploadQueue uploads_;
+    std::vector<uint64_t> pending_uploads_;
+
+    // Worker thread pool for parallel command generation, with one
+    // persistent output buffer per job slot
+    struct JobOutput {
+        Stage stage = Stage::Opaque;
+        CommandBuffer commands;
+    };
+    struct QueuedJob {
+        RenderJob job;
+        JobOutput* out = nullptr;
+    };
     std::vector<std::thread> workers_;
-    std::vector<RenderJob> job_queue_;
+    std::deque<JobOutput> job_outputs_;   // deque: slots stay put as it grows
+    size_t job_outputs_used_ = 0;         // slots dispatched this frame, in order
+    std::deque<QueuedJob> job_queue_;     // taken front first
     std::mutex job_mutex_;
     std::condition_variable job_cv_;
     std::atomic<uint32_t> jobs_remaining_{0};
@@ -64,13 +108,23 @@ private:
     Mat4 view_matrix_;
     Mat4 projection_matrix_;
 
+    // Culling scratch, kept to avoid reallocating every frame; owned by
+    // the thread that created the pipeline, see record_visible()
+    std::thread::id main_thread_ = std::this_thread::get_id();
+    BoundsSoA cull_bounds_;
+    std::vector<uint8_t> cull_visible_;
+    std::vector<uint8_t> cull_unbounded_;  // mesh not registered: never culled
+    OcclusionBuffer occlusion_;
+
     // Frame tracking
     std::atomic<uint64_t> frame_number_{0};
+    uint32_t frames_in_flight_ = 2;
 
     void worker_thread_func();
 
 public:
     RenderPipeline();
+    explicit RenderPipeline(const GpuUploadQueue::Config& uploads);
     ~RenderPipeline();
 
     // Initialize with worker thread count (0 = auto-detect based on CPU cores)
@@ -79,25 +133,63 @@ public:
 
     // Frame lifecycle
     void begin_frame();        // Swap buffers, prepare for new frame
-    void end_frame();          // Finalize command collection
+    void end_frame();          // Finalize command collection, sorted by key;
+                               // call with no jobs in flight
 
-    // Submit commands to a specific stage
+    // Submit commands to a specific stage. The rvalue overload moves the
+    // commands without copying and leaves buffer empty.
+    void submit(Stage stage, CommandBuffer&& buffer);
     void submit(Stage stage, const CommandBuffer& buffer);
 
     // Get a stage's read buffer (for the render backend to consume)
     const CommandBuffer& stage_commands(Stage stage) const;
+    // How end_frame() sorts a stage
+    static CommandBuffer::SortMode stage_sort_mode(Stage stage) {
+        return stage == Stage::Shadow || stage == Stage::Opaque ? CommandBuffer::SortMode::State
+                                                                : CommandBuffer::SortMode::Ordered;
+    }
+
+    // Culling stage: records a RenderCmd_DrawMesh, in instance order, for
+    // each instance whose registered mesh bounds intersect the frustum of
+    // the current view and projection. With occlusion, visible occluder
+    // instances are first drawn into a small software depth buffer and
+    // instances fully behind them are dropped as well. Bounds are tested
+    // in parallel on jobs, SIMD lanes at a time. Instances of unregistered
+    // meshes are always recorded.
+    //
+    // Main thread only (the thread that created the pipeline): it reuses
+    // the pipeline's culling scratch, and parallel_for on a JobSystem
+    // must not run concurrently or nested. Never call it from a RenderJob;
+    // cull first and hand the visible instances' commands to jobs.
+    CullStats record_visible(std::span<const MeshInstance> instances, CommandBuffer& out,
+                             bool occlusion = false, JobSystem& jobs = g_job_system);
 
     // Parallel job dispatch: splits work across worker threads
     void dispatch_jobs(const std::vector<RenderJob>& jobs);
     void wait_for_jobs();
 
-    // Resource management
+    // Resource management. Registering a mesh queues its upload; the
+    // backend drains upload_queue() once per frame (submit(), then
+    // retire() as fences complete), which also frees the staging space
+    // that uploads retried in begin_frame() wait on. Ids are generational
+    // (0 if the registry is full) and get_* never blocks, so workers may
+    // look resources up while recording. An unregistered resource misses
+    // at once but stays in memory until the frame it was removed in is
+    // retired: by begin_frame() once frames_in_flight() newer frames have
+    // begun, or earlier by a backend calling retire_frame().
     uint64_t register_mesh(MeshData mesh);
     uint64_t register_material(MaterialData material);
     void unregister_mesh(uint64_t id);
     void unregister_material(uint64_t id);
-    MeshData* get_mesh(uint64_t id);
-    MaterialData* get_material(uint64_t id);
+    MeshData* get_mesh(uint64_t id) { return meshes_.get(id); }
+    MaterialData* get_material(uint64_t id) { return materials_.get(id); }
+
+    // The backend is done with every frame up to and including frame
+    void retire_frame(uint64_t frame);
+    // Frames a backend may still be reading when a new one begins
+    void set_frames_in_flight(uint32_t frames) { frames_in_flight_ = frames; }
+    uint32_t frames_in_flight() const { return frames_in_flight_; }
+    GpuUploadQueue& upload_queue() { return uploads_; }
 
     // Camera
     void set_view_matrix(const Mat4& view) { view_matrix_ = view; }
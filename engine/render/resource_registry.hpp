@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Slot registry for render resources with lock-free lookups.
+//
+// Entries live in fixed-size blocks that never move, so a pointer from
+// get() stays valid for as long as the entry does. An id is
+// (generation << 32 | slot); remove() bumps the slot's generation at once,
+// so stale ids miss instead of aliasing the next occupant, but the entry
+// is only destroyed and its slot reused once retire() reports that the
+// frame it was removed in has finished (readers that looked it up during
+// that frame may still hold the pointer).
+//
+// get() may be called from any thread without locking; add(), remove()
+// and retire() must be serialized by the owner.
+template <typename T>
+class ResourceRegistry {
+public:
+    static constexpr uint32_t block_size = 256;
+    static constexpr uint32_t max_blocks = 4096;
+
+    ResourceRegistry() : block_table_(std::make_unique<std::atomic<Slot*>[]>(max_blocks)) {}
+    ResourceRegistry(const ResourceRegistry&) = delete;
+    ResourceRegistry& operator=(const ResourceRegistry&) = delete;
+
+    // Stores value and returns its id, or 0 if every slot is taken
+    uint64_t add(T value) {
+        uint32_t slot;
+        if (!free_slots_.empty()) {
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+        } else {
+            if (slot_count_ == block_size * max_blocks) return 0;
+            slot = slot_count_++;
+            if (slot / block_size == blocks_.size()) {
+                blocks_.push_back(std::make_unique<Slot[]>(block_size));
+                block_table_[slot / block_size].store(blocks_.back().get(), std::memory_order_release);
+            }
+        }
+        Slot& s = slot_at(slot);
+        s.value = std::move(value);
+        uint64_t id = static_cast<uint64_t>(s.generation) << 32 | slot;
+        s.id.store(id, std::memory_order_release);
+        ++size_;
+        return id;
+    }
+
+    // Makes id miss from now on; the entry is reclaimed by retire(frame)
+    bool remove(uint64_t id, uint64_t frame) {
+        if (!get(id)) return false;
+        auto slot = static_cast<uint32_t>(id);
+        Slot& s = slot_at(slot);
+        s.id.store(0, std::memory_order_release);
+        if (++s.generation == 0) s.generation = 1;
+        retired_.push_back({slot, frame});
+        --size_;
+        return true;
+    }
+
+    // Destroys entries removed in frames up to completed_frame and frees
+    // their slots for reuse
+    void retire(uint64_t completed_frame) {
+        std::erase_if(retired_, [&](const Retired& r) {
+            if (r.frame > completed_frame) return false;
+            slot_at(r.slot).value = T{};
+            free_slots_.push_back(r.slot);
+            return true;
+        });
+    }
+
+    T* get(uint64_t id) {
+        auto slot = static_cast<uint32_t>(id);
+        if (id >> 32 == 0 || slot / block_size >= max_blocks) return nullptr;
+        Slot* block = block_table_[slot / block_size].load(std::memory_order_acquire);
+        if (!block) return nullptr;
+        Slot& s = block[slot % block_size];
+        return s.id.load(std::memory_order_acquire) == id ? &s.value : nullptr;
+    }
+    const T* get(uint64_t id) const { return const_cast<ResourceRegistry*>(this)->get(id); }
+
+    size_t size() const { return size_; }
+    size_t pending_retire() const { return retired_.size(); }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> id{0};  // full id while live, 0 otherwise
+        uint32_t generation = 1;      // writer side only
+        T value{};
+    };
+    struct Retired { uint32_t slot; uint64_t frame; };
+
+    // Readers go through block_table_, which is never reallocated;
+    // blocks_ owns the blocks it points to
+    std::unique_ptr<std::atomic<Slot*>[]> block_table_;
+    std::vector<std::unique_ptr<Slot[]>> blocks_;
+    std::vector<uint32_t> free_slots_;
+    std::vector<Retired> retired_;
+    uint32_t slot_count_ = 0;
+    size_t size_ = 0;
+
+    Slot& slot_at(uint32_t slot) { return blocks_[slot / block_size][slot % block_size]; }
+};
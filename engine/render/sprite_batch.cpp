@@ -0,0 +1,41 @@
+#include "sprite_batch.hpp"
+
+namespace {
+
+uint32_t pack_color(Color c) {
+    return static_cast<uint32_t>(c.r) | static_cast<uint32_t>(c.g) << 8 |
+           static_cast<uint32_t>(c.b) << 16 | static_cast<uint32_t>(c.a) << 24;
+}
+
+} // namespace
+
+void SpriteBatcher::draw_rect(Vec2f pos, Size2f size, Color color, bool filled) {
+    add(Batch2DPipeline::Shape, {},
+        {{pos.x, pos.y, size.w, size.h}, {0.0f, 0.0f, 1.0f, 1.0f}, pack_color(color),
+         filled ? Shape2DKind::FilledRect : Shape2DKind::RectOutline, outline_width, 0});
+}
+
+void SpriteBatcher::draw_circle(Vec2f center, float radius, Color color, bool filled) {
+    // The circle's bounding square; the fragment shader cuts it round
+    add(Batch2DPipeline::Shape, {},
+        {{center.x - radius, center.y - radius, 2.0f * radius, 2.0f * radius},
+         {0.0f, 0.0f, 1.0f, 1.0f}, pack_color(color),
+         filled ? Shape2DKind::FilledCircle : Shape2DKind::CircleOutline, outline_width, 0});
+}
+
+void SpriteBatcher::draw_sprite(Vec2f pos, Size2f size, TextureHandle tex, Rect uv) {
+    add(Batch2DPipeline::Sprite, tex,
+        {{pos.x, pos.y, size.w, size.h}, {uv.x, uv.y, uv.w, uv.h}, pack_color(Color{}),
+         Shape2DKind::FilledRect, 0.0f, 0});
+}
+
+void SpriteBatcher::add(Batch2DPipeline pipeline, TextureHandle texture, const Instance2D& instance) {
+    // Shapes ignore the texture, so any shape continues a shape run
+    bool same_run = !draws_.empty() && draws_.back().pipeline == pipeline &&
+                    (pipeline == Batch2DPipeline::Shape || draws_.back().texture.id == texture.id);
+    if (!same_run) {
+        draws_.push_back({pipeline, texture, static_cast<uint32_t>(instances_.size()), 0});
+    }
+    instances_.push_back(instance);
+    ++draws_.back().instance_count;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "system/renderer/vulkan/vk_renderer.hpp"
+#include <vector>
+#include <cstdint>
+
+// Instanced 2D batching behind the RenderContext API.
+//
+// SpriteBatcher records draw_rect / draw_circle / draw_sprite calls as
+// fixed-size instances in submission order and starts a new draw only when
+// the pipeline or texture changes: every shape kind shares the shape
+// pipeline, and sprites share the sprite pipeline per texture. A backend
+// copies instances() into a storage buffer once per frame and issues one
+// instanced draw per draws() entry: 6 vertices, instance_count instances
+// from first_instance, expanding each instance to a quad in the vertex
+// shader. Painter's order is kept, so interleaving two textures still
+// splits the batch. HeadlessRenderer consumes these draws; the Vulkan
+// backend does not draw them yet.
+
+enum class Shape2DKind : uint32_t {
+    FilledRect,
+    RectOutline,
+    FilledCircle,
+    CircleOutline,
+};
+
+// One primitive, laid out for a std430 storage buffer (48 bytes)
+struct Instance2D {
+    float rect[4];     // x, y, width, height in pixels
+    float uv[4];       // x, y, width, height in texture space (sprites)
+    uint32_t color;    // RGBA8, r in the low byte
+    Shape2DKind kind;  // shapes only
+    float outline;     // outline width in pixels
+    uint32_t reserved;
+};
+static_assert(sizeof(Instance2D) == 48, "Instance2D must keep its std430 layout");
+
+enum class Batch2DPipeline : uint32_t {
+    Shape,
+    Sprite,
+};
+
+struct InstancedDraw2D {
+    Batch2DPipeline pipeline = Batch2DPipeline::Shape;
+    TextureHandle texture;          // sprites only
+    uint32_t first_instance = 0;
+    uint32_t instance_count = 0;
+};
+
+class SpriteBatcher final : public RenderContext {
+public:
+    static constexpr float outline_width = 1.0f;
+
+    void draw_rect(Vec2f pos, Size2f size, Color color, bool filled) override;
+    void draw_circle(Vec2f center, float radius, Color color, bool filled) override;
+    void draw_sprite(Vec2f pos, Size2f size, TextureHandle tex, Rect uv) override;
+    // Text is drawn from TextRenderer batches, not per call
+    void draw_text(Vec2f, const char*, Color, float) override {}
+
+    // Drops the recorded frame, keeping capacity
+    void reset() {
+        instances_.clear();
+        draws_.clear();
+    }
+
+    const std::vector<Instance2D>& instances() const { return instances_; }
+    const std::vector<InstancedDraw2D>& draws() const { return draws_; }
+
+private:
+    std::vector<Instance2D> instances_;
+    std::vector<InstancedDraw2D> draws_;
+
+    void add(Batch2DPipeline pipeline, TextureHandle texture, const Instance2D& instance);
+};
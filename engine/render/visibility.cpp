@@ -0,0 +1,236 @@
+#include "visibility.hpp"
+#include "../math/simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Clip w below which a point counts as behind the eye
+constexpr float min_clip_w = 1e-5f;
+
+// Plane distance of the box corner farthest along the plane normal; the
+// operation order is shared with the SIMD kernel so both agree exactly
+inline float farthest_distance(const float plane[4], float px, float py, float pz) {
+    return plane[0] * px + plane[1] * py + plane[2] * pz + plane[3];
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Frustum
+// ---------------------------------------------------------------------------
+
+Frustum Frustum::from_view_projection(const Mat4& vp) {
+    // Gribb/Hartmann: each plane is the last row plus or minus another row
+    auto row = [&vp](int r, float out[4]) {
+        for (int c = 0; c < 4; ++c) out[c] = vp(r, c);
+    };
+    float r[4][4];
+    for (int i = 0; i < 4; ++i) row(i, r[i]);
+
+    Frustum f;
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int side = 0; side < 2; ++side) {
+            float* p = f.planes[axis * 2 + side];
+            float sign = side == 0 ? 1.0f : -1.0f;
+            for (int c = 0; c < 4; ++c) p[c] = r[3][c] + sign * r[axis][c];
+            float len = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            if (len > 0.0f) {
+                for (int c = 0; c < 4; ++c) p[c] /= len;
+            }
+        }
+    }
+    return f;
+}
+
+bool Frustum::intersects(Vec3f min, Vec3f max) const {
+    for (const auto& p : planes) {
+        float d = farthest_distance(p, p[0] >= 0.0f ? max.x : min.x,
+                                       p[1] >= 0.0f ? max.y : min.y,
+                                       p[2] >= 0.0f ? max.z : min.z);
+        if (!(d >= 0.0f)) return false;
+    }
+    return true;
+}
+
+void BoundsSoA::resize(size_t n) {
+    min_x.resize(n); min_y.resize(n); min_z.resize(n);
+    max_x.resize(n); max_y.resize(n); max_z.resize(n);
+}
+
+size_t frustum_cull(const Frustum& frustum, const BoundsSoA& boxes,
+                    size_t begin, size_t end, uint8_t* visible) {
+    // Per plane, the farthest corner takes each coordinate from min or max
+    // by the sign of the normal, so the arrays to read are picked up front
+    const float* xs[6];
+    const float* ys[6];
+    const float* zs[6];
+    for (int k = 0; k < 6; ++k) {
+        const float* p = frustum.planes[k];
+        xs[k] = p[0] >= 0.0f ? boxes.max_x.data() : boxes.min_x.data();
+        ys[k] = p[1] >= 0.0f ? boxes.max_y.data() : boxes.min_y.data();
+        zs[k] = p[2] >= 0.0f ? boxes.max_z.data() : boxes.min_z.data();
+    }
+
+    size_t count = 0;
+    size_t i = begin;
+#if ERGO_SIMD_AVX2 || ERGO_SIMD_SSE
+    using namespace simd;
+    vfloat zero = splat(0.0f);
+    for (; i + lanes <= end; i += lanes) {
+        vfloat inside = cmp_le(zero, zero);
+        for (int k = 0; k < 6; ++k) {
+            const float* p = frustum.planes[k];
+            vfloat d = add(add(add(mul(splat(p[0]), load(xs[k] + i)),
+                                   mul(splat(p[1]), load(ys[k] + i))),
+                               mul(splat(p[2]), load(zs[k] + i))),
+                           splat(p[3]));
+            inside = vand(inside, cmp_le(zero, d));
+        }
+        uint32_t bits = movemask(inside);
+        for (size_t l = 0; l < lanes; ++l) {
+            uint8_t v = static_cast<uint8_t>((bits >> l) & 1u);
+            visible[i + l] = v;
+            count += v;
+        }
+    }
+#endif
+    for (; i < end; ++i) {
+        bool v = true;
+        for (int k = 0; k < 6 && v; ++k) {
+            v = farthest_distance(frustum.planes[k], xs[k][i], ys[k][i], zs[k][i]) >= 0.0f;
+        }
+        visible[i] = v ? 1 : 0;
+        count += v ? 1 : 0;
+    }
+    return count;
+}
+
+void transform_bounds(const Mat4& t, Vec3f local_min, Vec3f local_max,
+                      Vec3f& world_min, Vec3f& world_max) {
+    Vec3f c = (local_min + local_max) * 0.5f;
+    Vec3f e = (local_max - local_min) * 0.5f;
+    Vec3f wc{t.m[0] * c.x + t.m[4] * c.y + t.m[8] * c.z + t.m[12],
+             t.m[1] * c.x + t.m[5] * c.y + t.m[9] * c.z + t.m[13],
+             t.m[2] * c.x + t.m[6] * c.y + t.m[10] * c.z + t.m[14]};
+    Vec3f we{std::abs(t.m[0]) * e.x + std::abs(t.m[4]) * e.y + std::abs(t.m[8]) * e.z,
+             std::abs(t.m[1]) * e.x + std::abs(t.m[5]) * e.y + std::abs(t.m[9]) * e.z,
+             std::abs(t.m[2]) * e.x + std::abs(t.m[6]) * e.y + std::abs(t.m[10]) * e.z};
+    world_min = wc - we;
+    world_max = wc + we;
+}
+
+// ---------------------------------------------------------------------------
+// OcclusionBuffer
+// ---------------------------------------------------------------------------
+
+void OcclusionBuffer::begin(const Mat4& view_projection) {
+    view_projection_ = view_projection;
+    depth_.assign(static_cast<size_t>(width) * height, std::numeric_limits<float>::infinity());
+}
+
+// Corner k takes x from max if bit 0 is set, y from bit 1, z from bit 2
+bool OcclusionBuffer::project_corners(Vec3f min, Vec3f max, ScreenPoint out[8]) const {
+    const float* m = view_projection_.m;
+    for (int k = 0; k < 8; ++k) {
+        Vec3f p{(k & 1) ? max.x : min.x, (k & 2) ? max.y : min.y, (k & 4) ? max.z : min.z};
+        float x = m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12];
+        float y = m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13];
+        float z = m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14];
+        float w = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
+        if (!(w > min_clip_w)) return false;
+        out[k] = {(x / w * 0.5f + 0.5f) * width, (y / w * 0.5f + 0.5f) * height, z / w};
+    }
+    return true;
+}
+
+void OcclusionBuffer::add_occluder(Vec3f min, Vec3f max) {
+    if (depth_.empty()) return;
+    ScreenPoint s[8];
+    if (!project_corners(min, max, s)) return;
+
+    static constexpr int faces[6][4] = {
+        {0, 2, 6, 4}, {1, 3, 7, 5}, {0, 1, 5, 4}, {2, 3, 7, 6}, {0, 1, 3, 2}, {4, 5, 7, 6},
+    };
+    for (const auto& f : faces) {
+        raster_quad({s[f[0]], s[f[1]], s[f[2]], s[f[3]]});
+    }
+}
+
+// Faces are rasterized whole: split into triangles, pixels straddling the
+// diagonal would be fully inside neither half and leave a gap
+void OcclusionBuffer::raster_quad(const std::array<ScreenPoint, 4>& q) {
+    float area = 0.0f;
+    for (int k = 0; k < 4; ++k) {
+        const ScreenPoint& p = q[k];
+        const ScreenPoint& n = q[(k + 1) % 4];
+        area += p.x * n.y - n.x * p.y;
+    }
+    if (std::abs(area) < 1e-6f) return;
+    float sign = area > 0.0f ? 1.0f : -1.0f;
+
+    // Edge p->q as e(x, y) = dx * (y - p.y) - dy * (x - p.x), oriented so
+    // the inside is positive; a pixel is fully inside an edge when e at its
+    // center exceeds half the edge's L1 slope
+    struct Edge { float px, py, dx, dy, margin; };
+    auto make_edge = [sign](const ScreenPoint& from, const ScreenPoint& to) {
+        float dx = (to.x - from.x) * sign;
+        float dy = (to.y - from.y) * sign;
+        return Edge{from.x, from.y, dx, dy, 0.5f * (std::abs(dx) + std::abs(dy))};
+    };
+    const Edge edges[4] = {make_edge(q[0], q[1]), make_edge(q[1], q[2]),
+                           make_edge(q[2], q[3]), make_edge(q[3], q[0])};
+
+    auto clamp_x = [](float v) { return std::clamp(v, 0.0f, static_cast<float>(width)); };
+    auto clamp_y = [](float v) { return std::clamp(v, 0.0f, static_cast<float>(height)); };
+    int x0 = static_cast<int>(std::floor(clamp_x(std::min({q[0].x, q[1].x, q[2].x, q[3].x}))));
+    int x1 = std::min(width - 1, static_cast<int>(std::ceil(clamp_x(std::max({q[0].x, q[1].x, q[2].x, q[3].x})))));
+    int y0 = static_cast<int>(std::floor(clamp_y(std::min({q[0].y, q[1].y, q[2].y, q[3].y}))));
+    int y1 = std::min(height - 1, static_cast<int>(std::ceil(clamp_y(std::max({q[0].y, q[1].y, q[2].y, q[3].y})))));
+    float depth = std::max({q[0].z, q[1].z, q[2].z, q[3].z});
+
+    for (int y = y0; y <= y1; ++y) {
+        float cy = static_cast<float>(y) + 0.5f;
+        for (int x = x0; x <= x1; ++x) {
+            float cx = static_cast<float>(x) + 0.5f;
+            bool inside = true;
+            for (const Edge& e : edges) {
+                float v = e.dx * (cy - e.py) - e.dy * (cx - e.px);
+                inside = inside && v >= e.margin;
+            }
+            if (inside) {
+                float& d = depth_[static_cast<size_t>(y) * width + x];
+                d = std::min(d, depth);
+            }
+        }
+    }
+}
+
+bool OcclusionBuffer::test(Vec3f min, Vec3f max) const {
+    if (depth_.empty()) return true;
+    ScreenPoint s[8];
+    if (!project_corners(min, max, s)) return true;
+
+    float min_x = s[0].x, max_x = s[0].x, min_y = s[0].y, max_y = s[0].y, near_z = s[0].z;
+    for (int k = 1; k < 8; ++k) {
+        min_x = std::min(min_x, s[k].x); max_x = std::max(max_x, s[k].x);
+        min_y = std::min(min_y, s[k].y); max_y = std::max(max_y, s[k].y);
+        near_z = std::min(near_z, s[k].z);
+    }
+    // Off-screen boxes are the frustum test's call
+    if (max_x <= 0.0f || max_y <= 0.0f || min_x >= width || min_y >= height) return true;
+
+    // Every pixel the rectangle touches
+    int x0 = static_cast<int>(std::floor(std::max(min_x, 0.0f)));
+    int y0 = static_cast<int>(std::floor(std::max(min_y, 0.0f)));
+    int x1 = std::min(width - 1, static_cast<int>(std::floor(std::min(max_x, static_cast<float>(width)))));
+    int y1 = std::min(height - 1, static_cast<int>(std::floor(std::min(max_y, static_cast<float>(height)))));
+    for (int y = y0; y <= y1; ++y) {
+        const float* row = &depth_[static_cast<size_t>(y) * width];
+        for (int x = x0; x <= x1; ++x) {
+            if (near_z <= row[x]) return true;
+        }
+    }
+    return false;
+}
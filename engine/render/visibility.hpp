@@ -0,0 +1,74 @@
+#pragma once
+#include "../math/vec3.hpp"
+#include "../math/mat4.hpp"
+#include <array>
+#include <vector>
+#include <cstdint>
+
+// CPU visibility tests run before draw commands are recorded.
+
+// The six clip planes of a view-projection matrix (OpenGL clip space,
+// -w <= z <= w), normalized, with normals pointing inside.
+struct Frustum {
+    float planes[6][4] = {};  // nx, ny, nz, d: inside where n.p + d >= 0
+
+    static Frustum from_view_projection(const Mat4& view_projection);
+
+    // False only if the box lies entirely outside one plane (conservative:
+    // some boxes near a frustum corner pass)
+    bool intersects(Vec3f min, Vec3f max) const;
+};
+
+// World-space boxes in structure-of-arrays form for the batched test
+struct BoundsSoA {
+    std::vector<float> min_x, min_y, min_z;
+    std::vector<float> max_x, max_y, max_z;
+
+    size_t size() const { return min_x.size(); }
+    void resize(size_t n);
+    void set(size_t i, Vec3f min, Vec3f max) {
+        min_x[i] = min.x; min_y[i] = min.y; min_z[i] = min.z;
+        max_x[i] = max.x; max_y[i] = max.y; max_z[i] = max.z;
+    }
+};
+
+// Sets visible[i] to 1 for boxes in [begin, end) that intersect the
+// frustum and to 0 for the rest, SIMD lanes at a time; returns the number
+// visible. Matches Frustum::intersects exactly.
+size_t frustum_cull(const Frustum& frustum, const BoundsSoA& boxes,
+                    size_t begin, size_t end, uint8_t* visible);
+
+// Bounds of a local box under an affine transform (the box of the
+// transformed box)
+void transform_bounds(const Mat4& transform, Vec3f local_min, Vec3f local_max,
+                      Vec3f& world_min, Vec3f& world_max);
+
+// Small software depth buffer for occlusion culling.
+//
+// Occluder boxes are rasterized face by face at low resolution. A pixel is
+// written only if it lies entirely inside a face, with the face's farthest
+// corner depth, so the buffer never claims more coverage or nearness than
+// the occluders have. A box is hidden when every pixel under its screen
+// rectangle holds a depth nearer than the box's nearest corner. Boxes
+// crossing the near plane are never hidden and never occlude.
+class OcclusionBuffer {
+public:
+    static constexpr int width = 256;
+    static constexpr int height = 128;
+
+    // Clears the buffer for a new view
+    void begin(const Mat4& view_projection);
+
+    void add_occluder(Vec3f min, Vec3f max);
+    // True if any part of the box may be visible
+    bool test(Vec3f min, Vec3f max) const;
+
+private:
+    struct ScreenPoint { float x, y, z; };
+
+    Mat4 view_projection_;
+    std::vector<float> depth_;   // NDC depth per pixel, row-major
+
+    bool project_corners(Vec3f min, Vec3f max, ScreenPoint out[8]) const;
+    void raster_quad(const std::array<ScreenPoint, 4>& corners);
+};
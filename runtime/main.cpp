@@ -47,6 +47,7 @@ int main(int argc, char** argv) {
     // Render pipeline with multi-CPU worker threads
     RenderPipeline render_pipeline;
     render_pipeline.initialize(0);  // 0 = auto-detect thread count
+    renderer.set_pipeline(&render_pipeline);
 
     // Task manager
     TaskManager task_mgr;
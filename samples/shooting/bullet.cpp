@@ -12,6 +12,7 @@ void Bullet::start() {
     collider.shape = CircleData{4.0f};
     collider.tag = ColliderTag::Bullet;
     collider.transform = &object.transform_;
+    collider.ccd = true;  // fast mover: sweep instead of end-position test
     collider.on_hit = [this](const Collider& target) {
         return hit_callback(target);
     };
@@ -1,15 +1,11 @@
 #include "vk_renderer.hpp"
+#include "engine/render/sprite_batch.hpp"
+#include "engine/render/render_pipeline.hpp"
 
-// Stub RenderContext implementation for initial skeleton
-struct StubRenderContext final : RenderContext {
-    void draw_rect(Vec2f, Size2f, Color, bool) override {}
-    void draw_circle(Vec2f, float, Color, bool) override {}
-    void draw_sprite(Vec2f, Size2f, TextureHandle, Rect) override {}
-    void draw_text(Vec2f, const char*, Color, float) override {}
-};
-
+// Draw calls collect into instanced batches for the frame
 struct VulkanRenderer::Impl {
-    StubRenderContext render_context;
+    SpriteBatcher render_context;
+    RenderPipeline* pipeline = nullptr;
     bool initialized = false;
 };
 
@@ -22,16 +18,37 @@ bool VulkanRenderer::initialize() {
     impl_ = new Impl{};
     impl_->initialized = true;
     // TODO: Initialize Vulkan (VkInstance, VkDevice, VkQueue, swapchain, etc.)
+    // TODO: Persistently mapped staging buffer for GpuUploadQueue's ring, a
+    // transfer queue and a timeline semaphore carrying its fence values
     return true;
 }
 
 void VulkanRenderer::begin_frame() {
     if (!impl_) return;
+    impl_->render_context.reset();
     // TODO: Acquire swapchain image, begin command buffer
+    // TODO: Once copies really run on the GPU, GpuUploadQueue::retire() here
+    // with the timeline semaphore's value instead of at submission
 }
 
 void VulkanRenderer::end_frame() {
     if (!impl_) return;
+    // TODO: Draw render_context: instanced shape and sprite pipelines
+    // (no vertex input, Instance2D read from a per-frame SSBO) are still to
+    // be written. Then copy instances() into the SSBO and, per draws()
+    // entry, bind the pipeline (and the texture for sprites) and record
+    // vkCmdDraw(cmd, 6, draw.instance_count, 0, draw.first_instance)
+    if (impl_->pipeline) {
+        GpuUploadQueue& uploads = impl_->pipeline->upload_queue();
+        const UploadBatch& batch = uploads.submit();
+        // TODO: Record batch on the transfer queue: one vkCmdCopyBuffer per
+        // destination heap (one VkBuffer per device heap, created as
+        // DeviceHeapAllocator opens them) and vkCmdCopyBufferToImage per
+        // image copy; the graphics submit waits on it, and the frame signals
+        // batch.fence on the timeline semaphore
+        // No copy is in flight until then, so the batch is done once taken
+        uploads.retire(batch.fence);
+    }
     // TODO: End command buffer, submit, present
 }
 
@@ -42,6 +59,11 @@ void VulkanRenderer::shutdown() {
     impl_ = nullptr;
 }
 
+void VulkanRenderer::set_pipeline(RenderPipeline* pipeline) {
+    if (!impl_) return;
+    impl_->pipeline = pipeline;
+}
+
 RenderContext* VulkanRenderer::context() {
     if (!impl_) return nullptr;
     return &impl_->render_context;
@@ -15,6 +15,8 @@ struct RenderContext {
     virtual void draw_text(Vec2f pos, const char* text, Color color, float scale) = 0;
 };
 
+class RenderPipeline;
+
 class VulkanRenderer {
     // Vulkan internal state (VkInstance, VkDevice, etc.)
     struct Impl;
@@ -33,6 +35,9 @@ public:
     // Get RenderContext
     RenderContext* context();
 
+    // Pipeline whose upload queue end_frame() drains
+    void set_pipeline(RenderPipeline* pipeline);
+
     // Resource management
     TextureHandle load_texture(const char* path);
     void unload_texture(TextureHandle handle);
@@ -1,5 +1,9 @@
 #include "framework/test_framework.hpp"
 #include "engine/physics/hit_test.hpp"
+#include "engine/physics/physics_system.hpp"
+#include "engine/core/job_system.hpp"
+#include <vector>
+#include <algorithm>
 
 using namespace ergo::test;
 
@@ -196,6 +200,351 @@ static void register_check_hit_tests() {
     });
 }
 
+// ============================================================
+// Swept (continuous) tests
+// ============================================================
+
+static TestSuite suite_sweep("Physics/Sweep");
+
+static void register_sweep_tests() {
+    suite_sweep.add("circle_tunnels_discrete_but_hits_swept", [](TestContext& ctx) {
+        CircleData bullet{1.0f};
+        CircleData enemy{2.0f};
+        Transform2D te; te.position = {10.0f, 0.0f};
+        Transform2D end; end.position = {20.0f, 0.0f};
+
+        ERGO_TEST_ASSERT_FALSE(ctx, hit_test(bullet, end, enemy, te));
+        auto toi = sweep_test(bullet, {0.0f, 0.0f}, {20.0f, 0.0f}, enemy, te);
+        ERGO_TEST_ASSERT_TRUE(ctx, toi.has_value());
+        // Contact when distance == 3: x = 7 -> t = 7 / 20
+        if (toi) ERGO_TEST_ASSERT_NEAR(ctx, *toi, 0.35f, 1e-4f);
+    });
+
+    suite_sweep.add("circle_misses_box_corner", [](TestContext& ctx) {
+        CircleData bullet{0.5f};
+        AABBData box{Vec2f(1.0f, 1.0f)};
+        Transform2D tb; tb.position = {0.0f, 0.0f};
+        // Diagonal path passing 0.6 beyond the (1,1) corner along its normal
+        float off = 1.0f + 0.6f / std::sqrt(2.0f);
+        auto toi = sweep_test(bullet, {off - 5.0f, off + 5.0f}, {off + 5.0f, off - 5.0f}, box, tb);
+        ERGO_TEST_ASSERT_FALSE(ctx, toi.has_value());
+    });
+
+    suite_sweep.add("aabb_sweep_hits_face", [](TestContext& ctx) {
+        AABBData mover{Vec2f(1.0f, 1.0f)};
+        AABBData wall{Vec2f(1.0f, 10.0f)};
+        Transform2D tw; tw.position = {10.0f, 0.0f};
+        auto toi = sweep_test(mover, {0.0f, 0.0f}, {16.0f, 0.0f}, wall, tw);
+        ERGO_TEST_ASSERT_TRUE(ctx, toi.has_value());
+        // Faces meet at x = 8 -> t = 0.5
+        if (toi) ERGO_TEST_ASSERT_NEAR(ctx, *toi, 0.5f, 1e-4f);
+    });
+
+    suite_sweep.add("aabb_vs_circle_matches_reverse", [](TestContext& ctx) {
+        AABBData box{Vec2f(1.0f, 1.0f)};
+        CircleData circle{1.0f};
+        Transform2D tc; tc.position = {10.0f, 0.5f};
+        auto t1 = sweep_test(box, {0.0f, 0.0f}, {20.0f, 0.0f}, circle, tc);
+        Transform2D tbox; tbox.position = {0.0f, 0.0f};
+        auto t2 = sweep_test(circle, {10.0f, 0.5f}, {-10.0f, 0.5f}, box, tbox);
+        ERGO_TEST_ASSERT_TRUE(ctx, t1.has_value() && t2.has_value());
+        if (t1 && t2) ERGO_TEST_ASSERT_NEAR(ctx, *t1, *t2, 1e-5f);
+    });
+
+    suite_sweep.add("physics_system_reports_toi", [](TestContext& ctx) {
+        PhysicsSystem physics;
+
+        Transform2D te; te.position = {50.0f, 0.0f};
+        Collider enemy; enemy.tag = ColliderTag::Enemy;
+        enemy.shape = CircleData{5.0f}; enemy.transform = &te;
+
+        Transform2D tb; tb.position = {0.0f, 0.0f};
+        Collider bullet; bullet.tag = ColliderTag::Bullet;
+        bullet.shape = CircleData{1.0f}; bullet.transform = &tb;
+        bullet.ccd = true;
+
+        float reported = -1.0f;
+        bullet.on_hit = [&](const Collider&) { reported = physics.hit_toi(); return true; };
+
+        physics.register_collider(enemy);
+        physics.register_collider(bullet);
+
+        tb.position = {100.0f, 0.0f};  // jumps straight through the enemy
+        physics.mark_moved(bullet);
+        physics.run();
+        // Contact at x = 44 -> t = 0.44
+        ERGO_TEST_ASSERT_NEAR(ctx, reported, 0.44f, 1e-4f);
+        ERGO_TEST_ASSERT_NEAR(ctx, bullet.prev_position.x, 100.0f, 1e-6f);
+    });
+}
+
+// ============================================================
+// Batched SoA hit tests
+// ============================================================
+
+static TestSuite suite_hit_batch("Physics/HitBatch");
+
+static void register_hit_batch_tests() {
+    // 37 targets: four full 8-wide blocks plus a scalar tail
+    suite_hit_batch.add("batch_matches_scalar", [](TestContext& ctx) {
+        constexpr int count = 37;
+        std::vector<Transform2D> transforms(count);
+        std::vector<Collider> targets(count);
+        ColliderBatch2D batch;
+        for (int i = 0; i < count; ++i) {
+            transforms[i].position = {static_cast<float>((i * 7) % 23) - 11.0f,
+                                      static_cast<float>((i * 5) % 19) - 9.0f};
+            targets[i].transform = &transforms[i];
+            if (i % 3 == 0) targets[i].shape = CircleData{0.5f + 0.1f * static_cast<float>(i % 4)};
+            else            targets[i].shape = AABBData{Vec2f(0.3f * static_cast<float>(i % 5) + 0.2f, 1.0f)};
+            batch.add(&targets[i]);
+        }
+
+        Transform2D tq; tq.position = {0.7f, -1.3f};
+        Collider query_aabb; query_aabb.transform = &tq;
+        query_aabb.shape = AABBData{Vec2f(3.0f, 2.0f)};
+        Collider query_circle; query_circle.transform = &tq;
+        query_circle.shape = CircleData{4.0f};
+
+        for (const Collider* q : {&query_aabb, &query_circle}) {
+            std::vector<const Collider*> batched;
+            check_hit_batch(*q, batch, [&](Collider& t) { batched.push_back(&t); });
+
+            size_t expected = 0;
+            bool all_found = true;
+            for (auto& t : targets) {
+                if (!check_hit(*q, t)) continue;
+                ++expected;
+                if (std::find(batched.begin(), batched.end(), &t) == batched.end())
+                    all_found = false;
+            }
+            ERGO_TEST_ASSERT_EQ(ctx, batched.size(), expected);
+            ERGO_TEST_ASSERT_TRUE(ctx, all_found);
+        }
+    });
+
+    // Zero-radius circles: centers inside, on the edge of and outside boxes
+    suite_hit_batch.add("batch_matches_scalar_for_point_probes", [](TestContext& ctx) {
+        constexpr int count = 29;
+        std::vector<Transform2D> transforms(count);
+        std::vector<Collider> boxes(count), points(count);
+        ColliderBatch2D box_batch, point_batch;
+        for (int i = 0; i < count; ++i) {
+            transforms[i].position = {static_cast<float>(i % 6) * 0.5f - 1.5f,
+                                      static_cast<float>(i % 5) * 0.5f - 1.0f};
+            boxes[i].transform = points[i].transform = &transforms[i];
+            boxes[i].shape = AABBData{Vec2f(1.0f, 0.5f + 0.25f * static_cast<float>(i % 3))};
+            points[i].shape = CircleData{0.0f};
+            box_batch.add(&boxes[i]);
+            point_batch.add(&points[i]);
+        }
+
+        Transform2D tq; tq.position = {0.0f, 0.0f};
+        Collider probe; probe.transform = &tq;
+        probe.shape = CircleData{0.0f};
+        Collider box; box.transform = &tq;
+        box.shape = AABBData{Vec2f(1.0f, 0.5f)};
+
+        auto check = [&](const Collider& q, ColliderBatch2D& batch, std::vector<Collider>& targets) {
+            std::vector<const Collider*> batched;
+            check_hit_batch(q, batch, [&](Collider& t) { batched.push_back(&t); });
+            bool same = true;
+            size_t expected = 0;
+            for (auto& t : targets) {
+                bool found = std::find(batched.begin(), batched.end(), &t) != batched.end();
+                same = same && found == check_hit(q, t);
+                expected += check_hit(q, t) ? 1 : 0;
+            }
+            ERGO_TEST_ASSERT_TRUE(ctx, expected > 0);
+            ERGO_TEST_ASSERT_TRUE(ctx, same);
+        };
+        check(probe, box_batch, boxes);
+        check(box, point_batch, points);
+    });
+
+    suite_hit_batch.add("hit_test8_mask_bits", [](TestContext& ctx) {
+        CircleBatch circles;
+        for (int i = 0; i < 8; ++i) {
+            Vec2f pos{static_cast<float>(i) * 10.0f, 0.0f};
+            circles.push(nullptr, pos, CircleData{1.0f});
+        }
+        CircleData probe{1.0f};
+        Transform2D tp; tp.position = {30.5f, 0.0f};
+        // Only the target at x=30 lies within r_a + r_b = 2
+        ERGO_TEST_ASSERT_EQ(ctx, hit_test8(probe, tp, circles, 0), 1u << 3);
+    });
+}
+
+// ============================================================
+// PhysicsSystem dispatch tests
+// ============================================================
+
+static TestSuite suite_physics_system("Physics/PhysicsSystem");
+
+// Records (collider handle, target handle) for every on_hit call
+using HitLog = std::vector<std::pair<uint64_t, uint64_t>>;
+
+static HitLog run_bullet_field(int bullets, bool reverse_mark_order) {
+    PhysicsSystem physics;
+    HitLog log;
+
+    std::vector<Transform2D> transforms(static_cast<size_t>(bullets) + 1);
+    std::vector<Collider> colliders(static_cast<size_t>(bullets) + 1);
+
+    // One large enemy covering every bullet
+    transforms[0].position = {0.0f, 0.0f};
+    colliders[0].tag = ColliderTag::Enemy;
+    colliders[0].shape = AABBData{Vec2f(1000.0f, 1000.0f)};
+    colliders[0].transform = &transforms[0];
+
+    for (int i = 1; i <= bullets; ++i) {
+        transforms[i].position = {static_cast<float>(i), 0.0f};
+        colliders[i].tag = ColliderTag::Bullet;
+        colliders[i].shape = CircleData{1.0f};
+        colliders[i].transform = &transforms[i];
+    }
+
+    for (auto& c : colliders) {
+        physics.register_collider(c);
+        Collider* self = &c;
+        c.on_hit = [self, &log](const Collider& other) {
+            log.emplace_back(self->handle.id, other.handle.id);
+            return self->tag == ColliderTag::Bullet;  // bullets consume the hit
+        };
+    }
+
+    if (reverse_mark_order) {
+        for (int i = bullets; i >= 1; --i) physics.mark_moved(colliders[i]);
+    } else {
+        for (int i = 1; i <= bullets; ++i) physics.mark_moved(colliders[i]);
+    }
+    physics.run();
+    return log;
+}
+
+// Several frames of a mixed scene: players, small and boss-sized enemies,
+// and bullets (some ccd) moving each frame. Everything moved is marked.
+static HitLog run_mixed_scene(Broadphase2D broadphase) {
+    PhysicsSystem physics;
+    HitLog log;
+
+    constexpr int count = 300;
+    std::vector<Transform2D> transforms(count);
+    std::vector<Collider> colliders(count);
+    auto place = [&](int i, int frame) {
+        transforms[i].position = {static_cast<float>((i * 53 + frame * (i % 7)) % 800),
+                                  static_cast<float>((i * 29 + frame * 11) % 600)};
+    };
+
+    for (int i = 0; i < count; ++i) {
+        place(i, 0);
+        auto& c = colliders[i];
+        c.transform = &transforms[i];
+        if (i % 10 == 0) {
+            c.tag = ColliderTag::Player;
+            c.shape = CircleData{6.0f};
+        } else if (i % 3 == 0) {
+            c.tag = ColliderTag::Enemy;
+            c.shape = (i % 30 == 3) ? AABBData{Vec2f(200.0f, 120.0f)}
+                                    : AABBData{Vec2f(8.0f, 8.0f)};
+        } else {
+            c.tag = ColliderTag::Bullet;
+            c.shape = CircleData{2.0f};
+            c.ccd = (i % 4 == 1);
+        }
+        // Half the scene is registered before switching broadphase, half after
+        if (i == count / 2) physics.set_broadphase(broadphase);
+        physics.register_collider(c);
+        Collider* self = &c;
+        c.on_hit = [self, &log](const Collider& other) {
+            log.emplace_back(self->handle.id, other.handle.id);
+            return false;
+        };
+    }
+
+    for (int frame = 1; frame <= 6; ++frame) {
+        for (int i = 0; i < count; ++i) {
+            if (i % 30 == 3 && frame % 2) continue;  // bosses move every other frame
+            place(i, frame);
+            physics.mark_moved(colliders[i]);
+        }
+        if (frame == 3) physics.remove_collider(colliders[17]);
+        physics.run();
+    }
+    return log;
+}
+
+static void register_physics_system_tests() {
+    suite_physics_system.add("consumed_hit_skips_target", [](TestContext& ctx) {
+        auto log = run_bullet_field(1, false);
+        ERGO_TEST_ASSERT_EQ(ctx, log.size(), (size_t)1);
+        ERGO_TEST_ASSERT_EQ(ctx, log[0].first, (uint64_t)2);   // bullet
+        ERGO_TEST_ASSERT_EQ(ctx, log[0].second, (uint64_t)1);  // enemy
+    });
+
+    suite_physics_system.add("callbacks_ordered_by_handle", [](TestContext& ctx) {
+        auto log = run_bullet_field(100, true);
+        ERGO_TEST_ASSERT_EQ(ctx, log.size(), (size_t)100);
+        bool sorted = true;
+        for (size_t i = 1; i < log.size(); ++i) {
+            if (log[i - 1].first >= log[i].first) sorted = false;
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, sorted);
+    });
+
+    suite_physics_system.add("parallel_matches_serial", [](TestContext& ctx) {
+        auto serial = run_bullet_field(500, false);
+
+        g_job_system.initialize(3);
+        auto parallel = run_bullet_field(500, true);
+        g_job_system.shutdown();
+
+        ERGO_TEST_ASSERT_TRUE(ctx, serial == parallel);
+    });
+
+    suite_physics_system.add("broadphase_modes_match", [](TestContext& ctx) {
+        auto brute = run_mixed_scene(Broadphase2D::BruteForce);
+        auto grid = run_mixed_scene(Broadphase2D::Grid);
+        auto tree = run_mixed_scene(Broadphase2D::AabbTree);
+        ERGO_TEST_ASSERT_TRUE(ctx, !brute.empty());
+        ERGO_TEST_ASSERT_EQ(ctx, grid.size(), brute.size());
+        ERGO_TEST_ASSERT_EQ(ctx, tree.size(), brute.size());
+        ERGO_TEST_ASSERT_TRUE(ctx, grid == brute);
+        ERGO_TEST_ASSERT_TRUE(ctx, tree == brute);
+    });
+
+    suite_physics_system.add("tree_refits_unmarked_and_late_colliders", [](TestContext& ctx) {
+        PhysicsSystem physics;
+        physics.set_broadphase(Broadphase2D::AabbTree);
+        int hits = 0;
+
+        Transform2D enemy_transform, bullet_transform;
+        enemy_transform.position = {0.0f, 0.0f};
+        bullet_transform.position = {500.0f, 500.0f};
+        Collider enemy, bullet;
+        enemy.tag = ColliderTag::Enemy;
+        enemy.shape = AABBData{Vec2f(8.0f, 8.0f)};
+        enemy.transform = &enemy_transform;
+        bullet.tag = ColliderTag::Bullet;
+        bullet.shape = CircleData{2.0f};
+        bullet.on_hit = [&](const Collider&) { ++hits; return true; };
+
+        // The bullet has no transform when registered
+        physics.register_collider(enemy);
+        physics.register_collider(bullet);
+        bullet.transform = &bullet_transform;
+        physics.mark_moved(bullet);
+        physics.run();
+        ERGO_TEST_ASSERT_EQ(ctx, hits, 0);
+
+        // The enemy moves onto the bullet without being marked
+        enemy_transform.position = {500.0f, 500.0f};
+        physics.mark_moved(bullet);
+        physics.run();
+        ERGO_TEST_ASSERT_EQ(ctx, hits, 1);
+    });
+}
+
 // ============================================================
 // Registration
 // ============================================================
@@ -205,9 +554,15 @@ void register_physics_tests(TestRunner& runner) {
     register_circle_tests();
     register_circle_aabb_tests();
     register_check_hit_tests();
+    register_sweep_tests();
+    register_hit_batch_tests();
+    register_physics_system_tests();
 
     runner.add_suite(suite_aabb);
     runner.add_suite(suite_circle);
     runner.add_suite(suite_circle_aabb);
     runner.add_suite(suite_check_hit);
+    runner.add_suite(suite_sweep);
+    runner.add_suite(suite_hit_batch);
+    runner.add_suite(suite_physics_system);
 }
@@ -1,8 +1,21 @@
 #include "framework/test_framework.hpp"
 #include "engine/physics/spatial_grid.hpp"
+#include "engine/physics/aabb_tree.hpp"
+#include "engine/physics/raycast2d.hpp"
 #include "engine/physics/collision3d.hpp"
+#include "engine/physics/convex_hull3d.hpp"
+#include "engine/physics/triangle_mesh3d.hpp"
 #include "engine/physics/rigid_body.hpp"
 #include "engine/physics/rigid_body_world.hpp"
+#include "engine/physics/broadphase3d.hpp"
+#include "engine/physics/integrate3d.hpp"
+#include "engine/physics/cpu_physics.hpp"
+#include "engine/physics/gpu_physics.hpp"
+#include "engine/physics/gpu_compute_emulator.hpp"
+#include "engine/core/job_system.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 using namespace ergo::test;
 
@@ -26,6 +39,7 @@ static void register_spatial_grid_tests() {
         c1.shape = AABBData{Vec2f{5.0f, 5.0f}};
 
         grid.insert(&c1);
+        grid.build();
 
         auto results = grid.query({0.0f, 0.0f}, {64.0f, 64.0f});
         ERGO_TEST_ASSERT_EQ(ctx, results.size(), (size_t)1);
@@ -39,6 +53,7 @@ static void register_spatial_grid_tests() {
         c1.shape = AABBData{Vec2f{5.0f, 5.0f}};
 
         grid.insert(&c1);
+        grid.build();
 
         auto results = grid.query({500.0f, 500.0f}, {600.0f, 600.0f});
         ERGO_TEST_ASSERT_EQ(ctx, results.size(), (size_t)0);
@@ -61,6 +76,7 @@ static void register_spatial_grid_tests() {
         grid.insert(&c1);
         grid.insert(&c2);
         grid.insert(&c3);
+        grid.build();
 
         auto near = grid.query({0.0f, 0.0f}, {64.0f, 64.0f});
         ERGO_TEST_ASSERT_EQ(ctx, near.size(), (size_t)2);
@@ -76,11 +92,310 @@ static void register_spatial_grid_tests() {
         Collider c1; c1.handle = {1}; c1.transform = &t1;
         c1.shape = AABBData{Vec2f{5.0f, 5.0f}};
         grid.insert(&c1);
+        grid.build();
 
         grid.clear();
         auto results = grid.query({0.0f, 0.0f}, {64.0f, 64.0f});
         ERGO_TEST_ASSERT_EQ(ctx, results.size(), (size_t)0);
     });
+
+    spatial_grid_suite.add("SpatialGrid_LargeColliderReportedOnce", [](TestContext& ctx) {
+        SpatialGrid2D grid(16.0f);
+
+        Transform2D t1; t1.position = {0.0f, 0.0f};
+        Collider c1; c1.handle = {1}; c1.transform = &t1;
+        c1.shape = AABBData{Vec2f{200.0f, 200.0f}};  // spans ~625 cells
+        grid.insert(&c1);
+        grid.build();
+
+        std::vector<Collider*> results;
+        grid.query({-100.0f, -100.0f}, {100.0f, 100.0f}, results);
+        ERGO_TEST_ASSERT_EQ(ctx, results.size(), (size_t)1);
+
+        // Same buffer reused by a second query
+        grid.query({150.0f, 150.0f}, {190.0f, 190.0f}, results);
+        ERGO_TEST_ASSERT_EQ(ctx, results.size(), (size_t)1);
+    });
+
+    spatial_grid_suite.add("SpatialGrid_MatchesBruteForce", [](TestContext& ctx) {
+        SpatialGrid2D grid(32.0f);
+
+        constexpr int count = 2000;
+        std::vector<Transform2D> transforms(count);
+        std::vector<Collider> colliders(count);
+        for (int i = 0; i < count; ++i) {
+            transforms[i].position = {static_cast<float>((i * 37) % 1000),
+                                      static_cast<float>((i * 91) % 1000)};
+            colliders[i].handle = {static_cast<uint64_t>(i + 1)};
+            colliders[i].transform = &transforms[i];
+            if (i % 2) colliders[i].shape = CircleData{static_cast<float>(i % 20)};
+            else       colliders[i].shape = AABBData{Vec2f{4.0f, static_cast<float>(i % 50)}};
+        }
+
+        // Rebuild twice to exercise clear() with retained capacity
+        for (int frame = 0; frame < 2; ++frame) {
+            grid.clear();
+            for (auto& c : colliders) grid.insert(&c);
+            grid.build();
+        }
+
+        Vec2f qmin{300.0f, 420.0f}, qmax{380.0f, 510.0f};
+        std::vector<Collider*> results;
+        grid.query(qmin, qmax, results);
+
+        size_t expected = 0;
+        for (auto& c : colliders) {
+            Vec2f p = c.transform->position;
+            Vec2f e = std::holds_alternative<AABBData>(c.shape)
+                ? std::get<AABBData>(c.shape).half_extent
+                : Vec2f{std::get<CircleData>(c.shape).radius,
+                        std::get<CircleData>(c.shape).radius};
+            if (p.x - e.x <= qmax.x && p.x + e.x >= qmin.x &&
+                p.y - e.y <= qmax.y && p.y + e.y >= qmin.y) ++expected;
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, results.size(), expected);
+    });
+
+    spatial_grid_suite.add("SpatialGrid_BuildOnJobsMatchesSerial", [](TestContext& ctx) {
+        // Enough refs for the build to split into several chunks
+        constexpr int count = 40000;
+        std::vector<Transform2D> transforms(count);
+        std::vector<Collider> colliders(count);
+        for (int i = 0; i < count; ++i) {
+            transforms[i].position = {static_cast<float>((i * 37) % 4000),
+                                      static_cast<float>((i * 91) % 4000)};
+            colliders[i].handle = {static_cast<uint64_t>(i + 1)};
+            colliders[i].transform = &transforms[i];
+            colliders[i].shape = CircleData{2.0f + static_cast<float>(i % 11)};
+        }
+
+        JobSystem inline_jobs;
+        JobSystem pool;
+        pool.initialize(3);
+        SpatialGrid2D serial(64.0f), threaded(64.0f);
+        for (auto& c : colliders) {
+            serial.insert(&c);
+            threaded.insert(&c);
+        }
+        serial.build(inline_jobs);
+        threaded.build(pool);
+        pool.shutdown();
+
+        // Same buckets in the same order, not just the same sets
+        bool same = true;
+        for (int32_t cy = 0; cy < 64 && same; ++cy) {
+            for (int32_t cx = 0; cx < 64 && same; ++cx) {
+                std::vector<Collider*> a, b;
+                serial.for_each_in_cell(cx, cy, [&](Collider& c) { a.push_back(&c); });
+                threaded.for_each_in_cell(cx, cy, [&](Collider& c) { b.push_back(&c); });
+                same = a == b;
+            }
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, same);
+        ERGO_TEST_ASSERT_EQ(ctx, threaded.query({1000.0f, 1000.0f}, {1300.0f, 1200.0f}).size(),
+                            serial.query({1000.0f, 1000.0f}, {1300.0f, 1200.0f}).size());
+    });
+
+    spatial_grid_suite.add("SpatialGrid_ClampsFarCoordinates", [](TestContext& ctx) {
+        SpatialGrid2D grid(1.0f);
+
+        // Cell coordinates far outside int32 range end up in the edge cells
+        Transform2D t1; t1.position = {1e30f, -1e30f};
+        Transform2D t2; t2.position = {5.0f, 5.0f};
+        Collider c1; c1.handle = {1}; c1.transform = &t1;
+        c1.shape = CircleData{1.0f};
+        Collider c2; c2.handle = {2}; c2.transform = &t2;
+        c2.shape = CircleData{1.0f};
+        grid.insert(&c1);
+        grid.insert(&c2);
+        grid.build();
+
+        ERGO_TEST_ASSERT_EQ(ctx, grid.query({0.0f, 0.0f}, {10.0f, 10.0f}).size(), (size_t)1);
+        ERGO_TEST_ASSERT_EQ(ctx, grid.query({9e29f, -2e30f}, {2e30f, -9e29f}).size(), (size_t)1);
+        ERGO_TEST_ASSERT_EQ(ctx, grid.query({-INFINITY, -INFINITY}, {INFINITY, INFINITY}).size(), (size_t)2);
+        ERGO_TEST_ASSERT_EQ(ctx, grid.query({NAN, NAN}, {NAN, NAN}).size(), (size_t)0);
+    });
+}
+
+// ============================================================
+// Physics/AabbTree2D
+// ============================================================
+
+static TestSuite aabb_tree_suite("Physics/AabbTree2D");
+
+// Deterministic box i at frame f: mostly small, every 16th one huge
+static Aabb2D tree_test_box(int i, int f) {
+    float x = static_cast<float>((i * 53 + f * 7) % 900);
+    float y = static_cast<float>((i * 29 + f * 3) % 700);
+    float h = (i % 16 == 0) ? 150.0f : 2.0f + static_cast<float>(i % 5);
+    return {{x - h, y - h}, {x + h, y + h}};
+}
+
+static void register_aabb_tree_tests() {
+    aabb_tree_suite.add("AabbTree_QueryMatchesBruteForce", [](TestContext& ctx) {
+        constexpr int count = 400;
+        AabbTree2D tree(2.0f);
+        std::vector<int> ids(count);
+        std::vector<int32_t> proxies(count);
+        for (int i = 0; i < count; ++i) {
+            ids[i] = i;
+            proxies[i] = tree.create_proxy(tree_test_box(i, 0), &ids[i]);
+        }
+        // Move a subset over several frames, destroying and recreating some
+        for (int f = 1; f < 4; ++f) {
+            for (int i = f; i < count; i += 3) tree.move_proxy(proxies[i], tree_test_box(i, f));
+            tree.destroy_proxy(proxies[f * 10]);
+            proxies[f * 10] = tree.create_proxy(tree_test_box(f * 10, f), &ids[f * 10]);
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, tree.proxy_count(), (size_t)count);
+
+        int mismatches = 0;
+        for (int q = 0; q < 32; ++q) {
+            Aabb2D box = tree_test_box(q * 11, 5);
+            std::vector<bool> found(count, false);
+            tree.query(box, [&](void* ud) { found[*static_cast<int*>(ud)] = true; });
+            for (int i = 0; i < count; ++i) {
+                bool expected = tree.fat_aabb(proxies[i]).overlaps(box);
+                if (found[i] != expected) ++mismatches;
+            }
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, mismatches, 0);
+    });
+
+    aabb_tree_suite.add("AabbTree_StaysBalanced", [](TestContext& ctx) {
+        // Sorted insertion degenerates an unbalanced tree into a list
+        AabbTree2D tree(0.0f);
+        int dummy = 0;
+        for (int i = 0; i < 1024; ++i) {
+            float x = static_cast<float>(i) * 10.0f;
+            tree.create_proxy({{x, 0.0f}, {x + 1.0f, 1.0f}}, &dummy);
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, tree.height() < 32);
+    });
+
+    aabb_tree_suite.add("AabbTree_FatMarginAvoidsReinsert", [](TestContext& ctx) {
+        AabbTree2D tree(4.0f);
+        int dummy = 0;
+        int32_t p = tree.create_proxy({{0.0f, 0.0f}, {2.0f, 2.0f}}, &dummy);
+        ERGO_TEST_ASSERT_FALSE(ctx, tree.move_proxy(p, {{1.0f, 1.0f}, {3.0f, 3.0f}}));
+        ERGO_TEST_ASSERT_TRUE(ctx, tree.move_proxy(p, {{10.0f, 10.0f}, {12.0f, 12.0f}}));
+    });
+
+    aabb_tree_suite.add("AabbTree_FindPairsMovedOnly", [](TestContext& ctx) {
+        constexpr int count = 200;
+        AabbTree2D a(1.0f), b(1.0f);
+        std::vector<int> ids(count * 2);
+        std::vector<int32_t> pa(count), pb(count);
+        for (int i = 0; i < count; ++i) {
+            ids[i] = i;
+            ids[count + i] = i;
+            pa[i] = a.create_proxy(tree_test_box(i, 0), &ids[i]);
+            pb[i] = b.create_proxy(tree_test_box(i + 7, 1), &ids[count + i]);
+        }
+        for (int i = 0; i < count; i += 5) a.touch(pa[i]);
+
+        std::vector<std::pair<int, int>> pairs;
+        a.find_pairs(b, true, [&](void* ua, void* ub) {
+            pairs.emplace_back(*static_cast<int*>(ua), *static_cast<int*>(ub));
+        });
+        std::sort(pairs.begin(), pairs.end());
+
+        std::vector<std::pair<int, int>> expected;
+        for (int i = 0; i < count; i += 5) {
+            for (int j = 0; j < count; ++j) {
+                if (a.fat_aabb(pa[i]).overlaps(b.fat_aabb(pb[j]))) expected.emplace_back(i, j);
+            }
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, !expected.empty());
+        ERGO_TEST_ASSERT_TRUE(ctx, pairs == expected);
+
+        a.clear_moved();
+        size_t after_clear = 0;
+        a.find_pairs(b, true, [&](void*, void*) { ++after_clear; });
+        ERGO_TEST_ASSERT_EQ(ctx, after_clear, (size_t)0);
+    });
+}
+
+// ============================================================
+// Physics/Raycast2D
+// ============================================================
+
+static TestSuite raycast2d_suite("Physics/Raycast2D");
+
+// Scattered mix of boxes and circles shared by the raycast tests
+struct RaycastScene {
+    std::vector<Transform2D> transforms;
+    std::vector<Collider> colliders;
+    std::vector<Collider*> list;
+    SpatialGrid2D grid{32.0f};
+
+    RaycastScene() {
+        constexpr int count = 300;
+        transforms.resize(count);
+        colliders.resize(count);
+        for (int i = 0; i < count; ++i) {
+            transforms[i].position = {static_cast<float>((i * 53) % 640),
+                                      static_cast<float>((i * 29) % 480)};
+            colliders[i].handle = {static_cast<uint64_t>(i + 1)};
+            colliders[i].transform = &transforms[i];
+            colliders[i].tag = (i % 4 == 0) ? ColliderTag::Player : ColliderTag::Enemy;
+            if (i % 2) colliders[i].shape = CircleData{3.0f + static_cast<float>(i % 5)};
+            else       colliders[i].shape = AABBData{Vec2f{4.0f, 2.0f + static_cast<float>(i % 60)}};
+            list.push_back(&colliders[i]);
+            grid.insert(&colliders[i]);
+        }
+        grid.build();
+    }
+};
+
+static void register_raycast2d_tests() {
+    raycast2d_suite.add("Raycast2D_GridMatchesBruteForce", [](TestContext& ctx) {
+        RaycastScene scene;
+        int mismatches = 0;
+        for (int i = 0; i < 64; ++i) {
+            float angle = static_cast<float>(i) * 0.1f;
+            Vec2f origin{-50.0f + static_cast<float>(i * 13 % 700), static_cast<float>(i * 37 % 500)};
+            Vec2f dir{std::cos(angle), std::sin(angle)};
+
+            auto flat = raycast2d(origin, dir, 400.0f, scene.list);
+            auto grid = raycast2d(origin, dir, 400.0f, scene.grid);
+            if (flat.has_value() != grid.has_value()) { ++mismatches; continue; }
+            if (flat && flat->collider != grid->collider) ++mismatches;
+
+            auto flat_all = raycast2d_all(origin, dir, 400.0f, scene.list, ColliderTag::Enemy);
+            auto grid_all = raycast2d_all(origin, dir, 400.0f, scene.grid, ColliderTag::Enemy);
+            if (flat_all.size() != grid_all.size()) ++mismatches;
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, mismatches, 0);
+    });
+
+    raycast2d_suite.add("Raycast2D_GridMissOutsideBounds", [](TestContext& ctx) {
+        RaycastScene scene;
+        auto hit = raycast2d({-100.0f, -100.0f}, {-1.0f, 0.0f}, 1000.0f, scene.grid);
+        ERGO_TEST_ASSERT_FALSE(ctx, hit.has_value());
+    });
+
+    raycast2d_suite.add("Raycast2D_ManyMatchesSingle", [](TestContext& ctx) {
+        RaycastScene scene;
+        std::vector<RayQuery2D> rays;
+        for (int i = 0; i < 500; ++i) {
+            float angle = static_cast<float>(i) * 0.037f;
+            rays.push_back({{320.0f, 240.0f}, {std::cos(angle), std::sin(angle)}, 300.0f});
+        }
+
+        std::vector<std::optional<RayHit2D>> results;
+        raycast2d_many(rays, scene.grid, results);
+        ERGO_TEST_ASSERT_EQ(ctx, results.size(), rays.size());
+
+        int mismatches = 0;
+        for (size_t i = 0; i < rays.size(); ++i) {
+            auto single = raycast2d(rays[i].origin, rays[i].direction,
+                                    rays[i].max_distance, scene.grid);
+            if (single.has_value() != results[i].has_value()) ++mismatches;
+            else if (single && single->collider != results[i]->collider) ++mismatches;
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, mismatches, 0);
+    });
 }
 
 // ============================================================
@@ -89,6 +404,27 @@ static void register_spatial_grid_tests() {
 
 static TestSuite collision3d_suite("Physics/Collision3D");
 
+// Flat grid of n x n quads (two triangles each) at y = 0, facing up
+static std::shared_ptr<TriangleMesh3D> make_grid_mesh(int n, float cell) {
+    std::vector<Vec3f> vertices;
+    std::vector<uint32_t> indices;
+    float half = 0.5f * static_cast<float>(n) * cell;
+    for (int z = 0; z <= n; ++z) {
+        for (int x = 0; x <= n; ++x) {
+            vertices.push_back({static_cast<float>(x) * cell - half, 0.0f,
+                                static_cast<float>(z) * cell - half});
+        }
+    }
+    auto row = static_cast<uint32_t>(n + 1);
+    for (uint32_t z = 0; z < static_cast<uint32_t>(n); ++z) {
+        for (uint32_t x = 0; x < static_cast<uint32_t>(n); ++x) {
+            uint32_t a = z * row + x;
+            indices.insert(indices.end(), {a, a + row, a + 1, a + 1, a + row, a + row + 1});
+        }
+    }
+    return std::make_shared<TriangleMesh3D>(std::move(vertices), std::move(indices));
+}
+
 static void register_collision3d_tests() {
     collision3d_suite.add("Collision3D_SphereSphere_Hit", [](TestContext& ctx) {
         SphereShape s1{1.0f};
@@ -119,6 +455,7 @@ static void register_collision3d_tests() {
         auto contact = collide_sphere_plane(sphere, ts, plane);
         ERGO_TEST_ASSERT_TRUE(ctx, contact.has_value());
         ERGO_TEST_ASSERT_TRUE(ctx, contact->penetration > 0.0f);
+        ERGO_TEST_ASSERT_TRUE(ctx, contact->normal.y < 0.0f);  // sphere -> plane
     });
 
     collision3d_suite.add("Collision3D_SpherePlane_NoHit", [](TestContext& ctx) {
@@ -149,6 +486,201 @@ static void register_collision3d_tests() {
         auto contact = check_collision3d(a, ta, b, tb);
         ERGO_TEST_ASSERT_TRUE(ctx, contact.has_value());
     });
+
+    collision3d_suite.add("Collision3D_BoxPlane_Manifold", [](TestContext& ctx) {
+        BoxShape box{{0.5f, 0.5f, 0.5f}};
+        PlaneShape ground{{0.0f, 1.0f, 0.0f}, 0.0f};
+        Transform3D tb, tp;
+        tb.position = {0.0f, 0.45f, 0.0f};
+
+        ContactManifold m;
+        ERGO_TEST_ASSERT_TRUE(ctx, collide_manifold3d(box, tb, ground, tp, m));
+        ERGO_TEST_ASSERT_EQ(ctx, m.point_count, 4);
+        ERGO_TEST_ASSERT_NEAR(ctx, m.normal.y, -1.0f, 0.001f);
+        for (int i = 0; i < m.point_count; ++i) {
+            ERGO_TEST_ASSERT_NEAR(ctx, m.points[i].penetration, 0.05f, 0.001f);
+        }
+    });
+
+    collision3d_suite.add("Collision3D_BoxBox_Rotated", [](TestContext& ctx) {
+        BoxShape box{{0.5f, 0.5f, 0.5f}};
+        Transform3D ta, tb;
+        // Rotated 45 degrees about y the corners reach 0.707 along x
+        tb.rotation = Quat::from_axis_angle({0.0f, 1.0f, 0.0f}, 0.785398f);
+        tb.position = {1.15f, 0.0f, 0.0f};
+        ERGO_TEST_ASSERT_TRUE(ctx, collide_box_box(box, ta, box, tb).has_value());
+
+        // Diagonal neighbour rotated about z: the world AABBs overlap, the boxes do not
+        tb.rotation = Quat::from_axis_angle({0.0f, 0.0f, 1.0f}, 0.785398f);
+        tb.position = {1.1f, 1.1f, 0.0f};
+        ERGO_TEST_ASSERT_TRUE(ctx, compute_aabb3d(box, ta).overlaps(compute_aabb3d(box, tb)));
+        ERGO_TEST_ASSERT_FALSE(ctx, collide_box_box(box, ta, box, tb).has_value());
+
+        ContactManifold m;
+        tb.rotation = Quat::identity();
+        tb.position = {0.0f, 0.95f, 0.0f};
+        ERGO_TEST_ASSERT_TRUE(ctx, collide_manifold3d(box, ta, box, tb, m));
+        ERGO_TEST_ASSERT_EQ(ctx, m.point_count, 4);
+        ERGO_TEST_ASSERT_NEAR(ctx, m.normal.y, 1.0f, 0.001f);
+    });
+
+    collision3d_suite.add("Collision3D_CapsuleSphere", [](TestContext& ctx) {
+        // Closest points between the capsule segment and the sphere center
+        Transform3D ta, tb;
+        tb.position = {1.5f, 0.7f, 0.0f};
+        auto contact = check_collision3d(CapsuleShape{1.0f, 1.0f}, ta, SphereShape{1.0f}, tb);
+        ERGO_TEST_ASSERT_TRUE(ctx, contact.has_value());
+        ERGO_TEST_ASSERT_NEAR(ctx, contact->normal.x, 1.0f, 0.001f);
+        ERGO_TEST_ASSERT_NEAR(ctx, contact->penetration, 0.5f, 0.001f);
+
+        tb.position = {0.0f, 3.2f, 0.0f};
+        ERGO_TEST_ASSERT_FALSE(ctx, check_collision3d(CapsuleShape{1.0f, 1.0f}, ta,
+                                                      SphereShape{1.0f}, tb).has_value());
+    });
+
+    collision3d_suite.add("Collision3D_HullMatchesBox", [](TestContext& ctx) {
+        // A cube hull (plus interior points) must collide like the box it spans
+        std::vector<Vec3f> points = {{0.0f, 0.0f, 0.0f}, {0.1f, 0.2f, 0.3f}};
+        for (int i = 0; i < 8; ++i) {
+            points.push_back({(i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f});
+        }
+        auto hull = std::make_shared<ConvexHull3D>(points);
+        ERGO_TEST_ASSERT_EQ(ctx, hull->vertices().size(), size_t(8));
+        ERGO_TEST_ASSERT_EQ(ctx, hull->triangles().size(), size_t(36));
+
+        Transform3D ta, tb;
+        for (float x : {0.8f, 0.2f}) {  // shallow, then deep
+            tb.position = {x, 0.1f, 0.05f};
+            auto expected = check_collision3d(BoxShape{}, ta, BoxShape{}, tb);
+            auto contact = check_collision3d(ConvexHullShape{hull}, ta, BoxShape{}, tb);
+            ERGO_TEST_ASSERT_TRUE(ctx, contact.has_value());
+            ERGO_TEST_ASSERT_NEAR(ctx, contact->normal.x, expected->normal.x, 0.001f);
+            ERGO_TEST_ASSERT_NEAR(ctx, contact->penetration, expected->penetration, 0.001f);
+        }
+    });
+
+    collision3d_suite.add("Collision3D_HullSphereDeepEpa", [](TestContext& ctx) {
+        // Sphere center inside the hull: EPA on a rounded Minkowski sum,
+        // which converges slowly, must still report the nearest face
+        std::vector<Vec3f> points;
+        for (int i = 0; i < 8; ++i) {
+            points.push_back({(i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f});
+        }
+        auto hull = std::make_shared<ConvexHull3D>(points);
+        Transform3D ta, tb;
+        tb.position = {0.3f, 0.05f, 0.02f};
+        for (int repeat = 0; repeat < 2; ++repeat) {  // scratch reused across calls
+            auto contact = check_collision3d(ConvexHullShape{hull}, ta, SphereShape{0.3f}, tb);
+            ERGO_TEST_ASSERT_TRUE(ctx, contact.has_value());
+            if (!contact) return;
+            ERGO_TEST_ASSERT_NEAR(ctx, contact->normal.x, 1.0f, 0.01f);
+            ERGO_TEST_ASSERT_NEAR(ctx, contact->penetration, 0.5f, 0.01f);
+        }
+    });
+
+    collision3d_suite.add("Collision3D_HullSupportMap", [](TestContext& ctx) {
+        // Points in a shell: many end up inside the hull and are dropped
+        uint32_t seed = 12345;
+        auto next = [&seed]() {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<float>(seed >> 8) / 16777216.0f * 2.0f - 1.0f;
+        };
+        std::vector<Vec3f> cloud;
+        for (int i = 0; i < 400; ++i) {
+            Vec3f p{next(), next(), next()};
+            cloud.push_back(p.normalized() * (0.6f + 0.4f * std::abs(next())));
+        }
+        ConvexHull3D hull(cloud);
+        ERGO_TEST_ASSERT_TRUE(ctx, hull.vertices().size() < cloud.size());
+
+        int mismatches = 0;
+        for (int i = 0; i < 2000; ++i) {
+            Vec3f dir{next(), next(), next()};
+            float best = hull.vertices()[0].dot(dir);
+            for (const Vec3f& v : hull.vertices()) best = std::max(best, v.dot(dir));
+            if (hull.support(dir).dot(dir) < best) ++mismatches;
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, mismatches, 0);
+    });
+
+    collision3d_suite.add("Collision3D_MeshBvhQuery", [](TestContext& ctx) {
+        auto mesh = make_grid_mesh(16, 1.0f);
+        ERGO_TEST_ASSERT_EQ(ctx, mesh->triangle_count(), size_t(512));
+
+        // BVH query returns exactly the triangles a linear scan finds
+        bool same = true;
+        for (int i = 0; i < 20; ++i) {
+            float x = static_cast<float>(i % 5) * 3.1f - 7.0f;
+            float z = static_cast<float>(i / 5) * 3.7f - 6.0f;
+            Aabb3D box{{x, -0.5f, z}, {x + 1.3f, 0.5f, z + 2.1f}};
+
+            std::vector<uint32_t> found;
+            mesh->query(box, [&](uint32_t t) { found.push_back(t); });
+            std::sort(found.begin(), found.end());
+
+            std::vector<uint32_t> expected;
+            for (uint32_t t = 0; t < mesh->triangle_count(); ++t) {
+                Vec3f a, b, c;
+                mesh->triangle(t, a, b, c);
+                Aabb3D tb{{std::min({a.x, b.x, c.x}), std::min({a.y, b.y, c.y}), std::min({a.z, b.z, c.z})},
+                          {std::max({a.x, b.x, c.x}), std::max({a.y, b.y, c.y}), std::max({a.z, b.z, c.z})}};
+                if (tb.overlaps(box)) expected.push_back(t);
+            }
+            same = same && found == expected && !found.empty();
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, same);
+
+        // A box resting on the grid gets a four-point face manifold
+        Transform3D tm, tb;
+        tb.position = {0.3f, 0.45f, 0.2f};
+        ContactManifold m;
+        ERGO_TEST_ASSERT_TRUE(ctx, collide_manifold3d(BoxShape{}, tb, TriangleMeshShape{mesh}, tm, m));
+        ERGO_TEST_ASSERT_EQ(ctx, m.point_count, 4);
+        ERGO_TEST_ASSERT_NEAR(ctx, m.normal.y, -1.0f, 0.001f);
+    });
+
+    collision3d_suite.add("Collision3D_SphereCast", [](TestContext& ctx) {
+        Transform3D t;
+        Vec3f right{1.0f, 0.0f, 0.0f}, down{0.0f, -1.0f, 0.0f};
+
+        auto box = sphere_cast3d(BoxShape{}, t, {-5.0f, 0.2f, 0.1f}, right, 10.0f, 0.0f);
+        ERGO_TEST_ASSERT_TRUE(ctx, box.has_value());
+        ERGO_TEST_ASSERT_NEAR(ctx, box->distance, 4.5f, 0.001f);
+        ERGO_TEST_ASSERT_NEAR(ctx, box->normal.x, -1.0f, 0.001f);
+        ERGO_TEST_ASSERT_FALSE(ctx, sphere_cast3d(BoxShape{}, t, {-5.0f, 0.7f, 0.0f}, right,
+                                                  10.0f, 0.0f).has_value());
+        ERGO_TEST_ASSERT_FALSE(ctx, sphere_cast3d(BoxShape{}, t, {-5.0f, 0.2f, 0.1f}, right,
+                                                  4.0f, 0.0f).has_value());
+
+        auto sphere = sphere_cast3d(SphereShape{1.0f}, t, {-5.0f, 0.0f, 0.0f}, right, 10.0f, 0.5f);
+        ERGO_TEST_ASSERT_TRUE(ctx, sphere.has_value());
+        ERGO_TEST_ASSERT_NEAR(ctx, sphere->distance, 3.5f, 0.001f);
+        ERGO_TEST_ASSERT_NEAR(ctx, sphere->point.x, -1.0f, 0.001f);
+
+        auto capsule = sphere_cast3d(CapsuleShape{0.5f, 1.0f}, t, {0.0f, 5.0f, 0.0f}, down, 10.0f, 0.0f);
+        ERGO_TEST_ASSERT_TRUE(ctx, capsule.has_value());
+        ERGO_TEST_ASSERT_NEAR(ctx, capsule->distance, 3.5f, 0.001f);
+        ERGO_TEST_ASSERT_NEAR(ctx, capsule->normal.y, 1.0f, 0.001f);
+
+        Vec3f diagonal = Vec3f{1.0f, -1.0f, 0.0f}.normalized();
+        auto plane = sphere_cast3d(PlaneShape{}, t, {0.0f, 2.0f, 0.0f}, diagonal, 10.0f, 0.25f);
+        ERGO_TEST_ASSERT_TRUE(ctx, plane.has_value());
+        ERGO_TEST_ASSERT_NEAR(ctx, plane->distance, 1.75f * std::sqrt(2.0f), 0.001f);
+        ERGO_TEST_ASSERT_NEAR(ctx, plane->point.y, 0.0f, 0.001f);
+
+        // Meshes are one-sided: hit from above, not from below
+        TriangleMeshShape mesh{make_grid_mesh(4, 1.0f)};
+        auto above = sphere_cast3d(mesh, t, {0.3f, 3.0f, 0.2f}, down, 10.0f, 0.0f);
+        ERGO_TEST_ASSERT_TRUE(ctx, above.has_value());
+        ERGO_TEST_ASSERT_NEAR(ctx, above->distance, 3.0f, 0.001f);
+        ERGO_TEST_ASSERT_FALSE(ctx, sphere_cast3d(mesh, t, {0.3f, -3.0f, 0.2f}, {0.0f, 1.0f, 0.0f},
+                                                  10.0f, 0.0f).has_value());
+
+        // Starting inside reports distance 0
+        auto inside = sphere_cast3d(BoxShape{}, t, {0.1f, 0.0f, 0.0f}, right, 10.0f, 0.0f);
+        ERGO_TEST_ASSERT_TRUE(ctx, inside.has_value());
+        ERGO_TEST_ASSERT_NEAR(ctx, inside->distance, 0.0f, 0.0001f);
+    });
 }
 
 // ============================================================
@@ -157,6 +689,201 @@ static void register_collision3d_tests() {
 
 static TestSuite rigid_body_suite("Physics/RigidBody");
 
+// Ground plane plus separate stacks of unit boxes, one per x slot
+static std::vector<uint64_t> add_box_piles(RigidBodyWorld& world, int piles, int height) {
+    PhysicsBody ground;
+    ground.shape = PlaneShape{{0.0f, 1.0f, 0.0f}, 0.0f};
+    ground.body.set_static();
+    world.add_body(ground);
+
+    std::vector<uint64_t> ids;
+    for (int p = 0; p < piles; ++p) {
+        for (int h = 0; h < height; ++h) {
+            PhysicsBody box;
+            box.body.set_mass(1.0f);
+            box.shape = BoxShape{{0.5f, 0.5f, 0.5f}};
+            box.transform.position = {static_cast<float>(p % 8) * 3.0f, 0.5f + static_cast<float>(h),
+                                      static_cast<float>(p / 8) * 3.0f};
+            ids.push_back(world.add_body(box));
+        }
+    }
+    return ids;
+}
+
+static std::vector<Vec3f> run_box_piles(int piles, int frames) {
+    RigidBodyWorld world;
+    auto ids = add_box_piles(world, piles, 4);
+    // Knock every pile sideways so the solver has real work to do
+    for (size_t i = 0; i < ids.size(); i += 4) {
+        world.get_body(ids[i + 3])->body.apply_impulse({1.5f, 0.0f, 0.5f});
+    }
+    for (int i = 0; i < frames; ++i) world.step(1.0f / 60.0f);
+
+    std::vector<Vec3f> positions;
+    for (auto id : ids) positions.push_back(world.get_body(id)->transform.position);
+    return positions;
+}
+
+// Box piles plus a rain of spheres through CpuPhysicsComponent
+static std::vector<Vec3f> run_cpu_physics(uint32_t threads, int frames) {
+    CpuPhysicsComponent physics;
+    physics.set_thread_count(threads);
+    physics.start();
+
+    auto ids = add_box_piles(physics.world(), 24, 4);
+    for (int i = 0; i < 400; ++i) {
+        PhysicsBody ball;
+        ball.body.set_mass(0.5f);
+        ball.shape = SphereShape{0.3f};
+        ball.transform.position = {static_cast<float>(i % 20) * 1.1f, 6.0f + static_cast<float>(i / 20) * 0.7f,
+                                   static_cast<float>((i * 7) % 9)};
+        ids.push_back(physics.add_body(ball));
+    }
+
+    for (int i = 0; i < frames; ++i) physics.update(1.0f / 60.0f);
+
+    std::vector<Vec3f> positions;
+    for (auto id : ids) positions.push_back(physics.get_body(id)->transform.position);
+    physics.release();
+    return positions;
+}
+
+// Spheres on a lattice dropped onto a ground plane; spacing < 2r packs the
+// lattice tightly enough to produce sphere-sphere contacts
+static std::vector<Vec3f> run_gpu_physics(std::unique_ptr<GpuComputeBackend> backend,
+                                          int layers, float spacing, int frames,
+                                          int* contacts = nullptr) {
+    GpuPhysicsComponent physics;
+    physics.set_compute_backend(std::move(backend));
+    physics.start();
+
+    physics.add_body({0.0f, 0.0f, 0.0f}, 0.0f, PlaneShape{});
+    std::vector<uint64_t> ids;
+    for (int i = 0; i < layers * 100; ++i) {
+        Vec3f pos{static_cast<float>(i % 10) * spacing,
+                  1.0f + static_cast<float>(i / 100) * spacing,
+                  static_cast<float>((i / 10) % 10) * spacing};
+        ids.push_back(physics.add_body(pos, 1.0f, SphereShape{0.25f}));
+    }
+    if (contacts) {
+        physics.set_collision_callback(ids[0], [contacts](uint64_t, const ContactPoint&) {
+            ++*contacts;
+        });
+    }
+
+    for (int i = 0; i < frames; ++i) physics.update(1.0f / 60.0f);
+
+    std::vector<Vec3f> positions;
+    for (auto id : ids) positions.push_back(physics.get_position(id));
+    return positions;
+}
+
+// Bodies with varied velocities, masses and flags, for the integrate kernels
+static void fill_integration_bodies(std::vector<PhysicsBody>& bodies, BodyArrays3D& arrays) {
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        auto& pb = bodies[i];
+        float f = static_cast<float>(i);
+        pb.shape = SphereShape{0.25f};
+        pb.transform.position = {f * 0.5f, 10.0f, -f};
+        pb.transform.rotation = Quat::from_axis_angle({1.0f, 0.5f, 0.25f}, f * 0.1f);
+        pb.body.set_mass(0.5f + static_cast<float>(i % 5));
+        pb.body.velocity = {std::sin(f), std::cos(f) * 3.0f, 0.25f * f};
+        pb.body.angular_velocity = {0.3f * static_cast<float>(i % 7), -1.0f, std::sin(f * 0.7f)};
+        pb.body.force_accumulator = {f, -f, 2.0f};
+        if (i % 11 == 0) pb.body.is_sleeping = true;
+        if (i % 13 == 0) pb.body.set_static();
+        if (i % 17 == 0) pb.body.set_mass(0.0f);
+        arrays.push_back(pb);
+    }
+}
+
+// Mixed shapes over a mesh floor for the scene query tests
+static void add_query_scene(RigidBodyWorld& world) {
+    PhysicsBody ground;
+    ground.shape = TriangleMeshShape{make_grid_mesh(20, 2.0f)};
+    world.add_body(ground);
+
+    auto hull = std::make_shared<ConvexHull3D>(std::vector<Vec3f>{
+        {0.0f, 0.6f, 0.0f}, {0.5f, -0.3f, 0.2f}, {-0.4f, -0.3f, 0.4f}, {0.0f, -0.3f, -0.5f}});
+    for (int i = 0; i < 400; ++i) {
+        PhysicsBody pb;
+        pb.body.set_mass(1.0f);
+        pb.transform.position = {static_cast<float>((i * 37) % 36) - 18.0f,
+                                 0.5f + static_cast<float>((i * 13) % 8),
+                                 static_cast<float>((i * 7) % 34) - 17.0f};
+        pb.transform.rotation = Quat::from_axis_angle({0.3f, 1.0f, 0.2f}, static_cast<float>(i));
+        switch (i % 4) {
+            case 0:  pb.shape = SphereShape{0.3f + 0.1f * static_cast<float>(i % 3)}; break;
+            case 1:  pb.shape = BoxShape{{0.4f, 0.3f + 0.1f * static_cast<float>(i % 5), 0.5f}}; break;
+            case 2:  pb.shape = CapsuleShape{0.25f, 0.5f}; break;
+            default: pb.shape = ConvexHullShape{hull}; break;
+        }
+        world.add_body(pb);
+    }
+}
+
+// Deterministic rays through the query scene
+static std::vector<RayQuery3D> make_scene_rays(int count, float radius) {
+    std::vector<RayQuery3D> rays;
+    uint32_t seed = 777;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f * 2.0f - 1.0f;
+    };
+    for (int i = 0; i < count; ++i) {
+        Vec3f origin{next() * 20.0f, 4.0f + next() * 4.0f, next() * 20.0f};
+        Vec3f dir{next(), next() - 0.3f, next()};
+        rays.push_back({origin, dir, 30.0f, radius});
+    }
+    return rays;
+}
+
+// Rollback scene: piles being hit by spheres, with one body removed and
+// re-added so slot order and ids no longer follow insertion order. Returns
+// the sphere ids, which receive per-frame input forces.
+static std::vector<uint64_t> add_rollback_scene(RigidBodyWorld& world) {
+    auto boxes = add_box_piles(world, 6, 3);
+    world.remove_body(boxes[4]);
+    std::vector<uint64_t> spheres;
+    for (int i = 0; i < 6; ++i) {
+        PhysicsBody ball;
+        ball.body.set_mass(2.0f);
+        ball.shape = (i % 2) ? CollisionShape3D{SphereShape{0.4f}} : CollisionShape3D{CapsuleShape{0.3f, 0.3f}};
+        ball.transform.position = {static_cast<float>(i) * 3.0f - 1.0f, 1.0f, -3.0f};
+        ball.body.velocity = {0.5f, 0.0f, 4.0f + static_cast<float>(i) * 0.3f};
+        spheres.push_back(world.add_body(ball));
+    }
+    return spheres;
+}
+
+// Frames [first, last) of the rollback scene with deterministic "player
+// input"; returns the hash of the saved state after every frame
+static std::vector<uint64_t> run_rollback_frames(RigidBodyWorld& world,
+                                                 const std::vector<uint64_t>& inputs,
+                                                 int first, int last) {
+    std::vector<uint64_t> hashes;
+    std::vector<uint8_t> state;
+    for (int frame = first; frame < last; ++frame) {
+        if (frame % 7 == 0) {
+            uint64_t id = inputs[static_cast<size_t>(frame / 7) % inputs.size()];
+            float side = (frame % 14 == 0) ? 1.0f : -1.0f;
+            world.get_body(id)->body.apply_force({30.0f * side, 40.0f, 10.0f});
+        }
+        world.step(1.0f / 60.0f);
+
+        // FNV-1a over the blob
+        world.save_state(state);
+        uint64_t h = 14695981039346656037ull;
+        for (uint8_t byte : state) h = (h ^ byte) * 1099511628211ull;
+        hashes.push_back(h);
+    }
+    return hashes;
+}
+
+static bool same_bits(const std::vector<float>& a, const std::vector<float>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
 static void register_rigid_body_tests() {
     rigid_body_suite.add("RigidBody_SetMass", [](TestContext& ctx) {
         RigidBody body;
@@ -226,6 +953,71 @@ static void register_rigid_body_tests() {
         ERGO_TEST_ASSERT_EQ(ctx, world.body_count(), (size_t)0);
     });
 
+    rigid_body_suite.add("RigidBodyWorld_RemoveKeepsPointers", [](TestContext& ctx) {
+        RigidBodyWorld world;
+        std::vector<uint64_t> ids;
+        std::vector<PhysicsBody*> ptrs;
+        for (int i = 0; i < 100; ++i) {
+            PhysicsBody pb;
+            pb.shape = SphereShape{0.5f};
+            pb.transform.position = {static_cast<float>(i) * 2.0f, 0.0f, 0.0f};
+            ids.push_back(world.add_body(pb));
+        }
+        for (auto id : ids) ptrs.push_back(world.get_body(id));
+
+        for (int i = 0; i < 100; i += 3) world.remove_body(ids[i]);
+        ERGO_TEST_ASSERT_EQ(ctx, world.body_count(), (size_t)66);
+
+        bool stable = true;
+        for (int i = 0; i < 100; ++i) {
+            if (i % 3 == 0) {
+                stable = stable && world.get_body(ids[i]) == nullptr;
+                continue;
+            }
+            PhysicsBody* pb = world.get_body(ids[i]);
+            stable = stable && pb == ptrs[i] && pb->id == ids[i] &&
+                     pb->body.transform == &pb->transform &&
+                     pb->transform.position.x == static_cast<float>(i) * 2.0f;
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, stable);
+
+        // A reused slot gets a new id; the stale one keeps missing
+        PhysicsBody extra;
+        extra.shape = SphereShape{0.5f};
+        uint64_t extra_id = world.add_body(extra);
+        ERGO_TEST_ASSERT_TRUE(ctx, extra_id != ids[99]);
+        ERGO_TEST_ASSERT_TRUE(ctx, world.get_body(ids[99]) == nullptr);
+        ERGO_TEST_ASSERT_TRUE(ctx, world.get_body(extra_id) != nullptr);
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_CollisionCallback", [](TestContext& ctx) {
+        RigidBodyWorld world;
+
+        PhysicsBody ground;
+        ground.shape = PlaneShape{{0.0f, 1.0f, 0.0f}, 0.0f};
+        ground.body.set_static();
+        uint64_t ground_id = world.add_body(ground);
+
+        int hits = 0;
+        uint64_t other_id = 0;
+        float ball_y = 0.0f;
+        PhysicsBody ball;
+        ball.body.set_mass(1.0f);
+        ball.shape = SphereShape{0.5f};
+        ball.transform.position = {0.0f, 0.6f, 0.0f};
+        ball.on_collision = [&](PhysicsBody& other, const ContactPoint& contact) {
+            ++hits;
+            other_id = other.id;
+            ball_y = contact.point.y;
+        };
+        world.add_body(ball);
+
+        for (int i = 0; i < 30; ++i) world.step(1.0f / 60.0f);
+        ERGO_TEST_ASSERT_TRUE(ctx, hits > 0);
+        ERGO_TEST_ASSERT_EQ(ctx, other_id, ground_id);
+        ERGO_TEST_ASSERT_TRUE(ctx, ball_y < 0.1f);
+    });
+
     rigid_body_suite.add("RigidBodyWorld_Gravity", [](TestContext& ctx) {
         RigidBodyWorld world;
         world.set_gravity({0.0f, -10.0f, 0.0f});
@@ -248,6 +1040,528 @@ static void register_rigid_body_tests() {
         // Ball should have moved downward
         ERGO_TEST_ASSERT_TRUE(ctx, b->body.velocity.y < 0.0f);
     });
+
+    rigid_body_suite.add("Broadphase3D_MatchesBruteForce", [](TestContext& ctx) {
+        std::vector<PhysicsBody> bodies(301);
+        bodies[0].id = 1;
+        bodies[0].shape = PlaneShape{{0.0f, 1.0f, 0.0f}, 0.0f};
+        bodies[0].body.set_static();
+        for (int i = 1; i <= 300; ++i) {
+            auto& pb = bodies[i];
+            pb.id = static_cast<uint64_t>(i + 1);
+            pb.transform.position = {static_cast<float>((i * 37) % 50),
+                                     static_cast<float>((i * 13) % 20) - 2.0f,
+                                     static_cast<float>((i * 7) % 30)};
+            pb.transform.rotation = Quat::from_axis_angle({0.3f, 1.0f, 0.2f}, static_cast<float>(i));
+            if (i % 2) pb.shape = SphereShape{0.5f + static_cast<float>(i % 3)};
+            else       pb.shape = BoxShape{{1.0f, 0.5f + static_cast<float>(i % 4), 1.0f}};
+            if (i % 10 == 0) pb.body.set_static();
+        }
+
+        BodyArrays3D arrays;
+        for (auto& pb : bodies) arrays.push_back(pb);
+
+        SweepAndPrune3D sap;
+        sap.update(arrays);
+
+        std::vector<std::pair<uint32_t, uint32_t>> expected;
+        for (uint32_t i = 0; i < bodies.size(); ++i) {
+            for (uint32_t j = i + 1; j < bodies.size(); ++j) {
+                if (bodies[i].body.type == RigidBodyType::Static &&
+                    bodies[j].body.type == RigidBodyType::Static) continue;
+                Aabb3D bj = compute_aabb3d(bodies[j].shape, bodies[j].transform);
+                bool overlap = (i == 0)
+                    ? bj.min.y < 0.0f
+                    : compute_aabb3d(bodies[i].shape, bodies[i].transform).overlaps(bj);
+                if (overlap) expected.emplace_back(i, j);
+            }
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> found;
+        for (const auto& p : sap.pairs()) found.emplace_back(p.a, p.b);
+
+        ERGO_TEST_ASSERT_TRUE(ctx, !expected.empty());
+        ERGO_TEST_ASSERT_TRUE(ctx, found == expected);
+        ERGO_TEST_ASSERT_TRUE(ctx, sap.pairs()[0].is_new);
+
+        // Same bodies again: every pair persists from the previous step
+        sap.update(arrays);
+        bool any_new = false;
+        for (const auto& p : sap.pairs()) any_new = any_new || p.is_new;
+        ERGO_TEST_ASSERT_FALSE(ctx, any_new);
+    });
+
+    rigid_body_suite.add("Broadphase3D_AxisSwitchNeedsMargin", [](TestContext& ctx) {
+        // Same spread of centers on x and z, z scaled by k
+        auto spread = [](float k) {
+            std::vector<PhysicsBody> bodies(10);
+            for (int i = 0; i < 10; ++i) {
+                bodies[i].id = static_cast<uint64_t>(i + 1);
+                bodies[i].shape = SphereShape{0.5f};
+                bodies[i].transform.position = {static_cast<float>(i) * 2.0f, 0.0f,
+                                                static_cast<float>((i * 7) % 10) * 2.0f * k};
+            }
+            return bodies;
+        };
+        SweepAndPrune3D sap;
+        auto run = [&sap](std::vector<PhysicsBody> bodies) {
+            BodyArrays3D arrays;
+            for (auto& pb : bodies) arrays.push_back(pb);
+            sap.update(arrays);
+        };
+
+        run(spread(0.5f));
+        ERGO_TEST_ASSERT_EQ(ctx, sap.sort_axis(), 0);
+        run(spread(1.05f));   // z variance 1.1x of x: keep x
+        ERGO_TEST_ASSERT_EQ(ctx, sap.sort_axis(), 0);
+        run(spread(1.2f));    // 1.44x
+        ERGO_TEST_ASSERT_EQ(ctx, sap.sort_axis(), 2);
+        run(spread(1.0f));    // back to a tie: keep z
+        ERGO_TEST_ASSERT_EQ(ctx, sap.sort_axis(), 2);
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_SpheresRestOnPlane", [](TestContext& ctx) {
+        RigidBodyWorld world;
+
+        PhysicsBody ground;
+        ground.shape = PlaneShape{{0.0f, 1.0f, 0.0f}, 0.0f};
+        ground.body.set_static();
+        world.add_body(ground);
+
+        std::vector<uint64_t> ids;
+        for (int i = 0; i < 200; ++i) {
+            PhysicsBody ball;
+            ball.body.set_mass(1.0f);
+            ball.shape = SphereShape{0.5f};
+            ball.transform.position = {static_cast<float>(i % 20) * 1.5f, 1.0f + static_cast<float>(i / 20),
+                                       static_cast<float>(i % 7)};
+            ids.push_back(world.add_body(ball));
+        }
+
+        for (int i = 0; i < 120; ++i) world.step(1.0f / 60.0f);
+
+        int below = 0;
+        for (auto id : ids) {
+            if (world.get_body(id)->transform.position.y < 0.3f) ++below;
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, below, 0);
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_BoxStackStands", [](TestContext& ctx) {
+        RigidBodyWorld world;
+        world.set_max_substeps(1);
+
+        PhysicsBody ground;
+        ground.shape = PlaneShape{{0.0f, 1.0f, 0.0f}, 0.0f};
+        ground.body.set_static();
+        world.add_body(ground);
+
+        uint64_t top = 0;
+        for (int i = 0; i < 8; ++i) {
+            PhysicsBody box;
+            box.body.set_mass(1.0f);
+            box.shape = BoxShape{{0.5f, 0.5f, 0.5f}};
+            box.transform.position = {0.0f, 0.5f + static_cast<float>(i), 0.0f};
+            top = world.add_body(box);
+        }
+
+        for (int i = 0; i < 300; ++i) world.step(1.0f / 60.0f);
+
+        const auto* t = world.get_body(top);
+        ERGO_TEST_ASSERT_TRUE(ctx, t->transform.position.y > 7.3f);
+        ERGO_TEST_ASSERT_TRUE(ctx, std::abs(t->transform.position.x) < 0.25f);
+        ERGO_TEST_ASSERT_TRUE(ctx, std::abs(t->transform.position.z) < 0.25f);
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_IslandPerPile", [](TestContext& ctx) {
+        RigidBodyWorld world;
+        add_box_piles(world, 6, 3);
+
+        PhysicsBody ball;
+        ball.body.set_mass(1.0f);
+        ball.shape = SphereShape{0.5f};
+        ball.transform.position = {0.0f, 20.0f, 20.0f};
+        world.add_body(ball);
+
+        world.step(1.0f / 60.0f);
+        // The shared floor is static and does not merge piles
+        ERGO_TEST_ASSERT_EQ(ctx, world.island_count(), (size_t)7);
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_IslandSleepsAndWakesTogether", [](TestContext& ctx) {
+        RigidBodyWorld world;
+        world.set_max_substeps(1);
+        auto ids = add_box_piles(world, 1, 3);
+
+        auto sleeping = [&] {
+            int n = 0;
+            for (auto id : ids) n += world.get_body(id)->body.is_sleeping ? 1 : 0;
+            return n;
+        };
+
+        bool partial = false;
+        int frames = 0;
+        while (sleeping() == 0 && frames < 600) {
+            world.step(1.0f / 60.0f);
+            ++frames;
+            if (sleeping() != 0 && sleeping() != 3) partial = true;
+        }
+        ERGO_TEST_ASSERT_FALSE(ctx, partial);
+        ERGO_TEST_ASSERT_EQ(ctx, sleeping(), 3);
+
+        // Nudging the top box wakes the whole pile on the next step
+        world.get_body(ids[2])->body.apply_impulse({0.5f, 0.0f, 0.0f});
+        world.step(1.0f / 60.0f);
+        ERGO_TEST_ASSERT_EQ(ctx, sleeping(), 0);
+        ERGO_TEST_ASSERT_EQ(ctx, world.island_count(), (size_t)1);
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_VelocitySetWhileAsleepWakes", [](TestContext& ctx) {
+        RigidBodyWorld world;
+        world.set_max_substeps(1);
+        auto ids = add_box_piles(world, 1, 3);
+        for (int frame = 0; frame < 600 && !world.get_body(ids[0])->body.is_sleeping; ++frame) {
+            world.step(1.0f / 60.0f);
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, world.get_body(ids[0])->body.is_sleeping);
+
+        // Written straight to the body, without wake()
+        float x = world.get_body(ids[0])->transform.position.x;
+        world.get_body(ids[0])->body.velocity = {5.0f, 0.0f, 0.0f};
+        world.step(1.0f / 60.0f);
+        bool any_asleep = false;
+        for (auto id : ids) any_asleep = any_asleep || world.get_body(id)->body.is_sleeping;
+        ERGO_TEST_ASSERT_FALSE(ctx, any_asleep);
+
+        for (int frame = 0; frame < 30; ++frame) world.step(1.0f / 60.0f);
+        ERGO_TEST_ASSERT_TRUE(ctx, world.get_body(ids[0])->transform.position.x > x + 0.1f);
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_ParallelIslandsMatchSerial", [](TestContext& ctx) {
+        auto serial = run_box_piles(40, 90);
+
+        g_job_system.initialize(3);
+        auto parallel = run_box_piles(40, 90);
+        g_job_system.shutdown();
+
+        bool same = serial.size() == parallel.size();
+        for (size_t i = 0; same && i < serial.size(); ++i) {
+            same = serial[i].x == parallel[i].x && serial[i].y == parallel[i].y &&
+                   serial[i].z == parallel[i].z;
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, same);
+    });
+
+    rigid_body_suite.add("Integrate3D_SimdMatchesScalar", [](TestContext& ctx) {
+        // Odd count so the scalar tail runs too
+        std::vector<PhysicsBody> bodies(1003);
+        BodyArrays3D simd_arrays;
+        fill_integration_bodies(bodies, simd_arrays);
+        BodyArrays3D scalar_arrays = simd_arrays;
+
+        auto count = static_cast<uint32_t>(bodies.size());
+        Vec3f gravity{0.0f, -9.81f, 0.0f};
+        for (int step = 0; step < 30; ++step) {
+            integrate_velocities3d(simd_arrays, 0, count, gravity, 1.0f / 60.0f,
+                                   IntegrationMode::Reproducible);
+            integrate_positions3d(simd_arrays, 0, count, 1.0f / 60.0f, IntegrationMode::Reproducible);
+            integrate_velocities3d_scalar(scalar_arrays, 0, count, gravity, 1.0f / 60.0f);
+            integrate_positions3d_scalar(scalar_arrays, 0, count, 1.0f / 60.0f);
+        }
+
+        const auto& a = simd_arrays;
+        const auto& b = scalar_arrays;
+        ERGO_TEST_ASSERT_TRUE(ctx, same_bits(a.position.x, b.position.x) &&
+                                   same_bits(a.position.y, b.position.y) &&
+                                   same_bits(a.position.z, b.position.z));
+        ERGO_TEST_ASSERT_TRUE(ctx, same_bits(a.velocity.x, b.velocity.x) &&
+                                   same_bits(a.velocity.y, b.velocity.y) &&
+                                   same_bits(a.velocity.z, b.velocity.z));
+        ERGO_TEST_ASSERT_TRUE(ctx, same_bits(a.angular_velocity.x, b.angular_velocity.x) &&
+                                   same_bits(a.angular_velocity.z, b.angular_velocity.z));
+        ERGO_TEST_ASSERT_TRUE(ctx, same_bits(a.rotation.x, b.rotation.x) &&
+                                   same_bits(a.rotation.y, b.rotation.y) &&
+                                   same_bits(a.rotation.z, b.rotation.z) &&
+                                   same_bits(a.rotation.w, b.rotation.w));
+        ERGO_TEST_ASSERT_TRUE(ctx, same_bits(a.force.x, b.force.x));
+
+        // Static and sleeping bodies never move
+        ERGO_TEST_ASSERT_EQ(ctx, a.position.y[0], 10.0f);
+        ERGO_TEST_ASSERT_EQ(ctx, a.position.y[11], 10.0f);
+        ERGO_TEST_ASSERT_EQ(ctx, a.position.y[13], 10.0f);
+    });
+
+    rigid_body_suite.add("Integrate3D_RotationFollowsAngularVelocity", [](TestContext& ctx) {
+        std::vector<PhysicsBody> bodies(9);
+        BodyArrays3D arrays;
+        for (auto& pb : bodies) {
+            pb.body.gravity_scale = 0.0f;
+            pb.body.angular_damping = 0.0f;
+            pb.body.angular_velocity = {0.0f, 2.0f, 0.0f};
+            arrays.push_back(pb);
+        }
+        for (int step = 0; step < 60; ++step) {
+            integrate_positions3d(arrays, 0, 9, 1.0f / 60.0f, IntegrationMode::Fast);
+        }
+
+        // Two radians about y, for SIMD lanes and the scalar tail alike
+        Quat expected = Quat::from_axis_angle({0.0f, 1.0f, 0.0f}, 2.0f);
+        for (uint32_t i = 0; i < 9; ++i) {
+            ERGO_TEST_ASSERT_NEAR(ctx, arrays.rotation.y[i], expected.y, 0.01f);
+            ERGO_TEST_ASSERT_NEAR(ctx, arrays.rotation.w[i], expected.w, 0.01f);
+            ERGO_TEST_ASSERT_NEAR(ctx, arrays.rotation[i].length(), 1.0f, 0.0001f);
+        }
+    });
+
+    rigid_body_suite.add("CpuPhysics_ThreadedMatchesSingleThreaded", [](TestContext& ctx) {
+        auto single = run_cpu_physics(1, 90);
+        auto threaded = run_cpu_physics(4, 90);
+
+        bool same = single.size() == threaded.size();
+        for (size_t i = 0; same && i < single.size(); ++i) {
+            same = single[i].x == threaded[i].x && single[i].y == threaded[i].y &&
+                   single[i].z == threaded[i].z;
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, same);
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_ShapesRestOnMesh", [](TestContext& ctx) {
+        RigidBodyWorld world;
+        PhysicsBody ground;
+        ground.body.set_mass(5.0f);  // meshes are forced static
+        ground.shape = TriangleMeshShape{make_grid_mesh(12, 1.0f)};
+        world.add_body(ground);
+
+        std::vector<Vec3f> points;
+        for (int i = 0; i < 8; ++i) {
+            points.push_back({(i & 1) ? 0.4f : -0.4f, (i & 2) ? 0.3f : -0.3f, (i & 4) ? 0.4f : -0.4f});
+        }
+        auto hull = std::make_shared<ConvexHull3D>(points);
+
+        // Box, capsule and hull dropped tilted; each should come to rest on
+        // its largest face / side
+        CollisionShape3D shapes[3] = {BoxShape{}, CapsuleShape{0.3f, 0.4f}, ConvexHullShape{hull}};
+        float rest_height[3] = {0.5f, 0.3f, 0.3f};
+        uint64_t ids[3];
+        for (int i = 0; i < 3; ++i) {
+            PhysicsBody body;
+            body.body.set_mass(1.0f);
+            body.shape = shapes[i];
+            body.transform.position = {static_cast<float>(i) * 2.5f - 2.5f, 1.5f, 0.0f};
+            body.transform.rotation = Quat::from_axis_angle({1.0f, 0.0f, 0.3f}, 0.3f);
+            ids[i] = world.add_body(body);
+        }
+        for (int i = 0; i < 300; ++i) world.step(1.0f / 60.0f);
+
+        for (int i = 0; i < 3; ++i) {
+            const PhysicsBody* body = world.get_body(ids[i]);
+            ERGO_TEST_ASSERT_NEAR(ctx, body->transform.position.y, rest_height[i], 0.03f);
+            ERGO_TEST_ASSERT_TRUE(ctx, body->body.is_sleeping);
+        }
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_QueriesMatchBruteForce", [](TestContext& ctx) {
+        RigidBodyWorld world;
+        add_query_scene(world);
+        const RigidBodyWorld& scene = world;
+
+        // Raycasts and sweeps against every body, without the broadphase
+        for (float radius : {0.0f, 0.3f}) {
+            int hits = 0, mismatches = 0;
+            for (const RayQuery3D& q : make_scene_rays(300, radius)) {
+                std::optional<float> expected;
+                Vec3f dir = q.direction.normalized();
+                scene.for_each_body([&](const PhysicsBody& pb) {
+                    auto hit = sphere_cast3d(pb.shape, pb.transform, q.origin, dir,
+                                             q.max_distance, radius);
+                    if (hit && (!expected || hit->distance < *expected)) expected = hit->distance;
+                });
+                auto found = radius > 0.0f
+                    ? world.sweep_sphere(q.origin, radius, q.direction, q.max_distance)
+                    : world.raycast(q.origin, q.direction, q.max_distance);
+                if (found.has_value() != expected.has_value()) ++mismatches;
+                else if (found && std::abs(found->distance - *expected) > 1e-4f) ++mismatches;
+                hits += found.has_value() ? 1 : 0;
+            }
+            ERGO_TEST_ASSERT_EQ(ctx, mismatches, 0);
+            ERGO_TEST_ASSERT_TRUE(ctx, hits > 100);
+        }
+
+        // Overlaps against every body
+        std::vector<uint64_t> found, expected;
+        bool same = true;
+        for (int i = 0; i < 50; ++i) {
+            Transform3D t;
+            t.position = {static_cast<float>(i % 10) * 3.7f - 17.0f, static_cast<float>(i % 4),
+                          static_cast<float>(i / 10) * 6.1f - 14.0f};
+            t.rotation = Quat::from_axis_angle({1.0f, 0.5f, 0.0f}, static_cast<float>(i));
+            CollisionShape3D shape = (i % 2) ? CollisionShape3D{SphereShape{1.5f}}
+                                             : CollisionShape3D{BoxShape{{2.0f, 0.5f, 1.0f}}};
+
+            expected.clear();
+            scene.for_each_body([&](const PhysicsBody& pb) {
+                if (check_collision3d(shape, t, pb.shape, pb.transform)) expected.push_back(pb.id);
+            });
+            if (i % 2) world.overlap_sphere(t.position, 1.5f, found);
+            else world.overlap_box(t.position, {2.0f, 0.5f, 1.0f}, t.rotation, found);
+
+            std::sort(found.begin(), found.end());
+            std::sort(expected.begin(), expected.end());
+            same = same && found == expected;
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, same);
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_RaycastManyMatchesSingle", [](TestContext& ctx) {
+        JobSystem pool;
+        pool.initialize(4);
+        RigidBodyWorld world;
+        world.set_job_system(pool);
+        add_query_scene(world);
+        for (int i = 0; i < 10; ++i) world.step(1.0f / 60.0f);
+
+        auto rays = make_scene_rays(2000, 0.0f);
+        for (size_t i = 0; i < rays.size(); i += 2) rays[i].radius = 0.2f;
+        std::vector<std::optional<RayHit3D>> results;
+        world.raycast_many(rays, results);
+        pool.shutdown();
+
+        int mismatches = 0;
+        for (size_t i = 0; i < rays.size(); ++i) {
+            const auto& q = rays[i];
+            auto single = q.radius > 0.0f
+                ? world.sweep_sphere(q.origin, q.radius, q.direction, q.max_distance)
+                : world.raycast(q.origin, q.direction, q.max_distance);
+            if (single.has_value() != results[i].has_value()) ++mismatches;
+            else if (single && (single->id != results[i]->id ||
+                                single->distance != results[i]->distance)) ++mismatches;
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, results.size(), rays.size());
+        ERGO_TEST_ASSERT_EQ(ctx, mismatches, 0);
+
+        // Queries see a body moved between steps
+        PhysicsBody probe;
+        probe.shape = SphereShape{0.5f};
+        probe.transform.position = {0.0f, 50.0f, 0.0f};
+        uint64_t id = world.add_body(probe);
+        auto before = world.raycast({0.0f, 60.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, 20.0f);
+        world.get_body(id)->transform.position = {0.0f, 40.0f, 0.0f};
+        auto after = world.raycast({0.0f, 60.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, 30.0f);
+        ERGO_TEST_ASSERT_TRUE(ctx, before && before->id == id);
+        ERGO_TEST_ASSERT_TRUE(ctx, after && after->id == id);
+        ERGO_TEST_ASSERT_NEAR(ctx, after->distance, 19.5f, 0.001f);
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_RollbackResimulatesBitExact", [](TestContext& ctx) {
+        RigidBodyWorld world;
+        world.set_deterministic(true);
+        auto inputs = add_rollback_scene(world);
+
+        auto first_run = run_rollback_frames(world, inputs, 0, 200);
+        std::vector<uint8_t> saved;
+        world.save_state(saved);
+        auto tail = run_rollback_frames(world, inputs, 200, 600);
+        first_run.insert(first_run.end(), tail.begin(), tail.end());
+
+        // Roll back to frame 200 and re-simulate the same inputs
+        ERGO_TEST_ASSERT_TRUE(ctx, world.restore_state(saved));
+        auto replay = run_rollback_frames(world, inputs, 200, 600);
+        ERGO_TEST_ASSERT_TRUE(ctx, replay == tail);
+
+        // A fresh world on four workers produces the same 600 hashes
+        JobSystem pool;
+        pool.initialize(4);
+        RigidBodyWorld threaded;
+        threaded.set_job_system(pool);
+        threaded.set_deterministic(true);
+        auto threaded_inputs = add_rollback_scene(threaded);
+        auto threaded_run = run_rollback_frames(threaded, threaded_inputs, 0, 600);
+        pool.shutdown();
+        ERGO_TEST_ASSERT_TRUE(ctx, threaded_run == first_run);
+
+        // Something happened: the state kept changing
+        ERGO_TEST_ASSERT_TRUE(ctx, first_run[100] != first_run[101]);
+        ERGO_TEST_ASSERT_TRUE(ctx, first_run.front() != first_run.back());
+    });
+
+    rigid_body_suite.add("RigidBodyWorld_RestoreRejectsOtherBodies", [](TestContext& ctx) {
+        RigidBodyWorld world;
+        auto ids = add_box_piles(world, 2, 2);
+        std::vector<uint8_t> saved;
+        world.save_state(saved);
+        Vec3f start = world.get_body(ids[1])->transform.position;
+
+        for (int i = 0; i < 30; ++i) world.step(1.0f / 60.0f);
+        world.remove_body(ids[0]);
+        ERGO_TEST_ASSERT_FALSE(ctx, world.restore_state(saved));
+
+        PhysicsBody box;
+        box.shape = BoxShape{};
+        world.add_body(box);  // same count, different id
+        ERGO_TEST_ASSERT_FALSE(ctx, world.restore_state(saved));
+        ERGO_TEST_ASSERT_FALSE(ctx, world.restore_state({}));
+
+        RigidBodyWorld same;
+        auto same_ids = add_box_piles(same, 2, 2);
+        for (int i = 0; i < 30; ++i) same.step(1.0f / 60.0f);
+        ERGO_TEST_ASSERT_TRUE(ctx, same.restore_state(saved));
+        ERGO_TEST_ASSERT_TRUE(ctx, same_ids == ids);
+        ERGO_TEST_ASSERT_TRUE(ctx, same.get_body(ids[1])->transform.position.y == start.y);
+    });
+
+    rigid_body_suite.add("GpuPhysics_EmulatorMatchesCpuFallback", [](TestContext& ctx) {
+        // One spaced-out layer only touches the plane, where both paths
+        // apply the same impulse
+        auto cpu = run_gpu_physics(nullptr, 1, 1.0f, 120);
+        auto emulated = run_gpu_physics(std::make_unique<GpuComputeEmulator>(), 1, 1.0f, 120);
+
+        float max_error = 0.0f;
+        for (size_t i = 0; i < cpu.size(); ++i) {
+            max_error = std::max(max_error, (cpu[i] - emulated[i]).length());
+        }
+        ERGO_TEST_ASSERT_NEAR(ctx, max_error, 0.0f, 1e-3f);
+        ERGO_TEST_ASSERT_NEAR(ctx, emulated[0].y, 0.25f, 0.05f);
+    });
+
+    rigid_body_suite.add("GpuPhysics_EmulatorParticlesSettle", [](TestContext& ctx) {
+        JobSystem inline_jobs;
+        JobSystem pool;
+        pool.initialize(4);
+        int contacts_single = 0, contacts_threaded = 0;
+        auto single = run_gpu_physics(std::make_unique<GpuComputeEmulator>(inline_jobs),
+                                      6, 0.45f, 180, &contacts_single);
+        auto threaded = run_gpu_physics(std::make_unique<GpuComputeEmulator>(pool),
+                                        6, 0.45f, 180, &contacts_threaded);
+        pool.shutdown();
+
+        bool same = single.size() == threaded.size();
+        for (size_t i = 0; same && i < single.size(); ++i) {
+            same = single[i].x == threaded[i].x && single[i].y == threaded[i].y &&
+                   single[i].z == threaded[i].z;
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, same);
+        ERGO_TEST_ASSERT_EQ(ctx, contacts_single, contacts_threaded);
+        ERGO_TEST_ASSERT_TRUE(ctx, contacts_single > 0);
+
+        // Nothing tunnels through the ground
+        float lowest = single[0].y;
+        for (const Vec3f& p : single) lowest = std::min(lowest, p.y);
+        ERGO_TEST_ASSERT_TRUE(ctx, lowest > 0.15f);
+    });
+
+    rigid_body_suite.add("GpuPhysics_EmulatorClampsFarCells", [](TestContext& ctx) {
+        // x / cell size is far outside int32 range; both land in the edge cell
+        GpuPhysicsComponent physics;
+        physics.set_compute_backend(std::make_unique<GpuComputeEmulator>());
+        physics.start();
+        uint64_t a = physics.add_body({1e10f, 5.0f, 0.0f}, 1.0f, SphereShape{0.25f});
+        uint64_t b = physics.add_body({1e10f, 5.4f, 0.0f}, 1.0f, SphereShape{0.25f});
+        int contacts = 0;
+        physics.set_collision_callback(a, [&contacts](uint64_t, const ContactPoint&) { ++contacts; });
+
+        for (int i = 0; i < 5; ++i) physics.update(1.0f / 60.0f);
+        ERGO_TEST_ASSERT_TRUE(ctx, contacts > 0);
+        ERGO_TEST_ASSERT_TRUE(ctx, physics.get_position(b).y > physics.get_position(a).y);
+    });
 }
 
 // ============================================================
@@ -256,10 +1570,14 @@ static void register_rigid_body_tests() {
 
 void register_physics_extended_tests(TestRunner& runner) {
     register_spatial_grid_tests();
+    register_aabb_tree_tests();
+    register_raycast2d_tests();
     register_collision3d_tests();
     register_rigid_body_tests();
 
     runner.add_suite(spatial_grid_suite);
+    runner.add_suite(aabb_tree_suite);
+    runner.add_suite(raycast2d_suite);
     runner.add_suite(collision3d_suite);
     runner.add_suite(rigid_body_suite);
 }
@@ -2,8 +2,20 @@
 #include "engine/render/render_command.hpp"
 #include "engine/render/command_buffer.hpp"
 #include "engine/render/double_buffer.hpp"
+#include "engine/render/render_pipeline.hpp"
 #include "engine/render/post_process.hpp"
 #include "engine/render/light.hpp"
+#include "engine/render/particle_system.hpp"
+#include "engine/render/sprite_batch.hpp"
+#include "engine/render/visibility.hpp"
+#include "engine/render/gpu_upload_queue.hpp"
+#include "engine/render/resource_registry.hpp"
+#include "engine/render/headless_renderer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
 
 using namespace ergo::test;
 
@@ -42,6 +54,73 @@ static void register_command_buffer_tests() {
         ERGO_TEST_ASSERT_EQ(ctx, a.size(), (size_t)3);
     });
 
+    suite_command_buffer.add("CommandBuffer_StreamIsPacked", [](TestContext& ctx) {
+        CommandBuffer buf;
+        for (int i = 0; i < 100; ++i) {
+            buf.push(RenderCmd_DrawRect{{static_cast<float>(i), 0.0f, 0.0f}, 1.0f, 1.0f, {}, true});
+        }
+        buf.push(RenderCmd_DrawCircle{{1.0f, 2.0f, 0.0f}, 3.0f, {}, false});
+
+        // Each command costs a header plus its own size, not the largest command's
+        size_t rect_bytes = sizeof(CommandView::Header) + sizeof(RenderCmd_DrawRect);
+        ERGO_TEST_ASSERT_TRUE(ctx, buf.stream_bytes() <= 101 * (rect_bytes + CommandView::alignment));
+        ERGO_TEST_ASSERT_EQ(ctx, buf.arena_bytes(), (size_t)0);
+
+        size_t rects = 0;
+        for (CommandView cmd : buf) {
+            if (auto* rect = cmd.get_if<RenderCmd_DrawRect>()) {
+                ERGO_TEST_ASSERT_NEAR(ctx, rect->position.x, static_cast<float>(rects), 0.0f);
+                ++rects;
+            }
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, rects, (size_t)100);
+        ERGO_TEST_ASSERT_TRUE(ctx, buf[100].type() == RenderCommandType::DrawCircle);
+        ERGO_TEST_ASSERT_NEAR(ctx, buf[100].as<RenderCmd_DrawCircle>().radius, 3.0f, 0.0f);
+    });
+
+    suite_command_buffer.add("CommandBuffer_VariableDataInArena", [](TestContext& ctx) {
+        CommandBuffer buf;
+        {
+            // Source data goes away right after recording
+            std::string text = "hello arena";
+            RenderCmd_DrawText draw_text;
+            draw_text.text = text;
+            buf.push(draw_text);
+
+            std::vector<Mat4> bones(3);
+            bones[2].m[12] = 5.0f;
+            RenderCmd_DrawSkinnedMesh skinned;
+            skinned.bone_count = 3;
+            skinned.bone_matrices = bones;
+            buf.push(skinned);
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, buf.arena_bytes(), 11 + 3 * sizeof(Mat4));
+
+        // Merged copies own their data too
+        CommandBuffer merged;
+        merged.merge(buf);
+        buf.clear();
+        buf.push(RenderCmd_DrawText{{}, "overwritten", {}, 1.0f});
+
+        ERGO_TEST_ASSERT_EQ(ctx, merged.size(), (size_t)2);
+        ERGO_TEST_ASSERT_TRUE(ctx, merged[0].as<RenderCmd_DrawText>().text == "hello arena");
+        const auto& skinned = merged[1].as<RenderCmd_DrawSkinnedMesh>();
+        ERGO_TEST_ASSERT_EQ(ctx, skinned.bone_matrices.size(), (size_t)3);
+        ERGO_TEST_ASSERT_NEAR(ctx, skinned.bone_matrices[2].m[12], 5.0f, 0.0f);
+    });
+
+    suite_command_buffer.add("FrameArena_ResetReusesBlocks", [](TestContext& ctx) {
+        FrameArena arena;
+        for (int frame = 0; frame < 3; ++frame) {
+            arena.reset();
+            void* big = arena.allocate(FrameArena::block_size * 2, 8);
+            auto* small = static_cast<uint64_t*>(arena.allocate(sizeof(uint64_t), alignof(uint64_t)));
+            ERGO_TEST_ASSERT_TRUE(ctx, big != nullptr);
+            ERGO_TEST_ASSERT_EQ(ctx, reinterpret_cast<uintptr_t>(small) % alignof(uint64_t), (uintptr_t)0);
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, arena.block_count(), (size_t)2);
+    });
+
     suite_command_buffer.add("DoubleBuffer_WriteRead", [](TestContext& ctx) {
         DoubleBufferedCommands db;
 
@@ -77,6 +156,264 @@ static void register_command_buffer_tests() {
         auto merged = collector.take();
         ERGO_TEST_ASSERT_EQ(ctx, merged.size(), (size_t)3);
     });
+
+    suite_command_buffer.add("SharedCommandCollector_SubmitMovesCommands", [](TestContext& ctx) {
+        SharedCommandCollector collector;
+        CommandBuffer worker1, worker2;
+        worker1.push(RenderCmd_DrawRect{{1.0f, 0.0f, 0.0f}, 1.0f, 1.0f, {}, true});
+        std::string label = "worker 2";
+        worker2.push(RenderCmd_DrawText{{}, label, {}, 1.0f});
+        worker2.push(RenderCmd_DrawCircle{{}, 2.0f, {}, true});
+
+        const void* rect = &worker1[0].as<RenderCmd_DrawRect>();
+        const void* text = &worker2[0].as<RenderCmd_DrawText>();
+        const char* chars = worker2[0].as<RenderCmd_DrawText>().text.data();
+
+        collector.submit(std::move(worker1));
+        collector.submit(std::move(worker2));
+        ERGO_TEST_ASSERT_TRUE(ctx, worker1.empty());
+        ERGO_TEST_ASSERT_TRUE(ctx, worker2.empty());
+
+        // Workers record the next frame while the merged commands are read
+        worker1.push(RenderCmd_DrawRect{{9.0f, 0.0f, 0.0f}, 1.0f, 1.0f, {}, true});
+        worker2.push(RenderCmd_DrawText{{}, "next frame", {}, 1.0f});
+
+        // Same addresses: spliced, not copied
+        CommandBuffer merged = collector.take();
+        ERGO_TEST_ASSERT_EQ(ctx, merged.size(), (size_t)3);
+        ERGO_TEST_ASSERT_TRUE(ctx, &merged[0].as<RenderCmd_DrawRect>() == rect);
+        ERGO_TEST_ASSERT_TRUE(ctx, &merged[1].as<RenderCmd_DrawText>() == text);
+        ERGO_TEST_ASSERT_TRUE(ctx, merged[1].as<RenderCmd_DrawText>().text.data() == chars);
+        ERGO_TEST_ASSERT_TRUE(ctx, merged[1].as<RenderCmd_DrawText>().text == "worker 2");
+        ERGO_TEST_ASSERT_NEAR(ctx, merged[0].as<RenderCmd_DrawRect>().position.x, 1.0f, 0.0f);
+        ERGO_TEST_ASSERT_EQ(ctx, merged.arena_bytes(), label.size());
+    });
+
+    suite_command_buffer.add("CommandBuffer_MoveMergeAcrossBlocks", [](TestContext& ctx) {
+        // Enough commands to fill several arena blocks on both sides
+        CommandBuffer a, b;
+        for (int i = 0; i < 4000; ++i) {
+            RenderCmd_DrawRect rect;
+            rect.position.x = static_cast<float>(i);
+            (i % 2 ? b : a).push(rect, static_cast<uint64_t>(i));
+        }
+        a.merge(std::move(b));
+        a.push(RenderCmd_DrawRect{{4000.0f, 0.0f, 0.0f}, 1.0f, 1.0f, {}, true}, 4000);
+        a.sort();
+
+        bool ordered = a.size() == 4001;
+        for (size_t i = 0; ordered && i < a.size(); ++i) {
+            ordered = static_cast<size_t>(a[i].as<RenderCmd_DrawRect>().position.x) == i;
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, ordered);
+        ERGO_TEST_ASSERT_TRUE(ctx, b.empty());
+        ERGO_TEST_ASSERT_EQ(ctx, a.arena_bytes(), (size_t)0);
+    });
+
+    suite_command_buffer.add("RenderPipeline_JobsRecordIntoStages", [](TestContext& ctx) {
+        RenderPipeline pipeline;
+        pipeline.initialize(3);
+
+        auto record = [](CommandBuffer& out, uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                out.push(RenderCmd_DrawRect{{static_cast<float>(i), 0.0f, 0.0f}, 1.0f, 1.0f, {}, true},
+                         static_cast<uint64_t>(i));
+            }
+        };
+        std::vector<RenderJob> jobs;
+        const RenderPipeline::Stage stages[] = {RenderPipeline::Stage::Shadow,
+                                                RenderPipeline::Stage::Transparent,
+                                                RenderPipeline::Stage::UI};
+        for (uint32_t j = 0; j < 12; ++j) {
+            jobs.push_back({j, j * 10, j * 10 + 10, stages[j % 3], record});
+        }
+
+        // The same jobs twice: worker buffers are drained, not accumulated
+        for (int frame = 0; frame < 2; ++frame) {
+            pipeline.begin_frame();
+            pipeline.dispatch_jobs(jobs);
+            pipeline.wait_for_jobs();
+            pipeline.end_frame();
+        }
+        pipeline.begin_frame();
+
+        for (auto stage : stages) {
+            const CommandBuffer& buf = pipeline.stage_commands(stage);
+            ERGO_TEST_ASSERT_EQ(ctx, buf.size(), (size_t)40);
+            ERGO_TEST_ASSERT_TRUE(ctx, std::is_sorted(buf.sort_keys().begin(), buf.sort_keys().end()));
+            // Every key belongs to this stage's jobs
+            bool routed = true;
+            for (uint64_t key : buf.sort_keys()) routed = routed && stages[(key / 10) % 3] == stage;
+            ERGO_TEST_ASSERT_TRUE(ctx, routed);
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, pipeline.stage_commands(RenderPipeline::Stage::Opaque).empty());
+        pipeline.shutdown();
+    });
+
+    suite_command_buffer.add("RenderPipeline_JobsKeepDispatchOrder", [](TestContext& ctx) {
+        RenderPipeline pipeline;
+        pipeline.initialize(3);
+
+        // No keys: painter's order is all the UI stage has to go on
+        auto record = [](CommandBuffer& out, uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                out.push(RenderCmd_DrawRect{{static_cast<float>(i), 0.0f, 0.0f}, 1.0f, 1.0f, {}, true});
+            }
+        };
+        std::vector<RenderJob> jobs;
+        for (uint32_t j = 0; j < 6; ++j) {
+            jobs.push_back({j, j * 2, j * 2 + 2, RenderPipeline::Stage::UI, record});
+        }
+
+        for (int frame = 0; frame < 2; ++frame) {
+            pipeline.begin_frame();
+            // Two dispatches in one frame continue the order
+            pipeline.dispatch_jobs({jobs.begin(), jobs.begin() + 4});
+            pipeline.wait_for_jobs();
+            pipeline.dispatch_jobs({jobs.begin() + 4, jobs.end()});
+            pipeline.wait_for_jobs();
+            pipeline.end_frame();
+        }
+        pipeline.begin_frame();
+
+        const CommandBuffer& buf = pipeline.stage_commands(RenderPipeline::Stage::UI);
+        ERGO_TEST_ASSERT_EQ(ctx, buf.size(), (size_t)12);
+        bool ordered = buf.size() == 12;
+        for (size_t i = 0; i < buf.size(); ++i) {
+            ordered = ordered && static_cast<size_t>(buf[i].as<RenderCmd_DrawRect>().position.x) == i;
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, ordered);
+        pipeline.shutdown();
+    });
+
+    suite_command_buffer.add("RenderSortKey_PackUnpack", [](TestContext& ctx) {
+        RenderSortKey key{3, 200, RenderSortKey::quantize_depth(0.25f), 0x1234, 0xbeef};
+        RenderSortKey back = RenderSortKey::unpack(key.pack());
+        ERGO_TEST_ASSERT_EQ(ctx, back.stage, 3u);
+        ERGO_TEST_ASSERT_EQ(ctx, back.layer, 200u);
+        ERGO_TEST_ASSERT_EQ(ctx, back.depth, key.depth);
+        ERGO_TEST_ASSERT_EQ(ctx, back.material, 0x1234u);
+        ERGO_TEST_ASSERT_EQ(ctx, back.texture, 0xbeefu);
+
+        // Field order: a later stage outranks everything below it
+        RenderSortKey low{0, 255, (1u << RenderSortKey::depth_bits) - 1, 0xffff, 0xffff};
+        RenderSortKey high{1, 0, 0, 0, 0};
+        ERGO_TEST_ASSERT_TRUE(ctx, low.pack() < high.pack());
+        ERGO_TEST_ASSERT_TRUE(ctx, RenderSortKey::quantize_depth(0.2f) < RenderSortKey::quantize_depth(0.8f));
+        ERGO_TEST_ASSERT_TRUE(ctx, RenderSortKey::quantize_depth(0.2f, true) >
+                                   RenderSortKey::quantize_depth(0.8f, true));
+    });
+
+    suite_command_buffer.add("CommandBuffer_SortGroupsByTexture", [](TestContext& ctx) {
+        // Sprites from three atlases recorded interleaved
+        CommandBuffer buf;
+        buf.push(RenderCmd_Clear{}, RenderSortKey{}.pack());
+        buf.set_sort_key({0, 1, 0, 0, 0});
+        for (int i = 0; i < 12; ++i) {
+            RenderCmd_DrawSprite sprite;
+            sprite.position = {static_cast<float>(i), 0.0f, 0.0f};
+            sprite.texture.id = static_cast<uint64_t>(1 + i % 3);
+            buf.push(sprite);
+        }
+        buf.sort();
+
+        ERGO_TEST_ASSERT_EQ(ctx, buf.size(), (size_t)13);
+        ERGO_TEST_ASSERT_TRUE(ctx, buf[0].is<RenderCmd_Clear>());
+
+        // Three runs, recording order kept inside each
+        int texture_changes = 0;
+        bool stable = true;
+        for (size_t i = 2; i < buf.size(); ++i) {
+            const auto& prev = buf[i - 1].as<RenderCmd_DrawSprite>();
+            const auto& cur = buf[i].as<RenderCmd_DrawSprite>();
+            if (cur.texture.id != prev.texture.id) ++texture_changes;
+            else stable = stable && cur.position.x > prev.position.x;
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, texture_changes, 2);
+        ERGO_TEST_ASSERT_TRUE(ctx, stable);
+        ERGO_TEST_ASSERT_TRUE(ctx, std::is_sorted(buf.sort_keys().begin(), buf.sort_keys().end()));
+    });
+
+    suite_command_buffer.add("CommandBuffer_SortKeepsBarriersAndPainterOrder", [](TestContext& ctx) {
+        // Two views, each cleared and then drawn with sprites from two atlases
+        CommandBuffer buf;
+        auto sprite = [](float x, uint64_t texture) {
+            RenderCmd_DrawSprite s;
+            s.position = {x, 0.0f, 0.0f};
+            s.texture.id = texture;
+            return s;
+        };
+        for (int view = 0; view < 2; ++view) {
+            buf.push(RenderCmd_Clear{});
+            buf.push(RenderCmd_SetViewProjection{});
+            buf.push(sprite(static_cast<float>(view * 10 + 0), 2));
+            buf.push(sprite(static_cast<float>(view * 10 + 1), 1));
+            buf.push(sprite(static_cast<float>(view * 10 + 2), 2));
+        }
+        auto layout = [&buf] {
+            std::string out;
+            for (CommandView cmd : buf) {
+                if (cmd.is<RenderCmd_Clear>()) out += "C ";
+                else if (cmd.is<RenderCmd_SetViewProjection>()) out += "V ";
+                else out += std::to_string(static_cast<int>(cmd.as<RenderCmd_DrawSprite>().position.x)) + " ";
+            }
+            return out;
+        };
+
+        // Ordered: nothing moves
+        buf.sort(CommandBuffer::SortMode::Ordered);
+        ERGO_TEST_ASSERT_TRUE(ctx, layout() == "C V 0 1 2 C V 10 11 12 ");
+        // State: draws group by texture, but only between the barriers
+        buf.sort(CommandBuffer::SortMode::State);
+        ERGO_TEST_ASSERT_TRUE(ctx, layout() == "C V 1 0 2 C V 11 10 12 ");
+
+        // Through the pipeline, UI keeps painter's order
+        RenderPipeline pipeline;
+        pipeline.begin_frame();
+        CommandBuffer ui;
+        for (int i = 0; i < 4; ++i) ui.push(sprite(static_cast<float>(i), 4 - i));
+        pipeline.submit(RenderStage::UI, std::move(ui));
+        pipeline.end_frame();
+        pipeline.begin_frame();
+        const CommandBuffer& out = pipeline.stage_commands(RenderStage::UI);
+        bool painter = out.size() == 4;
+        for (size_t i = 0; painter && i < out.size(); ++i) {
+            painter = out[i].as<RenderCmd_DrawSprite>().position.x == static_cast<float>(i);
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, painter);
+    });
+
+    suite_command_buffer.add("CommandBuffer_RadixSortMatchesStableSort", [](TestContext& ctx) {
+        JobSystem pool;
+        pool.initialize(4);
+
+        // Enough commands for the radix path, with many duplicate keys
+        CommandBuffer buf;
+        std::vector<std::pair<uint64_t, int>> expected;
+        uint32_t seed = 99;
+        for (int i = 0; i < 20000; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            RenderSortKey key{(seed >> 28) & 3, (seed >> 20) & 7,
+                              RenderSortKey::quantize_depth(static_cast<float>((seed >> 8) & 15) / 15.0f),
+                              (seed >> 4) & 15, seed & 3};
+            RenderCmd_DrawRect rect;
+            rect.position.x = static_cast<float>(i);
+            buf.push(rect, key.pack());
+            expected.emplace_back(key.pack(), i);
+        }
+        buf.sort(pool);
+        pool.shutdown();
+        std::stable_sort(expected.begin(), expected.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        bool same = buf.size() == expected.size();
+        for (size_t i = 0; same && i < expected.size(); ++i) {
+            const auto& rect = buf[i].as<RenderCmd_DrawRect>();
+            same = buf.sort_keys()[i] == expected[i].first &&
+                   static_cast<int>(rect.position.x) == expected[i].second;
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, same);
+    });
 }
 
 // ============================================================
@@ -208,6 +545,660 @@ static void register_light_tests() {
     });
 }
 
+// ============================================================
+// SpriteBatcher tests
+// ============================================================
+
+static TestSuite suite_sprite_batch("Render/SpriteBatch");
+
+static void register_sprite_batch_tests() {
+    suite_sprite_batch.add("SpriteBatcher_RunsSplitOnStateChange", [](TestContext& ctx) {
+        SpriteBatcher batch;
+        TextureHandle a{1}, b{2};
+        batch.draw_rect({0, 0}, {10, 10}, {255, 0, 0, 255}, true);
+        batch.draw_circle({5, 5}, 3.0f, {0, 255, 0, 255}, false);  // still the shape run
+        batch.draw_sprite({0, 0}, {8, 8}, a, {});
+        batch.draw_sprite({8, 0}, {8, 8}, a, {});
+        batch.draw_sprite({16, 0}, {8, 8}, b, {});
+        batch.draw_rect({0, 0}, {1, 1}, {}, false);
+
+        const auto& draws = batch.draws();
+        ERGO_TEST_ASSERT_EQ(ctx, batch.instances().size(), (size_t)6);
+        ERGO_TEST_ASSERT_EQ(ctx, draws.size(), (size_t)4);
+        ERGO_TEST_ASSERT_TRUE(ctx, draws[0].pipeline == Batch2DPipeline::Shape);
+        ERGO_TEST_ASSERT_EQ(ctx, draws[0].instance_count, 2u);
+        ERGO_TEST_ASSERT_EQ(ctx, draws[1].texture.id, (uint64_t)1);
+        ERGO_TEST_ASSERT_EQ(ctx, draws[1].first_instance, 2u);
+        ERGO_TEST_ASSERT_EQ(ctx, draws[1].instance_count, 2u);
+        ERGO_TEST_ASSERT_EQ(ctx, draws[2].texture.id, (uint64_t)2);
+        ERGO_TEST_ASSERT_EQ(ctx, draws[3].first_instance, 5u);
+
+        // The circle is stored as its bounding square
+        const Instance2D& circle = batch.instances()[1];
+        ERGO_TEST_ASSERT_NEAR(ctx, circle.rect[0], 2.0f, 1e-6f);
+        ERGO_TEST_ASSERT_NEAR(ctx, circle.rect[2], 6.0f, 1e-6f);
+        ERGO_TEST_ASSERT_TRUE(ctx, circle.kind == Shape2DKind::CircleOutline);
+        ERGO_TEST_ASSERT_EQ(ctx, circle.color, 0xff00ff00u);
+
+        batch.reset();
+        ERGO_TEST_ASSERT_TRUE(ctx, batch.draws().empty());
+    });
+
+    suite_sprite_batch.add("SpriteBatcher_ParticlesBecomeOneDraw", [](TestContext& ctx) {
+        EmitterConfig config;
+        config.texture = TextureHandle{7};
+        config.max_particles = 20000;
+        ParticleEmitter emitter(config);
+        emitter.burst(20000);
+
+        SpriteBatcher batch;
+        emitter.draw(batch);
+        ERGO_TEST_ASSERT_EQ(ctx, batch.instances().size(), (size_t)20000);
+        ERGO_TEST_ASSERT_EQ(ctx, batch.draws().size(), (size_t)1);
+        ERGO_TEST_ASSERT_EQ(ctx, batch.draws()[0].instance_count, 20000u);
+    });
+}
+
+// ============================================================
+// Visibility tests
+// ============================================================
+
+static TestSuite suite_visibility("Render/Visibility");
+
+// 90 degree camera at the origin looking down -Z
+static Mat4 make_test_view_projection() {
+    return Mat4::perspective(1.5707964f, 1.0f, 0.1f, 100.0f) *
+           Mat4::look_at({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {0.0f, 1.0f, 0.0f});
+}
+
+static void register_visibility_tests() {
+    suite_visibility.add("Frustum_CullsBoxesOutside", [](TestContext& ctx) {
+        Frustum f = Frustum::from_view_projection(make_test_view_projection());
+        Vec3f h{0.5f, 0.5f, 0.5f};
+        auto box = [&](Vec3f c) { return f.intersects(c - h, c + h); };
+        ERGO_TEST_ASSERT_TRUE(ctx, box({0.0f, 0.0f, -10.0f}));
+        ERGO_TEST_ASSERT_TRUE(ctx, box({9.0f, 0.0f, -10.0f}));     // near the right edge
+        ERGO_TEST_ASSERT_TRUE(ctx, box({0.0f, 0.0f, 0.0f}));       // crosses the near plane
+        ERGO_TEST_ASSERT_FALSE(ctx, box({0.0f, 0.0f, 10.0f}));     // behind
+        ERGO_TEST_ASSERT_FALSE(ctx, box({12.0f, 0.0f, -10.0f}));   // right of the view
+        ERGO_TEST_ASSERT_FALSE(ctx, box({0.0f, -12.0f, -10.0f}));  // below
+        ERGO_TEST_ASSERT_FALSE(ctx, box({0.0f, 0.0f, -150.0f}));   // past the far plane
+    });
+
+    suite_visibility.add("FrustumCull_BatchMatchesScalar", [](TestContext& ctx) {
+        Frustum f = Frustum::from_view_projection(make_test_view_projection());
+        BoundsSoA boxes;
+        boxes.resize(1001);
+        uint32_t seed = 17;
+        auto next = [&seed](float range) {
+            seed = seed * 1664525u + 1013904223u;
+            return (static_cast<float>(seed >> 8) / 16777216.0f * 2.0f - 1.0f) * range;
+        };
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            Vec3f c{next(60.0f), next(60.0f), next(120.0f)};
+            Vec3f h{std::abs(next(3.0f)), std::abs(next(3.0f)), std::abs(next(3.0f))};
+            boxes.set(i, c - h, c + h);
+        }
+        std::vector<uint8_t> visible(boxes.size(), 9);
+        size_t count = frustum_cull(f, boxes, 3, boxes.size(), visible.data());
+
+        bool same = visible[0] == 9 && visible[2] == 9;
+        size_t expected = 0;
+        for (size_t i = 3; i < boxes.size(); ++i) {
+            bool v = f.intersects({boxes.min_x[i], boxes.min_y[i], boxes.min_z[i]},
+                                  {boxes.max_x[i], boxes.max_y[i], boxes.max_z[i]});
+            same = same && visible[i] == (v ? 1 : 0);
+            expected += v ? 1 : 0;
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, same);
+        ERGO_TEST_ASSERT_EQ(ctx, count, expected);
+        ERGO_TEST_ASSERT_TRUE(ctx, expected > 0 && expected < boxes.size() - 3);
+    });
+
+    suite_visibility.add("OcclusionBuffer_WallHidesBoxBehind", [](TestContext& ctx) {
+        OcclusionBuffer occlusion;
+        occlusion.begin(make_test_view_projection());
+        occlusion.add_occluder({-2.0f, -2.0f, -5.2f}, {2.0f, 2.0f, -5.0f});
+
+        Vec3f h{0.5f, 0.5f, 0.5f};
+        auto visible = [&](Vec3f c) { return occlusion.test(c - h, c + h); };
+        ERGO_TEST_ASSERT_FALSE(ctx, visible({0.0f, 0.0f, -20.0f}));   // straight behind
+        ERGO_TEST_ASSERT_TRUE(ctx, visible({0.0f, 0.0f, -2.0f}));     // in front
+        ERGO_TEST_ASSERT_TRUE(ctx, visible({15.0f, 0.0f, -20.0f}));   // beside
+        ERGO_TEST_ASSERT_TRUE(ctx, visible({0.0f, 0.0f, 0.0f}));      // crosses the near plane
+        // The wall itself stays visible
+        ERGO_TEST_ASSERT_TRUE(ctx, occlusion.test({-2.0f, -2.0f, -5.2f}, {2.0f, 2.0f, -5.0f}));
+    });
+
+    suite_visibility.add("RenderPipeline_RecordVisibleCulls", [](TestContext& ctx) {
+        RenderPipeline pipeline;
+        MeshData cube;
+        for (int k = 0; k < 8; ++k) {
+            Vertex v;
+            v.position = {(k & 1) ? 0.5f : -0.5f, (k & 2) ? 0.5f : -0.5f, (k & 4) ? 0.5f : -0.5f};
+            cube.vertices.push_back(v);
+        }
+        uint64_t cube_id = pipeline.register_mesh(cube);
+        ERGO_TEST_ASSERT_NEAR(ctx, pipeline.get_mesh(cube_id)->bounds_max.y, 0.5f, 0.0f);
+
+        pipeline.set_projection_matrix(Mat4::perspective(1.5707964f, 1.0f, 0.1f, 100.0f));
+        pipeline.set_view_matrix(Mat4::look_at({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f},
+                                               {0.0f, 1.0f, 0.0f}));
+
+        // A wall of occluders at z = -5, cubes hidden behind it at z = -30,
+        // a row in the open to the right, and a row behind the camera
+        std::vector<MeshInstance> instances;
+        auto add = [&](Vec3f pos, Vec3f scale, bool occluder) {
+            instances.push_back({cube_id, Mat4::translation(pos) * Mat4::scale(scale), 7, occluder});
+        };
+        add({0.0f, 0.0f, -5.0f}, {4.0f, 4.0f, 0.2f}, true);
+        for (int i = 0; i < 5; ++i) add({static_cast<float>(i) - 2.0f, 0.0f, -30.0f}, {1, 1, 1}, false);
+        for (int i = 0; i < 4; ++i) add({20.0f + i, 0.0f, -30.0f}, {1, 1, 1}, false);
+        for (int i = 0; i < 6; ++i) add({static_cast<float>(i), 0.0f, 10.0f}, {1, 1, 1}, false);
+        instances.push_back({999, Mat4{}, 0, false});  // unregistered: kept
+
+        CommandBuffer frustum_only;
+        CullStats stats = pipeline.record_visible(instances, frustum_only);
+        ERGO_TEST_ASSERT_EQ(ctx, stats.tested, 17u);
+        ERGO_TEST_ASSERT_EQ(ctx, stats.frustum_culled, 6u);
+        ERGO_TEST_ASSERT_EQ(ctx, frustum_only.size(), (size_t)11);
+
+        CommandBuffer occluded;
+        stats = pipeline.record_visible(instances, occluded, true);
+        ERGO_TEST_ASSERT_EQ(ctx, stats.occlusion_culled, 5u);
+        ERGO_TEST_ASSERT_EQ(ctx, occluded.size(), (size_t)6);
+        if (occluded.size() != 6) return;
+        ERGO_TEST_ASSERT_EQ(ctx, occluded[0].as<RenderCmd_DrawMesh>().material_id, (uint64_t)7);
+        ERGO_TEST_ASSERT_NEAR(ctx, occluded[1].as<RenderCmd_DrawMesh>().world_transform.m[12], 20.0f, 0.0f);
+        ERGO_TEST_ASSERT_EQ(ctx, occluded[5].as<RenderCmd_DrawMesh>().mesh_id, (uint64_t)999);
+    });
+}
+
+// ============================================================
+// Upload tests
+// ============================================================
+
+static TestSuite suite_uploads("Render/Uploads");
+
+static void register_upload_tests() {
+    suite_uploads.add("DeviceHeap_SubAllocatesAndCoalesces", [](TestContext& ctx) {
+        DeviceHeapAllocator heaps(1024);
+        GpuAllocation a = heaps.allocate(100, 16);
+        GpuAllocation b = heaps.allocate(200, 16);
+        GpuAllocation c = heaps.allocate(300, 16);
+        ERGO_TEST_ASSERT_EQ(ctx, heaps.heap_count(), (size_t)1);
+        ERGO_TEST_ASSERT_EQ(ctx, b.offset, (uint64_t)112);
+        ERGO_TEST_ASSERT_EQ(ctx, c.offset % 16, (uint64_t)0);
+
+        // Freeing both neighbours of b merges the hole back into one range
+        heaps.free(a);
+        heaps.free(b);
+        GpuAllocation d = heaps.allocate(300, 16);
+        ERGO_TEST_ASSERT_EQ(ctx, d.heap, 0u);
+        ERGO_TEST_ASSERT_EQ(ctx, d.offset, (uint64_t)0);
+
+        // Too big for the rest of the heap: a new heap, dedicated if oversized
+        GpuAllocation e = heaps.allocate(800, 16);
+        GpuAllocation f = heaps.allocate(4096, 16);
+        ERGO_TEST_ASSERT_EQ(ctx, e.heap, 1u);
+        ERGO_TEST_ASSERT_EQ(ctx, f.heap, 2u);
+        ERGO_TEST_ASSERT_EQ(ctx, heaps.heap_size(2), (uint64_t)4096);
+        ERGO_TEST_ASSERT_EQ(ctx, heaps.bytes_allocated(), (uint64_t)(300 + 300 + 800 + 4096));
+    });
+
+    suite_uploads.add("StagingRing_WrapsAfterRetire", [](TestContext& ctx) {
+        StagingRing ring(1000);
+        ERGO_TEST_ASSERT_EQ(ctx, ring.allocate(400, 16, 1), (size_t)0);
+        ERGO_TEST_ASSERT_EQ(ctx, ring.allocate(400, 16, 2), (size_t)400);
+        // Neither the end nor the front has room until frame 1 completes
+        ERGO_TEST_ASSERT_EQ(ctx, ring.allocate(300, 16, 3), StagingRing::npos);
+
+        ring.retire(1);
+        ERGO_TEST_ASSERT_EQ(ctx, ring.allocate(300, 16, 3), (size_t)0);
+        // Wrapped: only the gap up to frame 2's span remains
+        ERGO_TEST_ASSERT_EQ(ctx, ring.allocate(200, 16, 3), StagingRing::npos);
+        ERGO_TEST_ASSERT_EQ(ctx, ring.allocate(96, 16, 3), (size_t)304);
+
+        ring.retire(3);
+        ERGO_TEST_ASSERT_TRUE(ctx, ring.empty());
+        ERGO_TEST_ASSERT_EQ(ctx, ring.allocate(1000, 16, 4), (size_t)0);
+    });
+
+    suite_uploads.add("GpuUploadQueue_BatchesFrameUploads", [](TestContext& ctx) {
+        GpuUploadQueue uploads({4096, 1 << 20});
+        MeshData mesh;
+        mesh.vertices.resize(3);
+        mesh.vertices[1].position = {1.0f, 2.0f, 3.0f};
+        mesh.indices = {0, 1, 2};
+        ERGO_TEST_ASSERT_TRUE(ctx, uploads.enqueue_mesh(mesh));
+        ERGO_TEST_ASSERT_TRUE(ctx, mesh.uploaded);
+        ERGO_TEST_ASSERT_TRUE(ctx, mesh.gpu_vertex_buffer != 0 && mesh.gpu_index_buffer != 0);
+
+        uint32_t pixels[4] = {1, 2, 3, 4};
+        ERGO_TEST_ASSERT_TRUE(ctx, uploads.enqueue_texture(7, pixels, 2, 2));
+        ERGO_TEST_ASSERT_TRUE(ctx, uploads.enqueue_texture_region(8, 16, 32, 1, 1, pixels));
+
+        const UploadBatch& batch = uploads.submit();
+        ERGO_TEST_ASSERT_EQ(ctx, batch.fence, mesh.upload_fence);
+        ERGO_TEST_ASSERT_EQ(ctx, batch.buffers.size(), (size_t)2);
+        ERGO_TEST_ASSERT_EQ(ctx, batch.images.size(), (size_t)2);
+        if (batch.buffers.size() != 2 || batch.images.size() != 2) return;
+        ERGO_TEST_ASSERT_EQ(ctx, batch.buffers[0].dst.size, (uint64_t)(3 * sizeof(Vertex)));
+        ERGO_TEST_ASSERT_EQ(ctx, batch.images[1].x, 16u);
+
+        // The staged bytes are the mesh's
+        Vertex staged;
+        std::memcpy(&staged, uploads.staging_data() + batch.buffers[0].staging_offset + sizeof(Vertex),
+                    sizeof(Vertex));
+        ERGO_TEST_ASSERT_NEAR(ctx, staged.position.z, 3.0f, 0.0f);
+
+        ERGO_TEST_ASSERT_FALSE(ctx, uploads.is_complete(mesh.upload_fence));
+        uploads.retire(batch.fence);
+        ERGO_TEST_ASSERT_TRUE(ctx, uploads.is_complete(mesh.upload_fence));
+        ERGO_TEST_ASSERT_TRUE(ctx, uploads.submit().empty());
+    });
+
+    suite_uploads.add("GpuUploadQueue_FullRingDefersAndReleasesLate", [](TestContext& ctx) {
+        GpuUploadQueue uploads({1024, 1 << 20});
+        std::vector<uint8_t> pixels(600, 0xff);
+        ERGO_TEST_ASSERT_TRUE(ctx, uploads.enqueue_texture(1, pixels.data(), 150, 1));
+        ERGO_TEST_ASSERT_FALSE(ctx, uploads.enqueue_texture(2, pixels.data(), 150, 1));
+        uint64_t fence = uploads.submit().fence;
+        uploads.retire(fence);
+        ERGO_TEST_ASSERT_TRUE(ctx, uploads.enqueue_texture(2, pixels.data(), 150, 1));
+
+        // A released range stays allocated until the frame releasing it completes
+        MeshData mesh;
+        mesh.vertices.resize(4);
+        ERGO_TEST_ASSERT_TRUE(ctx, uploads.enqueue_mesh(mesh));
+        uint64_t allocated = uploads.heaps().bytes_allocated();
+        uploads.release_buffer(mesh.gpu_vertex_buffer);
+        fence = uploads.submit().fence;
+        ERGO_TEST_ASSERT_EQ(ctx, uploads.heaps().bytes_allocated(), allocated);
+        uploads.retire(fence);
+        ERGO_TEST_ASSERT_EQ(ctx, uploads.heaps().bytes_allocated(), (uint64_t)0);
+    });
+
+    suite_uploads.add("RenderPipeline_RegisterMeshQueuesUpload", [](TestContext& ctx) {
+        RenderPipeline pipeline;
+        MeshData mesh;
+        mesh.vertices.resize(8);
+        mesh.indices.resize(36);
+        uint64_t id = pipeline.register_mesh(mesh);
+        const MeshData* stored = pipeline.get_mesh(id);
+        ERGO_TEST_ASSERT_TRUE(ctx, stored && stored->uploaded);
+
+        const UploadBatch& batch = pipeline.upload_queue().submit();
+        ERGO_TEST_ASSERT_EQ(ctx, batch.buffers.size(), (size_t)2);
+        pipeline.upload_queue().retire(batch.fence);
+        pipeline.unregister_mesh(id);
+        pipeline.upload_queue().retire(pipeline.upload_queue().submit().fence);
+        ERGO_TEST_ASSERT_EQ(ctx, pipeline.upload_queue().heaps().bytes_allocated(), (uint64_t)0);
+    });
+
+    suite_uploads.add("Headless_DrainsUploadsPastRingCapacity", [](TestContext& ctx) {
+        // Each mesh takes over a quarter of the ring: only a few fit per frame
+        RenderPipeline pipeline(GpuUploadQueue::Config{4096, 1 << 20});
+        HeadlessRenderer renderer;
+        renderer.initialize();
+        std::vector<uint64_t> ids;
+        for (int i = 0; i < 12; ++i) {
+            MeshData mesh;
+            mesh.vertices.resize(32);
+            mesh.indices.resize(48);
+            ids.push_back(pipeline.register_mesh(mesh));
+        }
+
+        uint32_t uploads = 0;
+        for (int frame = 0; frame < 16; ++frame) {
+            pipeline.begin_frame();
+            renderer.begin_frame();
+            pipeline.end_frame();
+            renderer.consume(pipeline);
+            renderer.end_frame();
+            uploads += renderer.stats().buffer_uploads;
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, uploads, 24u);
+        bool all_uploaded = true;
+        for (uint64_t id : ids) {
+            const MeshData* mesh = pipeline.get_mesh(id);
+            all_uploaded = all_uploaded && mesh && mesh->uploaded &&
+                           pipeline.upload_queue().is_complete(mesh->upload_fence);
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, all_uploaded);
+
+        // Released ranges come back once the releasing frame is retired
+        for (uint64_t id : ids) pipeline.unregister_mesh(id);
+        for (int frame = 0; frame < 2; ++frame) {
+            pipeline.begin_frame();
+            renderer.begin_frame();
+            pipeline.end_frame();
+            renderer.consume(pipeline);
+            renderer.end_frame();
+        }
+        ERGO_TEST_ASSERT_EQ(ctx, pipeline.upload_queue().heaps().bytes_allocated(), (uint64_t)0);
+        renderer.shutdown();
+    });
+
+    suite_uploads.add("GpuUploadQueue_SplitsMeshLargerThanRing", [](TestContext& ctx) {
+        GpuUploadQueue uploads(GpuUploadQueue::Config{1024, 1 << 20});
+        MeshData mesh;
+        mesh.vertices.resize(100);
+        for (size_t i = 0; i < mesh.vertices.size(); ++i) mesh.vertices[i].position = {static_cast<float>(i), 1.0f, 2.0f};
+        mesh.indices.resize(300);
+        for (size_t i = 0; i < mesh.indices.size(); ++i) mesh.indices[i] = static_cast<uint32_t>(i * 7);
+
+        // Copy each frame's pieces back out of the ring, as a backend would
+        const uint64_t offset_mask = (uint64_t{1} << GpuAllocation::offset_bits) - 1;
+        std::vector<std::byte> vertex_data(mesh.vertices.size() * sizeof(Vertex));
+        std::vector<std::byte> index_data(mesh.indices.size() * sizeof(uint32_t));
+        int frames = 0;
+        bool done = false;
+        while (!done && frames < 64) {
+            done = uploads.enqueue_mesh(mesh);
+            ERGO_TEST_ASSERT_EQ(ctx, mesh.uploaded, done);
+            const UploadBatch& batch = uploads.submit();
+            for (const BufferCopy& copy : batch.buffers) {
+                uint64_t vb = mesh.gpu_vertex_buffer & offset_mask;
+                uint64_t ib = mesh.gpu_index_buffer & offset_mask;
+                bool vertex = copy.dst.heap + 1 == mesh.gpu_vertex_buffer >> GpuAllocation::offset_bits &&
+                              copy.dst.offset >= vb && copy.dst.offset < vb + vertex_data.size();
+                std::byte* dst = vertex ? vertex_data.data() + (copy.dst.offset - vb)
+                                        : index_data.data() + (copy.dst.offset - ib);
+                std::memcpy(dst, uploads.staging_data() + copy.staging_offset, copy.dst.size);
+            }
+            uploads.retire(batch.fence);
+            ++frames;
+        }
+        ERGO_TEST_ASSERT_TRUE(ctx, done);
+        ERGO_TEST_ASSERT_TRUE(ctx, frames > 1);
+        ERGO_TEST_ASSERT_TRUE(ctx, uploads.is_complete(mesh.upload_fence));
+        ERGO_TEST_ASSERT_TRUE(ctx, std::memcmp(vertex_data.data(), mesh.vertices.data(), vertex_data.size()) == 0);
+        ERGO_TEST_ASSERT_TRUE(ctx, std::memcmp(index_data.data(), mesh.indices.data(), index_data.size()) == 0);
+    });
+
+    suite_uploads.add("Headless_OversizedMeshDoesNotStallQueue", [](TestContext& ctx) {
+        RenderPipeline pipeline(GpuUploadQueue::Config{4096, 1 << 20});
+        HeadlessRenderer renderer;
+        renderer.initialize();
+        MeshData big;
+        big.vertices.resize(6400 / sizeof(Vertex) + 1);
+        MeshData small;
+        small.vertices.resize(2);
+        uint64_t big_id = pipeline.register_mesh(big);
+        uint64_t small_id = pipeline.register_mesh(small);
+
+        for (int frame = 0; frame < 10; ++frame) {
+            pipeline.begin_frame();
+            renderer.begin_frame();
+            pipeline.end_frame();
+            renderer.consume(pipeline);
+            renderer.end_frame();
+        }
+        for (uint64_t id : {big_id, small_id}) {
+            const MeshData* mesh = pipeline.get_mesh(id);
+            ERGO_TEST_ASSERT_TRUE(ctx, mesh && mesh->uploaded &&
+                                       pipeline.upload_queue().is_complete(mesh->upload_fence));
+        }
+        renderer.shutdown();
+    });
+}
+
+// ============================================================
+// Resource registry tests
+// ============================================================
+
+static TestSuite suite_registry("Render/ResourceRegistry");
+
+static void register_registry_tests() {
+    suite_registry.add("ResourceRegistry_StaleIdsMissAfterReuse", [](TestContext& ctx) {
+        ResourceRegistry<MaterialData> registry;
+        MaterialData first;
+        first.metallic = 0.25f;
+        uint64_t a = registry.add(first);
+        ERGO_TEST_ASSERT_TRUE(ctx, a != 0);
+        ERGO_TEST_ASSERT_TRUE(ctx, registry.get(0) == nullptr);
+
+        // Removed entries miss at once but live until their frame retires
+        const MaterialData* held = registry.get(a);
+        ERGO_TEST_ASSERT_TRUE(ctx, registry.remove(a, 5));
+        ERGO_TEST_ASSERT_TRUE(ctx, registry.get(a) == nullptr);
+        ERGO_TEST_ASSERT_FALSE(ctx, registry.remove(a, 5));
+        registry.retire(4);
+        ERGO_TEST_ASSERT_NEAR(ctx, held->metallic, 0.25f, 0.0f);
+        uint64_t b = registry.add(MaterialData{});
+        ERGO_TEST_ASSERT_TRUE(ctx, (b & 0xffffffffu) != (a & 0xffffffffu));
+
+        // After retiring, the slot is reused under a new generation
+        registry.retire(5);
+        uint64_t c = registry.add(MaterialData{});
+        ERGO_TEST_ASSERT_EQ(ctx, c & 0xffffffffu, a & 0xffffffffu);
+        ERGO_TEST_ASSERT_TRUE(ctx, c != a);
+        ERGO_TEST_ASSERT_TRUE(ctx, registry.get(a) == nullptr);
+        ERGO_TEST_ASSERT_TRUE(ctx, registry.get(c) != nullptr);
+        ERGO_TEST_ASSERT_EQ(ctx, registry.size(), (size_t)2);
+    });
+
+    suite_registry.add("ResourceRegistry_ReadsWhileGrowing", [](TestContext& ctx) {
+        ResourceRegistry<MaterialData> registry;
+        MaterialData m;
+        m.roughness = 0.5f;
+        uint64_t id = registry.add(m);
+
+        // Readers keep resolving one id while the writer adds blocks
+        std::atomic<bool> done{false};
+        std::atomic<uint32_t> misses{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 2; ++t) {
+            readers.emplace_back([&] {
+                while (!done.load(std::memory_order_acquire)) {
+                    const MaterialData* found = registry.get(id);
+                    if (!found || found->roughness != 0.5f) misses.fetch_add(1);
+                }
+            });
+        }
+        for (uint32_t i = 0; i < ResourceRegistry<MaterialData>::block_size * 8; ++i) {
+            registry.add(MaterialData{});
+        }
+        done.store(true, std::memory_order_release);
+        for (auto& r : readers) r.join();
+        ERGO_TEST_ASSERT_EQ(ctx, misses.load(), 0u);
+        ERGO_TEST_ASSERT_EQ(ctx, registry.size(), (size_t)(ResourceRegistry<MaterialData>::block_size * 8 + 1));
+    });
+
+    suite_registry.add("RenderPipeline_UnregisterDefersToRetiredFrame", [](TestContext& ctx) {
+        RenderPipeline pipeline;
+        pipeline.begin_frame();
+        uint64_t material = pipeline.register_material(MaterialData{});
+        ERGO_TEST_ASSERT_EQ(ctx, pipeline.get_material(material)->id, material);
+
+        MaterialData* held = pipeline.get_material(material);
+        pipeline.unregister_material(material);
+        ERGO_TEST_ASSERT_TRUE(ctx, pipeline.get_material(material) == nullptr);
+        pipeline.retire_frame(pipeline.frame_number() - 1);
+        ERGO_TEST_ASSERT_EQ(ctx, held->id, material);
+
+        pipeline.retire_frame(pipeline.frame_number());
+        uint64_t reused = pipeline.register_material(MaterialData{});
+        ERGO_TEST_ASSERT_TRUE(ctx, reused != material);
+        ERGO_TEST_ASSERT_TRUE(ctx, pipeline.get_material(material) == nullptr);
+    });
+
+    suite_registry.add("RenderPipeline_BeginFrameReclaimsAfterFramesInFlight", [](TestContext& ctx) {
+        RenderPipeline pipeline;
+        pipeline.set_frames_in_flight(2);
+        pipeline.begin_frame();
+        uint64_t removed = pipeline.register_material(MaterialData{});
+        pipeline.unregister_material(removed);
+
+        // Frames 2 and 3 may still read frame 1's lookups; frame 3 reclaims it
+        pipeline.begin_frame();
+        uint64_t early = pipeline.register_material(MaterialData{});
+        ERGO_TEST_ASSERT_TRUE(ctx, (early & 0xffffffffu) != (removed & 0xffffffffu));
+        pipeline.begin_frame();
+        uint64_t reused = pipeline.register_material(MaterialData{});
+        ERGO_TEST_ASSERT_EQ(ctx, reused & 0xffffffffu, removed & 0xffffffffu);
+        ERGO_TEST_ASSERT_EQ(ctx, reused >> 32, (removed >> 32) + 1);
+        ERGO_TEST_ASSERT_TRUE(ctx, pipeline.get_material(removed) == nullptr);
+        ERGO_TEST_ASSERT_TRUE(ctx, pipeline.get_material(reused) != nullptr);
+    });
+}
+
+// ============================================================
+// Headless renderer tests
+// ============================================================
+
+static TestSuite suite_headless("Render/Headless");
+
+static void register_headless_tests() {
+    suite_headless.add("Headless_HashIsStableAndOrderSensitive", [](TestContext& ctx) {
+        CommandBuffer ab, ba;
+        RenderCmd_DrawRect rect{{1.0f, 2.0f, 0.0f}, 10.0f, 5.0f, {255, 0, 0, 255}, true};
+        RenderCmd_DrawCircle circle{{20.0f, 20.0f, 0.0f}, 4.0f, {0, 255, 0, 255}, false};
+        ab.push(rect);
+        ab.push(circle);
+        ba.push(circle);
+        ba.push(rect);
+
+        HeadlessRenderer renderer;
+        renderer.initialize();
+        auto frame_hash = [&renderer](const CommandBuffer& commands) {
+            renderer.begin_frame();
+            renderer.consume(commands);
+            renderer.end_frame();
+            return renderer.stats().hash;
+        };
+        uint64_t first = frame_hash(ab);
+        ERGO_TEST_ASSERT_EQ(ctx, frame_hash(ab), first);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.stats().commands, 2u);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.stats().count(RenderCommandType::DrawCircle), 1u);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.stats().errors, 0u);
+        ERGO_TEST_ASSERT_TRUE(ctx, frame_hash(ba) != first);
+    });
+
+    suite_headless.add("Headless_ReportsMalformedCommands", [](TestContext& ctx) {
+        CommandBuffer commands;
+        commands.push(RenderCmd_DrawRect{{0.0f, 0.0f, 0.0f}, -1.0f, 5.0f, {}, true});
+        commands.push(RenderCmd_DrawSprite{{0.0f, 0.0f, 0.0f}, 8.0f, 8.0f, {}, {}});
+        Mat4 bone;
+        RenderCmd_DrawSkinnedMesh skinned;
+        skinned.bone_count = 2;
+        skinned.bone_matrices = {&bone, 1};
+        commands.push(skinned);
+        TextBatchVertex vertices[3] = {};
+        uint32_t indices[3] = {0, 1, 5};
+        RenderCmd_DrawTextBatch text;
+        text.vertices = vertices;
+        text.indices = indices;
+        commands.push(text);
+        commands.push(RenderCmd_DrawRect{{0.0f, 0.0f, 0.0f}, 4.0f, 4.0f, {}, true});
+
+        HeadlessRenderer renderer({16, 16});
+        renderer.initialize();
+        renderer.begin_frame();
+        renderer.consume(commands);
+        renderer.end_frame();
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.stats().commands, 5u);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.stats().errors, 4u);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.errors().size(), (size_t)4);
+        ERGO_TEST_ASSERT_TRUE(ctx, renderer.errors().empty() ||
+                                   renderer.errors()[0].find("DrawRect") != std::string::npos);
+    });
+
+    suite_headless.add("Headless_RasterizesPipelineFrame", [](TestContext& ctx) {
+        RenderPipeline pipeline;
+        MeshData quad;
+        for (int k = 0; k < 4; ++k) {
+            Vertex v;
+            v.position = {(k == 1 || k == 2) ? 1.0f : -1.0f, k >= 2 ? 1.0f : -1.0f, 0.0f};
+            quad.vertices.push_back(v);
+        }
+        quad.indices = {0, 1, 2, 0, 2, 3};
+        uint64_t quad_id = pipeline.register_mesh(quad);
+        MaterialData red, blue;
+        red.diffuse_color = {255, 0, 0, 255};
+        blue.diffuse_color = {0, 0, 255, 255};
+        uint64_t red_id = pipeline.register_material(red);
+        uint64_t blue_id = pipeline.register_material(blue);
+
+        pipeline.set_projection_matrix(Mat4::perspective(1.5707964f, 1.0f, 0.1f, 100.0f));
+        pipeline.set_view_matrix(Mat4::look_at({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f},
+                                               {0.0f, 1.0f, 0.0f}));
+
+        // The small blue quad is nearer; sorting draws it after the red one
+        // by material, and the depth test keeps it either way
+        pipeline.begin_frame();
+        CommandBuffer opaque, ui;
+        opaque.push(RenderCmd_DrawMesh{quad_id, Mat4::translation({0.0f, 0.0f, -3.0f}) *
+                                                Mat4::scale({0.2f, 0.2f, 1.0f}), blue_id});
+        opaque.push(RenderCmd_DrawMesh{quad_id, Mat4::translation({0.0f, 0.0f, -5.0f}), red_id});
+        ui.push(RenderCmd_DrawRect{{0.0f, 0.0f, 0.0f}, 10.0f, 10.0f, {0, 255, 0, 255}, true});
+        pipeline.submit(RenderStage::Opaque, std::move(opaque));
+        pipeline.submit(RenderStage::UI, std::move(ui));
+        pipeline.end_frame();
+        pipeline.begin_frame();
+
+        HeadlessRenderer renderer({64, 64});
+        renderer.initialize();
+        renderer.begin_frame();
+        renderer.consume(pipeline);
+        renderer.end_frame();
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.stats().errors, 0u);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.stats().triangles, 4u);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.pixel(32, 32), 0xffff0000u);  // blue
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.pixel(27, 32), 0xff0000ffu);  // red
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.pixel(2, 2), 0xff00ff00u);    // green
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.pixel(60, 60), 0xff000000u);
+    });
+
+    suite_headless.add("Headless_ValidatesStageSortModeAndRetiresFrame", [](TestContext& ctx) {
+        RenderPipeline pipeline;
+        HeadlessRenderer renderer;
+        renderer.initialize();
+
+        // UI keeps painter's order across textures, which a whole-key check
+        // would report as unsorted
+        pipeline.begin_frame();
+        uint64_t removed = pipeline.register_material(MaterialData{});
+        pipeline.unregister_material(removed);
+        CommandBuffer ui;
+        ui.push(RenderCmd_DrawSprite{{}, 4.0f, 4.0f, {9}, {}});
+        ui.push(RenderCmd_DrawSprite{{}, 4.0f, 4.0f, {1}, {}});
+        pipeline.submit(RenderStage::UI, std::move(ui));
+        pipeline.end_frame();
+
+        pipeline.begin_frame();
+        renderer.begin_frame();
+        renderer.consume(pipeline);
+        renderer.end_frame();
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.stats().count(RenderCommandType::DrawSprite), 2u);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.stats().errors, 0u);
+
+        // end_frame() retired frame 1, so its removed slot is free again
+        uint64_t reused = pipeline.register_material(MaterialData{});
+        ERGO_TEST_ASSERT_EQ(ctx, reused & 0xffffffffu, removed & 0xffffffffu);
+        renderer.shutdown();
+    });
+
+    suite_headless.add("Headless_ContextDrawsAsInstances", [](TestContext& ctx) {
+        HeadlessRenderer renderer({32, 32});
+        renderer.initialize();
+        TextureHandle tex = renderer.load_texture("atlas.png");
+        renderer.begin_frame();
+        RenderContext* rc = renderer.context();
+        rc->draw_rect({0.0f, 0.0f}, {8.0f, 8.0f}, {255, 0, 0, 255}, true);
+        rc->draw_circle({20.0f, 20.0f}, 4.0f, {0, 255, 0, 255}, true);
+        rc->draw_sprite({24.0f, 0.0f}, {8.0f, 8.0f}, tex, {});
+        renderer.end_frame();
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.stats().instanced_draws, 2u);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.stats().instances, 3u);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.pixel(4, 4), 0xff0000ffu);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.pixel(20, 20), 0xff00ff00u);
+        ERGO_TEST_ASSERT_EQ(ctx, renderer.pixel(20, 12), 0xff000000u);
+        ERGO_TEST_ASSERT_TRUE(ctx, renderer.pixel(28, 4) != 0xff000000u);
+    });
+}
+
 // ============================================================
 // Registration
 // ============================================================
@@ -216,8 +1207,18 @@ void register_render_tests(TestRunner& runner) {
     register_command_buffer_tests();
     register_post_process_tests();
     register_light_tests();
+    register_sprite_batch_tests();
+    register_visibility_tests();
+    register_upload_tests();
+    register_registry_tests();
+    register_headless_tests();
 
     runner.add_suite(suite_command_buffer);
     runner.add_suite(suite_post_process);
     runner.add_suite(suite_light);
+    runner.add_suite(suite_sprite_batch);
+    runner.add_suite(suite_visibility);
+    runner.add_suite(suite_uploads);
+    runner.add_suite(suite_registry);
+    runner.add_suite(suite_headless);
 }